@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_BUF_FILE_DATA_SRC_FACTORY_HPP
+#define _YACTFR_BUF_FILE_DATA_SRC_FACTORY_HPP
+
+#include <memory>
+#include <boost/noncopyable.hpp>
+#include <boost/optional/optional.hpp>
+#include <string>
+
+#include "data-src-factory.hpp"
+#include "aliases.hpp"
+
+namespace yactfr {
+namespace internal {
+
+class BufFileDataSrcFactoryImpl;
+
+} // namespace internal
+
+/*!
+@brief
+    Buffered file data source factory.
+
+@ingroup element_seq
+
+This is a factory of buffered file data sources, which are valid data
+sources for element sequences.
+
+A buffered file data source reads blocks of a file into a buffer which
+it owns with the <code>pread()</code> system call instead of memory
+mapping the file. Prefer this factory to MemoryMappedFileViewFactory
+when page faults are expensive, for example with a network or FUSE file
+system on which large sequential reads are much faster.
+
+All the buffered file data sources that such a factory creates operate
+on the same file handle/descriptor. The factory recycles the buffers of
+destroyed data sources, so that copying element sequence iterators
+doesn't allocate new buffers in the common case.
+
+Because a buffered file data source copies the data to its own buffer,
+it doesn't need the page cache once it has read a block: see CacheMode
+to scan a large file once without filling the page cache.
+*/
+class BufferedFileDataSourceFactory final :
+    public DataSourceFactory,
+    boost::noncopyable
+{
+public:
+    /*!
+    @brief
+        Page cache usage of buffered file data sources.
+    */
+    enum class CacheMode {
+        /// Read through the page cache, like any other program.
+        NORMAL,
+
+        /*!
+        Read through the page cache, but ask the kernel to drop the
+        cached pages of each block once the data source has read it
+        (<code>posix_fadvise()</code> with
+        <code>POSIX_FADV_DONTNEED</code>).
+
+        Note that this also drops the pages of this file which other
+        programs cached.
+        */
+        DROP_BEHIND,
+
+        /*!
+        Bypass the page cache completely (<code>O_DIRECT</code>): each
+        data source reads aligned blocks directly into its aligned
+        buffer.
+
+        If the file system doesn't support direct I/O, the factory falls
+        back to CacheMode::DROP_BEHIND (see cacheMode()).
+        */
+        DIRECT,
+    };
+
+public:
+    /*!
+    @brief
+        Creates a buffered file data source factory which can create
+        buffered file data sources on the file located at \p path.
+
+    \p blockSize is the size, in bytes, of each individual read
+    operation which the buffered file data sources of this factory
+    perform. The actual block size can be larger than \p blockSize
+    because the implementation rounds it up to a multiple of the
+    platform page size.
+
+    This factory can throw IOError on construction and when creating a
+    data source. Its created data source can throw IOError when getting
+    a new data block.
+
+    @param[in] path
+        Path of the file on which to create buffered file data sources.
+    @param[in] blockSize
+        Size (bytes) of each read operation, or \c boost::none to let
+        the implementation decide.
+    @param[in] cacheMode
+        Page cache usage of the buffered file data sources which this
+        factory creates. Prefer CacheMode::DROP_BEHIND or
+        CacheMode::DIRECT to scan a large file once.
+
+    @throws IOError
+        An I/O error occurred (file not found, permission denied, etc.).
+    */
+    explicit BufferedFileDataSourceFactory(std::string path,
+                                           const boost::optional<Size>& blockSize = boost::none,
+                                           CacheMode cacheMode = CacheMode::NORMAL);
+
+    /// Actual size (bytes) of each read operation.
+    Size blockSize() const noexcept;
+
+    /// Actual page cache usage of the buffered file data sources.
+    CacheMode cacheMode() const noexcept;
+
+private:
+    DataSource::UP _createDataSource() override;
+
+private:
+    /*
+     * Shared because buffered file data sources also keep a reference
+     * to keep the file descriptor opened and to give back their buffer.
+     */
+    std::shared_ptr<internal::BufFileDataSrcFactoryImpl> _pimpl;
+};
+
+} // namespace yactfr
+
+#endif // _YACTFR_BUF_FILE_DATA_SRC_FACTORY_HPP
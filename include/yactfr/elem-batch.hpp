@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_ELEM_BATCH_HPP
+#define _YACTFR_ELEM_BATCH_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "aliases.hpp"
+#include "elem.hpp"
+#include "metadata/fwd.hpp"
+
+namespace yactfr {
+
+class ElementSequenceIterator;
+
+namespace internal {
+
+class ParPktDecoderImpl;
+class Vm;
+
+} // namespace internal
+
+/*!
+@brief
+    Element batch.
+
+@ingroup element_seq
+
+An element batch contains compact records of consecutive elements.
+
+Call ElementSequenceIterator::nextBatch() to fill an element batch.
+You may reuse the same element batch for many calls: it keeps its
+allocated memory.
+
+Each record contains the kind, the offset, the data type (data elements
+only), and a value of its element, depending on the kind:
+
+<table>
+  <tr>
+    <th>Element kind
+    <th>Value
+  <tr>
+    <td>Element::Kind::FIXED_LENGTH_BIT_ARRAY,
+        Element::Kind::FIXED_LENGTH_BOOLEAN (0 or 1),
+        Element::Kind::FIXED_LENGTH_UNSIGNED_INTEGER,
+        Element::Kind::FIXED_LENGTH_UNSIGNED_ENUMERATION,
+        Element::Kind::VARIABLE_LENGTH_UNSIGNED_INTEGER,
+        Element::Kind::VARIABLE_LENGTH_UNSIGNED_ENUMERATION
+    <td>Record::unsignedIntegerValue
+  <tr>
+    <td>Element::Kind::FIXED_LENGTH_SIGNED_INTEGER,
+        Element::Kind::FIXED_LENGTH_SIGNED_ENUMERATION,
+        Element::Kind::VARIABLE_LENGTH_SIGNED_INTEGER,
+        Element::Kind::VARIABLE_LENGTH_SIGNED_ENUMERATION
+    <td>Record::signedIntegerValue
+  <tr>
+    <td>Element::Kind::FIXED_LENGTH_FLOATING_POINT_NUMBER
+    <td>Record::floatingPointNumberValue
+  <tr>
+    <td>Element::Kind::SUBSTRING,
+        Element::Kind::BLOB_SECTION,
+        Element::Kind::ARRAY_SECTION
+    <td>Record::section
+  <tr>
+    <td>Element::Kind::DEFAULT_CLOCK_VALUE
+    <td>Record::unsignedIntegerValue (cycles)
+  <tr>
+    <td>Element::Kind::PACKET_MAGIC_NUMBER
+    <td>Record::unsignedIntegerValue
+  <tr>
+    <td>Element::Kind::DATA_STREAM_INFO,
+        Element::Kind::EVENT_RECORD_INFO
+    <td>Record::unsignedIntegerValue (type ID, or 0 if none)
+  <tr>
+    <td>Element::Kind::SCOPE_BEGINNING,
+        Element::Kind::SCOPE_END
+    <td>Record::unsignedIntegerValue (numeric value of the Scope)
+  <tr>
+    <td>Element::Kind::STATIC_LENGTH_ARRAY_BEGINNING,
+        Element::Kind::DYNAMIC_LENGTH_ARRAY_BEGINNING,
+        Element::Kind::STATIC_LENGTH_BLOB_BEGINNING,
+        Element::Kind::DYNAMIC_LENGTH_BLOB_BEGINNING
+    <td>Record::unsignedIntegerValue (length)
+  <tr>
+    <td>Element::Kind::STATIC_LENGTH_STRING_BEGINNING,
+        Element::Kind::DYNAMIC_LENGTH_STRING_BEGINNING
+    <td>Record::unsignedIntegerValue (maximum length)
+  <tr>
+    <td>Any other kind
+    <td>Record::unsignedIntegerValue (0)
+</table>
+
+The section of a record points to bytes which the element batch owns,
+not to a data block of the data source: it remains valid until the next
+call to ElementSequenceIterator::nextBatch() with this element batch.
+*/
+class ElementBatch final
+{
+    friend class ElementSequenceIterator;
+    friend class internal::ParPktDecoderImpl;
+    friend class internal::Vm;
+
+public:
+    /// Section of data.
+    struct Section final
+    {
+        /// Beginning of the data.
+        const std::uint8_t *begin;
+
+        /// Size of the data (bytes).
+        Size size;
+    };
+
+    /// Compact element record.
+    struct Record final
+    {
+        /// Kind of the element.
+        Element::Kind kind;
+
+        /// Offset of the element within its element sequence (bits).
+        Index offset;
+
+        /// Data type of the element, or \c nullptr if it's not a data
+        /// element.
+        const DataType *dataType;
+
+        union {
+            /// Unsigned integer value.
+            unsigned long long unsignedIntegerValue;
+
+            /// Signed integer value.
+            long long signedIntegerValue;
+
+            /// Floating point number value.
+            double floatingPointNumberValue;
+
+            /// Section of data.
+            Section section;
+        };
+    };
+
+    /// Record vector.
+    using Records = std::vector<Record>;
+
+    /// Record iterator.
+    using ConstIterator = Records::const_iterator;
+
+public:
+    /// Builds an empty element batch.
+    explicit ElementBatch() = default;
+
+    /// Records of this element batch.
+    const Records& records() const noexcept
+    {
+        return _records;
+    }
+
+    /// Beginning of the records of this element batch.
+    ConstIterator begin() const noexcept
+    {
+        return _records.begin();
+    }
+
+    /// End of the records of this element batch.
+    ConstIterator end() const noexcept
+    {
+        return _records.end();
+    }
+
+    /// Number of records in this element batch.
+    Size size() const noexcept
+    {
+        return _records.size();
+    }
+
+    /// Whether or not this element batch is empty.
+    bool isEmpty() const noexcept
+    {
+        return _records.empty();
+    }
+
+    /*!
+    @brief
+        Returns the record at the index \p index.
+
+    @param[in] index
+        Index of the record to return.
+
+    @returns
+        Record at the index \p index.
+
+    @pre
+        \p index < size()
+    */
+    const Record& operator[](const Index index) const noexcept
+    {
+        return _records[index];
+    }
+
+private:
+    void _clear() noexcept;
+    void _append(const Element& elem, Index offset);
+    void _appendSection(Record& record, const std::uint8_t *begin, const std::uint8_t *end);
+    void _finish() noexcept;
+
+private:
+    Records _records;
+    std::vector<std::uint8_t> _sectionData;
+};
+
+} // namespace yactfr
+
+#endif // _YACTFR_ELEM_BATCH_HPP
@@ -24,7 +24,10 @@ class Vm;
 } // namespace internal
 
 class Element;
+class ElementBatch;
+class EventRecordColumnDecoder;
 class DataSourceFactory;
+class ElementSequenceOptions;
 class TraceType;
 
 /*!
@@ -39,6 +42,7 @@ ElementSequence::at() to create an element sequence iterator.
 class ElementSequenceIterator final
 {
     friend class ElementSequence;
+    friend class EventRecordColumnDecoder;
     friend class internal::Vm;
 
 public:
@@ -51,7 +55,9 @@ public:
 
 private:
     explicit ElementSequenceIterator(DataSourceFactory& dataSrcFactory,
-                                     const TraceType& traceType, bool end);
+                                     const TraceType& traceType,
+                                     std::shared_ptr<const ElementSequenceOptions> opts,
+                                     bool end);
 
 private:
     static constexpr Index _END_OFFSET = static_cast<Index>(~0ULL);
@@ -252,6 +258,162 @@ public:
     */
     void seekPacket(Index offset);
 
+    /*!
+    @brief
+        Advances this element sequence iterator to the ScopeEndElement
+        of the current scope.
+
+    The current scope is the scope which the current
+    ScopeBeginningElement of this iterator begins, or the innermost
+    scope which contains the current element of this iterator.
+
+    This method is equivalent to calling operator++() until the current
+    element is the ScopeEndElement of the current scope, but it
+    doesn't return to you for each skipped element.
+
+    This method does nothing if the current element of this iterator is
+    a ScopeEndElement.
+
+    @pre
+        This iterator is not equal to ElementSequence::end() on the
+        element sequence which created this iterator.
+    @pre
+        The current element of this iterator is a ScopeBeginningElement,
+        a ScopeEndElement, or any element between them.
+
+    @post
+        The current element of this iterator is the ScopeEndElement of
+        the current scope.
+
+    @throws ?
+        Any exception that the data source can throw when getting a new
+        data block.
+    @throws DecodingError
+        Any derived decoding error (see decoding-errors.hpp): advancing
+        led to a decoding error.
+    @throws DataNotAvailable
+        Data is not available now from the data source: try again later.
+    */
+    void skipCurrentScope();
+
+    /*!
+    @brief
+        Advances this element sequence iterator to the
+        StructureEndElement of the current structure.
+
+    The current structure is the structure which the current
+    StructureBeginningElement of this iterator begins, or the innermost
+    structure which contains the current element of this iterator.
+
+    This method is equivalent to calling operator++() until the current
+    element is the StructureEndElement of the current structure, but it
+    doesn't return to you for each skipped element.
+
+    This method does nothing if the current element of this iterator is
+    a StructureEndElement.
+
+    @pre
+        This iterator is not equal to ElementSequence::end() on the
+        element sequence which created this iterator.
+    @pre
+        The current element of this iterator is a
+        StructureBeginningElement, a StructureEndElement, or any element
+        between them.
+
+    @post
+        The current element of this iterator is the StructureEndElement
+        of the current structure.
+
+    @throws ?
+        Any exception that the data source can throw when getting a new
+        data block.
+    @throws DecodingError
+        Any derived decoding error (see decoding-errors.hpp): advancing
+        led to a decoding error.
+    @throws DataNotAvailable
+        Data is not available now from the data source: try again later.
+    */
+    void skipCurrentStructure();
+
+    /*!
+    @brief
+        Advances this element sequence iterator to the
+        EventRecordEndElement of the current event record.
+
+    This method is equivalent to calling operator++() until the current
+    element is an EventRecordEndElement, but it doesn't return to you
+    for each skipped element.
+
+    This method does nothing if the current element of this iterator is
+    an EventRecordEndElement.
+
+    @pre
+        This iterator is not equal to ElementSequence::end() on the
+        element sequence which created this iterator.
+    @pre
+        The current element of this iterator is an
+        EventRecordBeginningElement, an EventRecordEndElement, or any
+        element between them.
+
+    @post
+        The current element of this iterator is the
+        EventRecordEndElement of the current event record.
+
+    @throws ?
+        Any exception that the data source can throw when getting a new
+        data block.
+    @throws DecodingError
+        Any derived decoding error (see decoding-errors.hpp): advancing
+        led to a decoding error.
+    @throws DataNotAvailable
+        Data is not available now from the data source: try again later.
+    */
+    void skipToEventRecordEnd();
+
+    /*!
+    @brief
+        Fills \p batch with the records of at most \p maxCount
+        consecutive elements, starting with the current element, and
+        advances this element sequence iterator to the element following
+        the last recorded one.
+
+    This method is equivalent to recording the current element and then
+    calling operator++() until \p batch contains \p maxCount records or
+    this iterator reaches the end of its element sequence, but it
+    doesn't return to you for each element.
+
+    This method clears \p batch first. It keeps the allocated memory of
+    \p batch, so that you may reuse the same element batch for
+    many calls.
+
+    If advancing this iterator throws, then \p batch contains the
+    records of the elements which this method already passed.
+
+    @param[out] batch
+        Element batch to fill.
+    @param[in] maxCount
+        Maximum number of records to append to \p batch.
+
+    @pre
+        This iterator is not equal to ElementSequence::end() on the
+        element sequence which created this iterator.
+    @pre
+        \p maxCount ≥ 1.
+
+    @post
+        The current element of this iterator is invalidated.
+
+    @throws ?
+        Any exception that the data source can throw when getting a new
+        data block.
+    @throws DecodingError
+        Any derived decoding error (see decoding-errors.hpp): advancing
+        led to a decoding error.
+    @throws DataNotAvailable
+        Data is not available now from the data source: try again later.
+    */
+    void nextBatch(ElementBatch& batch, Size maxCount);
+
     /*!
     @brief
         Saves the position of this element sequence iterator
@@ -434,6 +596,7 @@ private:
 private:
     DataSourceFactory *_dataSrcFactory;
     const TraceType *_traceType;
+    std::shared_ptr<const ElementSequenceOptions> _opts;
     std::unique_ptr<internal::Vm> _vm;
 
     // current element
@@ -457,6 +620,12 @@ private:
      * iterators have their offset() method return the same value. Then,
      * for both iterators, ordering operators work as expected.
      *
+     * Only the first SubstringElement, BlobSectionElement, or
+     * ArraySectionElement of a string, BLOB, or array increments the
+     * mark: the following ones are at greater offsets anyway. This
+     * makes the mark independent of how the data source splits the
+     * data into blocks.
+     *
      * The mark is reset to 0 when the current element is
      * PacketBeginningElement, because two different packets within the
      * same element sequence cannot be at the same offset anyway (yactfr
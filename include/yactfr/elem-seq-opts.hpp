@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_ELEM_SEQ_OPTS_HPP
+#define _YACTFR_ELEM_SEQ_OPTS_HPP
+
+#include <functional>
+#include <set>
+#include <vector>
+#include <utility>
+#include <boost/optional/optional.hpp>
+
+#include "metadata/aliases.hpp"
+#include "metadata/ert.hpp"
+#include "metadata/data-loc.hpp"
+#include "elem.hpp"
+
+namespace yactfr {
+
+/*!
+@brief
+    Element sequence options.
+
+@ingroup element_seq
+
+Pass element sequence options to the
+\link ElementSequence::ElementSequence(const TraceType&, DataSourceFactory&, const ElementSequenceOptions&)
+element sequence constructor\endlink to change which elements its
+\link ElementSequenceIterator iterators\endlink produce.
+
+The default options make an element sequence iterator produce all the
+elements.
+*/
+class ElementSequenceOptions final
+{
+public:
+    /*!
+    @brief
+        Event record type filter.
+
+    An event record type filter returns \c true if the iterators must
+    produce the elements of an event record having a given type.
+    */
+    using EventRecordTypeFilter = std::function<bool (const EventRecordType&)>;
+
+public:
+    /*!
+    @brief
+        \c true if the iterators produce ArraySectionElement elements
+        for qualifying arrays.
+
+    @sa arraySectionsEnabled(bool)
+    */
+    bool arraySectionsEnabled() const noexcept
+    {
+        return _arraySectionsEnabled;
+    }
+
+    /*!
+    @brief
+        Sets whether or not the iterators produce ArraySectionElement
+        elements for qualifying arrays.
+
+    A qualifying array is a static-length or dynamic-length array of
+    which the element type is a fixed-length integer, enumeration, or
+    floating point number type with:
+
+    - A length of 8, 16, 32, or 64 bits.
+    - An alignment which is a multiple of 8 and which is less than or
+      equal to its length.
+
+    In other words, the items of a qualifying array are contiguous
+    bytes of data.
+
+    When this option is enabled, the iterators produce, between the
+    beginning and end elements of a qualifying array, one or more
+    ArraySectionElement elements instead of one element per array item.
+
+    @param[in] enabled
+        \c true to make the iterators produce ArraySectionElement
+        elements for qualifying arrays.
+    */
+    void arraySectionsEnabled(const bool enabled) noexcept
+    {
+        _arraySectionsEnabled = enabled;
+    }
+
+    /*!
+    @brief
+        Event record type filter, or an empty function if the iterators
+        produce the elements of all the event records.
+
+    @sa eventRecordTypeFilter(EventRecordTypeFilter)
+    */
+    const EventRecordTypeFilter& eventRecordTypeFilter() const noexcept
+    {
+        return _ertFilter;
+    }
+
+    /*!
+    @brief
+        Sets the event record type filter to \p filter.
+
+    When \p filter isn't an empty function, the iterators only produce
+    the elements of the event records of which \p filter returns \c true
+    for the type, including their EventRecordBeginningElement and
+    EventRecordEndElement elements.
+
+    The iterators still decode the other event records, without ever
+    producing their elements, to find the next one: decoding errors
+    within them remain possible.
+
+    An iterator only knows the type of an event record once it decoded
+    its header. Until then, an iterator keeps a copy of each element of
+    the event record. For each selected event record, an iterator then
+    produces those copies without decoding the header again, so that
+    the requested offsets of the data source still increase
+    monotonically. Therefore, filtering costs a copy of the header
+    elements of each event record.
+
+    Any iterator may call \p filter many times with the same event
+    record type.
+
+    @param[in] filter
+        New event record type filter, or an empty function to make the
+        iterators produce the elements of all the event records.
+    */
+    void eventRecordTypeFilter(EventRecordTypeFilter filter)
+    {
+        _ertFilter = std::move(filter);
+    }
+
+    /*!
+    @brief
+        Sets the event record type filter so that the iterators only
+        produce the elements of the event records of which the type ID
+        is in \p ids.
+
+    @param[in] ids
+        IDs of the types of the event records of which the iterators
+        produce the elements.
+
+    @sa eventRecordTypeFilter(EventRecordTypeFilter)
+    */
+    void eventRecordTypeFilter(std::set<TypeId> ids)
+    {
+        _ertFilter = [ids = std::move(ids)](const EventRecordType& ert) {
+            return ids.find(ert.id()) != ids.end();
+        };
+    }
+
+    /*!
+    @brief
+        Kinds of the elements which the iterators produce, or
+        \c boost::none if they produce elements of any kind.
+
+    @sa elementKinds(boost::optional<std::set<Element::Kind>>)
+    */
+    const boost::optional<std::set<Element::Kind>>& elementKinds() const noexcept
+    {
+        return _elemKinds;
+    }
+
+    /*!
+    @brief
+        Sets the kinds of the elements which the iterators produce to
+        \p kinds.
+
+    When \p kinds isn't \c boost::none, the iterators only produce the
+    elements having one of the kinds of \p kinds: they decode the data
+    of the other elements, maintaining the offsets, the saved lengths
+    and selectors, and the default clock value, without ever producing
+    them.
+
+    When the current element of an iterator becomes an element of which
+    the kind isn't part of \p kinds after a call to
+    ElementSequenceIterator::skipCurrentScope(),
+    ElementSequenceIterator::skipCurrentStructure(), or
+    ElementSequenceIterator::skipToEventRecordEnd(), the iterator goes
+    to the next element of which the kind is part of \p kinds.
+
+    @param[in] kinds
+        Kinds of the elements which the iterators produce, or
+        \c boost::none to make them produce elements of any kind.
+    */
+    void elementKinds(boost::optional<std::set<Element::Kind>> kinds)
+    {
+        _elemKinds = std::move(kinds);
+    }
+
+    /*!
+    @brief
+        Locations of the projected data, or \c boost::none if the
+        iterators produce the elements of all the data.
+
+    @sa projectedDataLocations(boost::optional<std::vector<DataLocation>>)
+    */
+    const boost::optional<std::vector<DataLocation>>& projectedDataLocations() const noexcept
+    {
+        return _projectedDataLocs;
+    }
+
+    /*!
+    @brief
+        Sets the locations of the projected data to \p locations.
+
+    When \p locations isn't \c boost::none, the iterators only produce,
+    as far as data elements (and their substring, BLOB section, and
+    array section elements) are concerned, the elements of:
+
+    - The data at the locations \p locations.
+    - The data which the data at the locations \p locations contains.
+    - The data which contains the data at the locations \p locations
+      (only the beginning and end elements of structures, arrays,
+      variants, and optionals).
+
+    The iterators also only produce the ScopeBeginningElement and
+    ScopeEndElement elements of the scopes which contain projected data
+    for at least one data stream or event record type.
+
+    The iterators always produce the elements which aren't data
+    elements, for example EventRecordBeginningElement and
+    DefaultClockValueElement.
+
+    A path element of a data location is the name of a structure
+    member: to go through an array, an optional, or a variant, continue
+    with the name of a member of the structure which it contains.
+
+    @param[in] locations
+        Locations of the projected data, or \c boost::none to make the
+        iterators produce the elements of all the data.
+    */
+    void projectedDataLocations(boost::optional<std::vector<DataLocation>> locations)
+    {
+        _projectedDataLocs = std::move(locations);
+    }
+
+private:
+    bool _arraySectionsEnabled = false;
+    EventRecordTypeFilter _ertFilter;
+    boost::optional<std::set<Element::Kind>> _elemKinds;
+    boost::optional<std::vector<DataLocation>> _projectedDataLocs;
+};
+
+} // namespace yactfr
+
+#endif // _YACTFR_ELEM_SEQ_OPTS_HPP
@@ -11,10 +11,12 @@
 #include <memory>
 
 #include "elem-seq-it.hpp"
+#include "elem-seq-opts.hpp"
 
 namespace yactfr {
 
 class DataSourceFactory;
+class PacketIndex;
 class TraceType;
 
 /*!
@@ -31,6 +33,10 @@ Once you create an element sequence iterator with
 ElementSequence::begin(), you can seek a packet which is known to be at
 a specific offset with ElementSequenceIterator::seekPacket(). You can
 also use the ElementSequence::at() helper.
+
+To get an iterator at the first event record of which the timestamp is
+greater than or equal to some value, use ElementSequence::atTimestamp()
+or ElementSequence::atNanosecondsFromOrigin().
 */
 class ElementSequence final
 {
@@ -61,6 +67,36 @@ public:
     */
     explicit ElementSequence(const TraceType& traceType, DataSourceFactory& dataSourceFactory);
 
+    /*!
+    @brief
+        Builds an element sequence described by the trace type
+        \p traceType, of which the iterators create data sources
+        with \p dataSourceFactory, and with the options \p options.
+
+    \p traceType and \p dataSourceFactory must exist as long as this
+    element sequence, or any \link ElementSequenceIterator element
+    sequence iterator\endlink created from this element sequence,
+    exists.
+
+    This constructor copies \p options.
+
+    @param[in] traceType
+        Trace type which describes the element sequence to create.
+    @param[in] dataSourceFactory
+        Factory of data sources used by the iterators which this element
+        sequence creates.
+    @param[in] options
+        Options of the iterators which this element sequence creates.
+    */
+    explicit ElementSequence(const TraceType& traceType, DataSourceFactory& dataSourceFactory,
+                             const ElementSequenceOptions& options);
+
+    /// Options of the iterators which this element sequence creates.
+    const ElementSequenceOptions& options() const noexcept
+    {
+        return *_opts;
+    }
+
     /*!
     @brief
         Returns an element sequence iterator at the beginning of this
@@ -131,9 +167,148 @@ public:
     */
     Iterator at(Index offset);
 
+    /*!
+    @brief
+        Creates an iterator at the EventRecordBeginningElement of the
+        first event record of this element sequence of which the
+        default clock value is greater than or equal to \p cycles,
+        using the packet index \p packetIndex.
+
+    This method binary searches \p packetIndex on the beginning and end
+    default clock values of its entries to find the first packet which
+    can contain such an event record, seeks this packet, and then
+    advances until it finds the event record, skipping the data of the
+    earlier event records.
+
+    The default clock value of an event record is the value of the
+    first DefaultClockValueElement which follows its
+    EventRecordBeginningElement, before its EventRecordInfoElement.
+    This method ignores an event record which has no default clock
+    value.
+
+    The options of this element sequence must make its iterators
+    produce EventRecordBeginningElement, EventRecordEndElement,
+    DefaultClockValueElement, and EventRecordInfoElement elements (see
+    ElementSequenceOptions::elementKinds()).
+
+    @param[in] packetIndex
+        Packet index of this element sequence.
+    @param[in] cycles
+        Default clock value (cycles) of the event record to find.
+
+    @returns
+        Element sequence iterator at the EventRecordBeginningElement of
+        the first event record of which the default clock value is
+        greater than or equal to \p cycles, or end() if there's none.
+
+    @throws ?
+        Any exception that the data source of the iterator can throw.
+    @throws DecodingError
+        Any derived decoding error (see decoding-errors.hpp).
+    @throws DataNotAvailable
+        Data is not available now; try again later.
+    */
+    Iterator atTimestamp(const PacketIndex& packetIndex, Cycles cycles);
+
+    /*!
+    @brief
+        Like atTimestamp(const PacketIndex&, Cycles), but using the
+        packet index of this element sequence, building it on the first
+        call.
+
+    This element sequence keeps its packet index (see PacketIndex) once
+    built: if the data of the data source factory grows afterwards, use
+    atTimestamp(const PacketIndex&, Cycles) with an up-to-date packet
+    index.
+
+    @param[in] cycles
+        Default clock value (cycles) of the event record to find.
+
+    @returns
+        Element sequence iterator at the EventRecordBeginningElement of
+        the first event record of which the default clock value is
+        greater than or equal to \p cycles, or end() if there's none.
+
+    @throws ?
+        Any exception that the data source of the iterator can throw.
+    @throws DecodingError
+        Any derived decoding error (see decoding-errors.hpp).
+    @throws DataNotAvailable
+        Data is not available now; try again later.
+    */
+    Iterator atTimestamp(Cycles cycles);
+
+    /*!
+    @brief
+        Like atTimestamp(const PacketIndex&, Cycles), but with a time
+        point, \p nsFromOrigin, in nanoseconds from the origin of the
+        default clock.
+
+    This method converts \p nsFromOrigin to a default clock value
+    using the frequency and the offset (see ClockType::offset()) of the
+    default clock type of the data stream type of the first entry of
+    \p packetIndex which has one, rounding up.
+
+    @param[in] packetIndex
+        Packet index of this element sequence.
+    @param[in] nsFromOrigin
+        Time point (nanoseconds from origin) of the event record to
+        find.
+
+    @returns
+        Element sequence iterator at the EventRecordBeginningElement of
+        the first event record of which the time point is greater than
+        or equal to \p nsFromOrigin, or end() if there's none, or if no
+        entry of \p packetIndex has a data stream type with a default
+        clock type.
+
+    @throws ?
+        Any exception that the data source of the iterator can throw.
+    @throws DecodingError
+        Any derived decoding error (see decoding-errors.hpp).
+    @throws DataNotAvailable
+        Data is not available now; try again later.
+    */
+    Iterator atNanosecondsFromOrigin(const PacketIndex& packetIndex, long long nsFromOrigin);
+
+    /*!
+    @brief
+        Like atNanosecondsFromOrigin(const PacketIndex&, long long),
+        but using the packet index of this element sequence, building
+        it on the first call.
+
+    @param[in] nsFromOrigin
+        Time point (nanoseconds from origin) of the event record to
+        find.
+
+    @returns
+        Element sequence iterator at the EventRecordBeginningElement of
+        the first event record of which the time point is greater than
+        or equal to \p nsFromOrigin, or end() if there's none.
+
+    @throws ?
+        Any exception that the data source of the iterator can throw.
+    @throws DecodingError
+        Any derived decoding error (see decoding-errors.hpp).
+    @throws DataNotAvailable
+        Data is not available now; try again later.
+
+    @sa atTimestamp(Cycles)
+    */
+    Iterator atNanosecondsFromOrigin(long long nsFromOrigin);
+
+private:
+    const PacketIndex& _pktIndex();
+
 private:
     const TraceType *_traceType;
     DataSourceFactory *_dataSrcFactory;
+
+    // shared with the iterators, which can outlive this sequence
+    std::shared_ptr<const ElementSequenceOptions> _opts;
+
+    // packet index, built on the first call to _pktIndex()
+    std::shared_ptr<const PacketIndex> _pktIndexPtr;
 };
 
 } // namespace yactfr
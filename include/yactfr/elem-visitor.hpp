@@ -12,6 +12,7 @@ namespace yactfr {
 
 class ArrayBeginningElement;
 class ArrayEndElement;
+class ArraySectionElement;
 class BeginningElement;
 class BlobBeginningElement;
 class BlobEndElement;
@@ -92,6 +93,7 @@ public:
     virtual ~ElementVisitor() = default;
     virtual void visit(const ArrayBeginningElement&);
     virtual void visit(const ArrayEndElement&);
+    virtual void visit(const ArraySectionElement&);
     virtual void visit(const BeginningElement&);
     virtual void visit(const BlobBeginningElement&);
     virtual void visit(const BlobEndElement&);
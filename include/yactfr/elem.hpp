@@ -63,7 +63,7 @@ class VmPos;
 class Element
 {
 private:
-    enum _Kind
+    enum _Kind : unsigned long long
     {
         _KIND_END                               = 1 << 0,
         _KIND_BEG                               = 1 << 1,
@@ -96,7 +96,8 @@ private:
         _KIND_VAR                               = 1 << 28,
         _KIND_INT_SEL                           = 1 << 29,
         _KIND_BOOL_SEL                          = 1 << 30,
-        _KIND_OPT                               = 1 << 31,
+        _KIND_OPT                               = 1ULL << 31,
+        _KIND_ARRAY_SECTION                     = 1ULL << 32,
     };
 
     using _U = unsigned long long;
@@ -192,6 +193,9 @@ public:
         /// BlobSectionElement
         BLOB_SECTION                                        = static_cast<_U>(_KIND_BLOB_SECTION),
 
+        /// ArraySectionElement
+        ARRAY_SECTION                                       = static_cast<_U>(_KIND_ARRAY_SECTION),
+
         /// StructureBeginningElement
         STRUCTURE_BEGINNING                                 = static_cast<_U>(_KIND_STRUCT | _KIND_BEG),
 
@@ -578,6 +582,12 @@ public:
         return _kind == Kind::BLOB_SECTION;
     }
 
+    /// \c true if this element is an array section element.
+    bool isArraySectionElement() const noexcept
+    {
+        return _kind == Kind::ARRAY_SECTION;
+    }
+
     /// \c true if this element is a structure beginning/end element.
     bool isStructureElement() const noexcept
     {
@@ -875,6 +885,15 @@ public:
     */
     const BlobSectionElement& asBlobSectionElement() const noexcept;
 
+    /*!
+    @brief
+        Returns this element as an array section element.
+
+    @pre
+        This type is an array section element.
+    */
+    const ArraySectionElement& asArraySectionElement() const noexcept;
+
     /*!
     @brief
         Returns this element as a data stream info element.
@@ -2899,6 +2918,106 @@ private:
     const std::uint8_t *_end = nullptr;
 };
 
+/*!
+@brief
+    Array section element.
+
+@ingroup elems
+
+This element only occurs when
+ElementSequenceOptions::arraySectionsEnabled() is \c true for the
+element sequence of the iterator.
+
+This element can occur:
+
+<dl>
+  <dt>Data stream static-length array</dt>
+  <dd>
+    Between StaticLengthArrayBeginningElement and
+    StaticLengthArrayEndElement elements, instead of one element per
+    array item.
+  </dd>
+
+  <dt>Data stream dynamic-length array</dt>
+  <dd>
+    Between DynamicLengthArrayBeginningElement and
+    DynamicLengthArrayEndElement elements, instead of one element per
+    array item.
+  </dd>
+</dl>
+
+An array section element contains one or more contiguous items of an
+array of which the element type is a fixed-length integer,
+enumeration, or floating point number type (see elementType()).
+
+begin() points to the first byte of the first item of the array section
+and end() points to the byte \em after the last byte of the last item of
+the array section. Use length() to get the number of items of the array
+section.
+
+The bytes of each item are in the byte order of the element type (see
+byteOrder()), without any padding between items.
+*/
+class ArraySectionElement final :
+    public Element
+{
+    friend class internal::Vm;
+    friend class internal::VmPos;
+
+private:
+    explicit ArraySectionElement() :
+        Element {Kind::ARRAY_SECTION}
+    {
+    }
+
+public:
+    /// Beginning of the data of this array section.
+    const std::uint8_t *begin() const noexcept
+    {
+        return _begin;
+    }
+
+    /// End of the data of this array section.
+    const std::uint8_t *end() const noexcept
+    {
+        return _end;
+    }
+
+    /// Size (bytes) of this array section.
+    Size size() const noexcept
+    {
+        return _end - _begin;
+    }
+
+    /// Number of items of this array section.
+    Size length() const noexcept
+    {
+        return this->size() / (_elemType->length() / 8);
+    }
+
+    /// Type of the items of this array section.
+    const FixedLengthBitArrayType& elementType() const noexcept
+    {
+        return *_elemType;
+    }
+
+    /// Byte order of the items of this array section.
+    ByteOrder byteOrder() const noexcept
+    {
+        return _elemType->byteOrder();
+    }
+
+    void accept(ElementVisitor& visitor) const override
+    {
+        visitor.visit(*this);
+    }
+
+private:
+    const std::uint8_t *_begin = nullptr;
+    const std::uint8_t *_end = nullptr;
+    const FixedLengthBitArrayType *_elemType = nullptr;
+};
+
 /*!
 @brief
     Array beginning base element.
@@ -4243,6 +4362,11 @@ inline const BlobSectionElement& Element::asBlobSectionElement() const noexcept
     return static_cast<const BlobSectionElement&>(*this);
 }
 
+inline const ArraySectionElement& Element::asArraySectionElement() const noexcept
+{
+    return static_cast<const ArraySectionElement&>(*this);
+}
+
 inline const DataStreamInfoElement& Element::asDataStreamInfoElement() const noexcept
 {
     return static_cast<const DataStreamInfoElement&>(*this);
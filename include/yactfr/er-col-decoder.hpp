@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_ER_COL_DECODER_HPP
+#define _YACTFR_ER_COL_DECODER_HPP
+
+#include <vector>
+#include <unordered_map>
+
+#include "aliases.hpp"
+#include "metadata/aliases.hpp"
+#include "metadata/fwd.hpp"
+#include "elem-seq.hpp"
+#include "elem-seq-opts.hpp"
+#include "er-cols.hpp"
+
+namespace yactfr {
+
+class DataSourceFactory;
+class Element;
+
+/*!
+@brief
+    Event record column decoder.
+
+@ingroup element_seq
+
+An event record column decoder decodes, one packet at a time, the event
+records of selected types into EventRecordColumns objects: contiguous
+per-datum columns of typed values.
+
+An event record column decoder owns an element sequence of which the
+iterator only produces the elements it needs: it decodes the event
+records of the other types without ever returning them.
+
+The event record columns of a decoder, which it creates on
+construction, remain the same objects during its whole lifetime: each
+call to decodeNextPacket() clears their values while keeping their
+allocated memory, so that decoding many packets doesn't reallocate once
+the columns are large enough.
+*/
+class EventRecordColumnDecoder final
+{
+public:
+    /// Event record columns vector.
+    using EventRecordColumnsVector = std::vector<EventRecordColumns>;
+
+public:
+    /*!
+    @brief
+        Builds an event record column decoder, described by the trace
+        type \p traceType, of which the element sequence creates data
+        sources with \p dataSourceFactory, for the event records of
+        which \p filter returns \c true for the type.
+
+    \p traceType and \p dataSourceFactory must exist as long as this
+    event record column decoder exists.
+
+    @param[in] traceType
+        Trace type which describes the packets to decode.
+    @param[in] dataSourceFactory
+        Factory of data sources used by the element sequence of this
+        decoder.
+    @param[in] filter
+        Event record type filter, or an empty function to decode the
+        event records of all the types.
+    */
+    explicit EventRecordColumnDecoder(const TraceType& traceType,
+                                      DataSourceFactory& dataSourceFactory,
+                                      ElementSequenceOptions::EventRecordTypeFilter filter = {});
+
+    /// Deleted copy constructor.
+    EventRecordColumnDecoder(const EventRecordColumnDecoder&) = delete;
+
+    /// Deleted copy assignment operator.
+    EventRecordColumnDecoder& operator=(const EventRecordColumnDecoder&) = delete;
+
+    /// Columns of the selected event record types, in data stream type
+    /// and event record type ID order.
+    const EventRecordColumnsVector& eventRecordColumns() const noexcept
+    {
+        return _erColsVec;
+    }
+
+    /*!
+    @brief
+        Returns the columns of the event record type \p eventRecordType,
+        or \c nullptr if this decoder doesn't decode the event records
+        of this type.
+
+    @param[in] eventRecordType
+        Event record type of the columns to find.
+
+    @returns
+        Columns of \p eventRecordType, or \c nullptr if none.
+    */
+    const EventRecordColumns *operator[](const EventRecordType& eventRecordType) const noexcept;
+
+    /*!
+    @brief
+        Clears all the event record columns and decodes the next packet
+        into them.
+
+    If this method throws, then the event record columns contain
+    partially decoded values until the next call.
+
+    @returns
+        \c true if this method decoded a packet, or \c false if there's
+        no more packet to decode (all the event record columns are
+        empty).
+
+    @throws ?
+        Any exception that the data source can throw when getting a new
+        data block.
+    @throws DecodingError
+        Any derived decoding error (see decoding-errors.hpp).
+    @throws DataNotAvailable
+        Data is not available now from the data source: try again later.
+    */
+    bool decodeNextPacket();
+
+    /*!
+    @brief
+        Makes the next call to decodeNextPacket() decode the packet
+        known to be located at offset \p offset (bytes).
+
+    @param[in] offset
+        Offset, in bytes, of the first byte of a packet within the
+        element sequence of this decoder.
+
+    @pre
+        \p offset corresponds to the very first byte of a packet within
+        the element sequence of this decoder.
+
+    @throws ?
+        Any exception that the data source can throw when getting a new
+        data block.
+    @throws DataNotAvailable
+        Data is not available now from the data source: try again later.
+    */
+    void seekPacket(Index offset);
+
+private:
+    static ElementSequenceOptions _elemSeqOpts(ElementSequenceOptions::EventRecordTypeFilter filter);
+    void _addErCols(const EventRecordType& ert);
+    void _addCols(EventRecordColumns& erCols, const StructureType *structType, Scope scope);
+    void _addCols(EventRecordColumns& erCols, const DataType& dt,
+                  const DataLocation::PathElements& pathElems, Scope scope);
+    void _setInstrColIndexes(const TraceType& traceType);
+    void _handleElem(const Element& elem);
+    EventRecordColumn *_curCol() noexcept;
+
+private:
+    ElementSequence _elemSeq;
+    ElementSequenceIterator _it;
+    bool _started = false;
+    EventRecordColumnsVector _erColsVec;
+
+    // event record type to index within `_erColsVec`
+    std::unordered_map<const EventRecordType *, Index> _ertErColsIndexes;
+
+    /*
+     * Index of the column which the data element of an instruction of
+     * the packet procedure fills within the columns of its event
+     * record, indexed with the index of the instruction.
+     */
+    std::vector<Index> _instrColIndexes;
+
+    // columns of the current event record, if any
+    EventRecordColumns *_curErCols = nullptr;
+
+    // current string column, if any
+    EventRecordColumn *_curStrCol = nullptr;
+
+    // whether or not the current string reached its null character
+    bool _curStrEnded = false;
+
+    // last default clock value
+    Cycles _defClkVal = 0;
+};
+
+} // namespace yactfr
+
+#endif // _YACTFR_ER_COL_DECODER_HPP
@@ -0,0 +1,250 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_ER_COLS_HPP
+#define _YACTFR_ER_COLS_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+
+#include "aliases.hpp"
+#include "metadata/aliases.hpp"
+#include "metadata/data-loc.hpp"
+#include "metadata/fwd.hpp"
+
+namespace yactfr {
+
+class EventRecordColumnDecoder;
+class EventRecordColumns;
+
+/*!
+@brief
+    Event record column.
+
+@ingroup element_seq
+
+An event record column contains, for each decoded event record of a
+given type, the value of a given scalar datum.
+
+Depending on kind(), the values are in:
+
+<dl>
+  <dt>EventRecordColumn::Kind::UNSIGNED_INTEGER
+  <dd>unsignedIntegerValues()
+
+  <dt>EventRecordColumn::Kind::SIGNED_INTEGER
+  <dd>signedIntegerValues()
+
+  <dt>EventRecordColumn::Kind::FLOATING_POINT_NUMBER
+  <dd>floatingPointNumberValues()
+
+  <dt>EventRecordColumn::Kind::STRING
+  <dd>
+    stringData() and stringOffsets(): the string of the event record at
+    the index \em i is the range of bytes from
+    <code>stringOffsets()[i]</code> to
+    <code>stringOffsets()[i + 1]</code> (excluded) within
+    stringData(), without any terminating null character.
+</dl>
+*/
+class EventRecordColumn final
+{
+    friend class EventRecordColumnDecoder;
+    friend class EventRecordColumns;
+
+public:
+    /// Event record column kind.
+    enum class Kind
+    {
+        /// Unsigned integers (fixed-length bit arrays, booleans,
+        /// unsigned integers, and unsigned enumerations).
+        UNSIGNED_INTEGER,
+
+        /// Signed integers (signed integers and signed enumerations).
+        SIGNED_INTEGER,
+
+        /// Floating point numbers.
+        FLOATING_POINT_NUMBER,
+
+        /// Strings.
+        STRING,
+    };
+
+private:
+    explicit EventRecordColumn(DataLocation location, const DataType& dataType, Kind kind);
+
+public:
+    /// Location of the datum of this column.
+    const DataLocation& location() const noexcept
+    {
+        return _loc;
+    }
+
+    /// Type of the datum of this column.
+    const DataType& dataType() const noexcept
+    {
+        return *_dt;
+    }
+
+    /// Kind of this column.
+    Kind kind() const noexcept
+    {
+        return _kind;
+    }
+
+    /// Values of this column if kind() is
+    /// EventRecordColumn::Kind::UNSIGNED_INTEGER.
+    const std::vector<unsigned long long>& unsignedIntegerValues() const noexcept
+    {
+        return _uIntVals;
+    }
+
+    /// Values of this column if kind() is
+    /// EventRecordColumn::Kind::SIGNED_INTEGER.
+    const std::vector<long long>& signedIntegerValues() const noexcept
+    {
+        return _sIntVals;
+    }
+
+    /// Values of this column if kind() is
+    /// EventRecordColumn::Kind::FLOATING_POINT_NUMBER.
+    const std::vector<double>& floatingPointNumberValues() const noexcept
+    {
+        return _floatVals;
+    }
+
+    /// Concatenated strings of this column if kind() is
+    /// EventRecordColumn::Kind::STRING.
+    const std::vector<char>& stringData() const noexcept
+    {
+        return _strData;
+    }
+
+    /// Offsets of the strings of this column within stringData(), plus
+    /// the size of stringData(), if kind() is
+    /// EventRecordColumn::Kind::STRING.
+    const std::vector<Index>& stringOffsets() const noexcept
+    {
+        return _strOffsets;
+    }
+
+    /*!
+    @brief
+        Returns the string of the event record at the index \p index.
+
+    @param[in] index
+        Index of the event record of which to get the string.
+
+    @returns
+        String of the event record at the index \p index.
+
+    @pre
+        kind() is EventRecordColumn::Kind::STRING.
+    @pre
+        \p index < <code>stringOffsets().size() - 1</code>
+    */
+    std::string stringValue(Index index) const;
+
+private:
+    void _clear() noexcept;
+
+private:
+    DataLocation _loc;
+    const DataType *_dt;
+    Kind _kind;
+    std::vector<unsigned long long> _uIntVals;
+    std::vector<long long> _sIntVals;
+    std::vector<double> _floatVals;
+    std::vector<char> _strData;
+    std::vector<Index> _strOffsets;
+};
+
+/*!
+@brief
+    Event record columns.
+
+@ingroup element_seq
+
+Event record columns contain, for the decoded event records of a given
+type, one timestamp column and one EventRecordColumn per scalar datum
+of the event record common context, specific context, and payload
+scopes.
+
+Only the scalar data which you can reach from the root structure of its
+scope through structure members only have a column: the data within
+arrays, variants, and optionals don't.
+
+All the columns, including timestamps(), have size() values.
+*/
+class EventRecordColumns final
+{
+    friend class EventRecordColumnDecoder;
+
+public:
+    /// Column vector.
+    using Columns = std::vector<EventRecordColumn>;
+
+private:
+    explicit EventRecordColumns(const EventRecordType& eventRecordType);
+
+public:
+    /// Type of the event records of these columns.
+    const EventRecordType& eventRecordType() const noexcept
+    {
+        return *_ert;
+    }
+
+    /// Number of decoded event records.
+    Size size() const noexcept
+    {
+        return _timestamps.size();
+    }
+
+    /// Default clock values (cycles) of the decoded event records, or
+    /// zeros if their data stream type has no default clock type.
+    const std::vector<Cycles>& timestamps() const noexcept
+    {
+        return _timestamps;
+    }
+
+    /// Data columns.
+    const Columns& columns() const noexcept
+    {
+        return _cols;
+    }
+
+    /*!
+    @brief
+        Returns the column of which the datum is at the location
+        \p location, or \c nullptr if none.
+
+    @param[in] location
+        Location of the datum of the column to find.
+
+    @returns
+        Column of which the datum is at the location \p location, or
+        \c nullptr if none.
+    */
+    const EventRecordColumn *operator[](const DataLocation& location) const noexcept;
+
+private:
+    void _clear() noexcept;
+
+private:
+    const EventRecordType *_ert;
+    std::vector<Cycles> _timestamps;
+    Columns _cols;
+
+    // location (scope and path elements) to column index
+    std::map<std::pair<Scope, DataLocation::PathElements>, Index> _locColIndexes;
+};
+
+} // namespace yactfr
+
+#endif // _YACTFR_ER_COLS_HPP
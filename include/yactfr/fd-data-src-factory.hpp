@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_FD_DATA_SRC_FACTORY_HPP
+#define _YACTFR_FD_DATA_SRC_FACTORY_HPP
+
+#include <memory>
+#include <boost/noncopyable.hpp>
+#include <boost/optional/optional.hpp>
+
+#include "data-src-factory.hpp"
+#include "aliases.hpp"
+
+namespace yactfr {
+namespace internal {
+
+class FdDataSrcFactoryImpl;
+
+} // namespace internal
+
+/*!
+@brief
+    File descriptor data source factory.
+
+@ingroup element_seq
+
+This is a factory of file descriptor data sources, which are valid data
+sources for element sequences.
+
+A file descriptor data source reads a data stream sequentially from a
+file descriptor with the <code>read()</code> system call. The file
+descriptor doesn't need to be seekable: it can be a pipe, a socket, or
+the standard input, for example to decode the output of a decompressor
+or of a remote host without writing it to disk first.
+
+All the data sources of a factory share a bounded ring buffer which
+contains the most recently read data: the factory discards the oldest
+data when it needs room for new data, so that the memory usage remains
+constant whatever the size of the data stream. A data source copies the
+data it needs from this ring buffer to its own block buffer.
+
+Therefore, you may copy an element sequence iterator or restore a
+saved position (see ElementSequenceIterator::restorePosition()) only
+as long as the data at this position is still buffered: otherwise, the
+data source throws IOError.
+
+The factory never closes the file descriptor.
+*/
+class FileDescriptorDataSourceFactory final :
+    public DataSourceFactory,
+    boost::noncopyable
+{
+public:
+    /*!
+    @brief
+        Creates a file descriptor data source factory which can create
+        data sources on the file descriptor \p fd.
+
+    \p fd must remain open as long as the factory or any of its data
+    sources exists. Nothing else may read \p fd in the meantime.
+
+    This factory's created data sources can throw IOError when getting
+    a new data block.
+
+    @param[in] fd
+        File descriptor from which to read the data stream.
+    @param[in] bufferSize
+        Size (bytes) of the ring buffer which contains the most
+        recently read data, or \c boost::none to let the implementation
+        decide.
+
+        The actual size is at least 64&nbsp;bytes.
+    */
+    explicit FileDescriptorDataSourceFactory(int fd,
+                                             const boost::optional<Size>& bufferSize = boost::none);
+
+    /// File descriptor from which the data sources read.
+    int fd() const noexcept;
+
+    /// Size (bytes) of the ring buffer.
+    Size bufferSize() const noexcept;
+
+private:
+    DataSource::UP _createDataSource() override;
+
+private:
+    // shared because file descriptor data sources also keep a reference
+    std::shared_ptr<internal::FdDataSrcFactoryImpl> _pimpl;
+};
+
+} // namespace yactfr
+
+#endif // _YACTFR_FD_DATA_SRC_FACTORY_HPP
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_LIVE_FILE_DATA_SRC_FACTORY_HPP
+#define _YACTFR_LIVE_FILE_DATA_SRC_FACTORY_HPP
+
+#include <memory>
+#include <boost/noncopyable.hpp>
+#include <boost/optional/optional.hpp>
+#include <string>
+
+#include "data-src-factory.hpp"
+#include "aliases.hpp"
+
+namespace yactfr {
+namespace internal {
+
+class MmapFileViewFactoryImpl;
+
+} // namespace internal
+
+/*!
+@brief
+    Live file data source factory.
+
+@ingroup element_seq
+
+This is a factory of live file data sources, which are valid data
+sources for element sequences.
+
+A live file data source reads a data stream file which a tracer keeps
+appending to, for example during an LTTng live capture, without
+reopening or rescanning it.
+
+Like a memory mapped file view (see MemoryMappedFileViewFactory), a
+live file data source memory maps the file. However, it maps whole
+windows of the preferred memory map size, even beyond the current end
+of the file, so that a mapped window remains valid as the file grows.
+
+A live file data source only gets the current size of the file
+(\c fstat()) when it needs data beyond the last known size. If the
+requested data isn't in the file yet, it throws DataNotAvailable: the
+element sequence iterator remains at the same position, and you may
+retry the same operation later to resume exactly where it stopped.
+
+Once the tracer is done writing the file, call markComplete(): the data
+sources then report the end of the data instead of throwing
+DataNotAvailable at the end of the file.
+
+The file must never shrink while live file data sources read it.
+
+All the live file data sources that such a factory creates operate on
+the same file handle/descriptor and share the same cache of memory
+mapped regions.
+*/
+class LiveFileDataSourceFactory final :
+    public DataSourceFactory,
+    boost::noncopyable
+{
+public:
+    /*!
+    @brief
+        Creates a live file data source factory which can create live
+        file data sources on the file located at \p path.
+
+    \p preferredMmapSize is the preferred size, in bytes, of each
+    memory mapped window. The actual size can be larger than
+    \p preferredMmapSize if the platform imposes a minimum size.
+
+    This factory can throw IOError on construction and when creating a
+    data source. Its created data source can throw IOError and
+    DataNotAvailable when getting a new data block.
+
+    @param[in] path
+        Path of the file on which to create live file data sources.
+    @param[in] preferredMmapSize
+        Preferred size (bytes) of each memory mapped window, or
+        \c boost::none to let the implementation decide.
+
+    @throws IOError
+        An I/O error occurred (file not found, permission denied, etc.).
+    */
+    explicit LiveFileDataSourceFactory(std::string path,
+                                       const boost::optional<Size>& preferredMmapSize = boost::none);
+
+    /*!
+    @brief
+        Last known size (bytes) of the file.
+
+    This is the size of the file when a data source or
+    updateFileSize() last got it.
+    */
+    Size fileSize() const noexcept;
+
+    /*!
+    @brief
+        Gets the current size of the file, updating the last known file
+        size (see fileSize()).
+
+    @returns
+        Current size (bytes) of the file.
+
+    @throws IOError
+        Cannot get the status of the file.
+    */
+    Size updateFileSize();
+
+    /*!
+    @brief
+        Marks the file as complete: the tracer won't append any more
+        data to it.
+
+    After this call, the live file data sources of this factory report
+    the end of the data, instead of throwing DataNotAvailable, when
+    there's no more data in the file.
+    */
+    void markComplete() noexcept;
+
+    /// Whether or not the file is marked as complete (see markComplete()).
+    bool isComplete() const noexcept;
+
+private:
+    DataSource::UP _createDataSource() override;
+
+private:
+    /*
+     * Shared because live file data sources also keep a reference to
+     * keep the file descriptor opened and to pin cached regions.
+     */
+    std::shared_ptr<internal::MmapFileViewFactoryImpl> _pimpl;
+};
+
+} // namespace yactfr
+
+#endif // _YACTFR_LIVE_FILE_DATA_SRC_FACTORY_HPP
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_MEM_DATA_SRC_FACTORY_HPP
+#define _YACTFR_MEM_DATA_SRC_FACTORY_HPP
+
+#include <memory>
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+#include "data-src-factory.hpp"
+#include "data-blk.hpp"
+#include "aliases.hpp"
+
+namespace yactfr {
+namespace internal {
+
+class MemDataSrcFactoryImpl;
+
+} // namespace internal
+
+/*!
+@brief
+    Memory data source factory.
+
+@ingroup element_seq
+
+This is a factory of memory data sources, which are valid data sources
+for element sequences.
+
+A memory data source reads data which already exists in memory, either
+a single contiguous buffer or a list of separately allocated chunks
+(for example, the buffers into which a collector receives packets). In
+the latter case, the data source presents the concatenation of the
+chunks as a single sequence of bytes, without concatenating them
+first.
+
+A memory data source never copies data, except when the element
+sequence iterator needs a few bytes which span more than one chunk: the
+data source then copies those bytes to a small internal buffer.
+
+The memory which the chunks point to belongs to the user: it must
+remain valid and unchanged as long as the factory or any of its data
+sources exists.
+*/
+class MemoryDataSourceFactory final :
+    public DataSourceFactory,
+    boost::noncopyable
+{
+public:
+    /*!
+    @brief
+        Creates a memory data source factory which can create data
+        sources on the \p size bytes at \p address.
+
+    @param[in] address
+        Address of the data.
+    @param[in] size
+        Size (bytes) of the data.
+    */
+    explicit MemoryDataSourceFactory(const void *address, Size size);
+
+    /*!
+    @brief
+        Creates a memory data source factory which can create data
+        sources on the concatenation of the chunks \p chunks.
+
+    \p chunks may contain empty chunks.
+
+    @param[in] chunks
+        Chunks of data, in order.
+    */
+    explicit MemoryDataSourceFactory(const std::vector<DataBlock>& chunks);
+
+    /// Total size (bytes) of the data.
+    Size size() const noexcept;
+
+    /// Number of chunks (including empty ones).
+    Size chunkCount() const noexcept;
+
+private:
+    DataSource::UP _createDataSource() override;
+
+private:
+    // shared because memory data sources also keep a reference
+    std::shared_ptr<const internal::MemDataSrcFactoryImpl> _pimpl;
+};
+
+} // namespace yactfr
+
+#endif // _YACTFR_MEM_DATA_SRC_FACTORY_HPP
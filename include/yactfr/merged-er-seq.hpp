@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_MERGED_ER_SEQ_HPP
+#define _YACTFR_MERGED_ER_SEQ_HPP
+
+#include <cassert>
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+#include "aliases.hpp"
+#include "elem-seq.hpp"
+#include "elem-seq-it.hpp"
+#include "elem-seq-it-pos.hpp"
+
+namespace yactfr {
+
+/*!
+@brief
+    Merged event record sequence.
+
+@ingroup element_seq
+
+A merged event record sequence merges the event records of many element
+sequences, typically one per data stream (for example, one per CPU),
+into a single sequence of event records ordered by default clock value.
+
+Call next() to go to the next event record of the merged sequence, and
+then use iterator() to read its elements, starting with its
+EventRecordBeginningElement. elementSequenceIndex() indicates the
+element sequence of the current event record and defaultClockValue()
+its default clock value.
+
+A merged event record sequence has a lookahead of exactly one event
+record per element sequence: it keeps the element sequences in a binary
+heap keyed on the default clock value of their next event record. Event
+records having the same default clock value come in element sequence
+index order, and the event records of a given element sequence always
+come in element sequence order. Once constructed, a merged event record
+sequence doesn't allocate memory for each event record.
+
+The default clock value of an event record is the value of the first
+DefaultClockValueElement which follows its EventRecordBeginningElement,
+before its EventRecordInfoElement. An event record without such an
+element has the last default clock value of its element sequence (the
+default clock value of the previous event record or the beginning
+default clock value of its packet), or 0 if there's none.
+
+The merged event record sequence compares the default clock values of
+the different element sequences as is: their data stream types should
+have the same default clock type.
+*/
+class MergedEventRecordSequence final :
+    boost::noncopyable
+{
+public:
+    /*!
+    @brief
+        Builds a merged event record sequence which merges the event
+        records of the element sequences \p elementSequences.
+
+    The element sequences of \p elementSequences must exist as long as
+    this merged event record sequence exists.
+
+    The options of the element sequences must make their iterators
+    produce EventRecordBeginningElement, EventRecordEndElement,
+    DefaultClockValueElement, and EventRecordInfoElement elements (see
+    ElementSequenceOptions::elementKinds()).
+
+    This constructor creates one iterator per element sequence.
+
+    @param[in] elementSequences
+        Element sequences of which to merge the event records.
+
+    @pre
+        All the element sequences of \p elementSequences share the same
+        trace type.
+
+    @throws ?
+        Any exception that a data source can throw when getting a new
+        data block.
+    @throws DecodingError
+        Any derived decoding error (see decoding-errors.hpp).
+    */
+    explicit MergedEventRecordSequence(const std::vector<ElementSequence *>& elementSequences);
+
+    /// Number of merged element sequences.
+    Size elementSequenceCount() const noexcept
+    {
+        return _streams.size();
+    }
+
+    /*!
+    @brief
+        Goes to the next event record of this merged sequence.
+
+    If the current event record is valid, then this method first
+    advances its iterator to the end of this event record, from its
+    current element (see ElementSequenceIterator::skipToEventRecordEnd()).
+
+    If this method throws, then you may not call it again.
+
+    @returns
+        \c true if there's a current event record, or \c false if there
+        are no more event records.
+
+    @pre
+        If there's a current event record, then you didn't advance
+        iterator() beyond its EventRecordEndElement.
+
+    @throws ?
+        Any exception that a data source can throw when getting a new
+        data block.
+    @throws DecodingError
+        Any derived decoding error (see decoding-errors.hpp).
+    @throws DataNotAvailable
+        Data is not available now from a data source.
+    */
+    bool next();
+
+    /*!
+    @brief
+        Index, within the element sequences of the constructor, of the
+        element sequence of the current event record.
+
+    @pre
+        The last call to next() returned \c true.
+    */
+    Index elementSequenceIndex() const noexcept
+    {
+        assert(_hasCur);
+        return _curIndex;
+    }
+
+    /*!
+    @brief
+        Default clock value of the current event record.
+
+    @pre
+        The last call to next() returned \c true.
+    */
+    Cycles defaultClockValue() const noexcept
+    {
+        assert(_hasCur);
+        return _streams[_curIndex].nextCycles;
+    }
+
+    /*!
+    @brief
+        Iterator of the element sequence of the current event record.
+
+    After a call to next(), the current element of this iterator is the
+    EventRecordBeginningElement of the current event record. You may
+    advance it up to the EventRecordEndElement of this event record.
+
+    @pre
+        The last call to next() returned \c true.
+    */
+    ElementSequenceIterator& iterator() noexcept
+    {
+        assert(_hasCur);
+        return _streams[_curIndex].it;
+    }
+
+private:
+    struct _Stream final
+    {
+        explicit _Stream(ElementSequence& seq);
+
+        ElementSequenceIterator it;
+        ElementSequenceIterator endIt;
+
+        // position of the EventRecordBeginningElement of the next event record
+        ElementSequenceIteratorPosition erBeginPos;
+
+        // last default clock value of this stream
+        Cycles lastCycles = 0;
+
+        // default clock value of the next event record
+        Cycles nextCycles = 0;
+    };
+
+private:
+    bool _advance(_Stream& stream);
+    bool _isAfter(Index a, Index b) const noexcept;
+    void _pushHeap(Index index);
+
+private:
+    std::vector<_Stream> _streams;
+
+    // min-heap of stream indexes, keyed on `_Stream::nextCycles` and then on the index
+    std::vector<Index> _heap;
+
+    bool _isPrimed = false;
+    bool _hasCur = false;
+    Index _curIndex = 0;
+};
+
+} // namespace yactfr
+
+#endif // _YACTFR_MERGED_ER_SEQ_HPP
@@ -45,6 +45,8 @@ struct DstIdComp final
 
 } // namespace internal
 
+class EventRecordColumnDecoder;
+
 /*!
 @brief
     Set of clock types with unique names.
@@ -74,6 +76,7 @@ class TraceType final :
 {
     friend class internal::TraceTypeImpl;
     friend class ElementSequenceIterator;
+    friend class EventRecordColumnDecoder;
 
 public:
     /// Unique pointer to constant trace type.
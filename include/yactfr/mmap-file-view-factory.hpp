@@ -10,6 +10,7 @@
 
 #include <memory>
 #include <boost/noncopyable.hpp>
+#include <boost/optional/optional.hpp>
 #include <string>
 
 #include "data-src-factory.hpp"
@@ -32,7 +33,9 @@ This is a factory of memory mapped file views, which are valid data
 sources for element sequences.
 
 All the memory mapped file views that such a factory creates operate on
-the same file handle/descriptor.
+the same file handle/descriptor and share the same cache of memory
+mapped regions: copying an element sequence iterator or seeking back
+and forth usually doesn't involve any memory map operation.
 */
 class MemoryMappedFileViewFactory final :
     public DataSourceFactory,
@@ -52,6 +55,54 @@ public:
 
         /// Expect page references in random order (less read ahead).
         RANDOM,
+
+        /*!
+        Each memory mapped file view tracks its own access pattern.
+
+        A view switches to sequential access when it reads contiguous
+        data blocks, and back to random access when it jumps elsewhere
+        (for example, after ElementSequenceIterator::seekPacket()).
+
+        During sequential access, a view asks the kernel to read ahead
+        the data which follows its current position and marks the
+        data which it already consumed as cold, so that a one-pass scan
+        of a large file doesn't evict the rest of the page cache.
+        */
+        ADAPTIVE,
+    };
+
+    /*!
+    @brief
+        Counters of what the memory mapped file views of a factory did.
+
+    See counters().
+    */
+    struct Counters final
+    {
+        /// Number of memory map operations.
+        Size mmapCount;
+
+        /// Number of memory unmap operations.
+        Size munmapCount;
+
+        /// Number of times a view reused a cached memory mapped region.
+        Size cachedRegionHitCount;
+
+        /// Total size (bytes) of the ranges which views asked the
+        /// kernel to read ahead (AccessPattern::ADAPTIVE).
+        Size readAheadSize;
+
+        /// Total size (bytes) of the consumed ranges which views
+        /// released (AccessPattern::ADAPTIVE).
+        Size releasedSize;
+
+        /// Number of times a view switched to sequential access
+        /// (AccessPattern::ADAPTIVE).
+        Size sequentialSwitchCount;
+
+        /// Number of times a view switched to random access
+        /// (AccessPattern::ADAPTIVE).
+        Size randomSwitchCount;
     };
 
 public:
@@ -71,7 +122,16 @@ public:
     data sources of this factory are optimized. Prefer
     AccessPattern::SEQUENTIAL if you're going to iterate whole packets
     in order. Prefer AccessPattern::RANDOM if you're going to skip many
-    elements and seek packets.
+    elements and seek packets. Prefer AccessPattern::ADAPTIVE to let
+    each view adapt to its actual access pattern, especially to scan
+    large files once.
+
+    \p maximumCachedMmapSize is the maximum total size, in bytes, of the
+    memory mapped regions which the factory keeps in its cache when no
+    view uses them anymore. The factory unmaps the least recently used
+    regions first. The regions which views currently use are never
+    unmapped, even if their total size exceeds
+    \p maximumCachedMmapSize.
 
     This factory can throw IOError on construction and when creating a
     data source. Its created data source can throw IOError when getting
@@ -85,13 +145,18 @@ public:
     @param[in] expectedAccessPattern
         Expected access pattern of the memory mapped file views created
         by this factory.
+    @param[in] maximumCachedMmapSize
+        Maximum total size (bytes) of the cached memory mapped regions,
+        or \c boost::none to let the implementation decide (four times
+        the memory map size).
 
     @throws IOError
         An I/O error occurred (file not found, permission denied, etc.).
     */
     explicit MemoryMappedFileViewFactory(std::string path,
                                          const boost::optional<Size>& preferredMmapSize = boost::none,
-                                         AccessPattern expectedAccessPattern = AccessPattern::NORMAL);
+                                         AccessPattern expectedAccessPattern = AccessPattern::NORMAL,
+                                         const boost::optional<Size>& maximumCachedMmapSize = boost::none);
 
     /// Current expected access pattern for future memory maps.
     AccessPattern expectedAccessPattern() const noexcept;
@@ -103,7 +168,8 @@ public:
 
     Note that this setting only applies to memory map operations
     performed \em after this call, by any data source created by this
-    factory.
+    factory: it doesn't apply to the regions which the factory already
+    cached.
 
     @param[in] expectedAccessPattern
         Expected access pattern of the memory mapped file views created
@@ -111,13 +177,26 @@ public:
     */
     void expectedAccessPattern(AccessPattern expectedAccessPattern) noexcept;
 
+    /// Maximum total size (bytes) of the cached memory mapped regions.
+    Size maximumCachedMmapSize() const noexcept;
+
+    /*!
+    @brief
+        Current counters of what the memory mapped file views of this
+        factory did since its construction.
+
+    @returns
+        Current counters.
+    */
+    Counters counters() const noexcept;
+
 private:
     DataSource::UP _createDataSource() override;
 
 private:
     /*
      * Shared because memory mapped file views also keep a reference to
-     * keep the file descriptor opened.
+     * keep the file descriptor opened and to pin cached regions.
      */
     std::shared_ptr<internal::MmapFileViewFactoryImpl> _pimpl;
 };
@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_MULTI_FILE_DATA_SRC_FACTORY_HPP
+#define _YACTFR_MULTI_FILE_DATA_SRC_FACTORY_HPP
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <boost/noncopyable.hpp>
+#include <boost/optional/optional.hpp>
+
+#include "data-src-factory.hpp"
+#include "aliases.hpp"
+
+namespace yactfr {
+namespace internal {
+
+class MultiFileDataSrcFactoryImpl;
+
+} // namespace internal
+
+/*!
+@brief
+    Multi-file data source factory.
+
+@ingroup element_seq
+
+This is a factory of multi-file data sources, which are valid data
+sources for element sequences.
+
+A multi-file data source presents the concatenation of the contents of
+a list of files as a single sequence of bytes. This makes it possible
+to decode many data stream files (for example, the per-CPU data stream
+files of a CTF trace) with a single element sequence. Usually, each
+file contains whole packets: a file join is then also a packet
+boundary.
+
+Use location() to map an offset within the concatenated data back to a
+file and an offset within this file.
+
+The factory opens the files lazily: its construction doesn't access
+any file, and it only gets the size of a file when a data source needs
+data at or after its beginning. All the data sources of a factory share
+a pool of file descriptors of which the size is limited: when a data
+source needs to read a file which isn't open and the pool is full, the
+factory closes the least recently used file.
+
+Like a buffered file data source (see BufferedFileDataSourceFactory),
+a multi-file data source reads blocks of a file into a buffer which it
+owns with the <code>pread()</code> system call.
+*/
+class MultiFileDataSourceFactory final :
+    public DataSourceFactory,
+    boost::noncopyable
+{
+public:
+    /*!
+    @brief
+        Location of a byte within a file.
+    */
+    struct Location final
+    {
+        /// Index of the file within paths().
+        Index fileIndex;
+
+        /// Offset (bytes) within the file.
+        Index offset;
+    };
+
+public:
+    /*!
+    @brief
+        Creates a multi-file data source factory which can create data
+        sources on the concatenation of the files located at \p paths.
+
+    \p blockSize is the size, in bytes, of each individual read
+    operation which the data sources of this factory perform. The
+    actual block size can be larger than \p blockSize because the
+    implementation rounds it up to a multiple of the platform page
+    size.
+
+    This factory doesn't throw on construction. Its created data source
+    can throw IOError when getting a new data block.
+
+    @param[in] paths
+        Paths of the files to concatenate, in order.
+    @param[in] maximumOpenFileCount
+        Maximum number of files to keep open at the same time (at least
+        1), or \c boost::none to let the implementation decide.
+    @param[in] blockSize
+        Size (bytes) of each read operation, or \c boost::none to let
+        the implementation decide.
+    */
+    explicit MultiFileDataSourceFactory(std::vector<std::string> paths,
+                                        const boost::optional<Size>& maximumOpenFileCount = boost::none,
+                                        const boost::optional<Size>& blockSize = boost::none);
+
+    /// Paths of the concatenated files.
+    const std::vector<std::string>& paths() const noexcept;
+
+    /// Maximum number of files to keep open at the same time.
+    Size maximumOpenFileCount() const noexcept;
+
+    /// Actual size (bytes) of each read operation.
+    Size blockSize() const noexcept;
+
+    /*!
+    @brief
+        Location of the byte at the offset \p offset (bytes) within the
+        concatenated data, or \c boost::none if \p offset is beyond
+        the last file.
+
+    For example, get the location of an element from its element
+    sequence iterator \c it with:
+
+    @code
+    factory.location(it.offset() / 8)
+    @endcode
+
+    @param[in] offset
+        Offset (bytes) within the concatenated data.
+
+    @returns
+        Location of the byte at \p offset, or \c boost::none if there's
+        no such byte.
+
+    @throws IOError
+        Cannot get the size of a file.
+    */
+    boost::optional<Location> location(Index offset) const;
+
+    /*!
+    @brief
+        Offset (bytes) of the first byte of the file having the index
+        \p fileIndex within the concatenated data.
+
+    @param[in] fileIndex
+        Index of the file within paths().
+
+    @returns
+        Offset of the first byte of the file \p fileIndex.
+
+    @pre
+        \p fileIndex < <code>paths().size()</code>.
+
+    @throws IOError
+        Cannot get the size of a file.
+    */
+    Index fileOffset(Index fileIndex) const;
+
+private:
+    DataSource::UP _createDataSource() override;
+
+private:
+    /*
+     * Shared because multi-file data sources also keep a reference to
+     * share the file descriptor pool and to give back their buffer.
+     */
+    std::shared_ptr<internal::MultiFileDataSrcFactoryImpl> _pimpl;
+};
+
+} // namespace yactfr
+
+#endif // _YACTFR_MULTI_FILE_DATA_SRC_FACTORY_HPP
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_PAR_PKT_DECODER_HPP
+#define _YACTFR_PAR_PKT_DECODER_HPP
+
+#include <memory>
+#include <boost/noncopyable.hpp>
+#include <boost/optional/optional.hpp>
+
+#include "aliases.hpp"
+#include "metadata/fwd.hpp"
+#include "elem-seq-opts.hpp"
+
+namespace yactfr {
+
+class DataSourceFactory;
+class ElementBatch;
+class PacketIndex;
+
+namespace internal {
+
+class ParPktDecoderImpl;
+
+} // namespace internal
+
+/*!
+@brief
+    Parallel packet decoder.
+
+@ingroup element_seq
+
+A parallel packet decoder decodes the packets of an element sequence
+on many worker threads and delivers the resulting elements in element
+sequence order.
+
+Because the VM of an element sequence iterator completely resets its
+state when it seeks a packet, packets are independently decodable once
+their offsets are known. A parallel packet decoder splits the entries
+of a packet index (see PacketIndex) into ranges of consecutive
+packets. Each worker thread owns its own element sequence iterator,
+and therefore its own data source from the same data source factory,
+and decodes whole packet ranges into element batches (see
+ElementBatch).
+
+next() delivers the element batches in packet range order through a
+bounded reorder buffer: a worker thread doesn't start decoding a packet
+range which is too far ahead of the next one to deliver, so that the
+memory usage remains bounded even if you consume slowly.
+
+The data source factory must be able to create data sources, and its
+data sources must be able to operate, concurrently on different
+threads. This is the case of the data source factories of yactfr which
+support random access, for example MemoryMappedFileViewFactory and
+BufferedFileDataSourceFactory.
+*/
+class ParallelPacketDecoder final :
+    boost::noncopyable
+{
+public:
+    /*!
+    @brief
+        Builds a parallel packet decoder which decodes the packets of
+        \p packetIndex, described by the trace type \p traceType, of
+        which the data sources come from \p dataSourceFactory, with the
+        element sequence options \p options, and starts its worker
+        threads.
+
+    \p traceType and \p dataSourceFactory must exist as long as this
+    parallel packet decoder exists. This constructor copies what it
+    needs from \p packetIndex and \p options.
+
+    @param[in] traceType
+        Trace type which describes the packets to decode.
+    @param[in] dataSourceFactory
+        Factory of data sources used by the worker threads.
+    @param[in] packetIndex
+        Packet index of the element sequence to decode.
+    @param[in] options
+        Options of the element sequence iterators of the worker
+        threads.
+    @param[in] workerCount
+        Number of worker threads (at least 1), or \c boost::none to use
+        the number of hardware threads.
+    @param[in] packetsPerRange
+        Number of packets per packet range (at least 1), or
+        \c boost::none to let the implementation decide from the
+        expected total lengths of the packets.
+    @param[in] maximumPendingRangeCount
+        Capacity of the reorder buffer, that is, the maximum number of
+        decoded or being decoded packet ranges not yet delivered by
+        next() (at least 1), or \c boost::none to let the
+        implementation decide.
+
+    @throws ?
+        Any exception that the data source can throw when getting a new
+        data block.
+    @throws DecodingError
+        Any derived decoding error (see decoding-errors.hpp).
+    */
+    explicit ParallelPacketDecoder(const TraceType& traceType,
+                                   DataSourceFactory& dataSourceFactory,
+                                   const PacketIndex& packetIndex,
+                                   const ElementSequenceOptions& options = ElementSequenceOptions {},
+                                   const boost::optional<Size>& workerCount = boost::none,
+                                   const boost::optional<Size>& packetsPerRange = boost::none,
+                                   const boost::optional<Size>& maximumPendingRangeCount = boost::none);
+
+    /*!
+    @brief
+        Stops and joins the worker threads, and destroys this parallel
+        packet decoder.
+
+    The worker threads finish decoding their current packet range
+    first.
+    */
+    ~ParallelPacketDecoder();
+
+    /// Number of worker threads.
+    Size workerCount() const noexcept;
+
+    /// Number of packets per packet range (the last packet range can
+    /// contain fewer packets).
+    Size packetsPerRange() const noexcept;
+
+    /// Number of packet ranges.
+    Size rangeCount() const noexcept;
+
+    /// Capacity of the reorder buffer (packet ranges).
+    Size maximumPendingRangeCount() const noexcept;
+
+    /*!
+    @brief
+        Fills \p batch with the records of all the elements of the next
+        packet range, waiting for a worker thread to decode it if
+        needed.
+
+    This method swaps the internal buffers of \p batch with the ones
+    which a worker thread filled, so that it doesn't copy any record:
+    the previous buffers of \p batch become available to decode a
+    subsequent packet range.
+
+    The first record of a packet range is the first element of its
+    first packet which the options of this decoder select, and the
+    offsets of the records are relative to the beginning of the element
+    sequence, like with ElementSequenceIterator::offset().
+
+    If decoding the next packet range failed, then this method rethrows
+    the exception of the worker thread: you may not call it again
+    afterwards.
+
+    @param[out] batch
+        Element batch to fill.
+
+    @returns
+        \c true if this method filled \p batch, or \c false if all the
+        packet ranges are delivered (\p batch is left unchanged).
+
+    @throws ?
+        Any exception that the data source can throw when getting a new
+        data block.
+    @throws DecodingError
+        Any derived decoding error (see decoding-errors.hpp).
+    @throws DataNotAvailable
+        Data is not available now from the data source.
+    */
+    bool next(ElementBatch& batch);
+
+private:
+    std::unique_ptr<internal::ParPktDecoderImpl> _pimpl;
+};
+
+} // namespace yactfr
+
+#endif // _YACTFR_PAR_PKT_DECODER_HPP
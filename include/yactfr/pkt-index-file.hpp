@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_PKT_INDEX_FILE_HPP
+#define _YACTFR_PKT_INDEX_FILE_HPP
+
+#include <memory>
+#include <string>
+#include <boost/noncopyable.hpp>
+#include <boost/optional/optional.hpp>
+
+#include "aliases.hpp"
+#include "metadata/fwd.hpp"
+#include "pkt-index.hpp"
+
+namespace yactfr {
+
+class DataSourceFactory;
+
+namespace internal {
+
+class PktIndexFileImpl;
+
+} // namespace internal
+
+/*!
+@brief
+    Packet index file.
+
+@ingroup element_seq
+
+A packet index file is the persistent, memory-mapped version of the
+packet index (see PacketIndex) of a single data stream file.
+
+Its format is versioned and made of a fixed-size header followed with
+one fixed-size record per packet, all little-endian, so that opening an
+up-to-date packet index file only maps it and checks its header: the
+\link operator[]() const subscript operator\endlink decodes a single
+record on demand.
+
+The header of a packet index file contains its key: the size and the
+modification time of the indexed data stream file as well as a hash of
+the metadata text. On construction, a packet index file object
+automatically updates the packet index file when its key doesn't match
+the current data stream file and metadata text:
+
+- If the data stream file only grew (same metadata text), then it
+  indexes the new packets and appends their records to the packet index
+  file.
+
+- Otherwise, it rebuilds the whole packet index file.
+
+Many processes may use the same packet index file concurrently: they
+synchronize their updates with file locks, and an update never modifies
+the records which another packet index file object already mapped.
+*/
+class PacketIndexFile final :
+    boost::noncopyable
+{
+public:
+    /*!
+    @brief
+        Opens, creating or updating it if needed, the packet index file
+        located at \p path for the data stream file located at
+        \p dataStreamPath, described by the trace type \p traceType of
+        which the metadata text is \p metadataText.
+
+    If it needs to update the packet index file, this constructor
+    indexes the packets of an element sequence of which the data
+    sources come from \p dataSourceFactory, which must create data
+    sources on the data stream file at \p dataStreamPath.
+
+    If the data of \p dataSourceFactory ends within the preamble of a
+    packet (for example, a tracer is still writing the data stream
+    file), then this constructor doesn't index this packet: it will do
+    so when the data stream file grows.
+
+    If it can't write the packet index file (for example, read-only
+    file system) and it's not up to date, then this constructor throws
+    IOError.
+
+    \p traceType must exist as long as this packet index file exists.
+
+    @param[in] path
+        Path of the packet index file.
+    @param[in] traceType
+        Trace type which describes the packets to index.
+    @param[in] metadataText
+        Metadata text from which \p traceType comes (only hashed).
+    @param[in] dataStreamPath
+        Path of the data stream file to index.
+    @param[in] dataSourceFactory
+        Factory of data sources on the data stream file at
+        \p dataStreamPath.
+
+    @throws IOError
+        An I/O error occurred (file not found, permission denied,
+        invalid packet index file, etc.).
+    @throws ?
+        Any exception that the data source can throw when getting a new
+        data block.
+    @throws DecodingError
+        Any derived decoding error (see decoding-errors.hpp).
+    */
+    explicit PacketIndexFile(std::string path, const TraceType& traceType,
+                             const std::string& metadataText, std::string dataStreamPath,
+                             DataSourceFactory& dataSourceFactory);
+
+    ~PacketIndexFile();
+
+    /// Path of this packet index file.
+    const std::string& path() const noexcept;
+
+    /// Path of the indexed data stream file.
+    const std::string& dataStreamPath() const noexcept;
+
+    /// Number of entries (packets) of this packet index file.
+    Size size() const noexcept;
+
+    /// Whether or not this packet index file is empty.
+    bool isEmpty() const noexcept
+    {
+        return this->size() == 0;
+    }
+
+    /*!
+    @brief
+        \c true if the constructor created, updated, or rebuilt this
+        packet index file.
+    */
+    bool wasUpdated() const noexcept;
+
+    /*!
+    @brief
+        Returns the entry at the index \p index, decoding its record.
+
+    @param[in] index
+        Index of the entry to return.
+
+    @returns
+        Entry at the index \p index.
+
+    @pre
+        \p index < size()
+    */
+    PacketIndexEntry operator[](Index index) const noexcept;
+
+    /*!
+    @brief
+        Returns the entry of the packet which contains the byte at the
+        offset \p offset (bytes) within the data stream file, or
+        \c boost::none if none.
+
+    @param[in] offset
+        Offset, in bytes, of a byte within the data stream file.
+
+    @returns
+        Entry of the packet which contains the byte at \p offset, or
+        \c boost::none if none.
+    */
+    boost::optional<PacketIndexEntry> findEntry(Index offset) const noexcept;
+
+private:
+    std::unique_ptr<internal::PktIndexFileImpl> _pimpl;
+};
+
+} // namespace yactfr
+
+#endif // _YACTFR_PKT_INDEX_FILE_HPP
@@ -0,0 +1,289 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_PKT_INDEX_HPP
+#define _YACTFR_PKT_INDEX_HPP
+
+#include <vector>
+#include <boost/optional/optional.hpp>
+
+#include "aliases.hpp"
+#include "metadata/aliases.hpp"
+#include "metadata/fwd.hpp"
+
+namespace yactfr {
+
+class DataSourceFactory;
+class PacketIndexFile;
+
+namespace internal {
+
+class PktIndexer;
+class PktIndexFileImpl;
+
+} // namespace internal
+
+/*!
+@brief
+    Packet index entry.
+
+@ingroup element_seq
+
+A packet index entry contains the properties of a single packet of an
+element sequence, as found in its preamble (packet header and packet
+context).
+*/
+class PacketIndexEntry final
+{
+    friend class PacketIndexFile;
+    friend class internal::PktIndexer;
+    friend class internal::PktIndexFileImpl;
+
+private:
+    explicit PacketIndexEntry() = default;
+
+public:
+    /// Offset, in bytes, of the first byte of the packet within its
+    /// element sequence.
+    Index offsetInElementSequence() const noexcept
+    {
+        return _offset;
+    }
+
+    /*!
+    @brief
+        Expected total length, in bits, of the packet.
+
+    @sa PacketInfoElement::expectedTotalLength()
+    */
+    const boost::optional<Size>& expectedTotalLength() const noexcept
+    {
+        return _expectedTotalLen;
+    }
+
+    /*!
+    @brief
+        Expected content length, in bits, of the packet.
+
+    @sa PacketInfoElement::expectedContentLength()
+    */
+    const boost::optional<Size>& expectedContentLength() const noexcept
+    {
+        return _expectedContentLen;
+    }
+
+    /*!
+    @brief
+        Type of the data stream of the packet, or \c nullptr if the
+        packet has no data stream type.
+
+    @sa DataStreamInfoElement::type()
+    */
+    const DataStreamType *dataStreamType() const noexcept
+    {
+        return _dst;
+    }
+
+    /*!
+    @brief
+        ID of the data stream of the packet.
+
+    @sa DataStreamInfoElement::id()
+    */
+    const boost::optional<unsigned long long>& dataStreamId() const noexcept
+    {
+        return _dsId;
+    }
+
+    /*!
+    @brief
+        Numeric sequence number of the packet within its data stream.
+
+    @sa PacketInfoElement::sequenceNumber()
+    */
+    const boost::optional<Index>& sequenceNumber() const noexcept
+    {
+        return _seqNum;
+    }
+
+    /*!
+    @brief
+        Count of total discarded event records at the end of the packet
+        since the beginning of its data stream.
+
+    @sa PacketInfoElement::discardedEventRecordCounterSnapshot()
+    */
+    const boost::optional<Size>& discardedEventRecordCounterSnapshot() const noexcept
+    {
+        return _discErCounterSnap;
+    }
+
+    /*!
+    @brief
+        Value of the default clock of the data stream of the packet at
+        its beginning.
+
+    This is the last default clock value which the preamble of the
+    packet sets.
+
+    @sa DefaultClockValueElement
+    */
+    const boost::optional<Cycles>& beginningDefaultClockValue() const noexcept
+    {
+        return _beginDefClkVal;
+    }
+
+    /*!
+    @brief
+        Value of the default clock of the data stream of the packet at
+        its end.
+
+    @sa PacketInfoElement::endDefaultClockValue()
+    */
+    const boost::optional<Cycles>& endDefaultClockValue() const noexcept
+    {
+        return _endDefClkVal;
+    }
+
+private:
+    Index _offset = 0;
+    boost::optional<Size> _expectedTotalLen;
+    boost::optional<Size> _expectedContentLen;
+    const DataStreamType *_dst = nullptr;
+    boost::optional<unsigned long long> _dsId;
+    boost::optional<Index> _seqNum;
+    boost::optional<Size> _discErCounterSnap;
+    boost::optional<Cycles> _beginDefClkVal;
+    boost::optional<Cycles> _endDefClkVal;
+};
+
+/*!
+@brief
+    Packet index.
+
+@ingroup element_seq
+
+A packet index contains one entry (PacketIndexEntry) per packet of an
+element sequence, in element sequence order.
+
+Building a packet index only decodes the preamble (packet header and
+packet context) of each packet: as soon as it knows the expected total
+length of a packet, it seeks the next packet (see
+ElementSequenceIterator::seekPacket()) without decoding any event
+record.
+
+Use the offsets of the entries with ElementSequence::at() or
+ElementSequenceIterator::seekPacket() to decode specific packets.
+*/
+class PacketIndex final
+{
+public:
+    /// Entry vector.
+    using Entries = std::vector<PacketIndexEntry>;
+
+    /// Entry iterator.
+    using ConstIterator = Entries::const_iterator;
+
+public:
+    /*!
+    @brief
+        Builds the packet index of the element sequence which the trace
+        type \p traceType describes and of which the data sources come
+        from \p dataSourceFactory.
+
+    \p traceType must exist as long as this packet index exists.
+
+    @param[in] traceType
+        Trace type which describes the packets to index.
+    @param[in] dataSourceFactory
+        Factory of data sources of the element sequence to index.
+
+    @throws ?
+        Any exception that the data source can throw when getting a new
+        data block.
+    @throws DecodingError
+        Any derived decoding error (see decoding-errors.hpp).
+    */
+    explicit PacketIndex(const TraceType& traceType, DataSourceFactory& dataSourceFactory);
+
+    /*!
+    @brief
+        Builds a packet index from the entries of the packet index
+        file \p file.
+
+    @param[in] file
+        Packet index file of which to copy the entries.
+    */
+    explicit PacketIndex(const PacketIndexFile& file);
+
+    /// Entries of this packet index.
+    const Entries& entries() const noexcept
+    {
+        return _entries;
+    }
+
+    /// Beginning of the entries of this packet index.
+    ConstIterator begin() const noexcept
+    {
+        return _entries.begin();
+    }
+
+    /// End of the entries of this packet index.
+    ConstIterator end() const noexcept
+    {
+        return _entries.end();
+    }
+
+    /// Number of entries (packets) of this packet index.
+    Size size() const noexcept
+    {
+        return _entries.size();
+    }
+
+    /// Whether or not this packet index is empty.
+    bool isEmpty() const noexcept
+    {
+        return _entries.empty();
+    }
+
+    /*!
+    @brief
+        Returns the entry at the index \p index.
+
+    @param[in] index
+        Index of the entry to return.
+
+    @returns
+        Entry at the index \p index.
+
+    @pre
+        \p index < size()
+    */
+    const PacketIndexEntry& operator[](Index index) const noexcept;
+
+    /*!
+    @brief
+        Returns the entry of the packet which contains the byte at the
+        offset \p offset (bytes) within the element sequence, or
+        \c nullptr if none.
+
+    @param[in] offset
+        Offset, in bytes, of a byte within the element sequence.
+
+    @returns
+        Entry of the packet which contains the byte at \p offset, or
+        \c nullptr if none.
+    */
+    const PacketIndexEntry *findEntry(Index offset) const noexcept;
+
+private:
+    Entries _entries;
+};
+
+} // namespace yactfr
+
+#endif // _YACTFR_PKT_INDEX_HPP
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_READ_AHEAD_FILE_DATA_SRC_FACTORY_HPP
+#define _YACTFR_READ_AHEAD_FILE_DATA_SRC_FACTORY_HPP
+
+#include <memory>
+#include <boost/noncopyable.hpp>
+#include <boost/optional/optional.hpp>
+#include <string>
+
+#include "data-src-factory.hpp"
+#include "aliases.hpp"
+
+namespace yactfr {
+namespace internal {
+
+class BufFileDataSrcFactoryImpl;
+
+} // namespace internal
+
+/*!
+@brief
+    Read-ahead file data source factory.
+
+@ingroup element_seq
+
+This is a factory of read-ahead file data sources, which are valid data
+sources for element sequences.
+
+Like a buffered file data source (see BufferedFileDataSourceFactory), a
+read-ahead file data source reads blocks of a file into buffers which it
+owns. However, it keeps up to a given number of asynchronous read
+operations in flight after the block which the element sequence iterator
+currently decodes, so that the disk latency overlaps with the decoding
+of the current block.
+
+The actual read-ahead depth adapts to how fast the element sequence
+iterator consumes data: it increases when the iterator has to wait for a
+block and decreases when blocks are constantly ready ahead of time.
+
+A read-ahead file data source uses Linux's io_uring when both the build
+environment and the running kernel support it, or a dedicated prefetch
+thread otherwise (see backend()).
+
+By default, a read-ahead file data source waits for the block which
+contains the requested data. In non-blocking mode, it throws
+DataNotAvailable instead of waiting: you may then retry the same
+element sequence iterator operation later.
+
+The read-ahead file data sources that such a factory creates operate on
+the same file handle/descriptor and reuse the buffers of destroyed data
+sources.
+*/
+class ReadAheadFileDataSourceFactory final :
+    public DataSourceFactory,
+    boost::noncopyable
+{
+public:
+    /// Read-ahead backend.
+    enum class Backend
+    {
+        /// Linux io_uring.
+        IO_URING,
+
+        /// Dedicated prefetch thread with <code>pread()</code>.
+        THREAD,
+    };
+
+public:
+    /*!
+    @brief
+        Creates a read-ahead file data source factory which can create
+        read-ahead file data sources on the file located at \p path.
+
+    \p blockSize is the size, in bytes, of each individual read
+    operation which the read-ahead file data sources of this factory
+    perform. The actual block size can be larger than \p blockSize
+    because the implementation rounds it up to a multiple of the
+    platform page size.
+
+    If \p backend is Backend::IO_URING or \c boost::none, then the
+    factory uses io_uring if it's available, falling back to
+    Backend::THREAD otherwise.
+
+    This factory can throw IOError on construction and when creating a
+    data source. Its created data source can throw IOError and, in
+    non-blocking mode, DataNotAvailable when getting a new data block.
+
+    @param[in] path
+        Path of the file on which to create read-ahead file data
+        sources.
+    @param[in] blockSize
+        Size (bytes) of each read operation, or \c boost::none to let
+        the implementation decide.
+    @param[in] maximumReadAheadDepth
+        Maximum number of blocks to read ahead (at least 1), or
+        \c boost::none to let the implementation decide.
+    @param[in] isNonBlocking
+        \c true to make the created data sources throw
+        DataNotAvailable instead of waiting for data.
+    @param[in] backend
+        Preferred read-ahead backend, or \c boost::none to let the
+        implementation decide.
+
+    @throws IOError
+        An I/O error occurred (file not found, permission denied, etc.).
+    */
+    explicit ReadAheadFileDataSourceFactory(std::string path,
+                                            const boost::optional<Size>& blockSize = boost::none,
+                                            const boost::optional<Size>& maximumReadAheadDepth = boost::none,
+                                            bool isNonBlocking = false,
+                                            const boost::optional<Backend>& backend = boost::none);
+
+    /// Actual size (bytes) of each read operation.
+    Size blockSize() const noexcept;
+
+    /// Maximum number of blocks to read ahead.
+    Size maximumReadAheadDepth() const noexcept
+    {
+        return _maxReadAheadDepth;
+    }
+
+    /// Whether or not the created data sources are non-blocking.
+    bool isNonBlocking() const noexcept
+    {
+        return _isNonBlocking;
+    }
+
+    /// Actual read-ahead backend.
+    Backend backend() const noexcept
+    {
+        return _backend;
+    }
+
+private:
+    DataSource::UP _createDataSource() override;
+
+private:
+    /*
+     * Shared because read-ahead file data sources also keep a
+     * reference to keep the file descriptor opened and to give back
+     * their buffers.
+     */
+    std::shared_ptr<internal::BufFileDataSrcFactoryImpl> _pimpl;
+
+    Size _maxReadAheadDepth;
+    bool _isNonBlocking;
+    Backend _backend;
+};
+
+} // namespace yactfr
+
+#endif // _YACTFR_READ_AHEAD_FILE_DATA_SRC_FACTORY_HPP
@@ -15,16 +15,25 @@
 #define _YACTFR_YACTFR_HPP
 
 #include "aliases.hpp"
+#include "buf-file-data-src-factory.hpp"
 #include "data-blk.hpp"
 #include "data-src-factory.hpp"
 #include "data-src.hpp"
 #include "decoding-errors.hpp"
+#include "elem-batch.hpp"
+#include "er-col-decoder.hpp"
+#include "er-cols.hpp"
 #include "elem-seq-it-pos.hpp"
 #include "elem-seq-it.hpp"
+#include "elem-seq-opts.hpp"
 #include "elem-seq.hpp"
 #include "elem-visitor.hpp"
 #include "elem.hpp"
+#include "fd-data-src-factory.hpp"
 #include "io-error.hpp"
+#include "live-file-data-src-factory.hpp"
+#include "mem-data-src-factory.hpp"
+#include "merged-er-seq.hpp"
 #include "metadata/aliases.hpp"
 #include "metadata/array-type.hpp"
 #include "metadata/blob-type.hpp"
@@ -71,6 +80,12 @@
 #include "metadata/vl-enum-type.hpp"
 #include "metadata/vl-int-type.hpp"
 #include "mmap-file-view-factory.hpp"
+#include "multi-file-data-src-factory.hpp"
+#include "par-pkt-decoder.hpp"
+#include "pkt-index-file.hpp"
+#include "pkt-index.hpp"
+#include "read-ahead-file-data-src-factory.hpp"
 #include "text-parse-error.hpp"
+#include "zstd-file-data-src-factory.hpp"
 
 #endif // _YACTFR_YACTFR_HPP
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_ZSTD_FILE_DATA_SRC_FACTORY_HPP
+#define _YACTFR_ZSTD_FILE_DATA_SRC_FACTORY_HPP
+
+#include <memory>
+#include <boost/noncopyable.hpp>
+#include <boost/optional/optional.hpp>
+#include <string>
+
+#include "data-src-factory.hpp"
+#include "aliases.hpp"
+
+namespace yactfr {
+namespace internal {
+
+class ZstdFileDataSrcFactoryImpl;
+
+} // namespace internal
+
+/*!
+@brief
+    zstd-seekable file data source factory.
+
+@ingroup element_seq
+
+This is a factory of zstd-seekable file data sources, which are valid
+data sources for element sequences.
+
+A zstd-seekable file data source reads a data stream file which is
+compressed with the
+<a href="https://github.com/facebook/zstd/blob/dev/contrib/seekable_format/zstd_seekable_compression_format.md">zstd seekable format</a>,
+that is, a sequence of independent zstd frames followed with a seek
+table, without decompressing it to disk first.
+
+The data source only decompresses the frame which contains the
+requested data: seeking a packet (see
+ElementSequenceIterator::seekPacket()) only decompresses the frame
+which contains the beginning of this packet.
+
+All the data sources of a factory share a cache of decompressed frames
+of which the size is limited, and the factory reuses the buffers of
+evicted frames.
+
+This factory is only available if the yactfr library was built with
+libzstd: see isSupported().
+*/
+class ZstdSeekableFileDataSourceFactory final :
+    public DataSourceFactory,
+    boost::noncopyable
+{
+public:
+    /*!
+    @brief
+        Creates a zstd-seekable file data source factory which can
+        create data sources on the zstd-seekable file located at
+        \p path.
+
+    This factory can throw IOError on construction and when creating a
+    data source. Its created data source can throw IOError when getting
+    a new data block.
+
+    @param[in] path
+        Path of the zstd-seekable file on which to create data sources.
+    @param[in] maximumCachedFrameCount
+        Maximum number of decompressed frames to keep in the cache of
+        the factory (at least 1), or \c boost::none to let the
+        implementation decide.
+
+    @throws IOError
+        An I/O error occurred (file not found, permission denied,
+        invalid seek table, library built without libzstd, etc.).
+    */
+    explicit ZstdSeekableFileDataSourceFactory(std::string path,
+                                               const boost::optional<Size>& maximumCachedFrameCount = boost::none);
+
+    /*!
+    @brief
+        Whether or not the yactfr library supports zstd-seekable files,
+        that is, whether or not it was built with libzstd.
+
+    @returns
+        \c true if zstd-seekable files are supported.
+    */
+    static bool isSupported() noexcept;
+
+    /// Number of frames of the zstd-seekable file.
+    Size frameCount() const noexcept;
+
+    /// Decompressed size (bytes) of the zstd-seekable file.
+    Size decompressedSize() const noexcept;
+
+    /// Maximum number of decompressed frames in the cache.
+    Size maximumCachedFrameCount() const noexcept;
+
+private:
+    DataSource::UP _createDataSource() override;
+
+private:
+    /*
+     * Shared because zstd-seekable file data sources also keep a
+     * reference to keep the file descriptor opened and to share the
+     * decompressed frame cache.
+     */
+    std::shared_ptr<internal::ZstdFileDataSrcFactoryImpl> _pimpl;
+};
+
+} // namespace yactfr
+
+#endif // _YACTFR_ZSTD_FILE_DATA_SRC_FACTORY_HPP
@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+/*
+ * Data source benchmark.
+ *
+ * Usage:
+ *
+ *     bench-data-src [--cold] [--repeat=N] TRACE-DIR
+ *
+ * Decodes all the data streams of the CTF trace TRACE-DIR with a `nop`
+ * iteration loop, once per data source factory configuration, and
+ * prints the elapsed time and throughput of each one, as well as the
+ * page cache footprint, that is, the total size of the pages of the
+ * data stream files which are in the page cache after the run.
+ *
+ * With `--cold`, the benchmark asks the kernel to drop the cached pages
+ * of the data stream files before each run: the page cache footprint
+ * then only shows what the data source configuration left in the page
+ * cache.
+ *
+ * To benchmark network-like storage, run this program on a trace which
+ * lives on an NFS or FUSE mount point, or within a cgroup which limits
+ * the read bandwidth and IOPS of the underlying block device (for
+ * example, `systemd-run --scope -p IOReadBandwidthMax=...`).
+ */
+
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <functional>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include <yactfr/yactfr.hpp>
+
+struct FactoryConfig final
+{
+    std::string name;
+    std::function<std::unique_ptr<yactfr::DataSourceFactory> (const std::string&)> create;
+};
+
+static std::vector<std::string> dsPaths(const std::string& tracePath)
+{
+    std::vector<std::string> paths;
+    const auto dir = opendir(tracePath.c_str());
+
+    if (!dir) {
+        return paths;
+    }
+
+    while (const auto entry = readdir(dir)) {
+        const std::string name {entry->d_name};
+
+        if (name == "metadata" || name[0] == '.') {
+            continue;
+        }
+
+        const auto path = tracePath + "/" + name;
+        struct stat st;
+
+        if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+            paths.push_back(path);
+        }
+    }
+
+    closedir(dir);
+    return paths;
+}
+
+static void dropCache(const std::string& path)
+{
+    const auto fd = open(path.c_str(), O_RDONLY);
+
+    if (fd >= 0) {
+        (void) posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+}
+
+// total size of the pages of the file `path` which are in the page cache
+static yactfr::Size cachedSize(const std::string& path)
+{
+    const auto fd = open(path.c_str(), O_RDONLY);
+    struct stat st;
+
+    if (fd < 0 || fstat(fd, &st) < 0 || st.st_size == 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+
+        return 0;
+    }
+
+    const auto size = static_cast<std::size_t>(st.st_size);
+    const auto addr = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+
+    close(fd);
+
+    if (addr == MAP_FAILED) {
+        return 0;
+    }
+
+    const auto pageSize = static_cast<std::size_t>(sysconf(_SC_PAGE_SIZE));
+    std::vector<unsigned char> vec((size + pageSize - 1) / pageSize);
+    yactfr::Size cached = 0;
+
+    if (mincore(addr, size, vec.data()) == 0) {
+        for (const auto page : vec) {
+            cached += (page & 1) ? pageSize : 0;
+        }
+    }
+
+    munmap(addr, size);
+    return cached;
+}
+
+int main(const int argc, const char * const argv[])
+{
+    auto cold = false;
+    unsigned int repeat = 3;
+    std::string tracePath;
+
+    for (auto i = 1; i < argc; ++i) {
+        const std::string arg {argv[i]};
+
+        if (arg == "--cold") {
+            cold = true;
+        } else if (arg.compare(0, 9, "--repeat=") == 0) {
+            repeat = std::max(std::atoi(arg.c_str() + 9), 1);
+        } else {
+            tracePath = arg;
+        }
+    }
+
+    if (tracePath.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--cold] [--repeat=N] TRACE-DIR\n";
+        return 1;
+    }
+
+    std::ifstream file {tracePath + "/metadata", std::ios::binary};
+    const auto metadataStream = yactfr::createMetadataStream(file);
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadataStream->text());
+    const auto paths = dsPaths(tracePath);
+    const std::vector<FactoryConfig> configs {
+        {"mmap (default)", [](const std::string& path) {
+            return std::make_unique<yactfr::MemoryMappedFileViewFactory>(path);
+        }},
+        {"mmap (4 MiB)", [](const std::string& path) {
+            return std::make_unique<yactfr::MemoryMappedFileViewFactory>(path, 4 << 20);
+        }},
+        {"mmap (adaptive)", [](const std::string& path) {
+            using Factory = yactfr::MemoryMappedFileViewFactory;
+
+            return std::make_unique<Factory>(path, boost::none, Factory::AccessPattern::ADAPTIVE);
+        }},
+        {"buffered (default)", [](const std::string& path) {
+            return std::make_unique<yactfr::BufferedFileDataSourceFactory>(path);
+        }},
+        {"buffered (64 KiB)", [](const std::string& path) {
+            return std::make_unique<yactfr::BufferedFileDataSourceFactory>(path, 64 << 10);
+        }},
+        {"buffered (8 MiB)", [](const std::string& path) {
+            return std::make_unique<yactfr::BufferedFileDataSourceFactory>(path, 8 << 20);
+        }},
+        {"buffered (drop behind)", [](const std::string& path) {
+            using Factory = yactfr::BufferedFileDataSourceFactory;
+
+            return std::make_unique<Factory>(path, boost::none, Factory::CacheMode::DROP_BEHIND);
+        }},
+        {"buffered (direct)", [](const std::string& path) {
+            using Factory = yactfr::BufferedFileDataSourceFactory;
+
+            return std::make_unique<Factory>(path, boost::none, Factory::CacheMode::DIRECT);
+        }},
+        {"read-ahead (default)", [](const std::string& path) {
+            return std::make_unique<yactfr::ReadAheadFileDataSourceFactory>(path);
+        }},
+        {"read-ahead (thread)", [](const std::string& path) {
+            using Factory = yactfr::ReadAheadFileDataSourceFactory;
+
+            return std::make_unique<Factory>(path, boost::none, boost::none, false,
+                                             Factory::Backend::THREAD);
+        }},
+        {"read-ahead (256 KiB)", [](const std::string& path) {
+            return std::make_unique<yactfr::ReadAheadFileDataSourceFactory>(path, 256 << 10, 32);
+        }},
+    };
+
+    for (const auto& config : configs) {
+        for (auto r = 0U; r < repeat; ++r) {
+            yactfr::Size totalSize = 0;
+            const auto start = std::chrono::steady_clock::now();
+
+            for (const auto& path : paths) {
+                if (cold) {
+                    dropCache(path);
+                }
+
+                const auto factory = config.create(path);
+                yactfr::ElementSequence seq {*traceTypeMsUuidPair.first, *factory};
+                yactfr::Index lastOffset = 0;
+
+                for (auto it = seq.begin(); it != seq.end(); ++it) {
+                    lastOffset = it.offset();
+                }
+
+                totalSize += lastOffset / 8;
+            }
+
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            yactfr::Size totalCachedSize = 0;
+
+            for (const auto& path : paths) {
+                totalCachedSize += cachedSize(path);
+            }
+
+            std::cout << std::left << std::setw(22) << config.name << std::right <<
+                         std::fixed << std::setprecision(3) << std::setw(10) <<
+                         elapsed.count() << " s" << std::setw(12) <<
+                         (static_cast<double>(totalSize) / (1 << 20) / elapsed.count()) <<
+                         " MiB/s" << std::setw(12) <<
+                         (static_cast<double>(totalCachedSize) / (1 << 20)) <<
+                         " MiB cached" << std::endl;
+        }
+    }
+
+    return 0;
+}
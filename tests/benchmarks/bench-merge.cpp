@@ -0,0 +1,260 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+/*
+ * Merged event record sequence benchmark.
+ *
+ * Usage:
+ *
+ *     bench-merge [--streams=N] [--events=N]
+ *
+ * Generates N in-memory data streams (128 by default) of which the
+ * event records have random increasing timestamps, and then:
+ *
+ * 1. Decodes each data stream after the other, skipping the data of
+ *    each event record, as a reference.
+ *
+ * 2. Merges them with a MergedEventRecordSequence, also skipping the
+ *    data of each event record, checking that the timestamps don't
+ *    decrease.
+ *
+ * For each run, prints the elapsed time and the time per event record.
+ * Also prints the number of memory allocations during the merge, once
+ * the merged sequence is primed, which is expected to be 0.
+ */
+
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <string>
+#include <vector>
+#include <memory>
+#include <random>
+#include <iostream>
+#include <iomanip>
+
+#include <yactfr/yactfr.hpp>
+
+using Clock = std::chrono::steady_clock;
+
+static std::atomic<unsigned long long> allocCount {0};
+
+void *operator new(const std::size_t size)
+{
+    ++allocCount;
+
+    if (const auto ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc {};
+}
+
+void operator delete(void * const ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void * const ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+static const auto metadata =
+    "/* CTF 1.8 */\n"
+    "typealias integer { size = 8; } := u8;"
+    "typealias integer { size = 32; } := u32;"
+    "trace {"
+    "  major = 1;"
+    "  minor = 8;"
+    "  byte_order = le;"
+    "};"
+    "clock {"
+    "  name = clk;"
+    "  freq = 1000000000;"
+    "};"
+    "typealias integer { size = 64; map = clock.clk.value; } := ts64;"
+    "stream {"
+    "  packet.context := struct {"
+    "    u32 packet_size;"
+    "    u32 content_size;"
+    "    ts64 timestamp_begin;"
+    "    ts64 timestamp_end;"
+    "  };"
+    "  event.header := struct {"
+    "    u8 id;"
+    "    ts64 timestamp;"
+    "  };"
+    "};"
+    "event {"
+    "  id = 0;"
+    "  fields := struct {"
+    "    u32 a;"
+    "    u32 b;"
+    "  };"
+    "};";
+
+// sizes (bytes)
+static constexpr std::size_t pktSize = 4096;
+static constexpr std::size_t pktCtxSize = 24;
+static constexpr std::size_t erSize = 17;
+static constexpr std::size_t ersPerPkt = (pktSize - pktCtxSize) / erSize;
+
+static void appendLe(std::vector<std::uint8_t>& data, const unsigned long long val,
+                     const unsigned int size)
+{
+    for (auto i = 0U; i < size; ++i) {
+        data.push_back(static_cast<std::uint8_t>(val >> (i * 8)));
+    }
+}
+
+static std::vector<std::uint8_t> createStream(std::mt19937_64& rng, const std::size_t erCount)
+{
+    std::uniform_int_distribution<unsigned long long> startDist {0, 1'000'000};
+    std::uniform_int_distribution<unsigned long long> deltaDist {1, 2'000};
+    std::vector<std::uint8_t> data;
+    auto ts = startDist(rng);
+
+    for (std::size_t i = 0; i < erCount; i += ersPerPkt) {
+        const auto pktErCount = std::min(ersPerPkt, erCount - i);
+        std::vector<unsigned long long> tss;
+
+        for (std::size_t j = 0; j < pktErCount; ++j) {
+            ts += deltaDist(rng);
+            tss.push_back(ts);
+        }
+
+        appendLe(data, pktSize * 8, 4);
+        appendLe(data, (pktCtxSize + pktErCount * erSize) * 8, 4);
+        appendLe(data, tss.front(), 8);
+        appendLe(data, tss.back(), 8);
+
+        for (const auto erTs : tss) {
+            appendLe(data, 0, 1);
+            appendLe(data, erTs, 8);
+            appendLe(data, erTs & 0xffffffff, 4);
+            appendLe(data, erTs >> 32, 4);
+        }
+
+        // padding
+        data.resize(data.size() + pktSize - pktCtxSize - pktErCount * erSize);
+    }
+
+    return data;
+}
+
+static void printResult(const std::string& name, const double secs,
+                        const unsigned long long erCount)
+{
+    std::cout << std::left << std::setw(12) << name << std::right <<
+                 std::fixed << std::setprecision(3) << std::setw(9) << secs << " s  " <<
+                 std::setprecision(1) << std::setw(7) << secs * 1e9 / erCount <<
+                 " ns/event record" << std::endl;
+}
+
+int main(const int argc, const char * const argv[])
+{
+    std::size_t streamCount = 128;
+    std::size_t erCount = 20'000;
+
+    for (auto i = 1; i < argc; ++i) {
+        const std::string arg {argv[i]};
+
+        if (arg.compare(0, 10, "--streams=") == 0) {
+            streamCount = std::max(std::atoi(arg.c_str() + 10), 1);
+        } else if (arg.compare(0, 9, "--events=") == 0) {
+            erCount = std::max(std::atoi(arg.c_str() + 9), 1);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--streams=N] [--events=N]\n";
+            return 1;
+        }
+    }
+
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadata,
+                                                              metadata + std::strlen(metadata));
+    auto& traceType = *traceTypeMsUuidPair.first;
+    std::mt19937_64 rng {0};
+    std::vector<std::vector<std::uint8_t>> streams;
+    std::vector<std::unique_ptr<yactfr::MemoryDataSourceFactory>> factories;
+    std::vector<std::unique_ptr<yactfr::ElementSequence>> seqs;
+    std::vector<yactfr::ElementSequence *> seqPtrs;
+
+    for (std::size_t i = 0; i < streamCount; ++i) {
+        streams.push_back(createStream(rng, erCount));
+        factories.push_back(std::make_unique<yactfr::MemoryDataSourceFactory>(streams.back().data(),
+                                                                              streams.back().size()));
+        seqs.push_back(std::make_unique<yactfr::ElementSequence>(traceType, *factories.back()));
+        seqPtrs.push_back(seqs.back().get());
+    }
+
+    const auto totalErCount = static_cast<unsigned long long>(streamCount) * erCount;
+
+    std::cout << streamCount << " streams, " << erCount << " event records per stream" <<
+                 std::endl;
+
+    // reference: one stream after the other
+    unsigned long long count = 0;
+    auto start = Clock::now();
+
+    for (auto seq : seqPtrs) {
+        for (auto it = seq->begin(); it != seq->end(); ++it) {
+            if (it->isEventRecordBeginningElement()) {
+                it.skipToEventRecordEnd();
+                ++count;
+            }
+        }
+    }
+
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+
+    printResult("sequential", elapsed.count(), count);
+
+    if (count != totalErCount) {
+        std::cerr << "Unexpected event record count " << count << ".\n";
+        return 1;
+    }
+
+    // merged
+    start = Clock::now();
+
+    yactfr::MergedEventRecordSequence mergedSeq {seqPtrs};
+    yactfr::Cycles lastCycles = 0;
+
+    count = 0;
+
+    // prime the lookahead of each stream before counting allocations
+    auto hasEr = mergedSeq.next();
+    const auto allocCountBefore = allocCount.load();
+
+    while (hasEr) {
+        if (mergedSeq.defaultClockValue() < lastCycles) {
+            std::cerr << "Decreasing timestamp.\n";
+            return 1;
+        }
+
+        lastCycles = mergedSeq.defaultClockValue();
+        ++count;
+        hasEr = mergedSeq.next();
+    }
+
+    elapsed = Clock::now() - start;
+
+    const auto allocDelta = allocCount.load() - allocCountBefore;
+
+    printResult("merged", elapsed.count(), count);
+    std::cout << "allocations during the merge: " << allocDelta << std::endl;
+
+    if (count != totalErCount) {
+        std::cerr << "Unexpected event record count " << count << ".\n";
+        return 1;
+    }
+
+    return 0;
+}
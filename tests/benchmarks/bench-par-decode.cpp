@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+/*
+ * Parallel packet decoding benchmark.
+ *
+ * Usage:
+ *
+ *     bench-par-decode [--max-workers=N] TRACE-DIR
+ *
+ * For each data stream of the CTF trace TRACE-DIR, builds its packet
+ * index, decodes it with a single element sequence iterator, and then
+ * decodes it with a ParallelPacketDecoder having 1, 2, 4, ..., N worker
+ * threads, printing the elapsed time, the throughput, and the speedup
+ * compared to the single iterator.
+ *
+ * The default maximum number of worker threads is the number of
+ * hardware threads.
+ */
+
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <thread>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <yactfr/yactfr.hpp>
+
+using Clock = std::chrono::steady_clock;
+
+static std::vector<std::string> dsPaths(const std::string& tracePath)
+{
+    std::vector<std::string> paths;
+    const auto dir = opendir(tracePath.c_str());
+
+    if (!dir) {
+        return paths;
+    }
+
+    while (const auto entry = readdir(dir)) {
+        const std::string name {entry->d_name};
+
+        if (name == "metadata" || name[0] == '.') {
+            continue;
+        }
+
+        const auto path = tracePath + "/" + name;
+        struct stat st;
+
+        if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+            paths.push_back(path);
+        }
+    }
+
+    closedir(dir);
+    return paths;
+}
+
+static double secsSince(const Clock::time_point start)
+{
+    const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+    return elapsed.count();
+}
+
+static void printResult(const std::string& name, const double secs, const double size,
+                        const double refSecs, yactfr::Size recordCount)
+{
+    std::cout << "  " << std::left << std::setw(14) << name << std::right <<
+                 std::fixed << std::setprecision(3) << std::setw(9) << secs << " s  " <<
+                 std::setprecision(1) << std::setw(8) << size / secs / 1024 / 1024 <<
+                 " MiB/s  x" << std::setprecision(2) << refSecs / secs <<
+                 "  (" << recordCount << " elements)" << std::endl;
+}
+
+int main(const int argc, const char * const argv[])
+{
+    unsigned int maxWorkerCount = std::max(std::thread::hardware_concurrency(), 1U);
+    std::string tracePath;
+
+    for (auto i = 1; i < argc; ++i) {
+        const std::string arg {argv[i]};
+
+        if (arg.compare(0, 14, "--max-workers=") == 0) {
+            maxWorkerCount = std::max(std::atoi(arg.c_str() + 14), 1);
+        } else {
+            tracePath = arg;
+        }
+    }
+
+    if (tracePath.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--max-workers=N] TRACE-DIR\n";
+        return 1;
+    }
+
+    std::ifstream file {tracePath + "/metadata", std::ios::binary};
+    const auto metadataStream = yactfr::createMetadataStream(file);
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadataStream->text());
+    auto& traceType = *traceTypeMsUuidPair.first;
+
+    for (const auto& path : dsPaths(tracePath)) {
+        yactfr::MemoryMappedFileViewFactory factory {path};
+        const yactfr::PacketIndex pktIndex {traceType, factory};
+        struct stat st;
+
+        stat(path.c_str(), &st);
+
+        const auto size = static_cast<double>(st.st_size);
+
+        std::cout << path << ": " << pktIndex.size() << " packets" << std::endl;
+
+        if (pktIndex.isEmpty()) {
+            continue;
+        }
+
+        // reference: single element sequence iterator
+        yactfr::ElementSequence seq {traceType, factory};
+        yactfr::ElementBatch batch;
+        yactfr::Size recordCount = 0;
+        auto start = Clock::now();
+
+        for (auto it = seq.begin(); it != seq.end();) {
+            it.nextBatch(batch, 4096);
+            recordCount += batch.size();
+        }
+
+        const auto refSecs = secsSince(start);
+
+        printResult("iterator", refSecs, size, refSecs, recordCount);
+
+        for (auto workerCount = 1U; workerCount <= maxWorkerCount;
+                workerCount = workerCount == maxWorkerCount ? workerCount + 1 :
+                              std::min(workerCount * 2, maxWorkerCount)) {
+            recordCount = 0;
+            start = Clock::now();
+
+            yactfr::ParallelPacketDecoder decoder {
+                traceType, factory, pktIndex, yactfr::ElementSequenceOptions {}, workerCount
+            };
+
+            while (decoder.next(batch)) {
+                recordCount += batch.size();
+            }
+
+            printResult(std::to_string(workerCount) + " workers", secsSince(start), size,
+                        refSecs, recordCount);
+        }
+    }
+
+    return 0;
+}
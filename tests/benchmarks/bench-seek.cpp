@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+/*
+ * Timestamp seeking benchmark.
+ *
+ * Usage:
+ *
+ *     bench-seek [--seeks=N] TRACE-DIR
+ *
+ * For each data stream of the CTF trace TRACE-DIR, builds its packet
+ * index, and then seeks N random default clock values between the
+ * beginning of its first packet and the end of its last packet with
+ * ElementSequence::atTimestamp(), printing the time to build the packet
+ * index as well as the average, median, and maximum seek latencies.
+ *
+ * For comparison, it also prints the average latency of a few linear
+ * seeks, that is, decoding from the beginning of the data stream until
+ * the first event record at or after the same default clock value.
+ */
+
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <random>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <yactfr/yactfr.hpp>
+
+using Clock = std::chrono::steady_clock;
+
+// number of linear seeks for comparison
+static constexpr unsigned int linearSeekCount = 5;
+
+static std::vector<std::string> dsPaths(const std::string& tracePath)
+{
+    std::vector<std::string> paths;
+    const auto dir = opendir(tracePath.c_str());
+
+    if (!dir) {
+        return paths;
+    }
+
+    while (const auto entry = readdir(dir)) {
+        const std::string name {entry->d_name};
+
+        if (name == "metadata" || name[0] == '.') {
+            continue;
+        }
+
+        const auto path = tracePath + "/" + name;
+        struct stat st;
+
+        if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+            paths.push_back(path);
+        }
+    }
+
+    closedir(dir);
+    return paths;
+}
+
+static double usSince(const Clock::time_point start)
+{
+    const std::chrono::duration<double, std::micro> elapsed = Clock::now() - start;
+
+    return elapsed.count();
+}
+
+// decodes from the beginning until the first event record at or after `cycles`
+static void linearSeek(yactfr::ElementSequence& seq, const yactfr::Cycles cycles)
+{
+    auto inErHeader = false;
+
+    for (auto it = seq.begin(); it != seq.end(); ++it) {
+        if (it->isEventRecordBeginningElement()) {
+            inErHeader = true;
+        } else if (it->isDefaultClockValueElement() && inErHeader) {
+            if (it->asDefaultClockValueElement().cycles() >= cycles) {
+                return;
+            }
+
+            inErHeader = false;
+        }
+    }
+}
+
+int main(const int argc, const char * const argv[])
+{
+    unsigned int seekCount = 1000;
+    std::string tracePath;
+
+    for (auto i = 1; i < argc; ++i) {
+        const std::string arg {argv[i]};
+
+        if (arg.compare(0, 8, "--seeks=") == 0) {
+            seekCount = std::max(std::atoi(arg.c_str() + 8), 1);
+        } else {
+            tracePath = arg;
+        }
+    }
+
+    if (tracePath.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--seeks=N] TRACE-DIR\n";
+        return 1;
+    }
+
+    std::ifstream file {tracePath + "/metadata", std::ios::binary};
+    const auto metadataStream = yactfr::createMetadataStream(file);
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadataStream->text());
+    std::mt19937_64 rng {0};
+
+    for (const auto& path : dsPaths(tracePath)) {
+        yactfr::MemoryMappedFileViewFactory factory {path};
+        yactfr::ElementSequence seq {*traceTypeMsUuidPair.first, factory};
+        auto start = Clock::now();
+        const yactfr::PacketIndex pktIndex {*traceTypeMsUuidPair.first, factory};
+        const auto indexUs = usSince(start);
+
+        std::cout << path << ": " << pktIndex.size() << " packets, index built in " <<
+                     std::fixed << std::setprecision(3) << indexUs / 1000 << " ms" << std::endl;
+
+        if (pktIndex.isEmpty() || !pktIndex[0].beginningDefaultClockValue() ||
+                !pktIndex[pktIndex.size() - 1].endDefaultClockValue()) {
+            std::cout << "  no packet default clock values: skipping" << std::endl;
+            continue;
+        }
+
+        std::uniform_int_distribution<yactfr::Cycles> dist {
+            *pktIndex[0].beginningDefaultClockValue(),
+            *pktIndex[pktIndex.size() - 1].endDefaultClockValue()
+        };
+        std::vector<yactfr::Cycles> targets;
+        std::vector<double> latencies;
+
+        for (auto i = 0U; i < seekCount; ++i) {
+            targets.push_back(dist(rng));
+        }
+
+        for (const auto target : targets) {
+            start = Clock::now();
+            static_cast<void>(seq.atTimestamp(pktIndex, target));
+            latencies.push_back(usSince(start));
+        }
+
+        double linearTotalUs = 0;
+        const auto linearCount = std::min(linearSeekCount, seekCount);
+
+        for (auto i = 0U; i < linearCount; ++i) {
+            start = Clock::now();
+            linearSeek(seq, targets[i]);
+            linearTotalUs += usSince(start);
+        }
+
+        double totalUs = 0;
+
+        for (const auto latency : latencies) {
+            totalUs += latency;
+        }
+
+        std::sort(latencies.begin(), latencies.end());
+        std::cout << "  indexed seek: " << std::setprecision(1) <<
+                     "avg " << totalUs / latencies.size() << " us, " <<
+                     "median " << latencies[latencies.size() / 2] << " us, " <<
+                     "max " << latencies.back() << " us" << std::endl <<
+                     "  linear seek:  avg " << linearTotalUs / linearCount << " us" << std::endl;
+    }
+
+    return 0;
+}
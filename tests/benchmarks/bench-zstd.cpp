@@ -0,0 +1,304 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+/*
+ * zstd-seekable file data source benchmark.
+ *
+ * Usage:
+ *
+ *     bench-zstd [--repeat=N] [--frame-size=SIZE] TRACE-DIR
+ *
+ * Compresses each data stream file of the CTF trace TRACE-DIR to the
+ * zstd seekable format (frames of SIZE bytes, 1 MiB by default) within
+ * a temporary directory, and then compares, for each file:
+ *
+ * decompress + mmap:
+ *     Decompress the whole file to a temporary file and decode it with
+ *     a memory mapped file view factory.
+ *
+ * seekable:
+ *     Decode the compressed file directly with a zstd-seekable file
+ *     data source factory.
+ *
+ * Both full decoding (`nop` iteration loop) and 100 packet seeks
+ * (reading the first 32 elements of each packet) are measured.
+ */
+
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <memory>
+#include <random>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <functional>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <zstd.h>
+
+#include <yactfr/yactfr.hpp>
+
+struct DsFile final
+{
+    std::string path;
+    std::string zstdPath;
+    std::vector<yactfr::Index> pktOffsets;
+};
+
+static std::vector<std::string> dsPaths(const std::string& tracePath)
+{
+    std::vector<std::string> paths;
+    const auto dir = opendir(tracePath.c_str());
+
+    if (!dir) {
+        return paths;
+    }
+
+    while (const auto entry = readdir(dir)) {
+        const std::string name {entry->d_name};
+
+        if (name == "metadata" || name[0] == '.') {
+            continue;
+        }
+
+        const auto path = tracePath + "/" + name;
+        struct stat st;
+
+        if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+            paths.push_back(path);
+        }
+    }
+
+    closedir(dir);
+    return paths;
+}
+
+static std::vector<std::uint8_t> readFile(const std::string& path)
+{
+    std::ifstream file {path, std::ios::binary};
+
+    return std::vector<std::uint8_t> {std::istreambuf_iterator<char> {file},
+                                      std::istreambuf_iterator<char> {}};
+}
+
+static void writeFile(const std::string& path, const std::vector<std::uint8_t>& data)
+{
+    std::ofstream file {path, std::ios::binary};
+
+    file.write(reinterpret_cast<const char *>(data.data()), data.size());
+}
+
+static void appendLe32(std::vector<std::uint8_t>& buf, const std::uint32_t val)
+{
+    for (auto i = 0U; i < 4; ++i) {
+        buf.push_back(static_cast<std::uint8_t>(val >> (i * 8)));
+    }
+}
+
+static void compressSeekable(const std::string& path, const std::string& zstdPath,
+                             const std::size_t frameSize)
+{
+    const auto data = readFile(path);
+    std::vector<std::uint8_t> out;
+    std::vector<std::uint8_t> frame;
+    std::vector<std::uint8_t> seekTable;
+    std::uint32_t frameCount = 0;
+
+    for (std::size_t offset = 0; offset < data.size(); offset += frameSize) {
+        const auto size = std::min(frameSize, data.size() - offset);
+
+        frame.resize(ZSTD_compressBound(size));
+
+        const auto comprSize = ZSTD_compress(frame.data(), frame.size(), data.data() + offset,
+                                             size, 3);
+
+        if (ZSTD_isError(comprSize)) {
+            std::cerr << "Cannot compress `" << path << "`: " <<
+                         ZSTD_getErrorName(comprSize) << "\n";
+            std::exit(1);
+        }
+
+        out.insert(out.end(), frame.begin(), frame.begin() + comprSize);
+        appendLe32(seekTable, static_cast<std::uint32_t>(comprSize));
+        appendLe32(seekTable, static_cast<std::uint32_t>(size));
+        ++frameCount;
+    }
+
+    appendLe32(out, 0x184d2a5e);
+    appendLe32(out, static_cast<std::uint32_t>(seekTable.size() + 9));
+    out.insert(out.end(), seekTable.begin(), seekTable.end());
+    appendLe32(out, frameCount);
+    out.push_back(0);
+    appendLe32(out, 0x8f92eab1);
+    writeFile(zstdPath, out);
+}
+
+static std::vector<yactfr::Index> pktOffsets(const yactfr::TraceType& traceType,
+                                             const std::string& path)
+{
+    yactfr::MemoryMappedFileViewFactory factory {path};
+    yactfr::ElementSequence seq {traceType, factory};
+    std::vector<yactfr::Index> offsets;
+
+    for (auto it = seq.begin(); it != seq.end(); ++it) {
+        if (it->isPacketBeginningElement()) {
+            offsets.push_back(it.offset() / 8);
+        }
+    }
+
+    return offsets;
+}
+
+/*
+ * Decodes with a factory which `createFactory` creates, either fully
+ * or by seeking the packets at `seekOffsets`.
+ */
+static void decode(const yactfr::TraceType& traceType,
+                   const std::function<std::unique_ptr<yactfr::DataSourceFactory> ()>& createFactory,
+                   const std::vector<yactfr::Index>& seekOffsets)
+{
+    const auto factory = createFactory();
+    yactfr::ElementSequence seq {traceType, *factory};
+    auto it = seq.begin();
+
+    if (seekOffsets.empty()) {
+        while (it != seq.end()) {
+            ++it;
+        }
+
+        return;
+    }
+
+    for (const auto offset : seekOffsets) {
+        it.seekPacket(offset);
+
+        for (auto i = 0U; i < 32 && it != seq.end(); ++i) {
+            ++it;
+        }
+    }
+}
+
+int main(const int argc, const char * const argv[])
+{
+    unsigned int repeat = 3;
+    std::size_t frameSize = 1 << 20;
+    std::string tracePath;
+
+    for (auto i = 1; i < argc; ++i) {
+        const std::string arg {argv[i]};
+
+        if (arg.compare(0, 9, "--repeat=") == 0) {
+            repeat = std::max(std::atoi(arg.c_str() + 9), 1);
+        } else if (arg.compare(0, 13, "--frame-size=") == 0) {
+            frameSize = std::max(std::atoll(arg.c_str() + 13), 1LL);
+        } else {
+            tracePath = arg;
+        }
+    }
+
+    if (tracePath.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--repeat=N] [--frame-size=SIZE] TRACE-DIR\n";
+        return 1;
+    }
+
+    std::ifstream file {tracePath + "/metadata", std::ios::binary};
+    const auto metadataStream = yactfr::createMetadataStream(file);
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadataStream->text());
+    const auto& traceType = *traceTypeMsUuidPair.first;
+    char tmpDirPath[] = "/tmp/yactfr-bench-zstd-XXXXXX";
+
+    if (!mkdtemp(tmpDirPath)) {
+        std::cerr << "Cannot create temporary directory.\n";
+        return 1;
+    }
+
+    const std::string decomprPath = std::string {tmpDirPath} + "/decompressed";
+    std::vector<DsFile> dsFiles;
+    std::mt19937 rng {42};
+
+    for (const auto& path : dsPaths(tracePath)) {
+        DsFile dsFile;
+
+        dsFile.path = path;
+        dsFile.zstdPath = std::string {tmpDirPath} + "/" + std::to_string(dsFiles.size()) +
+                          ".zst";
+        compressSeekable(path, dsFile.zstdPath, frameSize);
+
+        // 100 random packets
+        const auto offsets = pktOffsets(traceType, path);
+
+        for (auto i = 0U; i < 100 && !offsets.empty(); ++i) {
+            dsFile.pktOffsets.push_back(offsets[rng() % offsets.size()]);
+        }
+
+        dsFiles.push_back(std::move(dsFile));
+    }
+
+    const auto decomprMmapFactory = [&decomprPath](const DsFile& dsFile) {
+        // decompress the whole file (concatenated frames) to disk
+        const auto zstdData = readFile(dsFile.zstdPath);
+        std::vector<std::uint8_t> data;
+
+        data.resize(yactfr::ZstdSeekableFileDataSourceFactory {dsFile.zstdPath}.decompressedSize());
+
+        const auto ret = ZSTD_decompress(data.data(), data.size(), zstdData.data(),
+                                         zstdData.size());
+
+        if (ZSTD_isError(ret)) {
+            std::cerr << "Cannot decompress `" << dsFile.zstdPath << "`: " <<
+                         ZSTD_getErrorName(ret) << "\n";
+            std::exit(1);
+        }
+
+        writeFile(decomprPath, data);
+        return std::make_unique<yactfr::MemoryMappedFileViewFactory>(decomprPath);
+    };
+
+    const auto seekableFactory = [](const DsFile& dsFile) {
+        return std::make_unique<yactfr::ZstdSeekableFileDataSourceFactory>(dsFile.zstdPath);
+    };
+
+    using CreateFactory = std::function<std::unique_ptr<yactfr::DataSourceFactory> (const DsFile&)>;
+    const std::vector<std::pair<std::string, CreateFactory>> configs {
+        {"decompress + mmap", decomprMmapFactory},
+        {"seekable", seekableFactory},
+    };
+
+    for (const auto seek : {false, true}) {
+        for (const auto& config : configs) {
+            for (auto r = 0U; r < repeat; ++r) {
+                const auto start = std::chrono::steady_clock::now();
+
+                for (const auto& dsFile : dsFiles) {
+                    decode(traceType, [&config, &dsFile] {
+                        return config.second(dsFile);
+                    }, seek ? dsFile.pktOffsets : std::vector<yactfr::Index> {});
+                }
+
+                const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() -
+                                                              start;
+
+                std::cout << std::left << std::setw(20) << config.first <<
+                             std::setw(8) << (seek ? "seek" : "full") << std::right <<
+                             std::fixed << std::setprecision(3) << std::setw(10) <<
+                             elapsed.count() << " s" << std::endl;
+            }
+        }
+    }
+
+    for (const auto& dsFile : dsFiles) {
+        unlink(dsFile.zstdPath.c_str());
+    }
+
+    unlink(decomprPath.c_str());
+    rmdir(tmpDirPath);
+    return 0;
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_TESTS_DATA_SRC_CHECKS_HPP
+#define _YACTFR_TESTS_DATA_SRC_CHECKS_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <ostream>
+
+#include <yactfr/yactfr.hpp>
+
+#include <elem-printer.hpp>
+#include <common-trace.hpp>
+
+// number of times to repeat the common stream to span many pages
+static constexpr std::size_t streamCount = 200;
+
+/*
+ * Returns the common stream, repeated `streamCount` times.
+ */
+static std::vector<std::uint8_t> repeatedStream()
+{
+    std::vector<std::uint8_t> data;
+
+    for (std::size_t i = 0; i < streamCount; ++i) {
+        data.insert(data.end(), stream, stream + sizeof stream);
+    }
+
+    return data;
+}
+
+/*
+ * Substring elements depend on the data blocks of the data source:
+ * only print their contents.
+ */
+static void printElem(std::ostream& os, ElemPrinter& printer, const yactfr::Element& elem)
+{
+    if (elem.isSubstringElement()) {
+        auto& substrElem = elem.asSubstringElement();
+
+        os << std::string {substrElem.begin(), substrElem.end()};
+        return;
+    }
+
+    elem.accept(printer);
+}
+
+static std::string decode(const yactfr::TraceType& traceType,
+                          yactfr::DataSourceFactory& factory)
+{
+    yactfr::ElementSequence seq {traceType, factory};
+    std::ostringstream ss;
+    ElemPrinter printer {ss, 0};
+
+    for (auto& elem : seq) {
+        printElem(ss, printer, elem);
+    }
+
+    return ss.str();
+}
+
+/*
+ * Decodes the data of `factory` with an iterator and a copy of it,
+ * interleaving both, from somewhere in the middle.
+ *
+ * If `restore` is true, then also restores the saved position of the
+ * original iterator afterwards (seeking backward) and decodes again.
+ *
+ * Returns whether or not all the outputs are the same.
+ */
+static bool checkCopyAndMaybeRestore(const yactfr::TraceType& traceType,
+                                     yactfr::DataSourceFactory& factory, const bool restore)
+{
+    yactfr::ElementSequence seq {traceType, factory};
+    auto it = seq.begin();
+
+    // go somewhere in the middle
+    for (auto i = 0U; i < 5000; ++i) {
+        ++it;
+    }
+
+    auto itCopy = it;
+    yactfr::ElementSequenceIteratorPosition pos;
+    std::ostringstream ss;
+    std::ostringstream ssCopy;
+    ElemPrinter printer {ss, 0};
+    ElemPrinter printerCopy {ssCopy, 0};
+
+    it.savePosition(pos);
+
+    // interleave both iterators, which read the same data
+    while (it != seq.end()) {
+        printElem(ss, printer, *it);
+        printElem(ssCopy, printerCopy, *itCopy);
+        ++it;
+        ++itCopy;
+    }
+
+    if (itCopy != seq.end() || ss.str() != ssCopy.str()) {
+        return false;
+    }
+
+    if (!restore) {
+        return true;
+    }
+
+    std::ostringstream ssRestored;
+    ElemPrinter printerRestored {ssRestored, 0};
+
+    // seek backward
+    it.restorePosition(pos);
+
+    while (it != seq.end()) {
+        printElem(ssRestored, printerRestored, *it);
+        ++it;
+    }
+
+    return ss.str() == ssRestored.str();
+}
+
+static inline bool checkCopy(const yactfr::TraceType& traceType,
+                             yactfr::DataSourceFactory& factory)
+{
+    return checkCopyAndMaybeRestore(traceType, factory, false);
+}
+
+static inline bool checkCopyAndRestore(const yactfr::TraceType& traceType,
+                                       yactfr::DataSourceFactory& factory)
+{
+    return checkCopyAndMaybeRestore(traceType, factory, true);
+}
+
+#endif // _YACTFR_TESTS_DATA_SRC_CHECKS_HPP
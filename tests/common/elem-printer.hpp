@@ -211,6 +211,24 @@ public:
         *_os << '\n';
     }
 
+    void visit(const yactfr::ArraySectionElement& elem) override
+    {
+        this->_indent();
+        *_os << "AS:" << elem.length() << ":";
+
+        std::ios init {nullptr};
+
+        init.copyfmt(*_os);
+        *_os << std::hex << std::setfill('0');
+
+        for (const auto byte : elem) {
+            *_os << std::setw(2) << static_cast<unsigned int>(byte);
+        }
+
+        _os->copyfmt(init);
+        *_os << '\n';
+    }
+
     void visit(const yactfr::StaticLengthArrayBeginningElement& elem) override
     {
         this->_visitDataElem(elem, "SLA");
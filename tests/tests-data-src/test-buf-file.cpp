@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <unistd.h>
+
+#include <yactfr/yactfr.hpp>
+
+#include <mem-data-src-factory.hpp>
+#include <elem-printer.hpp>
+#include <data-src-checks.hpp>
+
+int main()
+{
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadata,
+                                                              metadata + std::strlen(metadata));
+    auto& traceType = *traceTypeMsUuidPair.first;
+    const auto data = repeatedStream();
+
+    char path[] = "/tmp/yactfr-test-buf-file-XXXXXX";
+    const auto fd = mkstemp(path);
+
+    if (fd < 0 || write(fd, data.data(), data.size()) != static_cast<ssize_t>(data.size())) {
+        std::cerr << "Cannot create temporary file.\n";
+        return 1;
+    }
+
+    close(fd);
+
+    MemDataSrcFactory memFactory {data.data(), data.size()};
+    yactfr::MemoryMappedFileViewFactory mmapFactory {path, 4096};
+    yactfr::BufferedFileDataSourceFactory bufFactory {path, 1};
+    yactfr::BufferedFileDataSourceFactory defBufFactory {path};
+    const auto expected = decode(traceType, memFactory);
+    auto ret = 0;
+
+    if (bufFactory.blockSize() != static_cast<yactfr::Size>(sysconf(_SC_PAGE_SIZE))) {
+        std::cerr << "Unexpected block size: " << bufFactory.blockSize() << "\n";
+        ret = 1;
+    }
+
+    if (decode(traceType, mmapFactory) != expected) {
+        std::cerr << "Memory mapped file view output differs.\n";
+        ret = 1;
+    }
+
+    if (decode(traceType, bufFactory) != expected) {
+        std::cerr << "Buffered file data source output differs (page-sized blocks).\n";
+        ret = 1;
+    }
+
+    if (decode(traceType, defBufFactory) != expected) {
+        std::cerr << "Buffered file data source output differs (default blocks).\n";
+        ret = 1;
+    }
+
+    if (!checkCopy(traceType, bufFactory)) {
+        std::cerr << "Iterator copy output differs.\n";
+        ret = 1;
+    }
+
+    // page cache usage
+    using CacheMode = yactfr::BufferedFileDataSourceFactory::CacheMode;
+
+    yactfr::BufferedFileDataSourceFactory dropBufFactory {path, 1, CacheMode::DROP_BEHIND};
+    yactfr::BufferedFileDataSourceFactory directBufFactory {path, 1, CacheMode::DIRECT};
+    yactfr::BufferedFileDataSourceFactory defDirectBufFactory {path, boost::none,
+                                                               CacheMode::DIRECT};
+
+    if (dropBufFactory.cacheMode() != CacheMode::DROP_BEHIND ||
+            defBufFactory.cacheMode() != CacheMode::NORMAL) {
+        std::cerr << "Unexpected cache mode.\n";
+        ret = 1;
+    }
+
+    // falls back to dropping pages if the file system doesn't support direct I/O
+    if (directBufFactory.cacheMode() == CacheMode::DIRECT &&
+            directBufFactory.blockSize() != static_cast<yactfr::Size>(sysconf(_SC_PAGE_SIZE) * 2)) {
+        std::cerr << "Unexpected block size (direct I/O): " << directBufFactory.blockSize() <<
+                     "\n";
+        ret = 1;
+    }
+
+    if (decode(traceType, dropBufFactory) != expected) {
+        std::cerr << "Buffered file data source output differs (drop behind).\n";
+        ret = 1;
+    }
+
+    if (decode(traceType, directBufFactory) != expected) {
+        std::cerr << "Buffered file data source output differs (direct I/O).\n";
+        ret = 1;
+    }
+
+    if (decode(traceType, defDirectBufFactory) != expected) {
+        std::cerr << "Buffered file data source output differs (direct I/O, default blocks).\n";
+        ret = 1;
+    }
+
+    if (!checkCopy(traceType, directBufFactory)) {
+        std::cerr << "Iterator copy output differs (direct I/O).\n";
+        ret = 1;
+    }
+
+    unlink(path);
+
+    try {
+        yactfr::BufferedFileDataSourceFactory {"/this/file/does/not/exist"};
+        std::cerr << "Expecting an I/O error.\n";
+        ret = 1;
+    } catch (const yactfr::IOError&) {
+    }
+
+    return ret;
+}
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <yactfr/yactfr.hpp>
+
+#include <mem-data-src-factory.hpp>
+#include <elem-printer.hpp>
+#include <data-src-checks.hpp>
+
+/*
+ * Seeks backward to data which isn't buffered anymore: expects an I/O
+ * error.
+ */
+static bool checkDiscarded(const yactfr::TraceType& traceType,
+                           yactfr::DataSourceFactory& factory, const yactfr::Size bufSize)
+{
+    yactfr::ElementSequence seq {traceType, factory};
+    auto it = seq.begin();
+    yactfr::ElementSequenceIteratorPosition pos;
+
+    it.savePosition(pos);
+
+    while (it != seq.end() && it.offset() < bufSize * 8 * 4) {
+        ++it;
+    }
+
+    try {
+        it.restorePosition(pos);
+
+        while (it != seq.end()) {
+            ++it;
+        }
+    } catch (const yactfr::IOError&) {
+        return true;
+    }
+
+    std::cerr << "Expecting an I/O error (discarded data).\n";
+    return false;
+}
+
+/*
+ * Creates a pipe of which a child process writes `data` to the write
+ * end, returning the read end.
+ */
+static int pipeData(const std::vector<std::uint8_t>& data)
+{
+    int fds[2];
+
+    if (pipe(fds) < 0) {
+        return -1;
+    }
+
+    const auto pid = fork();
+
+    if (pid < 0) {
+        return -1;
+    }
+
+    if (pid == 0) {
+        close(fds[0]);
+
+        std::size_t offset = 0;
+
+        // write small pieces to get short reads
+        while (offset < data.size()) {
+            const auto size = std::min(data.size() - offset, static_cast<std::size_t>(3000));
+            const auto ret = write(fds[1], data.data() + offset, size);
+
+            if (ret <= 0) {
+                _exit(1);
+            }
+
+            offset += static_cast<std::size_t>(ret);
+        }
+
+        _exit(0);
+    }
+
+    close(fds[1]);
+    return fds[0];
+}
+
+static bool closePipe(const int fd)
+{
+    int status;
+
+    close(fd);
+    return wait(&status) > 0;
+}
+
+int main()
+{
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadata,
+                                                              metadata + std::strlen(metadata));
+    auto& traceType = *traceTypeMsUuidPair.first;
+    const auto data = repeatedStream();
+
+    MemDataSrcFactory memFactory {data.data(), data.size()};
+    const auto expected = decode(traceType, memFactory);
+    auto ret = 0;
+
+    // small ring buffer: discards data during decoding
+    {
+        const auto fd = pipeData(data);
+        yactfr::FileDescriptorDataSourceFactory factory {fd, 4096};
+
+        if (factory.fd() != fd || factory.bufferSize() != 4096) {
+            std::cerr << "Unexpected factory properties.\n";
+            ret = 1;
+        }
+
+        if (decode(traceType, factory) != expected) {
+            std::cerr << "Output differs (small ring buffer).\n";
+            ret = 1;
+        }
+
+        closePipe(fd);
+    }
+
+    // minimum ring buffer: discards a single block at a time
+    {
+        const auto fd = pipeData(data);
+        yactfr::FileDescriptorDataSourceFactory factory {fd, 1};
+
+        if (factory.bufferSize() != 64) {
+            std::cerr << "Unexpected minimum ring buffer size.\n";
+            ret = 1;
+        }
+
+        if (decode(traceType, factory) != expected) {
+            std::cerr << "Output differs (minimum ring buffer).\n";
+            ret = 1;
+        }
+
+        closePipe(fd);
+    }
+
+    // default ring buffer: everything remains buffered
+    {
+        const auto fd = pipeData(data);
+        yactfr::FileDescriptorDataSourceFactory factory {fd};
+
+        if (!checkCopyAndRestore(traceType, factory)) {
+            std::cerr << "Iterator copy/restore output differs.\n";
+            ret = 1;
+        }
+
+        closePipe(fd);
+    }
+
+    {
+        const auto fd = pipeData(data);
+        yactfr::FileDescriptorDataSourceFactory factory {fd, 4096};
+
+        if (!checkDiscarded(traceType, factory, 4096)) {
+            ret = 1;
+        }
+
+        closePipe(fd);
+    }
+
+    // bad file descriptor
+    try {
+        yactfr::FileDescriptorDataSourceFactory factory {-1};
+
+        decode(traceType, factory);
+        std::cerr << "Expecting an I/O error (bad file descriptor).\n";
+        ret = 1;
+    } catch (const yactfr::IOError&) {
+    }
+
+    return ret;
+}
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <iostream>
+#include <vector>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <yactfr/yactfr.hpp>
+
+#include <mem-data-src-factory.hpp>
+#include <elem-printer.hpp>
+#include <data-src-checks.hpp>
+
+// size of each appended chunk (not a multiple of the page size)
+static constexpr std::size_t chunkSize = 1000;
+
+/*
+ * Decodes the file `path` while appending `data` to it, one chunk at a
+ * time, each time the data source reports that data isn't available.
+ */
+static bool checkLive(const yactfr::TraceType& traceType, const char * const path,
+                      const std::vector<std::uint8_t>& data, const std::string& expected)
+{
+    const auto fd = open(path, O_WRONLY | O_APPEND);
+
+    if (fd < 0) {
+        std::cerr << "Cannot open temporary file.\n";
+        return false;
+    }
+
+    yactfr::LiveFileDataSourceFactory factory {path, 4096};
+    yactfr::ElementSequence seq {traceType, factory};
+    std::ostringstream ss;
+    ElemPrinter printer {ss, 0};
+    yactfr::ElementSequenceIterator it {seq.end()};
+    std::size_t writtenSize = 0;
+    auto hasBegun = false;
+    auto notAvailCount = 0ULL;
+    auto ok = true;
+
+    while (true) {
+        try {
+            if (!hasBegun) {
+                it = seq.begin();
+                hasBegun = true;
+            } else {
+                ++it;
+            }
+
+            if (it == seq.end()) {
+                break;
+            }
+
+            printElem(ss, printer, *it);
+        } catch (const yactfr::DataNotAvailable&) {
+            ++notAvailCount;
+
+            // the data source stops exactly at the current end
+            if (hasBegun && it.offset() > writtenSize * 8) {
+                std::cerr << "Iterator is beyond the end of the file.\n";
+                ok = false;
+            }
+
+            if (factory.fileSize() != writtenSize) {
+                std::cerr << "Unexpected last known file size.\n";
+                ok = false;
+            }
+
+            if (writtenSize == data.size()) {
+                factory.markComplete();
+                continue;
+            }
+
+            // append a chunk
+            const auto size = std::min(chunkSize, data.size() - writtenSize);
+
+            if (write(fd, data.data() + writtenSize, size) != static_cast<ssize_t>(size)) {
+                std::cerr << "Cannot write temporary file.\n";
+                ok = false;
+                break;
+            }
+
+            writtenSize += size;
+        }
+    }
+
+    close(fd);
+
+    if (ss.str() != expected) {
+        std::cerr << "Output differs (live).\n";
+        ok = false;
+    }
+
+    if (notAvailCount < data.size() / chunkSize || !factory.isComplete()) {
+        std::cerr << "Unexpected number of unavailable data reports.\n";
+        ok = false;
+    }
+
+    return ok;
+}
+
+int main()
+{
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadata,
+                                                              metadata + std::strlen(metadata));
+    auto& traceType = *traceTypeMsUuidPair.first;
+    const auto data = repeatedStream();
+
+    // start with an empty file
+    char path[] = "/tmp/yactfr-test-live-file-XXXXXX";
+    const auto fd = mkstemp(path);
+
+    if (fd < 0) {
+        std::cerr << "Cannot create temporary file.\n";
+        return 1;
+    }
+
+    close(fd);
+
+    MemDataSrcFactory memFactory {data.data(), data.size()};
+    const auto expected = decode(traceType, memFactory);
+    auto ret = 0;
+
+    if (!checkLive(traceType, path, data, expected)) {
+        ret = 1;
+    }
+
+    // complete file
+    yactfr::LiveFileDataSourceFactory smallFactory {path, 1};
+    yactfr::LiveFileDataSourceFactory defFactory {path};
+
+    if (smallFactory.fileSize() != data.size() || smallFactory.updateFileSize() != data.size() ||
+            smallFactory.isComplete()) {
+        std::cerr << "Unexpected factory properties.\n";
+        ret = 1;
+    }
+
+    smallFactory.markComplete();
+    defFactory.markComplete();
+
+    if (decode(traceType, smallFactory) != expected) {
+        std::cerr << "Output differs (small windows).\n";
+        ret = 1;
+    }
+
+    if (decode(traceType, defFactory) != expected) {
+        std::cerr << "Output differs (default).\n";
+        ret = 1;
+    }
+
+    if (!checkCopyAndRestore(traceType, smallFactory)) {
+        std::cerr << "Iterator copy/restore output differs.\n";
+        ret = 1;
+    }
+
+    unlink(path);
+
+    try {
+        yactfr::LiveFileDataSourceFactory {"/this/file/does/not/exist"};
+        std::cerr << "Expecting an I/O error.\n";
+        ret = 1;
+    } catch (const yactfr::IOError&) {
+    }
+
+    return ret;
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <yactfr/yactfr.hpp>
+
+#include <mem-data-src-factory.hpp>
+#include <elem-printer.hpp>
+#include <data-src-checks.hpp>
+
+// sizes of the chunks, cycled (many chunks are smaller than 9 bytes)
+static const std::vector<std::size_t> chunkSizes {0, 1, 2, 3, 5, 8, 0, 13, 100, 4093, 7, 1, 1};
+
+/*
+ * Checks the data blocks which a data source of `factory` returns
+ * directly.
+ */
+static bool checkDataBlocks(yactfr::MemoryDataSourceFactory& factory,
+                            const std::vector<std::uint8_t>& data,
+                            const std::vector<std::vector<std::uint8_t>>& chunkBufs)
+{
+    auto dataSrc = factory.createDataSource();
+    auto ok = true;
+
+    for (yactfr::Index offset = 0; offset < data.size(); offset += 7) {
+        for (yactfr::Size minSize = 1; minSize <= 9; ++minSize) {
+            const auto blk = dataSrc->data(offset, minSize);
+
+            if (offset + minSize > data.size()) {
+                if (blk) {
+                    std::cerr << "Expecting no data at offset " << offset << ".\n";
+                    ok = false;
+                }
+
+                continue;
+            }
+
+            if (!blk || blk->size() < minSize ||
+                    std::memcmp(blk->address(), &data[offset], minSize) != 0) {
+                std::cerr << "Unexpected data block at offset " << offset << ".\n";
+                ok = false;
+                continue;
+            }
+
+            // a data block which doesn't cross chunks is within a chunk
+            const auto addr = static_cast<const std::uint8_t *>(blk->address());
+            auto isInChunk = false;
+
+            for (const auto& chunkBuf : chunkBufs) {
+                if (!chunkBuf.empty() && addr >= chunkBuf.data() &&
+                        addr + blk->size() <= chunkBuf.data() + chunkBuf.size()) {
+                    isInChunk = true;
+                    break;
+                }
+            }
+
+            if (blk->size() > minSize && !isInChunk) {
+                std::cerr << "Data block at offset " << offset << " isn't zero-copy.\n";
+                ok = false;
+            }
+        }
+    }
+
+    return ok;
+}
+
+int main()
+{
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadata,
+                                                              metadata + std::strlen(metadata));
+    auto& traceType = *traceTypeMsUuidPair.first;
+    const auto data = repeatedStream();
+
+    // separately allocated chunks
+    std::vector<std::vector<std::uint8_t>> chunkBufs;
+    std::vector<yactfr::DataBlock> chunks;
+    std::size_t offset = 0;
+
+    while (offset < data.size()) {
+        const auto size = std::min(chunkSizes[chunkBufs.size() % chunkSizes.size()],
+                                   data.size() - offset);
+
+        chunkBufs.emplace_back(data.begin() + offset, data.begin() + offset + size);
+        offset += size;
+    }
+
+    for (const auto& chunkBuf : chunkBufs) {
+        chunks.emplace_back(chunkBuf.data(), chunkBuf.size());
+    }
+
+    MemDataSrcFactory refFactory {data.data(), data.size()};
+    const auto expected = decode(traceType, refFactory);
+    yactfr::MemoryDataSourceFactory spanFactory {data.data(), data.size()};
+    yactfr::MemoryDataSourceFactory chunksFactory {chunks};
+    auto ret = 0;
+
+    if (spanFactory.size() != data.size() || spanFactory.chunkCount() != 1 ||
+            chunksFactory.size() != data.size() || chunksFactory.chunkCount() != chunks.size()) {
+        std::cerr << "Unexpected factory properties.\n";
+        ret = 1;
+    }
+
+    if (decode(traceType, spanFactory) != expected) {
+        std::cerr << "Output differs (span).\n";
+        ret = 1;
+    }
+
+    if (decode(traceType, chunksFactory) != expected) {
+        std::cerr << "Output differs (chunks).\n";
+        ret = 1;
+    }
+
+    if (!checkCopyAndRestore(traceType, chunksFactory)) {
+        std::cerr << "Iterator copy/restore output differs.\n";
+        ret = 1;
+    }
+
+    if (!checkDataBlocks(chunksFactory, data, chunkBufs)) {
+        ret = 1;
+    }
+
+    // no data at all
+    yactfr::MemoryDataSourceFactory emptyFactory {std::vector<yactfr::DataBlock> {
+        yactfr::DataBlock {data.data(), 0}
+    }};
+    yactfr::ElementSequence emptySeq {traceType, emptyFactory};
+
+    if (emptyFactory.size() != 0 || emptySeq.begin() != emptySeq.end()) {
+        std::cerr << "Expecting no elements.\n";
+        ret = 1;
+    }
+
+    return ret;
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <unistd.h>
+
+#include <yactfr/yactfr.hpp>
+
+#include <mem-data-src-factory.hpp>
+#include <elem-printer.hpp>
+#include <data-src-checks.hpp>
+
+int main()
+{
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadata,
+                                                              metadata + std::strlen(metadata));
+    auto& traceType = *traceTypeMsUuidPair.first;
+    const auto data = repeatedStream();
+
+    char path[] = "/tmp/yactfr-test-mmap-file-XXXXXX";
+    const auto fd = mkstemp(path);
+
+    if (fd < 0 || write(fd, data.data(), data.size()) != static_cast<ssize_t>(data.size())) {
+        std::cerr << "Cannot create temporary file.\n";
+        return 1;
+    }
+
+    close(fd);
+
+    const auto pageSize = static_cast<yactfr::Size>(sysconf(_SC_PAGE_SIZE));
+    MemDataSrcFactory memFactory {data.data(), data.size()};
+    yactfr::MemoryMappedFileViewFactory noCacheFactory {
+        path, 4096, yactfr::MemoryMappedFileViewFactory::AccessPattern::NORMAL, 0
+    };
+    yactfr::MemoryMappedFileViewFactory smallCacheFactory {
+        path, 4096, yactfr::MemoryMappedFileViewFactory::AccessPattern::SEQUENTIAL, 3 * pageSize
+    };
+    yactfr::MemoryMappedFileViewFactory bigCacheFactory {
+        path, 4096, yactfr::MemoryMappedFileViewFactory::AccessPattern::RANDOM, data.size() * 2
+    };
+    yactfr::MemoryMappedFileViewFactory adaptiveFactory {
+        path, 4096, yactfr::MemoryMappedFileViewFactory::AccessPattern::ADAPTIVE
+    };
+    yactfr::MemoryMappedFileViewFactory defFactory {path};
+    const auto expected = decode(traceType, memFactory);
+    auto ret = 0;
+
+    if (defFactory.maximumCachedMmapSize() != (512ULL << 20) * 4 ||
+            smallCacheFactory.maximumCachedMmapSize() != 3 * pageSize) {
+        std::cerr << "Unexpected maximum cached memory map size.\n";
+        ret = 1;
+    }
+
+    if (decode(traceType, noCacheFactory) != expected) {
+        std::cerr << "Output differs (no cache).\n";
+        ret = 1;
+    }
+
+    if (decode(traceType, smallCacheFactory) != expected) {
+        std::cerr << "Output differs (small cache).\n";
+        ret = 1;
+    }
+
+    if (decode(traceType, bigCacheFactory) != expected) {
+        std::cerr << "Output differs (big cache).\n";
+        ret = 1;
+    }
+
+    if (decode(traceType, defFactory) != expected) {
+        std::cerr << "Output differs (default).\n";
+        ret = 1;
+    }
+
+    if (decode(traceType, adaptiveFactory) != expected) {
+        std::cerr << "Output differs (adaptive).\n";
+        ret = 1;
+    }
+
+    if (noCacheFactory.counters().mmapCount == 0 ||
+            noCacheFactory.counters().mmapCount != noCacheFactory.counters().munmapCount) {
+        std::cerr << "Unexpected memory map counts (no cache).\n";
+        ret = 1;
+    }
+
+    // decode again with the cached regions
+    const auto bigCacheMmapCount = bigCacheFactory.counters().mmapCount;
+
+    if (decode(traceType, bigCacheFactory) != expected) {
+        std::cerr << "Output differs (big cache, second pass).\n";
+        ret = 1;
+    }
+
+    if (bigCacheFactory.counters().mmapCount != bigCacheMmapCount ||
+            bigCacheFactory.counters().munmapCount != 0 ||
+            bigCacheFactory.counters().cachedRegionHitCount == 0) {
+        std::cerr << "Unexpected memory map counts (big cache, second pass).\n";
+        ret = 1;
+    }
+
+    if (adaptiveFactory.counters().sequentialSwitchCount == 0 ||
+            adaptiveFactory.counters().readAheadSize == 0 ||
+            adaptiveFactory.counters().randomSwitchCount != 0) {
+        std::cerr << "Unexpected adaptive counters (sequential scan).\n";
+        ret = 1;
+    }
+
+    if (!checkCopyAndRestore(traceType, noCacheFactory) ||
+            !checkCopyAndRestore(traceType, smallCacheFactory) ||
+            !checkCopyAndRestore(traceType, bigCacheFactory) ||
+            !checkCopyAndRestore(traceType, adaptiveFactory)) {
+        std::cerr << "Iterator copy/restore output differs.\n";
+        ret = 1;
+    }
+
+    // restoring the position jumps backward
+    if (adaptiveFactory.counters().randomSwitchCount == 0) {
+        std::cerr << "Unexpected adaptive counters (seek).\n";
+        ret = 1;
+    }
+
+    unlink(path);
+
+    try {
+        yactfr::MemoryMappedFileViewFactory {"/this/file/does/not/exist"};
+        std::cerr << "Expecting an I/O error.\n";
+        ret = 1;
+    } catch (const yactfr::IOError&) {
+    }
+
+    return ret;
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <unistd.h>
+
+#include <yactfr/yactfr.hpp>
+
+#include <mem-data-src-factory.hpp>
+#include <elem-printer.hpp>
+#include <data-src-checks.hpp>
+
+static bool writeFile(const std::string& path, const std::uint8_t * const begin,
+                      const std::uint8_t * const end)
+{
+    std::ofstream file {path, std::ios::binary};
+
+    file.write(reinterpret_cast<const char *>(begin), end - begin);
+    return static_cast<bool>(file);
+}
+
+int main()
+{
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadata,
+                                                              metadata + std::strlen(metadata));
+    auto& traceType = *traceTypeMsUuidPair.first;
+    const auto data = repeatedStream();
+
+    char dirPath[] = "/tmp/yactfr-test-multi-file-XXXXXX";
+
+    if (!mkdtemp(dirPath)) {
+        std::cerr << "Cannot create temporary directory.\n";
+        return 1;
+    }
+
+    /*
+     * Split the data into files of various sizes, including empty
+     * files and files which are smaller than a VM request.
+     */
+    std::vector<std::string> paths;
+    std::size_t offset = 0;
+    auto ret = 0;
+
+    for (std::size_t i = 0; offset < data.size(); ++i) {
+        const auto size = std::min(data.size() - offset, (i * 997) % 1500);
+
+        paths.push_back(std::string {dirPath} + "/stream" + std::to_string(i));
+
+        if (!writeFile(paths.back(), data.data() + offset, data.data() + offset + size)) {
+            std::cerr << "Cannot write temporary file.\n";
+            return 1;
+        }
+
+        offset += size;
+    }
+
+    MemDataSrcFactory memFactory {data.data(), data.size()};
+    yactfr::MultiFileDataSourceFactory oneFileFactory {paths, 1, 1};
+    yactfr::MultiFileDataSourceFactory defFactory {paths};
+    const auto expected = decode(traceType, memFactory);
+
+    if (oneFileFactory.maximumOpenFileCount() != 1 || defFactory.paths() != paths) {
+        std::cerr << "Unexpected factory properties.\n";
+        ret = 1;
+    }
+
+    if (decode(traceType, oneFileFactory) != expected) {
+        std::cerr << "Output differs (one open file, page-sized blocks).\n";
+        ret = 1;
+    }
+
+    if (decode(traceType, defFactory) != expected) {
+        std::cerr << "Output differs (default).\n";
+        ret = 1;
+    }
+
+    if (!checkCopyAndRestore(traceType, oneFileFactory)) {
+        std::cerr << "Iterator copy/restore output differs.\n";
+        ret = 1;
+    }
+
+    // file 0 is empty and file 1 contains 997 bytes
+    const auto loc = defFactory.location(1000);
+
+    if (defFactory.fileOffset(0) != 0 || defFactory.fileOffset(2) != 997 || !loc ||
+            loc->fileIndex != 2 || loc->offset != 3 || defFactory.location(data.size())) {
+        std::cerr << "Unexpected location.\n";
+        ret = 1;
+    }
+
+    for (const auto& path : paths) {
+        unlink(path.c_str());
+    }
+
+    rmdir(dirPath);
+
+    // opening files is lazy: no error until reading
+    yactfr::MultiFileDataSourceFactory badFactory {{"/this/file/does/not/exist"}};
+
+    try {
+        decode(traceType, badFactory);
+        std::cerr << "Expecting an I/O error.\n";
+        ret = 1;
+    } catch (const yactfr::IOError&) {
+    }
+
+    return ret;
+}
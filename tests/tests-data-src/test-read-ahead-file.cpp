@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <iostream>
+#include <vector>
+#include <unistd.h>
+
+#include <yactfr/yactfr.hpp>
+
+#include <mem-data-src-factory.hpp>
+#include <elem-printer.hpp>
+#include <data-src-checks.hpp>
+
+using Backend = yactfr::ReadAheadFileDataSourceFactory::Backend;
+
+/*
+ * Calls `func` until it doesn't throw `yactfr::DataNotAvailable`,
+ * returning the number of retries.
+ */
+template <typename FuncT>
+static unsigned long long retry(FuncT&& func)
+{
+    unsigned long long count = 0;
+
+    while (true) {
+        try {
+            func();
+            return count;
+        } catch (const yactfr::DataNotAvailable&) {
+            ++count;
+        }
+    }
+}
+
+/*
+ * Like decode(), but retries when a non-blocking data source reports
+ * that data isn't available.
+ */
+static std::string decodeRetrying(const yactfr::TraceType& traceType,
+                                  yactfr::DataSourceFactory& factory)
+{
+    yactfr::ElementSequence seq {traceType, factory};
+    std::ostringstream ss;
+    ElemPrinter printer {ss, 0};
+    yactfr::ElementSequenceIterator it {seq.end()};
+
+    retry([&seq, &it] {
+        it = seq.begin();
+    });
+
+    while (it != seq.end()) {
+        printElem(ss, printer, *it);
+        retry([&it] {
+            ++it;
+        });
+    }
+
+    return ss.str();
+}
+
+static int check(const yactfr::TraceType& traceType, const char * const path,
+                 const std::string& expected, const Backend backend)
+{
+    const auto backendName = backend == Backend::IO_URING ? "io_uring" : "thread";
+    yactfr::ReadAheadFileDataSourceFactory smallFactory {path, 1, 1, false, backend};
+    yactfr::ReadAheadFileDataSourceFactory deepFactory {path, 1, 16, false, backend};
+    yactfr::ReadAheadFileDataSourceFactory defFactory {path, boost::none, boost::none, false,
+                                                       backend};
+    yactfr::ReadAheadFileDataSourceFactory nonBlockingFactory {path, 1, 4, true, backend};
+    auto ret = 0;
+
+    if (smallFactory.maximumReadAheadDepth() != 1 || !nonBlockingFactory.isNonBlocking() ||
+            deepFactory.isNonBlocking()) {
+        std::cerr << "Unexpected factory properties (" << backendName << ").\n";
+        ret = 1;
+    }
+
+    if (decodeRetrying(traceType, smallFactory) != expected) {
+        std::cerr << "Output differs (" << backendName << ", depth 1).\n";
+        ret = 1;
+    }
+
+    if (decodeRetrying(traceType, deepFactory) != expected) {
+        std::cerr << "Output differs (" << backendName << ", depth 16).\n";
+        ret = 1;
+    }
+
+    if (decodeRetrying(traceType, defFactory) != expected) {
+        std::cerr << "Output differs (" << backendName << ", default).\n";
+        ret = 1;
+    }
+
+    if (decodeRetrying(traceType, nonBlockingFactory) != expected) {
+        std::cerr << "Output differs (" << backendName << ", non-blocking).\n";
+        ret = 1;
+    }
+
+    if (!checkCopyAndRestore(traceType, deepFactory)) {
+        std::cerr << "Iterator copy/restore output differs (" << backendName << ").\n";
+        ret = 1;
+    }
+
+    return ret;
+}
+
+int main()
+{
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadata,
+                                                              metadata + std::strlen(metadata));
+    auto& traceType = *traceTypeMsUuidPair.first;
+    const auto data = repeatedStream();
+
+    char path[] = "/tmp/yactfr-test-read-ahead-file-XXXXXX";
+    const auto fd = mkstemp(path);
+
+    if (fd < 0 || write(fd, data.data(), data.size()) != static_cast<ssize_t>(data.size())) {
+        std::cerr << "Cannot create temporary file.\n";
+        return 1;
+    }
+
+    close(fd);
+
+    MemDataSrcFactory memFactory {data.data(), data.size()};
+    const auto expected = decode(traceType, memFactory);
+    auto ret = 0;
+
+    if (yactfr::ReadAheadFileDataSourceFactory {path, boost::none, boost::none, false,
+                                                Backend::THREAD}.backend() != Backend::THREAD) {
+        std::cerr << "Unexpected backend.\n";
+        ret = 1;
+    }
+
+    // falls back to the thread backend if io_uring isn't available
+    ret |= check(traceType, path, expected, Backend::IO_URING);
+    ret |= check(traceType, path, expected, Backend::THREAD);
+    unlink(path);
+
+    try {
+        yactfr::ReadAheadFileDataSourceFactory {"/this/file/does/not/exist"};
+        std::cerr << "Expecting an I/O error.\n";
+        ret = 1;
+    } catch (const yactfr::IOError&) {
+    }
+
+    return ret;
+}
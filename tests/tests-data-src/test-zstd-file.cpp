@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <string>
+#include <unistd.h>
+
+#include <yactfr/yactfr.hpp>
+
+#include <mem-data-src-factory.hpp>
+#include <elem-printer.hpp>
+#include <data-src-checks.hpp>
+
+static void appendLe32(std::vector<std::uint8_t>& buf, const std::uint32_t val)
+{
+    for (auto i = 0U; i < 4; ++i) {
+        buf.push_back(static_cast<std::uint8_t>(val >> (i * 8)));
+    }
+}
+
+/*
+ * Appends a zstd frame which contains `size` bytes of `data` within
+ * raw (uncompressed) blocks to `buf`, returning the size of the frame.
+ *
+ * This makes it possible to create zstd-seekable files without libzstd.
+ */
+static std::uint32_t appendRawFrame(std::vector<std::uint8_t>& buf,
+                                    const std::uint8_t * const data, const std::size_t size)
+{
+    const auto initSize = buf.size();
+
+    // magic number
+    appendLe32(buf, 0xfd2fb528);
+
+    // descriptor: 4-byte content size, single segment
+    buf.push_back(0xa0);
+    appendLe32(buf, static_cast<std::uint32_t>(size));
+
+    std::size_t offset = 0;
+
+    do {
+        const auto blkSize = std::min(size - offset, static_cast<std::size_t>(1000));
+        const auto isLast = offset + blkSize == size;
+        const auto blkHeader = static_cast<std::uint32_t>((blkSize << 3) | (isLast ? 1 : 0));
+
+        buf.push_back(static_cast<std::uint8_t>(blkHeader));
+        buf.push_back(static_cast<std::uint8_t>(blkHeader >> 8));
+        buf.push_back(static_cast<std::uint8_t>(blkHeader >> 16));
+        buf.insert(buf.end(), data + offset, data + offset + blkSize);
+        offset += blkSize;
+    } while (offset < size);
+
+    return static_cast<std::uint32_t>(buf.size() - initSize);
+}
+
+/*
+ * Creates a zstd-seekable file of which the frames contain `data`,
+ * including empty frames and frames which are smaller than a VM
+ * request.
+ */
+static bool writeSeekableFile(const std::string& path, const std::vector<std::uint8_t>& data,
+                              std::size_t& frameCount)
+{
+    std::vector<std::uint8_t> buf;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> entries;
+    std::size_t offset = 0;
+
+    for (std::size_t i = 0; offset < data.size(); ++i) {
+        const auto size = std::min(data.size() - offset, (i * 997) % 3000);
+
+        entries.emplace_back(appendRawFrame(buf, data.data() + offset, size), size);
+        offset += size;
+    }
+
+    frameCount = entries.size();
+
+    // seek table within a skippable frame
+    appendLe32(buf, 0x184d2a5e);
+    appendLe32(buf, static_cast<std::uint32_t>(entries.size() * 8 + 9));
+
+    for (const auto& entry : entries) {
+        appendLe32(buf, entry.first);
+        appendLe32(buf, entry.second);
+    }
+
+    appendLe32(buf, static_cast<std::uint32_t>(entries.size()));
+    buf.push_back(0);
+    appendLe32(buf, 0x8f92eab1);
+
+    std::ofstream file {path, std::ios::binary};
+
+    file.write(reinterpret_cast<const char *>(buf.data()), buf.size());
+    return static_cast<bool>(file);
+}
+
+int main()
+{
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadata,
+                                                              metadata + std::strlen(metadata));
+    auto& traceType = *traceTypeMsUuidPair.first;
+    const auto data = repeatedStream();
+
+    char path[] = "/tmp/yactfr-test-zstd-file-XXXXXX";
+    const auto fd = mkstemp(path);
+    std::size_t frameCount;
+
+    if (fd < 0 || !writeSeekableFile(path, data, frameCount)) {
+        std::cerr << "Cannot create temporary file.\n";
+        return 1;
+    }
+
+    close(fd);
+
+    auto ret = 0;
+
+    if (!yactfr::ZstdSeekableFileDataSourceFactory::isSupported()) {
+        // library built without libzstd
+        try {
+            yactfr::ZstdSeekableFileDataSourceFactory {path};
+            std::cerr << "Expecting an I/O error (unsupported).\n";
+            ret = 1;
+        } catch (const yactfr::IOError&) {
+        }
+
+        unlink(path);
+        return ret;
+    }
+
+    MemDataSrcFactory memFactory {data.data(), data.size()};
+    yactfr::ZstdSeekableFileDataSourceFactory oneFrameFactory {path, 1};
+    yactfr::ZstdSeekableFileDataSourceFactory defFactory {path};
+    const auto expected = decode(traceType, memFactory);
+
+    if (defFactory.frameCount() != frameCount || defFactory.decompressedSize() != data.size() ||
+            oneFrameFactory.maximumCachedFrameCount() != 1) {
+        std::cerr << "Unexpected factory properties.\n";
+        ret = 1;
+    }
+
+    if (decode(traceType, oneFrameFactory) != expected) {
+        std::cerr << "Output differs (one cached frame).\n";
+        ret = 1;
+    }
+
+    if (decode(traceType, defFactory) != expected) {
+        std::cerr << "Output differs (default).\n";
+        ret = 1;
+    }
+
+    if (!checkCopyAndRestore(traceType, oneFrameFactory) ||
+            !checkCopyAndRestore(traceType, defFactory)) {
+        std::cerr << "Iterator copy/restore output differs.\n";
+        ret = 1;
+    }
+
+    // not a zstd-seekable file
+    {
+        std::ofstream file {path, std::ios::binary};
+
+        file.write(reinterpret_cast<const char *>(data.data()), data.size());
+    }
+
+    try {
+        yactfr::ZstdSeekableFileDataSourceFactory {path};
+        std::cerr << "Expecting an I/O error (invalid seek table).\n";
+        ret = 1;
+    } catch (const yactfr::IOError&) {
+    }
+
+    unlink(path);
+
+    try {
+        yactfr::ZstdSeekableFileDataSourceFactory {"/this/file/does/not/exist"};
+        std::cerr << "Expecting an I/O error.\n";
+        ret = 1;
+    } catch (const yactfr::IOError&) {
+    }
+
+    return ret;
+}
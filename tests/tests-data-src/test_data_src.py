@@ -0,0 +1,39 @@
+import pytest
+import functools
+
+
+@pytest.fixture
+def data_src_executor(executor):
+    return functools.partial(executor, 'data-src')
+
+
+def test_buf_file(data_src_executor):
+    data_src_executor('buf-file')
+
+
+def test_fd(data_src_executor):
+    data_src_executor('fd')
+
+
+def test_live_file(data_src_executor):
+    data_src_executor('live-file')
+
+
+def test_mem(data_src_executor):
+    data_src_executor('mem')
+
+
+def test_mmap_file(data_src_executor):
+    data_src_executor('mmap-file')
+
+
+def test_multi_file(data_src_executor):
+    data_src_executor('multi-file')
+
+
+def test_read_ahead_file(data_src_executor):
+    data_src_executor('read-ahead-file')
+
+
+def test_zstd_file(data_src_executor):
+    data_src_executor('zstd-file')
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstring>
+#include <sstream>
+#include <iostream>
+
+#include <yactfr/yactfr.hpp>
+
+#include <mem-data-src-factory.hpp>
+
+static const auto metadata =
+    "/* CTF 1.8 */\n"
+    "typealias integer { size = 8; } := u8;"
+    "typealias integer { size = 16; } := u16;"
+    "trace {"
+    "  major = 1;"
+    "  minor = 8;"
+    "  byte_order = be;"
+    "};"
+    "clock {"
+    "  name = clk;"
+    "  freq = 1000;"
+    "  offset_s = 10;"
+    "};"
+    "typealias integer { size = 8; map = clock.clk.value; } := ts8;"
+    "stream {"
+    "  packet.context := struct {"
+    "    u16 packet_size;"
+    "    u16 content_size;"
+    "    ts8 timestamp_begin;"
+    "    ts8 timestamp_end;"
+    "  };"
+    "  event.header := struct {"
+    "    u8 id;"
+    "    ts8 timestamp;"
+    "  };"
+    "};"
+    "event {"
+    "  id = 0;"
+    "  fields := struct {"
+    "    u8 x;"
+    "  };"
+    "};";
+
+static const std::uint8_t stream[] = {
+    // packet context
+    0x00, 0x80, 0x00, 0x78, 0x10, 0x30,
+
+    // event records
+    0x00, 0x10, 0x01,
+    0x00, 0x20, 0x02,
+    0x00, 0x30, 0x03,
+
+    // padding
+    0x00,
+
+    // packet context
+    0x00, 0x80, 0x00, 0x78, 0x40, 0x60,
+
+    // event records
+    0x00, 0x40, 0x04,
+    0x00, 0x50, 0x05,
+    0x00, 0x60, 0x06,
+
+    // padding
+    0x00,
+
+    // packet context
+    0x00, 0x60, 0x00, 0x60, 0x70, 0x80,
+
+    // event records
+    0x00, 0x70, 0x07,
+    0x00, 0x80, 0x08,
+};
+
+static const auto expected =
+    "0: 1 2 3 4 5 6 7 8\n"
+    "16: 1 2 3 4 5 6 7 8\n"
+    "17: 2 3 4 5 6 7 8\n"
+    "48: 3 4 5 6 7 8\n"
+    "49: 4 5 6 7 8\n"
+    "85: 6 7 8\n"
+    "112: 7 8\n"
+    "128: 8\n"
+    "129: end\n"
+    "ns 9000000000: 1 2 3 4 5 6 7 8\n"
+    "ns 10048500000: 4 5 6 7 8\n"
+    "ns 10113000000: 8\n"
+    "ns 10200000000: end\n";
+
+/*
+ * Prints the payloads of the remaining event records from `it`, which
+ * must be at an event record beginning element.
+ */
+static void printRest(std::ostream& os, yactfr::ElementSequence& seq,
+                      yactfr::ElementSequenceIterator it)
+{
+    if (it == seq.end()) {
+        os << " end\n";
+        return;
+    }
+
+    if (it->kind() != yactfr::Element::Kind::EVENT_RECORD_BEGINNING) {
+        os << " not at an event record beginning\n";
+        return;
+    }
+
+    for (; it != seq.end(); ++it) {
+        if (it->isFixedLengthUnsignedIntegerElement()) {
+            auto& intElem = it->asFixedLengthUnsignedIntegerElement();
+
+            if (intElem.structureMemberType()->name() == "x") {
+                os << ' ' << intElem.value();
+            }
+        }
+    }
+
+    os << '\n';
+}
+
+int main()
+{
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadata,
+                                                              metadata + std::strlen(metadata));
+    MemDataSrcFactory factory {stream, sizeof stream, 3};
+    yactfr::ElementSequence seq {*traceTypeMsUuidPair.first, factory};
+    const yactfr::PacketIndex pktIndex {*traceTypeMsUuidPair.first, factory};
+    std::ostringstream ss;
+
+    for (const yactfr::Cycles cycles : {0, 16, 17, 48, 49, 85, 112, 128, 129}) {
+        ss << cycles << ':';
+        printRest(ss, seq, seq.atTimestamp(cycles));
+
+        // same result with an explicit packet index
+        std::ostringstream idxSs;
+
+        printRest(idxSs, seq, seq.atTimestamp(pktIndex, cycles));
+
+        if (ss.str().substr(ss.str().rfind(':') + 1) != idxSs.str()) {
+            std::cerr << "Unexpected result with an explicit packet index for " <<
+                         cycles << ".\n";
+            return 1;
+        }
+    }
+
+    for (const long long ns : {9000000000LL, 10048500000LL, 10113000000LL, 10200000000LL}) {
+        ss << "ns " << ns << ':';
+        printRest(ss, seq, seq.atNanosecondsFromOrigin(ns));
+    }
+
+    if (ss.str() == expected) {
+        return 0;
+    }
+
+    std::cerr << "Expected:\n\n" << expected << "\n" <<
+                 "Got:\n\n" << ss.str();
+    return 1;
+}
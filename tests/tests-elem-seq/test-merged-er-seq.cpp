@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstring>
+#include <sstream>
+#include <iostream>
+#include <vector>
+
+#include <yactfr/yactfr.hpp>
+
+#include <mem-data-src-factory.hpp>
+
+static const auto metadata =
+    "/* CTF 1.8 */\n"
+    "typealias integer { size = 8; } := u8;"
+    "typealias integer { size = 16; } := u16;"
+    "trace {"
+    "  major = 1;"
+    "  minor = 8;"
+    "  byte_order = be;"
+    "};"
+    "clock {"
+    "  name = clk;"
+    "  freq = 1000;"
+    "};"
+    "typealias integer { size = 8; map = clock.clk.value; } := ts8;"
+    "stream {"
+    "  packet.context := struct {"
+    "    u16 packet_size;"
+    "    u16 content_size;"
+    "    ts8 timestamp_begin;"
+    "    ts8 timestamp_end;"
+    "  };"
+    "  event.header := struct {"
+    "    u8 id;"
+    "    ts8 timestamp;"
+    "  };"
+    "};"
+    "event {"
+    "  id = 0;"
+    "  fields := struct {"
+    "    u8 x;"
+    "  };"
+    "};";
+
+static const std::uint8_t streamA[] = {
+    0x00, 0x80, 0x00, 0x78, 0x10, 0x50,
+    0x00, 0x10, 1,
+    0x00, 0x30, 3,
+    0x00, 0x50, 5,
+    0x00,
+};
+
+static const std::uint8_t streamB[] = {
+    0x00, 0x80, 0x00, 0x78, 0x10, 0x60,
+    0x00, 0x10, 11,
+    0x00, 0x20, 12,
+    0x00, 0x60, 16,
+    0x00,
+};
+
+static const std::uint8_t streamD[] = {
+    0x00, 0x48, 0x00, 0x48, 0x05, 0x05,
+    0x00, 0x05, 21,
+
+    0x00, 0x60, 0x00, 0x60, 0x30, 0x70,
+    0x00, 0x30, 23,
+    0x00, 0x70, 27,
+};
+
+/*
+ * Ties: A (index 0) before B (index 1) at 16, and A before D
+ * (index 3) at 48. C (index 2) is empty.
+ */
+static const auto expected =
+    "3 5 21\n"
+    "0 16 1\n"
+    "1 16 11\n"
+    "1 32 -\n"
+    "0 48 3\n"
+    "3 48 23\n"
+    "0 80 5\n"
+    "1 96 16\n"
+    "3 112 27\n";
+
+int main()
+{
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadata,
+                                                              metadata + std::strlen(metadata));
+    auto& traceType = *traceTypeMsUuidPair.first;
+    MemDataSrcFactory factoryA {streamA, sizeof streamA, 4};
+    MemDataSrcFactory factoryB {streamB, sizeof streamB};
+    MemDataSrcFactory factoryC {nullptr, 0};
+    MemDataSrcFactory factoryD {streamD, sizeof streamD, 5};
+    yactfr::ElementSequence seqA {traceType, factoryA};
+    yactfr::ElementSequence seqB {traceType, factoryB};
+    yactfr::ElementSequence seqC {traceType, factoryC};
+    yactfr::ElementSequence seqD {traceType, factoryD};
+    yactfr::MergedEventRecordSequence mergedSeq {{&seqA, &seqB, &seqC, &seqD}};
+    std::ostringstream ss;
+
+    if (mergedSeq.elementSequenceCount() != 4) {
+        std::cerr << "Unexpected element sequence count.\n";
+        return 1;
+    }
+
+    while (mergedSeq.next()) {
+        auto& it = mergedSeq.iterator();
+
+        if (it->kind() != yactfr::Element::Kind::EVENT_RECORD_BEGINNING) {
+            std::cerr << "Not at an event record beginning.\n";
+            return 1;
+        }
+
+        ss << mergedSeq.elementSequenceIndex() << ' ' << mergedSeq.defaultClockValue() << ' ';
+
+        if (mergedSeq.defaultClockValue() == 32) {
+            // leave the iterator at the event record beginning
+            ss << "-\n";
+            continue;
+        }
+
+        // read the payload
+        while (!it->isFixedLengthUnsignedIntegerElement() ||
+                it->asFixedLengthUnsignedIntegerElement().structureMemberType()->name() != "x") {
+            ++it;
+        }
+
+        const auto x = it->asFixedLengthUnsignedIntegerElement().value();
+
+        ss << x << '\n';
+
+        if (x % 2 == 1) {
+            // go to the event record end
+            while (it->kind() != yactfr::Element::Kind::EVENT_RECORD_END) {
+                ++it;
+            }
+        }
+    }
+
+    if (mergedSeq.next()) {
+        std::cerr << "Unexpected event record after the end.\n";
+        return 1;
+    }
+
+    if (ss.str() == expected) {
+        return 0;
+    }
+
+    std::cerr << "Expected:\n\n" << expected << "\n" <<
+                 "Got:\n\n" << ss.str();
+    return 1;
+}
@@ -11,9 +11,17 @@ def test_at(elem_seq_executor):
     elem_seq_executor('at')
 
 
+def test_at_timestamp(elem_seq_executor):
+    elem_seq_executor('at-timestamp')
+
+
 def test_begin(elem_seq_executor):
     elem_seq_executor('begin')
 
 
 def test_end(elem_seq_executor):
     elem_seq_executor('end')
+
+
+def test_merged_er_seq(elem_seq_executor):
+    elem_seq_executor('merged-er-seq')
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstring>
+#include <sstream>
+#include <iostream>
+
+#include <yactfr/yactfr.hpp>
+
+#include <mem-data-src-factory.hpp>
+#include <elem-printer.hpp>
+
+static const auto metadata =
+    "/* CTF 1.8 */\n"
+    "typealias integer { size = 8; } := u8;"
+    "typealias integer { size = 16; align = 16; byte_order = le; } := u16le;"
+    "typealias integer { size = 32; align = 32; } := u32;"
+    "typealias integer { size = 8; align = 32; } := u8a32;"
+    "typealias floating_point {"
+    "  exp_dig = 8;"
+    "  mant_dig = 24;"
+    "  align = 32;"
+    "} := flt;"
+    "trace {"
+    "  major = 1;"
+    "  minor = 8;"
+    "  byte_order = be;"
+    "};"
+    "event {"
+    "  fields := struct {"
+    "    u8 len;"
+    "    u16le a[3];"
+    "    u32 b[len];"
+    "    flt c[2];"
+    "    u8a32 d[2];"
+    "    u8 e[0];"
+    "    struct { u8 x; u8 y; } f[2];"
+    "  };"
+    "};";
+
+static const std::uint8_t stream[] = {
+    // `len` and padding
+    0x02, 0xff,
+
+    // `a`
+    0x01, 0x00, 0x02, 0x00, 0x03, 0x00,
+
+    // `b`
+    0x00, 0x00, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x0b,
+
+    // `c`
+    0x3f, 0x80, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00,
+
+    // `d`
+    0x11, 0xff, 0xff, 0xff, 0x22,
+
+    // `f`
+    0x33, 0x44, 0x55, 0x66,
+};
+
+static const auto expected =
+    "P {\n"
+    "PC {\n"
+    "DSI:T0\n"
+    "PI\n"
+    "ER {\n"
+    "ERI:T0\n"
+    "SC:5 {\n"
+    "ST {\n"
+    "FLUI:len:2\n"
+    "SLA:a {\n"
+    "AS:1:0100\n"
+    "AS:2:02000300\n"
+    "}\n"
+    "DLA:b {\n"
+    "AS:1:0000000a\n"
+    "AS:1:0000000b\n"
+    "}\n"
+    "SLA:c {\n"
+    "AS:1:3f800000\n"
+    "AS:1:40000000\n"
+    "}\n"
+    "SLA:d {\n"
+    "FLUI:17\n"
+    "FLUI:34\n"
+    "}\n"
+    "SLA:e {\n"
+    "}\n"
+    "SLA:f {\n"
+    "ST {\n"
+    "FLUI:x:51\n"
+    "FLUI:y:68\n"
+    "}\n"
+    "ST {\n"
+    "FLUI:x:85\n"
+    "FLUI:y:102\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "}\n";
+
+int main()
+{
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadata,
+                                                              metadata + std::strlen(metadata));
+    MemDataSrcFactory factory {stream, sizeof stream, 5};
+    yactfr::ElementSequenceOptions opts;
+
+    opts.arraySectionsEnabled(true);
+
+    yactfr::ElementSequence seq {*traceTypeMsUuidPair.first, factory, opts};
+    std::ostringstream ss;
+    ElemPrinter printer {ss, 0};
+
+    for (auto& elem : seq) {
+        elem.accept(printer);
+    }
+
+    if (ss.str() == expected) {
+        return 0;
+    }
+
+    std::cerr << "Expected:\n\n" << expected << "\n" <<
+                 "Got:\n\n" << ss.str();
+    return 1;
+}
@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstring>
+#include <sstream>
+#include <iostream>
+
+#include <yactfr/yactfr.hpp>
+
+#include <mem-data-src-factory.hpp>
+
+static const auto metadata =
+    "/* CTF 1.8 */\n"
+    "typealias integer { size = 8; } := u8;"
+    "typealias integer { size = 8; signed = true; } := s8;"
+    "typealias integer { size = 16; } := u16;"
+    "trace {"
+    "  major = 1;"
+    "  minor = 8;"
+    "  byte_order = be;"
+    "};"
+    "clock {"
+    "  name = clk;"
+    "  freq = 1000;"
+    "};"
+    "typealias integer { size = 8; map = clock.clk.value; } := ts8;"
+    "stream {"
+    "  event.header := struct {"
+    "    u8 id;"
+    "    ts8 ts;"
+    "  };"
+    "};"
+    "event {"
+    "  id = 0;"
+    "  name = zero;"
+    "  fields := struct {"
+    "    u8 len;"
+    "    string str;"
+    "    u16 arr[len];"
+    "    s8 b;"
+    "  };"
+    "};"
+    "event {"
+    "  id = 1;"
+    "  name = one;"
+    "};";
+
+static const std::uint8_t stream[] = {
+    0x00, 0x10, 0x02, 'a', 'b', 'c', 0, 0x00, 0x05, 0x00, 0x06, 0x07,
+    0x01, 0x20,
+    0x00, 0x05, 0x01, 'd', 'e', 0, 0x00, 0x15, 0xf6,
+};
+
+static const auto expected =
+    "-- batch\n"
+    "0:ER\n"
+    "0:FLUI:0\n"
+    "8:FLUI:16\n"
+    "16:DCV:16\n"
+    "-- batch\n"
+    "16:ERI:0\n"
+    "16:FLUI:2\n"
+    "24:SS:abc\n"
+    "48:SS:\n"
+    "-- batch\n"
+    "56:DLA:2\n"
+    "56:FLUI:5\n"
+    "72:FLUI:6\n"
+    "88:FLSI:7\n"
+    "-- batch\n"
+    "96:ER\n"
+    "96:FLUI:1\n"
+    "104:FLUI:32\n"
+    "112:DCV:32\n"
+    "-- batch\n"
+    "112:ERI:1\n"
+    "112:ER\n"
+    "112:FLUI:0\n"
+    "120:FLUI:5\n"
+    "-- batch\n"
+    "128:DCV:261\n"
+    "128:ERI:0\n"
+    "128:FLUI:1\n"
+    "136:SS:d\n"
+    "-- batch\n"
+    "144:SS:e\n"
+    "160:DLA:1\n"
+    "160:FLUI:21\n"
+    "176:FLSI:-10\n";
+
+static void printRecord(std::ostream& os, const yactfr::ElementBatch::Record& record)
+{
+    os << record.offset << ':';
+
+    switch (record.kind) {
+    case yactfr::Element::Kind::EVENT_RECORD_BEGINNING:
+        os << "ER";
+        break;
+
+    case yactfr::Element::Kind::DEFAULT_CLOCK_VALUE:
+        os << "DCV:" << record.unsignedIntegerValue;
+        break;
+
+    case yactfr::Element::Kind::EVENT_RECORD_INFO:
+        os << "ERI:" << record.unsignedIntegerValue;
+        break;
+
+    case yactfr::Element::Kind::FIXED_LENGTH_UNSIGNED_INTEGER:
+        os << "FLUI:" << record.unsignedIntegerValue;
+        break;
+
+    case yactfr::Element::Kind::FIXED_LENGTH_SIGNED_INTEGER:
+        os << "FLSI:" << record.signedIntegerValue;
+        break;
+
+    case yactfr::Element::Kind::DYNAMIC_LENGTH_ARRAY_BEGINNING:
+        os << "DLA:" << record.unsignedIntegerValue;
+        break;
+
+    case yactfr::Element::Kind::SUBSTRING:
+        os << "SS:";
+
+        for (auto it = record.section.begin; it != record.section.begin + record.section.size; ++it) {
+            if (*it == 0) {
+                break;
+            }
+
+            os << static_cast<char>(*it);
+        }
+
+        break;
+
+    default:
+        os << "?";
+        break;
+    }
+
+    os << '\n';
+}
+
+static bool checkAllKinds(const yactfr::TraceType& traceType)
+{
+    // without any option, the records must match the regular iteration
+    MemDataSrcFactory factory {stream, sizeof stream, 5};
+    yactfr::ElementSequence seq {traceType, factory};
+    auto refIt = seq.begin();
+    auto it = seq.begin();
+    yactfr::ElementBatch batch;
+
+    while (it != seq.end()) {
+        it.nextBatch(batch, 7);
+
+        if (batch.isEmpty() || batch.size() > 7) {
+            return false;
+        }
+
+        for (auto& record : batch) {
+            if (refIt == seq.end() || record.kind != refIt->kind() ||
+                    record.offset != refIt.offset()) {
+                return false;
+            }
+
+            ++refIt;
+        }
+    }
+
+    return refIt == seq.end();
+}
+
+int main()
+{
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadata,
+                                                              metadata + std::strlen(metadata));
+    MemDataSrcFactory factory {stream, sizeof stream, 3};
+    yactfr::ElementSequenceOptions opts;
+
+    opts.elementKinds(std::set<yactfr::Element::Kind> {
+        yactfr::Element::Kind::EVENT_RECORD_BEGINNING,
+        yactfr::Element::Kind::DEFAULT_CLOCK_VALUE,
+        yactfr::Element::Kind::EVENT_RECORD_INFO,
+        yactfr::Element::Kind::FIXED_LENGTH_UNSIGNED_INTEGER,
+        yactfr::Element::Kind::FIXED_LENGTH_SIGNED_INTEGER,
+        yactfr::Element::Kind::DYNAMIC_LENGTH_ARRAY_BEGINNING,
+        yactfr::Element::Kind::SUBSTRING,
+    });
+
+    yactfr::ElementSequence seq {*traceTypeMsUuidPair.first, factory, opts};
+    std::ostringstream ss;
+    yactfr::ElementBatch batch;
+
+    for (auto it = seq.begin(); it != seq.end();) {
+        it.nextBatch(batch, 4);
+        ss << "-- batch\n";
+
+        for (auto& record : batch) {
+            printRecord(ss, record);
+        }
+    }
+
+    const auto allKindsOk = checkAllKinds(*traceTypeMsUuidPair.first);
+
+    if (ss.str() == expected && allKindsOk) {
+        return 0;
+    }
+
+    if (!allKindsOk) {
+        std::cerr << "Records don't match the regular iteration.\n";
+    }
+
+    std::cerr << "Expected:\n\n" << expected << "\n" <<
+                 "Got:\n\n" << ss.str();
+    return 1;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstring>
+#include <sstream>
+#include <iostream>
+
+#include <yactfr/yactfr.hpp>
+
+#include <mem-data-src-factory.hpp>
+#include <elem-printer.hpp>
+
+static const auto metadata =
+    "/* CTF 1.8 */\n"
+    "typealias integer { size = 8; } := u8;"
+    "typealias integer { size = 16; } := u16;"
+    "trace {"
+    "  major = 1;"
+    "  minor = 8;"
+    "  byte_order = be;"
+    "};"
+    "stream {"
+    "  event.header := struct {"
+    "    u8 id;"
+    "  };"
+    "};"
+    "event {"
+    "  id = 0;"
+    "  fields := struct {"
+    "    u8 len;"
+    "    struct {"
+    "      u16 x;"
+    "      u8 y;"
+    "    } s;"
+    "    string str;"
+    "    u16 arr[len];"
+    "    struct {"
+    "      u8 fd;"
+    "      u8 other;"
+    "    } inner;"
+    "    string name;"
+    "  };"
+    "};"
+    "event {"
+    "  id = 1;"
+    "  fields := struct {"
+    "    u8 z;"
+    "  };"
+    "};";
+
+static const std::uint8_t stream[] = {
+    0x00, 0x02, 0x01, 0x02, 0x03, 'a', 'b', 0, 0x00, 0x04, 0x00, 0x05, 0x06, 0x07, 'c', 0,
+    0x01, 0x08,
+    0x00, 0x01, 0x11, 0x12, 0x13, 0, 0x00, 0x14, 0x15, 0x16, 'd', 'e', 0,
+};
+
+static const auto expected =
+    "P {\n"
+    "PC {\n"
+    "DSI:T0\n"
+    "PI\n"
+    "ER {\n"
+    "ERI:T0\n"
+    "SC:5 {\n"
+    "ST {\n"
+    "ST:s {\n"
+    "FLUI:x:258\n"
+    "}\n"
+    "DLA:arr {\n"
+    "FLUI:4\n"
+    "FLUI:5\n"
+    "}\n"
+    "ST:inner {\n"
+    "FLUI:fd:6\n"
+    "}\n"
+    "NTS:name {\n"
+    "SS:2:c\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "ER {\n"
+    "ERI:T1\n"
+    "SC:5 {\n"
+    "}\n"
+    "}\n"
+    "ER {\n"
+    "ERI:T0\n"
+    "SC:5 {\n"
+    "ST {\n"
+    "ST:s {\n"
+    "FLUI:x:4370\n"
+    "}\n"
+    "DLA:arr {\n"
+    "FLUI:20\n"
+    "}\n"
+    "ST:inner {\n"
+    "FLUI:fd:21\n"
+    "}\n"
+    "NTS:name {\n"
+    "SS:2:de\n"
+    "SS:1:\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "}\n";
+
+int main()
+{
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadata,
+                                                              metadata + std::strlen(metadata));
+    MemDataSrcFactory factory {stream, sizeof stream, 3};
+    yactfr::ElementSequenceOptions opts;
+
+    opts.projectedDataLocations(std::vector<yactfr::DataLocation> {
+        yactfr::DataLocation {yactfr::Scope::EVENT_RECORD_PAYLOAD, {"s", "x"}},
+        yactfr::DataLocation {yactfr::Scope::EVENT_RECORD_PAYLOAD, {"arr"}},
+        yactfr::DataLocation {yactfr::Scope::EVENT_RECORD_PAYLOAD, {"inner", "fd"}},
+        yactfr::DataLocation {yactfr::Scope::EVENT_RECORD_PAYLOAD, {"name"}},
+    });
+
+    yactfr::ElementSequence seq {*traceTypeMsUuidPair.first, factory, opts};
+    std::ostringstream ss;
+    ElemPrinter printer {ss, 0};
+
+    for (auto& elem : seq) {
+        elem.accept(printer);
+    }
+
+    if (ss.str() == expected) {
+        return 0;
+    }
+
+    std::cerr << "Expected:\n\n" << expected << "\n" <<
+                 "Got:\n\n" << ss.str();
+    return 1;
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstring>
+#include <sstream>
+#include <iostream>
+
+#include <yactfr/yactfr.hpp>
+
+#include <mem-data-src-factory.hpp>
+#include <elem-printer.hpp>
+
+static const auto metadata =
+    "/* CTF 1.8 */\n"
+    "typealias integer { size = 8; } := u8;"
+    "typealias integer { size = 16; } := u16;"
+    "trace {"
+    "  major = 1;"
+    "  minor = 8;"
+    "  byte_order = be;"
+    "};"
+    "clock {"
+    "  name = clk;"
+    "  freq = 1000;"
+    "};"
+    "typealias integer { size = 8; map = clock.clk.value; } := ts8;"
+    "stream {"
+    "  event.header := struct {"
+    "    u8 id;"
+    "    ts8 ts;"
+    "  };"
+    "};"
+    "event {"
+    "  id = 0;"
+    "  name = zero;"
+    "  fields := struct {"
+    "    u8 len;"
+    "    struct {"
+    "      u16 x;"
+    "      u8 y[2];"
+    "    } s;"
+    "    string str;"
+    "    u16 arr[len];"
+    "    u8 b;"
+    "  };"
+    "};"
+    "event {"
+    "  id = 1;"
+    "  name = one;"
+    "};";
+
+static const std::uint8_t stream[] = {
+    0x00, 0x10, 0x02, 0x01, 0x02, 0x03, 0x04, 'a', 'b', 0, 0x00, 0x05, 0x00, 0x06, 0x07,
+    0x01, 0x20,
+    0x00, 0x05, 0x01, 0x11, 0x12, 0x13, 0x14, 0, 0x00, 0x15, 0x16,
+};
+
+static const auto expectedInfo =
+    "ER {\n"
+    "DCV:16\n"
+    "ERI:T0:#zero\n"
+    "ER {\n"
+    "DCV:32\n"
+    "ERI:T1:#one\n"
+    "ER {\n"
+    "DCV:261\n"
+    "ERI:T0:#zero\n";
+
+static const auto expectedUInts =
+    "FLUI:id:0\n"
+    "FLUI:ts:16\n"
+    "FLUI:len:2\n"
+    "FLUI:x:258\n"
+    "FLUI:3\n"
+    "FLUI:4\n"
+    "FLUI:5\n"
+    "FLUI:6\n"
+    "FLUI:b:7\n"
+    "FLUI:id:1\n"
+    "FLUI:ts:32\n"
+    "FLUI:id:0\n"
+    "FLUI:ts:5\n"
+    "FLUI:len:1\n"
+    "FLUI:x:4370\n"
+    "FLUI:19\n"
+    "FLUI:20\n"
+    "FLUI:21\n"
+    "FLUI:b:22\n";
+
+static std::string decode(const yactfr::TraceType& traceType,
+                          std::set<yactfr::Element::Kind> kinds)
+{
+    MemDataSrcFactory factory {stream, sizeof stream, 3};
+    yactfr::ElementSequenceOptions opts;
+
+    opts.elementKinds(std::move(kinds));
+
+    yactfr::ElementSequence seq {traceType, factory, opts};
+    std::ostringstream ss;
+    ElemPrinter printer {ss, 0};
+
+    for (auto& elem : seq) {
+        elem.accept(printer);
+    }
+
+    return ss.str();
+}
+
+int main()
+{
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadata,
+                                                              metadata + std::strlen(metadata));
+    const auto infoStr = decode(*traceTypeMsUuidPair.first, {
+        yactfr::Element::Kind::EVENT_RECORD_BEGINNING,
+        yactfr::Element::Kind::DEFAULT_CLOCK_VALUE,
+        yactfr::Element::Kind::EVENT_RECORD_INFO,
+    });
+    const auto uIntsStr = decode(*traceTypeMsUuidPair.first, {
+        yactfr::Element::Kind::FIXED_LENGTH_UNSIGNED_INTEGER,
+    });
+
+    if (infoStr == expectedInfo && uIntsStr == expectedUInts) {
+        return 0;
+    }
+
+    std::cerr << "Expected (info):\n\n" << expectedInfo << "\n" <<
+                 "Got (info):\n\n" << infoStr << "\n" <<
+                 "Expected (unsigned integers):\n\n" << expectedUInts << "\n" <<
+                 "Got (unsigned integers):\n\n" << uIntsStr;
+    return 1;
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstring>
+#include <sstream>
+#include <iostream>
+
+#include <yactfr/yactfr.hpp>
+
+#include <mem-data-src-factory.hpp>
+
+static const auto metadata =
+    "/* CTF 1.8 */\n"
+    "typealias integer { size = 8; } := u8;"
+    "typealias integer { size = 8; signed = true; } := s8;"
+    "typealias integer { size = 16; } := u16;"
+    "trace {"
+    "  major = 1;"
+    "  minor = 8;"
+    "  byte_order = be;"
+    "};"
+    "clock {"
+    "  name = clk;"
+    "  freq = 1000;"
+    "};"
+    "typealias integer { size = 8; map = clock.clk.value; } := ts8;"
+    "stream {"
+    "  packet.context := struct {"
+    "    u16 packet_size;"
+    "    u16 content_size;"
+    "  };"
+    "  event.header := struct {"
+    "    u8 id;"
+    "    ts8 ts;"
+    "  };"
+    "  event.context := struct {"
+    "    u8 cpu;"
+    "  };"
+    "};"
+    "event {"
+    "  id = 0;"
+    "  name = zero;"
+    "  fields := struct {"
+    "    u8 len;"
+    "    string str;"
+    "    u16 arr[len];"
+    "    s8 b;"
+    "    struct {"
+    "      u8 x;"
+    "    } s;"
+    "  };"
+    "};"
+    "event {"
+    "  id = 1;"
+    "  name = one;"
+    "};";
+
+static const std::uint8_t stream[] = {
+    // packet 1
+    0x00, 0xd8, 0x00, 0xd8,
+    0x00, 0x10, 0x01, 0x02, 'a', 'b', 0, 0x00, 0x05, 0x00, 0x06, 0xf9, 0x09,
+    0x01, 0x20, 0x02,
+    0x00, 0x30, 0x03, 0x00, 0, 0x05, 0x0a,
+
+    // packet 2
+    0x00, 0x98, 0x00, 0x98,
+    0x00, 0x40, 0x04, 0x01, 'x', 'y', 'z', 0, 0x00, 0x07, 0x01, 0x0b,
+    0x01, 0x50, 0x05,
+};
+
+static const auto expected =
+    "packet\n"
+    "zero: 2\n"
+    "ts: 16 48\n"
+    "3/cpu: 1 3\n"
+    "5/len: 2 0\n"
+    "5/str: 'ab' ''\n"
+    "5/b: -7 5\n"
+    "5/s/x: 9 10\n"
+    "packet\n"
+    "zero: 1\n"
+    "ts: 64\n"
+    "3/cpu: 4\n"
+    "5/len: 1\n"
+    "5/str: 'xyz'\n"
+    "5/b: 1\n"
+    "5/s/x: 11\n"
+    "end\n";
+
+static void printCols(std::ostream& os, const yactfr::EventRecordColumns& erCols)
+{
+    os << *erCols.eventRecordType().name() << ": " << erCols.size() << '\n';
+    os << "ts:";
+
+    for (const auto ts : erCols.timestamps()) {
+        os << ' ' << ts;
+    }
+
+    os << '\n';
+
+    for (auto& col : erCols.columns()) {
+        os << static_cast<int>(col.location().scope());
+
+        for (auto& pathElem : col.location()) {
+            os << '/' << pathElem;
+        }
+
+        os << ':';
+
+        switch (col.kind()) {
+        case yactfr::EventRecordColumn::Kind::UNSIGNED_INTEGER:
+            for (const auto val : col.unsignedIntegerValues()) {
+                os << ' ' << val;
+            }
+
+            break;
+
+        case yactfr::EventRecordColumn::Kind::SIGNED_INTEGER:
+            for (const auto val : col.signedIntegerValues()) {
+                os << ' ' << val;
+            }
+
+            break;
+
+        case yactfr::EventRecordColumn::Kind::FLOATING_POINT_NUMBER:
+            for (const auto val : col.floatingPointNumberValues()) {
+                os << ' ' << val;
+            }
+
+            break;
+
+        case yactfr::EventRecordColumn::Kind::STRING:
+            for (yactfr::Index i = 0; i < erCols.size(); ++i) {
+                os << " '" << col.stringValue(i) << '\'';
+            }
+
+            break;
+        }
+
+        os << '\n';
+    }
+}
+
+int main()
+{
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadata,
+                                                              metadata + std::strlen(metadata));
+    auto& traceType = *traceTypeMsUuidPair.first;
+    MemDataSrcFactory factory {stream, sizeof stream, 3};
+    yactfr::EventRecordColumnDecoder decoder {traceType, factory,
+                                              [](const yactfr::EventRecordType& ert) {
+        return ert.id() == 0;
+    }};
+    std::ostringstream ss;
+
+    if (decoder.eventRecordColumns().size() != 1) {
+        std::cerr << "Expecting the columns of a single event record type.\n";
+        return 1;
+    }
+
+    auto& erCols = decoder.eventRecordColumns().front();
+
+    if (decoder[erCols.eventRecordType()] != &erCols ||
+            !erCols[yactfr::DataLocation {yactfr::Scope::EVENT_RECORD_PAYLOAD, {"s", "x"}}] ||
+            erCols[yactfr::DataLocation {yactfr::Scope::EVENT_RECORD_PAYLOAD, {"arr"}}]) {
+        std::cerr << "Unexpected column lookup result.\n";
+        return 1;
+    }
+
+    const yactfr::Cycles *tsData = nullptr;
+
+    while (decoder.decodeNextPacket()) {
+        ss << "packet\n";
+        printCols(ss, erCols);
+
+        if (tsData && erCols.timestamps().data() != tsData) {
+            std::cerr << "Timestamp column was reallocated.\n";
+            return 1;
+        }
+
+        tsData = erCols.timestamps().data();
+    }
+
+    ss << "end\n";
+
+    if (erCols.size() != 0) {
+        std::cerr << "Expecting empty columns after the last packet.\n";
+        return 1;
+    }
+
+    if (ss.str() == expected) {
+        return 0;
+    }
+
+    std::cerr << "Expected:\n\n" << expected << "\n" <<
+                 "Got:\n\n" << ss.str();
+    return 1;
+}
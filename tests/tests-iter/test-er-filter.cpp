@@ -0,0 +1,617 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstring>
+#include <sstream>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+#include <yactfr/yactfr.hpp>
+
+#include <mem-data-src-factory.hpp>
+#include <elem-printer.hpp>
+
+static const auto metadata =
+    "/* CTF 1.8 */\n"
+    "typealias integer { size = 8; } := u8;"
+    "typealias integer { size = 16; } := u16;"
+    "trace {"
+    "  major = 1;"
+    "  minor = 8;"
+    "  byte_order = be;"
+    "};"
+    "clock {"
+    "  name = clk;"
+    "  freq = 1000;"
+    "};"
+    "typealias integer { size = 8; map = clock.clk.value; } := ts8;"
+    "stream {"
+    "  event.header := struct {"
+    "    u8 id;"
+    "    ts8 ts;"
+    "  };"
+    "};"
+    "event {"
+    "  id = 0;"
+    "  name = zero;"
+    "  fields := struct {"
+    "    u8 a;"
+    "  };"
+    "};"
+    "event {"
+    "  id = 1;"
+    "  name = one;"
+    "  fields := struct {"
+    "    string s;"
+    "  };"
+    "};"
+    "event {"
+    "  id = 2;"
+    "  name = two;"
+    "  fields := struct {"
+    "    u16 b;"
+    "  };"
+    "};";
+
+static const std::uint8_t stream[] = {
+    0x00, 0x10, 0x01,
+    0x01, 0x20, 'x', 'y', 'z', 0,
+    0x02, 0x05, 0x02, 0x03,
+    0x01, 0x06, 0,
+    0x00, 0x07, 0x04,
+};
+
+static const auto expectedIds =
+    "P {\n"
+    "PC {\n"
+    "DSI:T0\n"
+    "PI\n"
+    "ER {\n"
+    "SC:2 {\n"
+    "ST {\n"
+    "FLUI:id:0\n"
+    "FLUI:ts:16\n"
+    "DCV:16\n"
+    "}\n"
+    "}\n"
+    "ERI:T0:#zero\n"
+    "SC:5 {\n"
+    "ST {\n"
+    "FLUI:a:1\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "ER {\n"
+    "SC:2 {\n"
+    "ST {\n"
+    "FLUI:id:2\n"
+    "FLUI:ts:5\n"
+    "DCV:261\n"
+    "}\n"
+    "}\n"
+    "ERI:T2:#two\n"
+    "SC:5 {\n"
+    "ST {\n"
+    "FLUI:b:515\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "ER {\n"
+    "SC:2 {\n"
+    "ST {\n"
+    "FLUI:id:0\n"
+    "FLUI:ts:7\n"
+    "DCV:263\n"
+    "}\n"
+    "}\n"
+    "ERI:T0:#zero\n"
+    "SC:5 {\n"
+    "ST {\n"
+    "FLUI:a:4\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "}\n";
+
+static const auto expectedPred =
+    "P {\n"
+    "PC {\n"
+    "DSI:T0\n"
+    "PI\n"
+    "ER {\n"
+    "SC:2 {\n"
+    "ST {\n"
+    "FLUI:id:1\n"
+    "FLUI:ts:32\n"
+    "DCV:32\n"
+    "}\n"
+    "}\n"
+    "ERI:T1:#one\n"
+    "SC:5 {\n"
+    "ST {\n"
+    "NTS:s {\n"
+    "SS:1:x\n"
+    "SS:3:yz\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "ER {\n"
+    "SC:2 {\n"
+    "ST {\n"
+    "FLUI:id:1\n"
+    "FLUI:ts:6\n"
+    "DCV:262\n"
+    "}\n"
+    "}\n"
+    "ERI:T1:#one\n"
+    "SC:5 {\n"
+    "ST {\n"
+    "NTS:s {\n"
+    "SS:1:\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "}\n";
+
+/*
+ * The event record header contains a string: the iterator must keep
+ * its substrings until it knows whether or not it selects the event
+ * record.
+ */
+static const auto strMetadata =
+    "/* CTF 1.8 */\n"
+    "typealias integer { size = 8; } := u8;"
+    "trace {"
+    "  major = 1;"
+    "  minor = 8;"
+    "  byte_order = be;"
+    "};"
+    "stream {"
+    "  event.header := struct {"
+    "    u8 id;"
+    "    string tag;"
+    "  };"
+    "};"
+    "event {"
+    "  id = 0;"
+    "  name = zero;"
+    "  fields := struct {"
+    "    u8 a;"
+    "  };"
+    "};"
+    "event {"
+    "  id = 1;"
+    "  name = one;"
+    "  fields := struct {"
+    "    u8 b;"
+    "  };"
+    "};";
+
+static const std::uint8_t strStream[] = {
+    0x00, 'a', 'b', 'c', 0, 0x01,
+    0x01, 'd', 'e', 0, 0x02,
+    0x00, 'f', 0, 0x03,
+};
+
+static const auto expectedStr =
+    "P {\n"
+    "PC {\n"
+    "DSI:T0\n"
+    "PI\n"
+    "ER {\n"
+    "SC:2 {\n"
+    "ST {\n"
+    "FLUI:id:0\n"
+    "NTS:tag {\n"
+    "SS:1:a\n"
+    "SS:1:b\n"
+    "SS:1:c\n"
+    "SS:1:\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "ERI:T0:#zero\n"
+    "SC:5 {\n"
+    "ST {\n"
+    "FLUI:a:1\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "ER {\n"
+    "SC:2 {\n"
+    "ST {\n"
+    "FLUI:id:0\n"
+    "NTS:tag {\n"
+    "SS:1:f\n"
+    "SS:1:\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "ERI:T0:#zero\n"
+    "SC:5 {\n"
+    "ST {\n"
+    "FLUI:a:3\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "}\n";
+
+class ForwardOnlyDataSrcFactory;
+
+/*
+ * Data source which, like a pipe, can only provide data at increasing
+ * offsets.
+ *
+ * Copies each data block to the same buffer, invalidating the previous
+ * one, and sets `*isBackward` if a requested offset is less than the
+ * previous one.
+ */
+class ForwardOnlyDataSrc :
+    public yactfr::DataSource
+{
+    friend class ForwardOnlyDataSrcFactory;
+
+private:
+    explicit ForwardOnlyDataSrc(const std::uint8_t * const addr, const std::size_t size,
+                                const std::size_t maxDataBlkSize, bool * const isBackward) :
+        _addr {addr},
+        _size {size},
+        _maxDataBlkSize {maxDataBlkSize},
+        _isBackward {isBackward}
+    {
+    }
+
+    boost::optional<yactfr::DataBlock> _data(const yactfr::Index offset,
+                                             const yactfr::Size minSize) override
+    {
+        if (offset < _lastOffset) {
+            *_isBackward = true;
+        }
+
+        _lastOffset = offset;
+
+        if (offset >= _size) {
+            return boost::none;
+        }
+
+        const auto blockSize = std::min(_size - offset,
+                                        std::max(minSize, static_cast<yactfr::Size>(_maxDataBlkSize)));
+
+        _buf.assign(_addr + offset, _addr + offset + blockSize);
+        return yactfr::DataBlock {static_cast<const void *>(_buf.data()), _buf.size()};
+    }
+
+private:
+    const std::uint8_t * const _addr;
+    const std::size_t _size;
+    const std::size_t _maxDataBlkSize;
+    bool * const _isBackward;
+    yactfr::Index _lastOffset = 0;
+    std::vector<std::uint8_t> _buf;
+};
+
+class ForwardOnlyDataSrcFactory :
+    public yactfr::DataSourceFactory
+{
+public:
+    explicit ForwardOnlyDataSrcFactory(const std::uint8_t * const addr, const std::size_t size,
+                                       const std::size_t maxDataBlkSize, bool& isBackward) :
+        _addr {addr},
+        _size {size},
+        _maxDataBlkSize {maxDataBlkSize},
+        _isBackward {&isBackward}
+    {
+    }
+
+private:
+    yactfr::DataSource::UP _createDataSource() override
+    {
+        return yactfr::DataSource::UP {
+            new ForwardOnlyDataSrc {_addr, _size, _maxDataBlkSize, _isBackward}
+        };
+    }
+
+private:
+    const std::uint8_t * const _addr;
+    const std::size_t _size;
+    const std::size_t _maxDataBlkSize;
+    bool * const _isBackward;
+};
+
+/*
+ * Decodes `data` (`size` bytes) with a forward-only data source
+ * providing data blocks of at most `maxDataBlkSize` bytes and returns
+ * the printed elements.
+ *
+ * Sets `isBackward` if the iterator requests an offset which is less
+ * than the previous one.
+ */
+static std::string decodeForwardOnly(const yactfr::TraceType& traceType,
+                                     const yactfr::ElementSequenceOptions& opts,
+                                     const std::uint8_t * const data, const std::size_t size,
+                                     const std::size_t maxDataBlkSize, bool& isBackward)
+{
+    ForwardOnlyDataSrcFactory factory {data, size, maxDataBlkSize, isBackward};
+    yactfr::ElementSequence seq {traceType, factory, opts};
+    std::ostringstream ss;
+    ElemPrinter printer {ss, 0};
+
+    for (auto& elem : seq) {
+        elem.accept(printer);
+    }
+
+    return ss.str();
+}
+
+/*
+ * Decodes `stream` with data blocks of at most `maxDataBlkSize` bytes
+ * and returns the printed elements.
+ */
+static std::string decode(const yactfr::TraceType& traceType,
+                          const yactfr::ElementSequenceOptions& opts,
+                          const std::size_t maxDataBlkSize)
+{
+    MemDataSrcFactory factory {stream, sizeof stream, maxDataBlkSize};
+    yactfr::ElementSequence seq {traceType, factory, opts};
+    std::ostringstream ss;
+    ElemPrinter printer {ss, 0};
+
+    for (auto& elem : seq) {
+        elem.accept(printer);
+    }
+
+    return ss.str();
+}
+
+static std::string printRest(yactfr::ElementSequenceIterator it,
+                             const yactfr::ElementSequenceIterator& end)
+{
+    std::ostringstream ss;
+    ElemPrinter printer {ss, 0};
+
+    while (it != end) {
+        it->accept(printer);
+        ++it;
+    }
+
+    return ss.str();
+}
+
+/*
+ * Checks that, for each element of `stream` with `opts`, a copy of the
+ * iterator and a restored position give the same following elements,
+ * also when the iterator emits the kept elements of an event record.
+ */
+static bool checkCopiesAndPositions(const yactfr::TraceType& traceType,
+                                    const yactfr::ElementSequenceOptions& opts)
+{
+    MemDataSrcFactory factory {stream, sizeof stream, 3};
+    yactfr::ElementSequence seq {traceType, factory, opts};
+
+    for (auto it = seq.begin(); it != seq.end(); ++it) {
+        const auto expected = printRest(it, seq.end());
+        yactfr::ElementSequenceIteratorPosition pos;
+
+        it.savePosition(pos);
+
+        auto otherIt = seq.begin();
+
+        otherIt.restorePosition(pos);
+
+        if (printRest(otherIt, seq.end()) != expected) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Decodes `stream` with `opts`, skipping the contents of each event
+ * record header scope (structure if `skipStruct` is true), and returns
+ * the printed elements.
+ */
+static std::string decodeSkippingHeaders(const yactfr::TraceType& traceType,
+                                         const yactfr::ElementSequenceOptions& opts,
+                                         const bool skipStruct)
+{
+    MemDataSrcFactory factory {stream, sizeof stream, 3};
+    yactfr::ElementSequence seq {traceType, factory, opts};
+    std::ostringstream ss;
+    ElemPrinter printer {ss, 0};
+    auto isInHeader = false;
+
+    for (auto it = seq.begin(); it != seq.end(); ++it) {
+        it->accept(printer);
+
+        if (it->isScopeBeginningElement() &&
+                it->asScopeBeginningElement().scope() == yactfr::Scope::EVENT_RECORD_HEADER) {
+            if (!skipStruct) {
+                it.skipCurrentScope();
+                it->accept(printer);
+                continue;
+            }
+
+            isInHeader = true;
+        } else if (isInHeader && it->isStructureBeginningElement()) {
+            it.skipCurrentStructure();
+            it->accept(printer);
+            isInHeader = false;
+        }
+    }
+
+    return ss.str();
+}
+
+/*
+ * Returns `str` without the contents of the event record header scopes
+ * (structures if `keepStruct` is true).
+ */
+static std::string withoutHeaderContents(const std::string& str, const bool keepStruct)
+{
+    std::istringstream iss {str};
+    std::string result;
+    std::string line;
+    auto level = 0;
+
+    while (std::getline(iss, line)) {
+        if (level > 0) {
+            if (line.back() == '{') {
+                ++level;
+            } else if (line == "}") {
+                --level;
+            }
+
+            if (level > 0) {
+                continue;
+            }
+        }
+
+        result += line + '\n';
+
+        if (line == "SC:2 {") {
+            level = 1;
+
+            if (keepStruct) {
+                std::getline(iss, line);
+                result += line + '\n';
+            }
+        }
+    }
+
+    return result;
+}
+
+/*
+ * Decodes `stream` within a single data block without any event record
+ * type filter and returns the printed elements, except the ones of the
+ * event records of which the type doesn't satisfy `filter`.
+ */
+static std::string decodeAndFilter(const yactfr::TraceType& traceType,
+                                   const yactfr::ElementSequenceOptions::EventRecordTypeFilter& filter)
+{
+    MemDataSrcFactory factory {stream, sizeof stream, sizeof stream};
+    yactfr::ElementSequence seq {traceType, factory};
+    std::ostringstream ss;
+    ElemPrinter printer {ss, 0};
+    std::ostringstream erSs;
+    ElemPrinter erPrinter {erSs, 0};
+    const yactfr::EventRecordType *ert = nullptr;
+    auto isInEr = false;
+
+    for (auto& elem : seq) {
+        if (elem.isEventRecordBeginningElement()) {
+            erSs.str("");
+            ert = nullptr;
+            isInEr = true;
+        }
+
+        if (!isInEr) {
+            elem.accept(printer);
+            continue;
+        }
+
+        elem.accept(erPrinter);
+
+        if (elem.isEventRecordInfoElement()) {
+            ert = elem.asEventRecordInfoElement().type();
+        } else if (elem.isEventRecordEndElement()) {
+            if (ert && filter(*ert)) {
+                ss << erSs.str();
+            }
+
+            isInEr = false;
+        }
+    }
+
+    return ss.str();
+}
+
+int main()
+{
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadata,
+                                                              metadata + std::strlen(metadata));
+    yactfr::ElementSequenceOptions idsOpts;
+
+    idsOpts.eventRecordTypeFilter(std::set<yactfr::TypeId> {0, 2});
+
+    yactfr::ElementSequenceOptions predOpts;
+
+    predOpts.eventRecordTypeFilter([](const yactfr::EventRecordType& ert) {
+        return ert.name() && *ert.name() == "one";
+    });
+
+    const auto idsStr = decode(*traceTypeMsUuidPair.first, idsOpts, 3);
+    const auto predStr = decode(*traceTypeMsUuidPair.first, predOpts, 3);
+    const auto bigBlksIdsStr = decode(*traceTypeMsUuidPair.first, idsOpts, sizeof stream);
+    const auto bigBlksPredStr = decode(*traceTypeMsUuidPair.first, predOpts, sizeof stream);
+    const auto expectedBigBlksIds = decodeAndFilter(*traceTypeMsUuidPair.first,
+                                                    idsOpts.eventRecordTypeFilter());
+    const auto expectedBigBlksPred = decodeAndFilter(*traceTypeMsUuidPair.first,
+                                                     predOpts.eventRecordTypeFilter());
+    auto isBackward = false;
+    const auto fwdIdsStr = decodeForwardOnly(*traceTypeMsUuidPair.first, idsOpts, stream,
+                                             sizeof stream, 3, isBackward);
+    const auto fwdPredStr = decodeForwardOnly(*traceTypeMsUuidPair.first, predOpts, stream,
+                                              sizeof stream, 3, isBackward);
+    const auto strTraceTypeMsUuidPair = yactfr::fromMetadataText(strMetadata,
+                                                                 strMetadata + std::strlen(strMetadata));
+    yactfr::ElementSequenceOptions strOpts;
+
+    strOpts.eventRecordTypeFilter(std::set<yactfr::TypeId> {0});
+
+    const auto fwdStrStr = decodeForwardOnly(*strTraceTypeMsUuidPair.first, strOpts, strStream,
+                                             sizeof strStream, 1, isBackward);
+
+    const auto copiesOk = checkCopiesAndPositions(*traceTypeMsUuidPair.first, idsOpts) &&
+                          checkCopiesAndPositions(*traceTypeMsUuidPair.first, predOpts);
+    const auto skipScopeStr = decodeSkippingHeaders(*traceTypeMsUuidPair.first, idsOpts, false);
+    const auto skipStructStr = decodeSkippingHeaders(*traceTypeMsUuidPair.first, idsOpts, true);
+    const auto skipOk = skipScopeStr == withoutHeaderContents(expectedIds, false) &&
+                        skipStructStr == withoutHeaderContents(expectedIds, true);
+
+    if (idsStr == expectedIds && predStr == expectedPred &&
+            bigBlksIdsStr == expectedBigBlksIds && bigBlksPredStr == expectedBigBlksPred &&
+            fwdIdsStr == expectedIds && fwdPredStr == expectedPred && fwdStrStr == expectedStr &&
+            !isBackward && copiesOk && skipOk) {
+        return 0;
+    }
+
+    if (!copiesOk) {
+        std::cerr << "Copying an iterator or restoring a position doesn't give the same "
+                     "elements.\n\n";
+    }
+
+    if (!skipOk) {
+        std::cerr << "Skipping the event record headers gives:\n\n" << skipScopeStr << "\n" <<
+                     skipStructStr << "\n";
+    }
+
+    if (isBackward) {
+        std::cerr << "An iterator requested a decreasing data source offset.\n\n";
+    }
+
+    std::cerr << "Expected (IDs):\n\n" << expectedIds << "\n" <<
+                 "Got (IDs):\n\n" << idsStr << "\n" <<
+                 "Expected (predicate):\n\n" << expectedPred << "\n" <<
+                 "Got (predicate):\n\n" << predStr << "\n" <<
+                 "Expected (IDs, big data blocks):\n\n" << expectedBigBlksIds << "\n" <<
+                 "Got (IDs, big data blocks):\n\n" << bigBlksIdsStr << "\n" <<
+                 "Expected (predicate, big data blocks):\n\n" << expectedBigBlksPred << "\n" <<
+                 "Got (predicate, big data blocks):\n\n" << bigBlksPredStr << "\n" <<
+                 "Got (IDs, forward-only):\n\n" << fwdIdsStr << "\n" <<
+                 "Got (predicate, forward-only):\n\n" << fwdPredStr << "\n" <<
+                 "Expected (string header, forward-only):\n\n" << expectedStr << "\n" <<
+                 "Got (string header, forward-only):\n\n" << fwdStrStr;
+    return 1;
+}
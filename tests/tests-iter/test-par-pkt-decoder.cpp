@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include <yactfr/yactfr.hpp>
+
+#include <mem-data-src-factory.hpp>
+#include <common-trace.hpp>
+
+// number of times to repeat the common stream
+static constexpr std::size_t streamCount = 200;
+
+// offset of a data stream type ID (packet header) to corrupt
+static constexpr std::size_t corruptOffset = sizeof stream * 117 + 20;
+
+static bool sameRecord(const yactfr::ElementBatch::Record& a,
+                       const yactfr::ElementBatch::Record& b)
+{
+    if (a.kind != b.kind || a.offset != b.offset || a.dataType != b.dataType) {
+        return false;
+    }
+
+    if (a.kind == yactfr::Element::Kind::SUBSTRING ||
+            a.kind == yactfr::Element::Kind::BLOB_SECTION ||
+            a.kind == yactfr::Element::Kind::ARRAY_SECTION) {
+        return a.section.size == b.section.size &&
+               std::memcmp(a.section.begin, b.section.begin, a.section.size) == 0;
+    }
+
+    return a.unsignedIntegerValue == b.unsignedIntegerValue;
+}
+
+/*
+ * Checks that decoding `data` in parallel with the given parameters
+ * delivers the same records as `refBatch`.
+ */
+static bool check(const yactfr::TraceType& traceType, const std::vector<std::uint8_t>& data,
+                  const yactfr::PacketIndex& pktIndex, const yactfr::ElementSequenceOptions& opts,
+                  const yactfr::ElementBatch& refBatch,
+                  const boost::optional<yactfr::Size>& workerCount,
+                  const boost::optional<yactfr::Size>& pktsPerRange,
+                  const boost::optional<yactfr::Size>& maxPendingRangeCount)
+{
+    /*
+     * Substring elements depend on the data block boundaries: use a
+     * single data block, like refBatch() does.
+     */
+    MemDataSrcFactory factory {data.data(), data.size()};
+    yactfr::ParallelPacketDecoder decoder {
+        traceType, factory, pktIndex, opts, workerCount, pktsPerRange, maxPendingRangeCount
+    };
+    yactfr::ElementBatch batch;
+    yactfr::Index refIndex = 0;
+    yactfr::Size batchCount = 0;
+
+    if (workerCount && decoder.workerCount() != *workerCount) {
+        std::cerr << "Unexpected worker count " << decoder.workerCount() << ".\n";
+        return false;
+    }
+
+    if (pktsPerRange && decoder.packetsPerRange() != *pktsPerRange) {
+        std::cerr << "Unexpected packets per range " << decoder.packetsPerRange() << ".\n";
+        return false;
+    }
+
+    while (decoder.next(batch)) {
+        ++batchCount;
+
+        for (auto& record : batch) {
+            if (refIndex >= refBatch.size() || !sameRecord(record, refBatch[refIndex])) {
+                std::cerr << "Unexpected record " << refIndex << " at offset " <<
+                             record.offset << ".\n";
+                return false;
+            }
+
+            ++refIndex;
+        }
+    }
+
+    if (refIndex != refBatch.size()) {
+        std::cerr << "Expecting " << refBatch.size() << " records, got " << refIndex << ".\n";
+        return false;
+    }
+
+    if (batchCount != decoder.rangeCount()) {
+        std::cerr << "Expecting " << decoder.rangeCount() << " batches, got " <<
+                     batchCount << ".\n";
+        return false;
+    }
+
+    // no more packet range
+    return !decoder.next(batch);
+}
+
+static yactfr::ElementBatch refBatch(const yactfr::TraceType& traceType,
+                                     const std::vector<std::uint8_t>& data,
+                                     const yactfr::ElementSequenceOptions& opts)
+{
+    MemDataSrcFactory factory {data.data(), data.size()};
+    yactfr::ElementSequence seq {traceType, factory, opts};
+    yactfr::ElementBatch batch;
+
+    seq.begin().nextBatch(batch, 1'000'000);
+    return batch;
+}
+
+/*
+ * Checks that a parallel packet decoder delivers the packet ranges
+ * preceding the packet at `corruptOffset` and then rethrows the
+ * decoding error.
+ */
+static bool checkError(const yactfr::TraceType& traceType, std::vector<std::uint8_t> data,
+                       const yactfr::PacketIndex& pktIndex)
+{
+    data[corruptOffset] = 0x17;
+
+    MemDataSrcFactory factory {data.data(), data.size()};
+    yactfr::ParallelPacketDecoder decoder {
+        traceType, factory, pktIndex, yactfr::ElementSequenceOptions {}, 4, 1, 3
+    };
+    yactfr::ElementBatch batch;
+    yactfr::Size batchCount = 0;
+
+    try {
+        while (decoder.next(batch)) {
+            ++batchCount;
+        }
+    } catch (const yactfr::UnknownDataStreamTypeDecodingError&) {
+        const auto entry = pktIndex.findEntry(corruptOffset);
+
+        if (!entry || batchCount != static_cast<yactfr::Size>(entry - &pktIndex[0])) {
+            std::cerr << "Unexpected delivered batch count " << batchCount << ".\n";
+            return false;
+        }
+
+        return true;
+    }
+
+    std::cerr << "Expecting a decoding error.\n";
+    return false;
+}
+
+int main()
+{
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadata,
+                                                              metadata + std::strlen(metadata));
+    auto& traceType = *traceTypeMsUuidPair.first;
+    std::vector<std::uint8_t> data;
+
+    for (std::size_t i = 0; i < streamCount; ++i) {
+        data.insert(data.end(), stream, stream + sizeof stream);
+    }
+
+    MemDataSrcFactory factory {data.data(), data.size()};
+    const yactfr::PacketIndex pktIndex {traceType, factory};
+    const yactfr::ElementSequenceOptions allOpts;
+    const auto allRefBatch = refBatch(traceType, data, allOpts);
+
+    // one packet per range, with a reorder buffer smaller than the worker count
+    if (!check(traceType, data, pktIndex, allOpts, allRefBatch, 4, 1, 2)) {
+        return 1;
+    }
+
+    // many packets per range, last range with fewer packets
+    if (!check(traceType, data, pktIndex, allOpts, allRefBatch, 3, 7, boost::none)) {
+        return 1;
+    }
+
+    // single worker thread
+    if (!check(traceType, data, pktIndex, allOpts, allRefBatch, 1, 5, 1)) {
+        return 1;
+    }
+
+    // implementation defaults
+    if (!check(traceType, data, pktIndex, allOpts, allRefBatch, boost::none, boost::none,
+               boost::none)) {
+        return 1;
+    }
+
+    // without packet beginning and end elements
+    yactfr::ElementSequenceOptions someOpts;
+
+    someOpts.elementKinds(std::set<yactfr::Element::Kind> {
+        yactfr::Element::Kind::PACKET_MAGIC_NUMBER,
+        yactfr::Element::Kind::EVENT_RECORD_BEGINNING,
+        yactfr::Element::Kind::FIXED_LENGTH_UNSIGNED_INTEGER,
+        yactfr::Element::Kind::SUBSTRING,
+    });
+
+    if (!check(traceType, data, pktIndex, someOpts, refBatch(traceType, data, someOpts), 4, 3,
+               boost::none)) {
+        return 1;
+    }
+
+    if (!checkError(traceType, data, pktIndex)) {
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <yactfr/yactfr.hpp>
+
+#include <mem-data-src-factory.hpp>
+#include <common-trace.hpp>
+
+// number of times to repeat the common stream
+static constexpr std::size_t streamCount = 200;
+
+// size of the partial packet preamble at the end of the first part
+static constexpr std::size_t partialSize = 10;
+
+template <typename T>
+static void printOpt(std::ostream& os, const char * const prefix, const T& val)
+{
+    if (val) {
+        os << ' ' << prefix << *val;
+    }
+}
+
+static std::string entryStr(const yactfr::PacketIndexEntry& entry)
+{
+    std::ostringstream ss;
+
+    ss << '@' << entry.offsetInElementSequence();
+    printOpt(ss, "T", entry.expectedTotalLength());
+    printOpt(ss, "C", entry.expectedContentLength());
+
+    if (entry.dataStreamType()) {
+        ss << " DST" << entry.dataStreamType()->id();
+    }
+
+    printOpt(ss, "DS", entry.dataStreamId());
+    printOpt(ss, "SN", entry.sequenceNumber());
+    printOpt(ss, "DERCS", entry.discardedEventRecordCounterSnapshot());
+    printOpt(ss, "B", entry.beginningDefaultClockValue());
+    printOpt(ss, "E", entry.endDefaultClockValue());
+    return ss.str();
+}
+
+/*
+ * Checks that the entries of `file` are the first `count` entries of
+ * `index`.
+ */
+static bool checkEntries(const yactfr::PacketIndexFile& file, const yactfr::PacketIndex& index,
+                         const yactfr::Size count)
+{
+    if (file.size() != count) {
+        std::cerr << "Expecting " << count << " entries, got " << file.size() << ".\n";
+        return false;
+    }
+
+    for (yactfr::Index i = 0; i < count; ++i) {
+        if (entryStr(file[i]) != entryStr(index[i])) {
+            std::cerr << "Entry " << i << ": expecting `" << entryStr(index[i]) <<
+                         "`, got `" << entryStr(file[i]) << "`.\n";
+            return false;
+        }
+    }
+
+    for (const yactfr::Index offset : {0, 1, 100, 1234, 5000}) {
+        const auto fileEntry = file.findEntry(offset);
+        const auto entry = index.findEntry(offset);
+
+        if (entry && entry - &index[0] >= static_cast<std::ptrdiff_t>(count)) {
+            continue;
+        }
+
+        if (static_cast<bool>(fileEntry) != static_cast<bool>(entry) ||
+                (entry && entryStr(*fileEntry) != entryStr(*entry))) {
+            std::cerr << "Unexpected entry lookup result for offset " << offset << ".\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool writeFile(const std::string& path, const std::uint8_t * const data,
+                      const std::size_t size, const int flags)
+{
+    const auto fd = open(path.c_str(), O_WRONLY | O_CREAT | flags, 0644);
+
+    if (fd < 0) {
+        return false;
+    }
+
+    const auto ret = write(fd, data, size);
+
+    close(fd);
+    return ret == static_cast<ssize_t>(size);
+}
+
+static std::unique_ptr<yactfr::PacketIndexFile> openIndexFile(const std::string& path,
+                                                              const yactfr::TraceType& traceType,
+                                                              const std::string& metadataText,
+                                                              const std::string& dsPath)
+{
+    yactfr::MemoryMappedFileViewFactory factory {dsPath};
+
+    return std::make_unique<yactfr::PacketIndexFile>(path, traceType, metadataText, dsPath,
+                                                     factory);
+}
+
+int main()
+{
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadata,
+                                                              metadata + std::strlen(metadata));
+    auto& traceType = *traceTypeMsUuidPair.first;
+    std::vector<std::uint8_t> data;
+
+    for (std::size_t i = 0; i < streamCount; ++i) {
+        data.insert(data.end(), stream, stream + sizeof stream);
+    }
+
+    MemDataSrcFactory memFactory {data.data(), data.size()};
+    const yactfr::PacketIndex index {traceType, memFactory};
+    const auto pktCountPerStream = index.size() / streamCount;
+    char dirPath[] = "/tmp/yactfr-test-pkt-index-file-XXXXXX";
+
+    if (!mkdtemp(dirPath)) {
+        std::cerr << "Cannot create temporary directory.\n";
+        return 1;
+    }
+
+    const auto dsPath = std::string {dirPath} + "/stream";
+    const auto path = std::string {dirPath} + "/stream.idx";
+    const auto firstSize = sizeof stream * (streamCount / 2) + partialSize;
+    auto ret = 1;
+
+    [&] {
+        // first half, ending with a partial packet preamble
+        if (!writeFile(dsPath, data.data(), firstSize, O_TRUNC)) {
+            std::cerr << "Cannot write data stream file.\n";
+            return;
+        }
+
+        // create
+        const auto file = openIndexFile(path, traceType, metadata, dsPath);
+
+        if (!file->wasUpdated() ||
+                !checkEntries(*file, index, pktCountPerStream * (streamCount / 2))) {
+            std::cerr << "Unexpected created packet index file.\n";
+            return;
+        }
+
+        // up to date
+        auto file2 = openIndexFile(path, traceType, metadata, dsPath);
+
+        if (file2->wasUpdated() ||
+                !checkEntries(*file2, index, pktCountPerStream * (streamCount / 2))) {
+            std::cerr << "Unexpected up-to-date packet index file.\n";
+            return;
+        }
+
+        // second half: append
+        if (!writeFile(dsPath, data.data() + firstSize, data.size() - firstSize, O_APPEND)) {
+            std::cerr << "Cannot write data stream file.\n";
+            return;
+        }
+
+        file2 = openIndexFile(path, traceType, metadata, dsPath);
+
+        if (!file2->wasUpdated() || !checkEntries(*file2, index, index.size())) {
+            std::cerr << "Unexpected appended packet index file.\n";
+            return;
+        }
+
+        // first object still maps its records
+        if (!checkEntries(*file, index, pktCountPerStream * (streamCount / 2))) {
+            std::cerr << "Unexpected records after appending.\n";
+            return;
+        }
+
+        // different metadata text: rebuild
+        const auto otherMetadata = std::string {metadata} + "\n";
+
+        file2 = openIndexFile(path, traceType, otherMetadata, dsPath);
+
+        if (!file2->wasUpdated() || !checkEntries(*file2, index, index.size())) {
+            std::cerr << "Unexpected rebuilt packet index file.\n";
+            return;
+        }
+
+        // copy to a packet index
+        const yactfr::PacketIndex index2 {*file2};
+
+        if (index2.size() != index.size() || entryStr(index2[7]) != entryStr(index[7])) {
+            std::cerr << "Unexpected packet index from packet index file.\n";
+            return;
+        }
+
+        // invalid packet index file: rebuild
+        const std::uint8_t junk[] = {'j', 'u', 'n', 'k'};
+
+        if (!writeFile(path, junk, sizeof junk, O_TRUNC)) {
+            std::cerr << "Cannot write packet index file.\n";
+            return;
+        }
+
+        file2 = openIndexFile(path, traceType, otherMetadata, dsPath);
+
+        if (!file2->wasUpdated() || !checkEntries(*file2, index, index.size())) {
+            std::cerr << "Unexpected packet index file rebuilt from an invalid one.\n";
+            return;
+        }
+
+        ret = 0;
+    }();
+
+    unlink(path.c_str());
+    unlink(dsPath.c_str());
+    rmdir(dirPath);
+    return ret;
+}
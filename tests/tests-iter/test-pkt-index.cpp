@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstring>
+#include <sstream>
+#include <iostream>
+
+#include <yactfr/yactfr.hpp>
+
+#include <mem-data-src-factory.hpp>
+
+static const auto metadata =
+    "/* CTF 1.8 */\n"
+    "typealias integer { size = 8; } := u8;"
+    "typealias integer { size = 16; } := u16;"
+    "trace {"
+    "  major = 1;"
+    "  minor = 8;"
+    "  byte_order = be;"
+    "  packet.header := struct {"
+    "    u8 stream_id;"
+    "    u8 stream_instance_id;"
+    "  };"
+    "};"
+    "clock {"
+    "  name = clk;"
+    "  freq = 1000;"
+    "};"
+    "typealias integer { size = 8; map = clock.clk.value; } := ts8;"
+    "stream {"
+    "  id = 0;"
+    "  packet.context := struct {"
+    "    u16 packet_size;"
+    "    u16 content_size;"
+    "    ts8 timestamp_begin;"
+    "    ts8 timestamp_end;"
+    "    u8 packet_seq_num;"
+    "    u8 events_discarded;"
+    "  };"
+    "  event.header := struct {"
+    "    u8 id;"
+    "  };"
+    "};"
+    "stream {"
+    "  id = 1;"
+    "  packet.context := struct {"
+    "    u16 packet_size;"
+    "    u16 content_size;"
+    "  };"
+    "  event.header := struct {"
+    "    u8 id;"
+    "  };"
+    "};"
+    "event {"
+    "  stream_id = 0;"
+    "  id = 0;"
+    "  fields := struct {"
+    "    u8 x;"
+    "  };"
+    "};"
+    "event {"
+    "  stream_id = 1;"
+    "  id = 0;"
+    "  fields := struct {"
+    "    u8 x;"
+    "  };"
+    "};";
+
+static const std::uint8_t stream[] = {
+    // packet header
+    0x00, 0x05,
+
+    // packet context
+    0x00, 0x80, 0x00, 0x60, 0x12, 0x34, 0x00, 0x02,
+
+    /*
+     * Event record with an unknown type: the packet index never decodes
+     * event records.
+     */
+    0xff, 0x17,
+
+    // padding
+    0x00, 0x00, 0x00, 0x00,
+
+    // packet header
+    0x01, 0x07,
+
+    // packet context
+    0x00, 0x50, 0x00, 0x50,
+
+    // event record
+    0x00, 0x2a,
+
+    // event record
+    0x00, 0x2b,
+
+    // packet header
+    0x00, 0x05,
+
+    // packet context
+    0x00, 0x60, 0x00, 0x50, 0x34, 0x56, 0x01, 0x03,
+
+    // padding
+    0x00, 0x00,
+};
+
+static const auto expected =
+    "@0 T128 C96 DST0 DS5 SN0 DERCS2 B18 E52\n"
+    "@16 T80 C80 DST1 DS7\n"
+    "@26 T96 C80 DST0 DS5 SN1 DERCS3 B52 E86\n";
+
+template <typename T>
+static void printOpt(std::ostream& os, const char * const prefix, const T& val)
+{
+    if (val) {
+        os << ' ' << prefix << *val;
+    }
+}
+
+static const char *findEntry(const yactfr::PacketIndex& index, const yactfr::Index offset)
+{
+    const auto entry = index.findEntry(offset);
+
+    if (!entry) {
+        return "none";
+    }
+
+    return entry == &index[0] ? "0" : entry == &index[1] ? "1" : "2";
+}
+
+int main()
+{
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadata,
+                                                              metadata + std::strlen(metadata));
+    MemDataSrcFactory factory {stream, sizeof stream, 3};
+    const yactfr::PacketIndex index {*traceTypeMsUuidPair.first, factory};
+    std::ostringstream ss;
+
+    for (auto& entry : index) {
+        ss << '@' << entry.offsetInElementSequence();
+        printOpt(ss, "T", entry.expectedTotalLength());
+        printOpt(ss, "C", entry.expectedContentLength());
+
+        if (entry.dataStreamType()) {
+            ss << " DST" << entry.dataStreamType()->id();
+        }
+
+        printOpt(ss, "DS", entry.dataStreamId());
+        printOpt(ss, "SN", entry.sequenceNumber());
+        printOpt(ss, "DERCS", entry.discardedEventRecordCounterSnapshot());
+        printOpt(ss, "B", entry.beginningDefaultClockValue());
+        printOpt(ss, "E", entry.endDefaultClockValue());
+        ss << '\n';
+    }
+
+    if (ss.str() != expected) {
+        std::cerr << "Expected:\n\n" << expected << "\n" <<
+                     "Got:\n\n" << ss.str();
+        return 1;
+    }
+
+    std::ostringstream findSs;
+
+    for (const yactfr::Index offset : {0, 15, 16, 25, 26, 37, 38, 1000}) {
+        findSs << findEntry(index, offset) << ' ';
+    }
+
+    if (findSs.str() != "0 0 1 1 2 2 none none ") {
+        std::cerr << "Unexpected entry lookup result: " << findSs.str() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
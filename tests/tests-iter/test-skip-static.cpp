@@ -0,0 +1,344 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstring>
+#include <sstream>
+#include <iostream>
+
+#include <yactfr/yactfr.hpp>
+
+#include <mem-data-src-factory.hpp>
+#include <elem-printer.hpp>
+
+static const auto metadata =
+    "/* CTF 1.8 */\n"
+    "typealias integer { size = 8; } := u8;"
+    "typealias integer { size = 16; } := u16;"
+    "typealias integer { size = 32; } := u32;"
+    "typealias integer { size = 8; encoding = UTF8; } := ch;"
+    "trace {"
+    "  major = 1;"
+    "  minor = 8;"
+    "  byte_order = be;"
+    "};"
+    "event {"
+    "  fields := struct {"
+    "    u8 len;"
+    "    struct {"
+    "      u16 x;"
+    "      u8 arr[3];"
+    "      ch str[2];"
+    "      struct {"
+    "        u32 z;"
+    "      } inner;"
+    "    } s;"
+    "    struct {"
+    "      u8 p;"
+    "      u16 q;"
+    "    } items[len];"
+    "    u8 b;"
+    "  };"
+    "};";
+
+static const std::uint8_t stream[] = {
+    // event record: skip structure `s` from its beginning
+    0x02,
+    0x01, 0x02, 0x03, 0x04, 0x05, 'h', 'i', 0x06, 0x07, 0x08, 0x09,
+    0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+    0x10,
+
+    // event record: skip payload scope from its `len` member
+    0x01,
+    0x11, 0x12, 0x13, 0x14, 0x15, 'j', 'k', 0x16, 0x17, 0x18, 0x19,
+    0x1a, 0x1b, 0x1c,
+    0x1d,
+
+    // event record: skip payload scope from its beginning
+    0x03,
+    0x21, 0x22, 0x23, 0x24, 0x25, 'l', 'm', 0x26, 0x27, 0x28, 0x29,
+    0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32,
+    0x33,
+};
+
+/*
+ * The fixed-length bit arrays of structure `s` don't have the same byte
+ * order: the VM must decode it to report the byte order change within
+ * a byte.
+ */
+static const auto boMetadata =
+    "/* CTF 1.8 */\n"
+    "typealias integer { size = 8; } := u8;"
+    "typealias integer { size = 4; byte_order = le; } := le4;"
+    "typealias integer { size = 4; byte_order = be; } := be4;"
+    "trace {"
+    "  major = 1;"
+    "  minor = 8;"
+    "  byte_order = be;"
+    "};"
+    "event {"
+    "  fields := struct {"
+    "    struct {"
+    "      u8 a;"
+    "      le4 b;"
+    "      be4 c;"
+    "    } s;"
+    "  };"
+    "};";
+
+static const std::uint8_t boStream[] = {
+    0x01, 0x23,
+};
+
+/*
+ * The static length of structure `s` (2^32 + 16 bits) doesn't fit 32
+ * bits: skipping it must go beyond the data like decoding it does.
+ */
+static const auto bigMetadata =
+    "/* CTF 1.8 */\n"
+    "typealias integer { size = 8; } := u8;"
+    "trace {"
+    "  major = 1;"
+    "  minor = 8;"
+    "  byte_order = be;"
+    "};"
+    "event {"
+    "  fields := struct {"
+    "    struct {"
+    "      u8 a;"
+    "      u8 arr[0x20000000];"
+    "      u8 b;"
+    "    } s;"
+    "  };"
+    "};";
+
+static const std::uint8_t bigStream[] = {
+    0x01, 0x02, 0x03,
+};
+
+static const auto expected =
+    "P {\n"
+    "PC {\n"
+    "DSI:T0\n"
+    "PI\n"
+    "ER {\n"
+    "ERI:T0\n"
+    "SC:5 {\n"
+    "ST {\n"
+    "FLUI:len:2\n"
+    "ST:s {\n"
+    "}\n"
+    "DLA:items {\n"
+    "ST {\n"
+    "FLUI:p:10\n"
+    "FLUI:q:2828\n"
+    "}\n"
+    "ST {\n"
+    "FLUI:p:13\n"
+    "FLUI:q:3599\n"
+    "}\n"
+    "}\n"
+    "FLUI:b:16\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "ER {\n"
+    "ERI:T0\n"
+    "SC:5 {\n"
+    "ST {\n"
+    "FLUI:len:1\n"
+    "}\n"
+    "}\n"
+    "ER {\n"
+    "ERI:T0\n"
+    "SC:5 {\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "}\n";
+
+/*
+ * Decodes `stream` with data blocks of at most `maxDataBlkSize` bytes,
+ * skipping parts of it, and returns the printed elements.
+ *
+ * If `checkEq` is true, then also checks that, after each skip, the
+ * iterator is equal to a copy of it which went through all the skipped
+ * elements one by one. Sets `eqOk` to false if this check fails.
+ */
+static std::string decode(const yactfr::TraceType& traceType, const std::size_t maxDataBlkSize,
+                          const bool checkEq, bool& eqOk)
+{
+    MemDataSrcFactory factory {stream, sizeof stream, maxDataBlkSize};
+    yactfr::ElementSequence seq {traceType, factory};
+    std::ostringstream ss;
+    ElemPrinter printer {ss, 0};
+    yactfr::Index erIndex = 0;
+    yactfr::Index structIndex = 0;
+
+    const auto skip = [&](yactfr::ElementSequenceIterator& it, const bool scope) {
+        const auto walkIt = it;
+
+        if (scope) {
+            it.skipCurrentScope();
+        } else {
+            it.skipCurrentStructure();
+        }
+
+        it->accept(printer);
+
+        if (!checkEq) {
+            return;
+        }
+
+        auto otherIt = walkIt;
+
+        while (otherIt != it) {
+            ++otherIt;
+
+            if (otherIt == seq.end() || otherIt.offset() > it.offset()) {
+                eqOk = false;
+                return;
+            }
+        }
+    };
+
+    for (auto it = seq.begin(); it != seq.end(); ++it) {
+        it->accept(printer);
+
+        switch (it->kind()) {
+        case yactfr::Element::Kind::EVENT_RECORD_BEGINNING:
+            ++erIndex;
+            structIndex = 0;
+            break;
+
+        case yactfr::Element::Kind::SCOPE_BEGINNING:
+            if (erIndex == 3) {
+                skip(it, true);
+            }
+
+            break;
+
+        case yactfr::Element::Kind::STRUCTURE_BEGINNING:
+            if (erIndex == 1 && structIndex == 1) {
+                skip(it, false);
+            }
+
+            ++structIndex;
+            break;
+
+        case yactfr::Element::Kind::FIXED_LENGTH_UNSIGNED_INTEGER:
+            if (erIndex == 2) {
+                skip(it, true);
+            }
+
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return ss.str();
+}
+
+/*
+ * Returns whether or not skipping structure `s` of `boStream` throws
+ * like decoding it does.
+ */
+static bool skipThrowsBoChange()
+{
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(boMetadata,
+                                                              boMetadata + std::strlen(boMetadata));
+    MemDataSrcFactory factory {boStream, sizeof boStream, sizeof boStream};
+    yactfr::ElementSequence seq {*traceTypeMsUuidPair.first, factory};
+    yactfr::Index structIndex = 0;
+
+    for (auto it = seq.begin(); it != seq.end(); ++it) {
+        if (it->kind() != yactfr::Element::Kind::STRUCTURE_BEGINNING) {
+            continue;
+        }
+
+        if (structIndex == 1) {
+            try {
+                it.skipCurrentStructure();
+            } catch (const yactfr::ByteOrderChangeWithinByteDecodingError&) {
+                return true;
+            }
+
+            return false;
+        }
+
+        ++structIndex;
+    }
+
+    return false;
+}
+
+/*
+ * Returns whether or not skipping structure `s` of `bigStream` throws
+ * like decoding it does.
+ */
+static bool skipThrowsBigLen()
+{
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(bigMetadata,
+                                                              bigMetadata + std::strlen(bigMetadata));
+    MemDataSrcFactory factory {bigStream, sizeof bigStream, sizeof bigStream};
+    yactfr::ElementSequence seq {*traceTypeMsUuidPair.first, factory};
+    yactfr::Index structIndex = 0;
+
+    for (auto it = seq.begin(); it != seq.end(); ++it) {
+        if (it->kind() != yactfr::Element::Kind::STRUCTURE_BEGINNING) {
+            continue;
+        }
+
+        if (structIndex == 1) {
+            try {
+                it.skipCurrentStructure();
+            } catch (const yactfr::DecodingError&) {
+                return true;
+            }
+
+            return false;
+        }
+
+        ++structIndex;
+    }
+
+    return false;
+}
+
+int main()
+{
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadata,
+                                                              metadata + std::strlen(metadata));
+    auto eqOk = true;
+    const auto smallBlksStr = decode(*traceTypeMsUuidPair.first, 5, true, eqOk);
+    const auto bigBlksStr = decode(*traceTypeMsUuidPair.first, sizeof stream, true, eqOk);
+    const auto boOk = skipThrowsBoChange();
+    const auto bigLenOk = skipThrowsBigLen();
+
+    if (smallBlksStr == expected && bigBlksStr == expected && eqOk && boOk && bigLenOk) {
+        return 0;
+    }
+
+    std::cerr << "Expected:\n\n" << expected << "\n" <<
+                 "Got (small data blocks):\n\n" << smallBlksStr << "\n" <<
+                 "Got (big data blocks):\n\n" << bigBlksStr << "\n";
+
+    if (!eqOk) {
+        std::cerr << "Skipping iterator isn't equal to walking iterator.\n";
+    }
+
+    if (!boOk) {
+        std::cerr << "Skipping doesn't report a byte order change within a byte.\n";
+    }
+
+    if (!bigLenOk) {
+        std::cerr << "Skipping doesn't go beyond the data with a length of 2^32 bits or more.\n";
+    }
+
+    return 1;
+}
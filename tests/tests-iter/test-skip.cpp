@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstring>
+#include <sstream>
+#include <iostream>
+
+#include <yactfr/yactfr.hpp>
+
+#include <mem-data-src-factory.hpp>
+#include <elem-printer.hpp>
+
+static const auto metadata =
+    "/* CTF 1.8 */\n"
+    "typealias integer { size = 8; } := u8;"
+    "typealias integer { size = 16; } := u16;"
+    "trace {"
+    "  major = 1;"
+    "  minor = 8;"
+    "  byte_order = be;"
+    "};"
+    "event {"
+    "  context := struct {"
+    "    u8 len;"
+    "  };"
+    "  fields := struct {"
+    "    string a;"
+    "    struct {"
+    "      u8 x;"
+    "      u16 y[event.context.len];"
+    "      struct {"
+    "        u8 z;"
+    "      } inner;"
+    "    } s;"
+    "    u8 b;"
+    "  };"
+    "};";
+
+static const std::uint8_t stream[] = {
+    // event record: skip to event record end
+    0x02,
+    'a', 'b', 'c', 0,
+    0x01, 0x00, 0x02, 0x00, 0x03, 0x04,
+    0x05,
+
+    // event record: skip specific context and payload scopes
+    0x01,
+    'd', 0,
+    0x11, 0x00, 0x12, 0x13,
+    0x14,
+
+    // event record: skip structure `s` from its beginning
+    0x00,
+    0,
+    0x21, 0x22,
+    0x23,
+
+    // event record: skip structure `s` from its `x` member
+    0x01,
+    'e', 'f', 0,
+    0x31, 0x00, 0x32, 0x33,
+    0x34,
+};
+
+static const auto expected =
+    "P {\n"
+    "PC {\n"
+    "DSI:T0\n"
+    "PI\n"
+    "ER {\n"
+    "}\n"
+    "ER {\n"
+    "ERI:T0\n"
+    "SC:4 {\n"
+    "}\n"
+    "SC:5 {\n"
+    "}\n"
+    "}\n"
+    "ER {\n"
+    "ERI:T0\n"
+    "SC:4 {\n"
+    "ST {\n"
+    "FLUI:len:0\n"
+    "}\n"
+    "}\n"
+    "SC:5 {\n"
+    "ST {\n"
+    "NTS:a {\n"
+    "SS:1:\n"
+    "}\n"
+    "ST:s {\n"
+    "}\n"
+    "FLUI:b:35\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "ER {\n"
+    "ERI:T0\n"
+    "SC:4 {\n"
+    "ST {\n"
+    "FLUI:len:1\n"
+    "}\n"
+    "}\n"
+    "SC:5 {\n"
+    "ST {\n"
+    "NTS:a {\n"
+    "SS:2:ef\n"
+    "SS:1:\n"
+    "}\n"
+    "ST:s {\n"
+    "FLUI:x:49\n"
+    "}\n"
+    "FLUI:b:52\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "}\n"
+    "}\n";
+
+int main()
+{
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadata,
+                                                              metadata + std::strlen(metadata));
+    MemDataSrcFactory factory {stream, sizeof stream, 3};
+    yactfr::ElementSequence seq {*traceTypeMsUuidPair.first, factory};
+    std::ostringstream ss;
+    ElemPrinter printer {ss, 0};
+    yactfr::Index erIndex = 0;
+
+    for (auto it = seq.begin(); it != seq.end(); ++it) {
+        it->accept(printer);
+
+        switch (it->kind()) {
+        case yactfr::Element::Kind::EVENT_RECORD_BEGINNING:
+            if (erIndex == 0) {
+                it.skipToEventRecordEnd();
+                it->accept(printer);
+            }
+
+            ++erIndex;
+            break;
+
+        case yactfr::Element::Kind::SCOPE_BEGINNING:
+            if (erIndex == 2) {
+                it.skipCurrentScope();
+                it->accept(printer);
+            }
+
+            break;
+
+        case yactfr::Element::Kind::STRUCTURE_BEGINNING:
+            if (erIndex == 3 && it.offset() == 176) {
+                it.skipCurrentStructure();
+                it->accept(printer);
+            }
+
+            break;
+
+        case yactfr::Element::Kind::FIXED_LENGTH_UNSIGNED_INTEGER:
+            if (erIndex == 4 && it.offset() == 232) {
+                it.skipCurrentStructure();
+                it->accept(printer);
+            }
+
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    if (ss.str() == expected) {
+        return 0;
+    }
+
+    std::cerr << "Expected:\n\n" << expected << "\n" <<
+                 "Got:\n\n" << ss.str();
+    return 1;
+}
@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iostream>
+
+#include <yactfr/yactfr.hpp>
+
+#include <mem-data-src-factory.hpp>
+#include <elem-printer.hpp>
+
+/*
+ * The payload scope contains two runs of standard fixed-length
+ * integers: the alignment of `g` breaks the first one, and `i` needs
+ * padding within the second one.
+ */
+static const auto metadata =
+    "/* CTF 1.8 */\n"
+    "typealias integer { size = 8; } := u8;"
+    "typealias integer { size = 16; byte_order = le; } := le16;"
+    "typealias integer { size = 32; signed = true; } := s32;"
+    "typealias integer { size = 64; } := u64;"
+    "typealias integer { size = 32; align = 32; } := a32;"
+    "typealias integer { size = 16; align = 16; } := a16;"
+    "typealias enum : integer { size = 8; } { A = 1, B = 2 } := e8;"
+    "trace {"
+    "  major = 1;"
+    "  minor = 8;"
+    "  byte_order = be;"
+    "};"
+    "event {"
+    "  fields := struct {"
+    "    u8 a;"
+    "    le16 b;"
+    "    s32 c;"
+    "    u64 d;"
+    "    e8 e;"
+    "    u8 f;"
+    "    a32 g;"
+    "    u8 h;"
+    "    a16 i;"
+    "  };"
+    "};";
+
+static const std::uint8_t stream[] = {
+    // event record
+    0x01,
+    0x02, 0x03,
+    0xff, 0xff, 0xff, 0xfe,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00,
+    0x02,
+    0x07,
+    0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x2a,
+    0x08,
+    0x00,
+    0x01, 0x00,
+
+    // event record
+    0x11,
+    0x12, 0x13,
+    0x80, 0x00, 0x00, 0x00,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0x01,
+    0x17,
+    0x00, 0x00, 0x00,
+    0x18, 0x19, 0x1a, 0x1b,
+    0x1c,
+    0x00,
+    0x1d, 0x1e,
+};
+
+static const auto expectedStr =
+    "0 P {\n"
+    "0 PC {\n"
+    "0 DSI:T0\n"
+    "0 PI\n"
+    "0 ER {\n"
+    "0 ERI:T0\n"
+    "0 SC:5 {\n"
+    "0 ST {\n"
+    "0 FLUI:a:1\n"
+    "8 FLUI:b:770\n"
+    "24 FLSI:c:-2\n"
+    "56 FLUI:d:256\n"
+    "120 FLUE:e:2\n"
+    "128 FLUI:f:7\n"
+    "160 FLUI:g:42\n"
+    "192 FLUI:h:8\n"
+    "208 FLUI:i:256\n"
+    "224 }\n"
+    "224 }\n"
+    "224 }\n"
+    "224 ER {\n"
+    "224 ERI:T0\n"
+    "224 SC:5 {\n"
+    "224 ST {\n"
+    "224 FLUI:a:17\n"
+    "232 FLUI:b:4882\n"
+    "248 FLSI:c:-2147483648\n"
+    "280 FLUI:d:18446744073709551615\n"
+    "344 FLUE:e:1\n"
+    "352 FLUI:f:23\n"
+    "384 FLUI:g:404298267\n"
+    "416 FLUI:h:28\n"
+    "432 FLUI:i:7454\n"
+    "448 }\n"
+    "448 }\n"
+    "448 }\n"
+    "448 }\n"
+    "448 }\n";
+
+/*
+ * An element and its offset within the element sequence.
+ */
+struct Entry
+{
+    yactfr::Index offset;
+    std::string str;
+};
+
+static std::vector<Entry> entries(yactfr::ElementSequenceIterator it,
+                                  const yactfr::ElementSequenceIterator& end)
+{
+    std::vector<Entry> entries;
+
+    while (it != end) {
+        std::ostringstream ss;
+        ElemPrinter printer {ss, 0};
+
+        it->accept(printer);
+        entries.push_back({it.offset(), ss.str()});
+        ++it;
+    }
+
+    return entries;
+}
+
+static bool operator==(const Entry& left, const Entry& right)
+{
+    return left.offset == right.offset && left.str == right.str;
+}
+
+static std::string str(const std::vector<Entry>& entries)
+{
+    std::ostringstream ss;
+
+    for (auto& entry : entries) {
+        ss << entry.offset << ' ' << entry.str;
+    }
+
+    return ss.str();
+}
+
+/*
+ * Checks that, for each element, a copy of the iterator and a restored
+ * position give the same remaining entries as `expected`.
+ */
+static bool checkCopiesAndPositions(yactfr::ElementSequence& seq,
+                                    const std::vector<Entry>& expected)
+{
+    std::size_t index = 0;
+
+    for (auto it = seq.begin(); it != seq.end(); ++it, ++index) {
+        const std::vector<Entry> expectedRest {expected.begin() + index, expected.end()};
+        auto itCopy = it;
+
+        if (entries(itCopy, seq.end()) != expectedRest) {
+            return false;
+        }
+
+        yactfr::ElementSequenceIteratorPosition pos;
+
+        it.savePosition(pos);
+
+        auto otherIt = seq.begin();
+
+        otherIt.restorePosition(pos);
+
+        if (entries(otherIt, seq.end()) != expectedRest) {
+            return false;
+        }
+    }
+
+    return index == expected.size();
+}
+
+int main()
+{
+    const auto traceTypeMsUuidPair = yactfr::fromMetadataText(metadata,
+                                                              metadata + std::strlen(metadata));
+    auto& traceType = *traceTypeMsUuidPair.first;
+    MemDataSrcFactory refFactory {stream, sizeof stream};
+    yactfr::ElementSequence refSeq {traceType, refFactory};
+    const auto expected = entries(refSeq.begin(), refSeq.end());
+    auto ok = true;
+
+    /*
+     * With small data blocks, the VM decodes some runs member by member
+     * instead of all at once: the results must be the same.
+     */
+    for (std::size_t maxDataBlkSize = 1; maxDataBlkSize <= sizeof stream; ++maxDataBlkSize) {
+        MemDataSrcFactory factory {stream, sizeof stream, maxDataBlkSize};
+        yactfr::ElementSequence seq {traceType, factory};
+        const auto result = entries(seq.begin(), seq.end());
+
+        if (result != expected) {
+            std::cerr << "With data blocks of " << maxDataBlkSize << " bytes:\n\n" <<
+                         str(result) << "\nExpected:\n\n" << str(expected);
+            ok = false;
+        }
+    }
+
+    if (!checkCopiesAndPositions(refSeq, expected)) {
+        std::cerr << "Copying an iterator or restoring a position within a run doesn't "
+                     "give the same elements.\n";
+        ok = false;
+    }
+
+    if (str(expected) != expectedStr) {
+        std::cerr << "Expected:\n\n" << expectedStr << "\nGot:\n\n" << str(expected);
+        ok = false;
+    }
+
+    return ok ? 0 : 1;
+}
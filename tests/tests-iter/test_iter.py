@@ -7,6 +7,10 @@ def iter_executor(executor):
     return functools.partial(executor, 'iter')
 
 
+def test_array_sections(iter_executor):
+    iter_executor('array-sections')
+
+
 def test_cmp(iter_executor):
     iter_executor('cmp')
 
@@ -29,3 +33,47 @@ def test_move_ctor(iter_executor):
 
 def test_seek_packet(iter_executor):
     iter_executor('seek-packet')
+
+
+def test_skip(iter_executor):
+    iter_executor('skip')
+
+
+def test_skip_static(iter_executor):
+    iter_executor('skip-static')
+
+
+def test_er_filter(iter_executor):
+    iter_executor('er-filter')
+
+
+def test_elem_kinds(iter_executor):
+    iter_executor('elem-kinds')
+
+
+def test_data_proj(iter_executor):
+    iter_executor('data-proj')
+
+
+def test_batch(iter_executor):
+    iter_executor('batch')
+
+
+def test_er_cols(iter_executor):
+    iter_executor('er-cols')
+
+
+def test_pkt_index(iter_executor):
+    iter_executor('pkt-index')
+
+
+def test_pkt_index_file(iter_executor):
+    iter_executor('pkt-index-file')
+
+
+def test_par_pkt_decoder(iter_executor):
+    iter_executor('par-pkt-decoder')
+
+
+def test_std_fl_int_runs(iter_executor):
+    iter_executor('std-fl-int-runs')
@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstring>
+#include <cerrno>
+#include <sstream>
+#include <algorithm>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <yactfr/buf-file-data-src-factory.hpp>
+#include <yactfr/io-error.hpp>
+
+#include "internal/buf-file-data-src-factory-impl.hpp"
+#include "internal/utils.hpp"
+
+namespace yactfr {
+namespace internal {
+
+class BufferedFileDataSource final :
+    public DataSource
+{
+public:
+    explicit BufferedFileDataSource(std::shared_ptr<internal::BufFileDataSrcFactoryImpl> bufFileDataSrcFactoryImpl);
+    ~BufferedFileDataSource();
+
+private:
+    boost::optional<DataBlock> _data(Index offset, Size minSize) override;
+    Size _read(Index offset);
+
+private:
+    std::shared_ptr<internal::BufFileDataSrcFactoryImpl> _bufFileDataSrcFactoryImpl;
+    std::unique_ptr<BufFileDataSrcBuf> _buf;
+
+    // current block: first byte, offset within the file, and size
+    const std::uint8_t *_blkBegin = nullptr;
+    Index _blkOffset = 0;
+    Size _blkSize = 0;
+};
+
+BufferedFileDataSource::BufferedFileDataSource(std::shared_ptr<internal::BufFileDataSrcFactoryImpl> bufFileDataSrcFactoryImpl) :
+    _bufFileDataSrcFactoryImpl {bufFileDataSrcFactoryImpl},
+    _buf {bufFileDataSrcFactoryImpl->takeBuf()}
+{
+}
+
+BufferedFileDataSource::~BufferedFileDataSource()
+{
+    _bufFileDataSrcFactoryImpl->giveBackBuf(std::move(_buf));
+}
+
+boost::optional<DataBlock> BufferedFileDataSource::_data(const Index offset, const Size minSize)
+{
+    if ((offset + minSize) > _bufFileDataSrcFactoryImpl->fileSize()) {
+        // no more data
+        return boost::none;
+    }
+
+    const auto blkEndOffset = _blkOffset + _blkSize;
+
+    if (offset >= _blkOffset && (offset + minSize) <= blkEndOffset) {
+        // requested data is within the current block
+        const auto offsetFromBlkOffset = offset - _blkOffset;
+
+        return DataBlock {
+            static_cast<const void *>(_blkBegin + offsetFromBlkOffset),
+            _blkSize - offsetFromBlkOffset
+        };
+    }
+
+    const auto readArea = _buf->readArea();
+
+    if (_bufFileDataSrcFactoryImpl->cacheMode() == BufferedFileDataSourceFactory::CacheMode::DIRECT) {
+        /*
+         * Direct I/O: read the whole block which begins at the aligned
+         * offset preceding the requested offset. The block size is at
+         * least twice the alignment, so that this block contains the
+         * requested data.
+         */
+        const auto readOffset = offset & ~(_bufFileDataSrcFactoryImpl->alignment() - 1);
+        const auto skipSize = offset - readOffset;
+
+        _blkSize = 0;
+
+        const auto readSize = this->_read(readOffset);
+
+        _blkSize = readSize > skipSize ? readSize - skipSize : 0;
+        _blkBegin = readArea + skipSize;
+    } else if (offset >= _blkOffset && offset < blkEndOffset) {
+        /*
+         * We don't have enough buffered data to satisfy the requested
+         * minimum size.
+         *
+         * Move the available data to the end of the carry-over area,
+         * just before the read area, and read the following block into
+         * the read area.
+         */
+        const auto availSize = blkEndOffset - offset;
+
+        assert(availSize < minSize);
+        assert(availSize <= BufFileDataSrcBuf::carryOverSize);
+
+        const auto carryOverBegin = readArea - availSize;
+
+        std::memmove(carryOverBegin, _blkBegin + (offset - _blkOffset), availSize);
+        _blkSize = 0;
+        _blkSize = availSize + this->_read(blkEndOffset);
+        _blkBegin = carryOverBegin;
+    } else {
+        // requested offset is outside the current block
+        _blkSize = 0;
+        _blkSize = this->_read(offset);
+        _blkBegin = readArea;
+    }
+
+    _blkOffset = offset;
+
+    if (_blkSize < minSize) {
+        // file is shorter than when the factory opened it
+        return boost::none;
+    }
+
+    return DataBlock {static_cast<const void *>(_blkBegin), _blkSize};
+}
+
+Size BufferedFileDataSource::_read(const Index offset)
+{
+    const auto fileSize = _bufFileDataSrcFactoryImpl->fileSize();
+    const auto cacheMode = _bufFileDataSrcFactoryImpl->cacheMode();
+
+    /*
+     * With direct I/O, the size to read must also be aligned: read a
+     * whole block and stop at the end of the file.
+     */
+    const auto size = cacheMode == BufferedFileDataSourceFactory::CacheMode::DIRECT ?
+                      _buf->blockSize() : std::min(fileSize - offset, _buf->blockSize());
+    Size readSize = 0;
+
+    while (readSize < size && (offset + readSize) < fileSize) {
+        const auto ret = pread(_bufFileDataSrcFactoryImpl->fd(), _buf->readArea() + readSize,
+                               static_cast<size_t>(size - readSize),
+                               static_cast<off_t>(offset + readSize));
+
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            const auto error = internal::strError();
+            std::ostringstream ss;
+
+            ss << "Cannot read region [" << offset << ", " << (offset + size) <<
+                  "[ of file \"" << _bufFileDataSrcFactoryImpl->path() << "\": " << error;
+            throw IOError {ss.str()};
+        }
+
+        if (ret == 0) {
+            // end of file
+            break;
+        }
+
+        readSize += static_cast<Size>(ret);
+    }
+
+    if (cacheMode == BufferedFileDataSourceFactory::CacheMode::DROP_BEHIND && readSize > 0) {
+        /*
+         * This data source has its own copy of the block: drop the
+         * cached pages of the block, including its first partial page.
+         */
+        const auto dropOffset = offset & ~(_bufFileDataSrcFactoryImpl->alignment() - 1);
+
+        (void) posix_fadvise(_bufFileDataSrcFactoryImpl->fd(), static_cast<off_t>(dropOffset),
+                             static_cast<off_t>(offset + readSize - dropOffset),
+                             POSIX_FADV_DONTNEED);
+    }
+
+    return readSize;
+}
+
+} // namespace internal
+
+BufferedFileDataSourceFactory::BufferedFileDataSourceFactory(std::string path,
+                                                             const boost::optional<Size>& blockSize,
+                                                             const CacheMode cacheMode) :
+    _pimpl {
+        std::make_shared<internal::BufFileDataSrcFactoryImpl>(std::move(path), blockSize,
+                                                              cacheMode)
+    }
+{
+}
+
+Size BufferedFileDataSourceFactory::blockSize() const noexcept
+{
+    return _pimpl->blockSize();
+}
+
+BufferedFileDataSourceFactory::CacheMode BufferedFileDataSourceFactory::cacheMode() const noexcept
+{
+    return _pimpl->cacheMode();
+}
+
+DataSource::UP BufferedFileDataSourceFactory::_createDataSource()
+{
+    return std::make_unique<internal::BufferedFileDataSource>(_pimpl);
+}
+
+} // namespace yactfr
@@ -0,0 +1,260 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <yactfr/elem-batch.hpp>
+#include <yactfr/metadata/dst.hpp>
+#include <yactfr/metadata/ert.hpp>
+
+namespace yactfr {
+namespace {
+
+template <typename ElemT>
+const ElemT& elemAs(const Element& elem) noexcept
+{
+    return static_cast<const ElemT&>(elem);
+}
+
+template <typename ElemT>
+void setDataType(ElementBatch::Record& record, const Element& elem) noexcept
+{
+    record.dataType = &elemAs<ElemT>(elem).dataType();
+}
+
+} // namespace
+
+void ElementBatch::_clear() noexcept
+{
+    _records.clear();
+    _sectionData.clear();
+}
+
+void ElementBatch::_append(const Element& elem, const Index offset)
+{
+    _records.push_back(Record {});
+
+    auto& record = _records.back();
+
+    record.kind = elem.kind();
+    record.offset = offset;
+    record.dataType = nullptr;
+    record.unsignedIntegerValue = 0;
+
+    /*
+     * Switch on the kind instead of visiting the element: this is
+     * called for each element which a VM emits while filling a batch.
+     */
+    using K = Element::Kind;
+
+    switch (elem.kind()) {
+    case K::SCOPE_BEGINNING:
+        record.unsignedIntegerValue = static_cast<unsigned long long>(elemAs<ScopeBeginningElement>(elem).scope());
+        break;
+
+    case K::SCOPE_END:
+        record.unsignedIntegerValue = static_cast<unsigned long long>(elemAs<ScopeEndElement>(elem).scope());
+        break;
+
+    case K::PACKET_MAGIC_NUMBER:
+        record.unsignedIntegerValue = elemAs<PacketMagicNumberElement>(elem).value();
+        break;
+
+    case K::DEFAULT_CLOCK_VALUE:
+        record.unsignedIntegerValue = elemAs<DefaultClockValueElement>(elem).cycles();
+        break;
+
+    case K::DATA_STREAM_INFO:
+    {
+        const auto dst = elemAs<DataStreamInfoElement>(elem).type();
+
+        if (dst) {
+            record.unsignedIntegerValue = dst->id();
+        }
+
+        break;
+    }
+
+    case K::EVENT_RECORD_INFO:
+    {
+        const auto ert = elemAs<EventRecordInfoElement>(elem).type();
+
+        if (ert) {
+            record.unsignedIntegerValue = ert->id();
+        }
+
+        break;
+    }
+
+    case K::FIXED_LENGTH_BIT_ARRAY:
+        setDataType<FixedLengthBitArrayElement>(record, elem);
+        record.unsignedIntegerValue = elemAs<FixedLengthBitArrayElement>(elem).unsignedIntegerValue();
+        break;
+
+    case K::FIXED_LENGTH_BOOLEAN:
+        setDataType<FixedLengthBooleanElement>(record, elem);
+        record.unsignedIntegerValue = elemAs<FixedLengthBooleanElement>(elem).value() ? 1 : 0;
+        break;
+
+    case K::FIXED_LENGTH_SIGNED_INTEGER:
+    case K::FIXED_LENGTH_SIGNED_ENUMERATION:
+        setDataType<FixedLengthSignedIntegerElement>(record, elem);
+        record.signedIntegerValue = elemAs<FixedLengthSignedIntegerElement>(elem).value();
+        break;
+
+    case K::FIXED_LENGTH_UNSIGNED_INTEGER:
+    case K::FIXED_LENGTH_UNSIGNED_ENUMERATION:
+        setDataType<FixedLengthUnsignedIntegerElement>(record, elem);
+        record.unsignedIntegerValue = elemAs<FixedLengthUnsignedIntegerElement>(elem).value();
+        break;
+
+    case K::FIXED_LENGTH_FLOATING_POINT_NUMBER:
+        setDataType<FixedLengthFloatingPointNumberElement>(record, elem);
+        record.floatingPointNumberValue = elemAs<FixedLengthFloatingPointNumberElement>(elem).value();
+        break;
+
+    case K::VARIABLE_LENGTH_SIGNED_INTEGER:
+    case K::VARIABLE_LENGTH_SIGNED_ENUMERATION:
+        setDataType<VariableLengthSignedIntegerElement>(record, elem);
+        record.signedIntegerValue = elemAs<VariableLengthSignedIntegerElement>(elem).value();
+        break;
+
+    case K::VARIABLE_LENGTH_UNSIGNED_INTEGER:
+    case K::VARIABLE_LENGTH_UNSIGNED_ENUMERATION:
+        setDataType<VariableLengthUnsignedIntegerElement>(record, elem);
+        record.unsignedIntegerValue = elemAs<VariableLengthUnsignedIntegerElement>(elem).value();
+        break;
+
+    case K::NULL_TERMINATED_STRING_BEGINNING:
+        setDataType<NullTerminatedStringBeginningElement>(record, elem);
+        break;
+
+    case K::NULL_TERMINATED_STRING_END:
+        setDataType<NullTerminatedStringEndElement>(record, elem);
+        break;
+
+    case K::SUBSTRING:
+    {
+        const auto& substrElem = elemAs<SubstringElement>(elem);
+
+        this->_appendSection(record, reinterpret_cast<const std::uint8_t *>(substrElem.begin()),
+                             reinterpret_cast<const std::uint8_t *>(substrElem.end()));
+        break;
+    }
+
+    case K::BLOB_SECTION:
+    {
+        const auto& sectionElem = elemAs<BlobSectionElement>(elem);
+
+        this->_appendSection(record, sectionElem.begin(), sectionElem.end());
+        break;
+    }
+
+    case K::ARRAY_SECTION:
+    {
+        const auto& sectionElem = elemAs<ArraySectionElement>(elem);
+
+        this->_appendSection(record, sectionElem.begin(), sectionElem.end());
+        break;
+    }
+
+    case K::STATIC_LENGTH_ARRAY_BEGINNING:
+    case K::DYNAMIC_LENGTH_ARRAY_BEGINNING:
+        setDataType<ArrayBeginningElement>(record, elem);
+        record.unsignedIntegerValue = elemAs<ArrayBeginningElement>(elem).length();
+        break;
+
+    case K::STATIC_LENGTH_ARRAY_END:
+    case K::DYNAMIC_LENGTH_ARRAY_END:
+        setDataType<ArrayEndElement>(record, elem);
+        break;
+
+    case K::STATIC_LENGTH_STRING_BEGINNING:
+    case K::DYNAMIC_LENGTH_STRING_BEGINNING:
+        setDataType<NonNullTerminatedStringBeginningElement>(record, elem);
+        record.unsignedIntegerValue = elemAs<NonNullTerminatedStringBeginningElement>(elem).maximumLength();
+        break;
+
+    case K::STATIC_LENGTH_STRING_END:
+    case K::DYNAMIC_LENGTH_STRING_END:
+        setDataType<NonNullTerminatedStringEndElement>(record, elem);
+        break;
+
+    case K::STATIC_LENGTH_BLOB_BEGINNING:
+    case K::DYNAMIC_LENGTH_BLOB_BEGINNING:
+        setDataType<BlobBeginningElement>(record, elem);
+        record.unsignedIntegerValue = elemAs<BlobBeginningElement>(elem).length();
+        break;
+
+    case K::STATIC_LENGTH_BLOB_END:
+    case K::DYNAMIC_LENGTH_BLOB_END:
+        setDataType<BlobEndElement>(record, elem);
+        break;
+
+    case K::STRUCTURE_BEGINNING:
+        setDataType<StructureBeginningElement>(record, elem);
+        break;
+
+    case K::STRUCTURE_END:
+        setDataType<StructureEndElement>(record, elem);
+        break;
+
+    case K::VARIANT_WITH_SIGNED_INTEGER_SELECTOR_BEGINNING:
+    case K::VARIANT_WITH_UNSIGNED_INTEGER_SELECTOR_BEGINNING:
+        setDataType<VariantBeginningElement>(record, elem);
+        break;
+
+    case K::VARIANT_WITH_SIGNED_INTEGER_SELECTOR_END:
+    case K::VARIANT_WITH_UNSIGNED_INTEGER_SELECTOR_END:
+        setDataType<VariantEndElement>(record, elem);
+        break;
+
+    case K::OPTIONAL_WITH_BOOLEAN_SELECTOR_BEGINNING:
+    case K::OPTIONAL_WITH_SIGNED_INTEGER_SELECTOR_BEGINNING:
+    case K::OPTIONAL_WITH_UNSIGNED_INTEGER_SELECTOR_BEGINNING:
+        setDataType<OptionalBeginningElement>(record, elem);
+        break;
+
+    case K::OPTIONAL_WITH_BOOLEAN_SELECTOR_END:
+    case K::OPTIONAL_WITH_SIGNED_INTEGER_SELECTOR_END:
+    case K::OPTIONAL_WITH_UNSIGNED_INTEGER_SELECTOR_END:
+        setDataType<OptionalEndElement>(record, elem);
+        break;
+
+    default:
+        break;
+    }
+}
+
+void ElementBatch::_appendSection(Record& record, const std::uint8_t * const begin,
+                                  const std::uint8_t * const end)
+{
+    /*
+     * Only set the size of the section of the record: _finish() sets
+     * its beginning once the section data vector won't grow anymore.
+     */
+    _sectionData.insert(_sectionData.end(), begin, end);
+    record.section.size = end - begin;
+}
+
+void ElementBatch::_finish() noexcept
+{
+    /*
+     * Set the section beginnings now that the section data vector
+     * won't grow anymore.
+     */
+    Index sectionDataOffset = 0;
+
+    for (auto& record : _records) {
+        if (record.kind == Element::Kind::SUBSTRING ||
+                record.kind == Element::Kind::BLOB_SECTION ||
+                record.kind == Element::Kind::ARRAY_SECTION) {
+            record.section.begin = _sectionData.data() + sectionDataOffset;
+            sectionDataOffset += record.section.size;
+        }
+    }
+}
+
+} // namespace yactfr
@@ -6,6 +6,8 @@
  */
 
 #include <yactfr/elem-seq-it.hpp>
+#include <yactfr/elem-batch.hpp>
+#include <yactfr/elem-seq-opts.hpp>
 
 #include "internal/vm.hpp"
 #include "internal/metadata/trace-type-impl.hpp"
@@ -13,14 +15,18 @@
 namespace yactfr {
 
 ElementSequenceIterator::ElementSequenceIterator(DataSourceFactory& dataSrcFactory,
-                                                 const TraceType& traceType, const bool end) :
+                                                 const TraceType& traceType,
+                                                 std::shared_ptr<const ElementSequenceOptions> opts,
+                                                 const bool end) :
     _dataSrcFactory {&dataSrcFactory},
-    _traceType {&traceType}
+    _traceType {&traceType},
+    _opts {std::move(opts)}
 {
     if (end) {
         _offset = _END_OFFSET;
     } else {
-        _vm = std::make_unique<internal::Vm>(*_dataSrcFactory, traceType._pimpl->pktProc(), *this);
+        _vm = std::make_unique<internal::Vm>(*_dataSrcFactory, traceType._pimpl->pktProc(), *_opts,
+                                             *this);
         _vm->nextElem();
     }
 }
@@ -35,6 +41,7 @@ void ElementSequenceIterator::_resetOther(ElementSequenceIterator& other)
 ElementSequenceIterator::ElementSequenceIterator(const ElementSequenceIterator& other) :
     _dataSrcFactory {other._dataSrcFactory},
     _traceType {other._traceType},
+    _opts {other._opts},
     _offset {other._offset},
     _mark {other._mark}
 {
@@ -54,6 +61,7 @@ ElementSequenceIterator::ElementSequenceIterator(const ElementSequenceIterator&
 ElementSequenceIterator::ElementSequenceIterator(ElementSequenceIterator&& other) :
     _dataSrcFactory {other._dataSrcFactory},
     _traceType {other._traceType},
+    _opts {other._opts},
     _offset {other._offset},
     _mark {other._mark}
 {
@@ -82,6 +90,7 @@ ElementSequenceIterator& ElementSequenceIterator::operator=(const ElementSequenc
      */
     assert(_dataSrcFactory == other._dataSrcFactory);
     assert(_traceType == other._traceType);
+    assert(_opts == other._opts);
     _offset = other._offset;
     _mark = other._mark;
 
@@ -108,6 +117,7 @@ ElementSequenceIterator& ElementSequenceIterator::operator=(ElementSequenceItera
      */
     assert(_dataSrcFactory == other._dataSrcFactory);
     assert(_traceType == other._traceType);
+    assert(_opts == other._opts);
     _offset = other._offset;
     _mark = other._mark;
 
@@ -140,6 +150,44 @@ void ElementSequenceIterator::seekPacket(const Index offset)
     _vm->seekPkt(offset);
 }
 
+void ElementSequenceIterator::skipCurrentScope()
+{
+    assert(_offset != _END_OFFSET);
+    assert(_vm);
+    _vm->skipCurScope();
+}
+
+void ElementSequenceIterator::skipCurrentStructure()
+{
+    assert(_offset != _END_OFFSET);
+    assert(_vm);
+    _vm->skipCurStruct();
+}
+
+void ElementSequenceIterator::skipToEventRecordEnd()
+{
+    assert(_offset != _END_OFFSET);
+    assert(_vm);
+    _vm->skipToErEnd();
+}
+
+void ElementSequenceIterator::nextBatch(ElementBatch& batch, const Size maxCount)
+{
+    assert(_offset != _END_OFFSET);
+    assert(_vm);
+    assert(maxCount >= 1);
+    batch._clear();
+
+    try {
+        _vm->nextBatch(batch, maxCount);
+    } catch (...) {
+        batch._finish();
+        throw;
+    }
+
+    batch._finish();
+}
+
 void ElementSequenceIterator::savePosition(ElementSequenceIteratorPosition& pos) const
 {
     assert(_vm);
@@ -154,7 +202,7 @@ void ElementSequenceIterator::restorePosition(const ElementSequenceIteratorPosit
          * no VM. Create a new VM before restoring the VM's position.
          */
         _vm = std::make_unique<internal::Vm>(*_dataSrcFactory, _traceType->_pimpl->pktProc(),
-                                             *this);
+                                             *_opts, *this);
     }
 
     _vm->restorePos(pos);
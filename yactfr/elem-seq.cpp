@@ -5,15 +5,27 @@
  * of the MIT license. See the LICENSE file for details.
  */
 
+#include <algorithm>
+
 #include <yactfr/elem-seq.hpp>
+#include <yactfr/elem-seq-it-pos.hpp>
+#include <yactfr/pkt-index.hpp>
 #include <yactfr/metadata/trace-type.hpp>
+#include <yactfr/metadata/dst.hpp>
+#include <yactfr/metadata/clk-type.hpp>
 
 namespace yactfr {
 
-
 ElementSequence::ElementSequence(const TraceType& traceType, DataSourceFactory& dataSrcFactory) :
+    ElementSequence {traceType, dataSrcFactory, ElementSequenceOptions {}}
+{
+}
+
+ElementSequence::ElementSequence(const TraceType& traceType, DataSourceFactory& dataSrcFactory,
+                                 const ElementSequenceOptions& opts) :
     _traceType {&traceType},
-    _dataSrcFactory {&dataSrcFactory}
+    _dataSrcFactory {&dataSrcFactory},
+    _opts {std::make_shared<const ElementSequenceOptions>(opts)}
 {
 }
 
@@ -25,14 +37,154 @@ ElementSequence::Iterator ElementSequence::at(const Index offset)
     return it;
 }
 
+/*
+ * Returns the first packet of `pktIndex` which can contain an event
+ * record of which the default clock value is greater than or equal to
+ * `cycles`.
+ */
+static PacketIndex::ConstIterator firstCandidatePkt(const PacketIndex& pktIndex,
+                                                    const Cycles cycles)
+{
+    // last packet which begins at or before `cycles`
+    auto it = std::upper_bound(pktIndex.begin(), pktIndex.end(), cycles,
+                               [](const Cycles cycles, const PacketIndexEntry& entry) {
+        return cycles < entry.beginningDefaultClockValue().value_or(0);
+    });
+
+    if (it != pktIndex.begin()) {
+        --it;
+    }
+
+    // skip the packets which end before `cycles`
+    while (it != pktIndex.end() && it->endDefaultClockValue() &&
+            *it->endDefaultClockValue() < cycles) {
+        ++it;
+    }
+
+    return it;
+}
+
+/*
+ * Converts `nsFromOrigin` to a value of a clock described by
+ * `clkType`, rounding up.
+ */
+static Cycles cyclesFromNsFromOrigin(const ClockType& clkType, const long long nsFromOrigin)
+{
+    constexpr long long nsPerSec = 1'000'000'000LL;
+    const auto freq = static_cast<long long>(clkType.frequency());
+    auto secs = nsFromOrigin / nsPerSec;
+    auto ns = nsFromOrigin % nsPerSec;
+
+    if (ns < 0) {
+        ns += nsPerSec;
+        --secs;
+    }
+
+    const auto cyclesFromOrigin = secs * freq + (ns * freq + nsPerSec - 1) / nsPerSec;
+    const auto offsetCycles = clkType.offset().seconds() * freq +
+                              static_cast<long long>(clkType.offset().cycles());
+
+    if (cyclesFromOrigin <= offsetCycles) {
+        return 0;
+    }
+
+    return static_cast<Cycles>(cyclesFromOrigin - offsetCycles);
+}
+
+ElementSequence::Iterator ElementSequence::atTimestamp(const PacketIndex& pktIndex,
+                                                       const Cycles cycles)
+{
+    const auto pktIt = firstCandidatePkt(pktIndex, cycles);
+
+    if (pktIt == pktIndex.end()) {
+        return this->end();
+    }
+
+    auto it = this->at(pktIt->offsetInElementSequence());
+    const auto endIt = this->end();
+    ElementSequenceIteratorPosition erBeginPos;
+
+    // whether or not we're within the header of an event record
+    auto inErHeader = false;
+
+    while (it != endIt) {
+        switch (it->kind()) {
+        case Element::Kind::EVENT_RECORD_BEGINNING:
+            it.savePosition(erBeginPos);
+            inErHeader = true;
+            break;
+
+        case Element::Kind::DEFAULT_CLOCK_VALUE:
+            if (!inErHeader) {
+                break;
+            }
+
+            if (it->asDefaultClockValueElement().cycles() >= cycles) {
+                it.restorePosition(erBeginPos);
+                return it;
+            }
+
+            // too early: skip the data of this event record
+            inErHeader = false;
+            it.skipToEventRecordEnd();
+            break;
+
+        case Element::Kind::EVENT_RECORD_INFO:
+            // no default clock value
+            inErHeader = false;
+            break;
+
+        default:
+            break;
+        }
+
+        ++it;
+    }
+
+    return it;
+}
+
+ElementSequence::Iterator ElementSequence::atTimestamp(const Cycles cycles)
+{
+    return this->atTimestamp(this->_pktIndex(), cycles);
+}
+
+ElementSequence::Iterator ElementSequence::atNanosecondsFromOrigin(const PacketIndex& pktIndex,
+                                                                   const long long nsFromOrigin)
+{
+    for (auto& entry : pktIndex) {
+        if (entry.dataStreamType() && entry.dataStreamType()->defaultClockType()) {
+            return this->atTimestamp(pktIndex,
+                                     cyclesFromNsFromOrigin(*entry.dataStreamType()->defaultClockType(),
+                                                            nsFromOrigin));
+        }
+    }
+
+    return this->end();
+}
+
+ElementSequence::Iterator ElementSequence::atNanosecondsFromOrigin(const long long nsFromOrigin)
+{
+    return this->atNanosecondsFromOrigin(this->_pktIndex(), nsFromOrigin);
+}
+
+const PacketIndex& ElementSequence::_pktIndex()
+{
+    if (!_pktIndexPtr) {
+        _pktIndexPtr = std::make_shared<const PacketIndex>(*_traceType, *_dataSrcFactory);
+    }
+
+    return *_pktIndexPtr;
+}
+
 ElementSequence::Iterator ElementSequence::begin()
 {
-    return ElementSequence::Iterator {*_dataSrcFactory, *_traceType, false};
+    return ElementSequence::Iterator {*_dataSrcFactory, *_traceType, _opts, false};
 }
 
 ElementSequence::Iterator ElementSequence::end() noexcept
 {
-    return ElementSequence::Iterator {*_dataSrcFactory, *_traceType, true};
+    return ElementSequence::Iterator {*_dataSrcFactory, *_traceType, _opts, true};
 }
 
 } // namespace yactfr
@@ -158,6 +158,10 @@ void ElementVisitor::visit(const BlobSectionElement&)
 {
 }
 
+void ElementVisitor::visit(const ArraySectionElement&)
+{
+}
+
 void ElementVisitor::visit(const ArrayBeginningElement& elem)
 {
     this->visit(static_cast<const BeginningElement&>(elem));
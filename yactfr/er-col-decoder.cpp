@@ -0,0 +1,449 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <algorithm>
+#include <cassert>
+
+#include <yactfr/er-col-decoder.hpp>
+#include <yactfr/elem.hpp>
+#include <yactfr/metadata/trace-type.hpp>
+#include <yactfr/metadata/dst.hpp>
+#include <yactfr/metadata/ert.hpp>
+#include <yactfr/metadata/struct-type.hpp>
+
+#include "internal/vm.hpp"
+#include "internal/metadata/trace-type-impl.hpp"
+
+namespace yactfr {
+namespace {
+
+// no column for the data element of an instruction
+constexpr auto noColIndex = static_cast<Index>(~0ULL);
+
+} // namespace
+
+EventRecordColumn::EventRecordColumn(DataLocation loc, const DataType& dt, const Kind kind) :
+    _loc {std::move(loc)},
+    _dt {&dt},
+    _kind {kind}
+{
+    if (_kind == Kind::STRING) {
+        _strOffsets.push_back(0);
+    }
+}
+
+std::string EventRecordColumn::stringValue(const Index index) const
+{
+    assert(_kind == Kind::STRING);
+    assert(index + 1 < _strOffsets.size());
+
+    const auto begin = _strData.data() + _strOffsets[index];
+
+    return std::string {begin, _strData.data() + _strOffsets[index + 1]};
+}
+
+void EventRecordColumn::_clear() noexcept
+{
+    _uIntVals.clear();
+    _sIntVals.clear();
+    _floatVals.clear();
+    _strData.clear();
+    _strOffsets.clear();
+
+    if (_kind == Kind::STRING) {
+        _strOffsets.push_back(0);
+    }
+}
+
+EventRecordColumns::EventRecordColumns(const EventRecordType& ert) :
+    _ert {&ert}
+{
+}
+
+const EventRecordColumn *EventRecordColumns::operator[](const DataLocation& loc) const noexcept
+{
+    const auto it = _locColIndexes.find(std::make_pair(loc.scope(), loc.pathElements()));
+
+    if (it == _locColIndexes.end()) {
+        return nullptr;
+    }
+
+    return &_cols[it->second];
+}
+
+void EventRecordColumns::_clear() noexcept
+{
+    _timestamps.clear();
+
+    for (auto& col : _cols) {
+        col._clear();
+    }
+}
+
+EventRecordColumnDecoder::EventRecordColumnDecoder(const TraceType& traceType,
+                                                   DataSourceFactory& dataSrcFactory,
+                                                   ElementSequenceOptions::EventRecordTypeFilter filter) :
+    _elemSeq {traceType, dataSrcFactory, EventRecordColumnDecoder::_elemSeqOpts(filter)},
+    _it {_elemSeq.end()}
+{
+    for (const auto& dst : traceType.dataStreamTypes()) {
+        for (const auto& ert : dst->eventRecordTypes()) {
+            if (!filter || filter(*ert)) {
+                this->_addErCols(*ert);
+            }
+        }
+    }
+
+    this->_setInstrColIndexes(traceType);
+}
+
+ElementSequenceOptions EventRecordColumnDecoder::_elemSeqOpts(ElementSequenceOptions::EventRecordTypeFilter filter)
+{
+    ElementSequenceOptions opts;
+
+    opts.eventRecordTypeFilter(std::move(filter));
+
+    /*
+     * Only produce what's needed to fill the columns: the VM decodes
+     * the data of the other elements without ever returning them.
+     */
+    opts.elementKinds(std::set<Element::Kind> {
+        Element::Kind::PACKET_BEGINNING,
+        Element::Kind::PACKET_END,
+        Element::Kind::DEFAULT_CLOCK_VALUE,
+        Element::Kind::EVENT_RECORD_INFO,
+        Element::Kind::EVENT_RECORD_END,
+        Element::Kind::FIXED_LENGTH_BIT_ARRAY,
+        Element::Kind::FIXED_LENGTH_BOOLEAN,
+        Element::Kind::FIXED_LENGTH_SIGNED_INTEGER,
+        Element::Kind::FIXED_LENGTH_UNSIGNED_INTEGER,
+        Element::Kind::FIXED_LENGTH_FLOATING_POINT_NUMBER,
+        Element::Kind::FIXED_LENGTH_SIGNED_ENUMERATION,
+        Element::Kind::FIXED_LENGTH_UNSIGNED_ENUMERATION,
+        Element::Kind::VARIABLE_LENGTH_SIGNED_INTEGER,
+        Element::Kind::VARIABLE_LENGTH_UNSIGNED_INTEGER,
+        Element::Kind::VARIABLE_LENGTH_SIGNED_ENUMERATION,
+        Element::Kind::VARIABLE_LENGTH_UNSIGNED_ENUMERATION,
+        Element::Kind::NULL_TERMINATED_STRING_BEGINNING,
+        Element::Kind::NULL_TERMINATED_STRING_END,
+        Element::Kind::STATIC_LENGTH_STRING_BEGINNING,
+        Element::Kind::STATIC_LENGTH_STRING_END,
+        Element::Kind::DYNAMIC_LENGTH_STRING_BEGINNING,
+        Element::Kind::DYNAMIC_LENGTH_STRING_END,
+        Element::Kind::SUBSTRING,
+    });
+
+    return opts;
+}
+
+void EventRecordColumnDecoder::_addErCols(const EventRecordType& ert)
+{
+    EventRecordColumns erCols {ert};
+
+    assert(ert.dataStreamType());
+    this->_addCols(erCols, ert.dataStreamType()->eventRecordCommonContextType(),
+                   Scope::EVENT_RECORD_COMMON_CONTEXT);
+    this->_addCols(erCols, ert.specificContextType(), Scope::EVENT_RECORD_SPECIFIC_CONTEXT);
+    this->_addCols(erCols, ert.payloadType(), Scope::EVENT_RECORD_PAYLOAD);
+    _ertErColsIndexes[&ert] = _erColsVec.size();
+    _erColsVec.push_back(std::move(erCols));
+}
+
+void EventRecordColumnDecoder::_addCols(EventRecordColumns& erCols,
+                                        const StructureType * const structType, const Scope scope)
+{
+    if (structType) {
+        this->_addCols(erCols, *structType, {}, scope);
+    }
+}
+
+void EventRecordColumnDecoder::_addCols(EventRecordColumns& erCols, const DataType& dt,
+                                        const DataLocation::PathElements& pathElems,
+                                        const Scope scope)
+{
+    if (dt.isStructureType()) {
+        for (const auto& memberType : dt.asStructureType()) {
+            auto memberPathElems = pathElems;
+
+            memberPathElems.push_back(memberType->name());
+            this->_addCols(erCols, memberType->dataType(), memberPathElems, scope);
+        }
+
+        return;
+    }
+
+    EventRecordColumn::Kind kind;
+
+    if (dt.isFixedLengthFloatingPointNumberType()) {
+        kind = EventRecordColumn::Kind::FLOATING_POINT_NUMBER;
+    } else if (dt.isSignedIntegerType()) {
+        kind = EventRecordColumn::Kind::SIGNED_INTEGER;
+    } else if (dt.isFixedLengthBitArrayType() || dt.isVariableLengthIntegerType()) {
+        kind = EventRecordColumn::Kind::UNSIGNED_INTEGER;
+    } else if (dt.isNullTerminatedStringType() || dt.isNonNullTerminatedStringType()) {
+        kind = EventRecordColumn::Kind::STRING;
+    } else {
+        // array, BLOB, variant, or optional: no column
+        return;
+    }
+
+    erCols._locColIndexes[std::make_pair(scope, pathElems)] = erCols._cols.size();
+    erCols._cols.push_back(EventRecordColumn {DataLocation {scope, pathElems}, dt, kind});
+}
+
+void EventRecordColumnDecoder::_setInstrColIndexes(const TraceType& traceType)
+{
+    /*
+     * A data type has a single column index: the columns of the common
+     * context of an event record, which all the event record types of
+     * a data stream type share, come first (see _addErCols()).
+     */
+    std::unordered_map<const DataType *, Index> dtColIndexes;
+
+    for (const auto& erCols : _erColsVec) {
+        for (Index colIndex = 0; colIndex < erCols._cols.size(); ++colIndex) {
+            dtColIndexes[&erCols._cols[colIndex].dataType()] = colIndex;
+        }
+    }
+
+    const auto& instrs = traceType._pimpl->pktProc().instrs();
+
+    _instrColIndexes.assign(instrs.size(), noColIndex);
+
+    for (const auto instr : instrs) {
+        if (!instr->isBeginReadData() || instr->kind() == internal::Instr::Kind::BEGIN_READ_SCOPE) {
+            continue;
+        }
+
+        const auto& dt = static_cast<const internal::ReadDataInstr&>(*instr).dt();
+        const auto it = dtColIndexes.find(&dt);
+
+        if (it != dtColIndexes.end()) {
+            _instrColIndexes[instr->index()] = it->second;
+        }
+    }
+}
+
+const EventRecordColumns *EventRecordColumnDecoder::operator[](const EventRecordType& ert) const noexcept
+{
+    const auto it = _ertErColsIndexes.find(&ert);
+
+    if (it == _ertErColsIndexes.end()) {
+        return nullptr;
+    }
+
+    return &_erColsVec[it->second];
+}
+
+bool EventRecordColumnDecoder::decodeNextPacket()
+{
+    if (!_started) {
+        _it = _elemSeq.begin();
+        _started = true;
+    }
+
+    for (auto& erCols : _erColsVec) {
+        erCols._clear();
+    }
+
+    _curErCols = nullptr;
+    _curStrCol = nullptr;
+    _defClkVal = 0;
+
+    if (_it == _elemSeq.end()) {
+        return false;
+    }
+
+    assert(_it->kind() == Element::Kind::PACKET_BEGINNING);
+    ++_it;
+
+    while (_it->kind() != Element::Kind::PACKET_END) {
+        this->_handleElem(*_it);
+        ++_it;
+    }
+
+    // go to the beginning of the next packet, if any
+    ++_it;
+    return true;
+}
+
+void EventRecordColumnDecoder::seekPacket(const Index offset)
+{
+    _it = _elemSeq.at(offset);
+    _started = true;
+}
+
+EventRecordColumn *EventRecordColumnDecoder::_curCol() noexcept
+{
+    if (!_curErCols) {
+        // not within the contexts or payload of a decoded event record
+        return nullptr;
+    }
+
+    // instruction which emitted the current data element
+    assert(_it._vm);
+
+    const auto instr = _it._vm->lastInstr();
+
+    assert(instr);
+    assert(instr->index() < _instrColIndexes.size());
+
+    const auto colIndex = _instrColIndexes[instr->index()];
+
+    if (colIndex == noColIndex) {
+        return nullptr;
+    }
+
+    assert(colIndex < _curErCols->_cols.size());
+    return &_curErCols->_cols[colIndex];
+}
+
+void EventRecordColumnDecoder::_handleElem(const Element& elem)
+{
+    switch (elem.kind()) {
+    case Element::Kind::DEFAULT_CLOCK_VALUE:
+        _defClkVal = elem.asDefaultClockValueElement().cycles();
+        break;
+
+    case Element::Kind::EVENT_RECORD_INFO:
+    {
+        const auto ert = elem.asEventRecordInfoElement().type();
+
+        assert(ert);
+
+        const auto it = _ertErColsIndexes.find(ert);
+
+        assert(it != _ertErColsIndexes.end());
+        _curErCols = &_erColsVec[it->second];
+
+        // the event record header, which contains its timestamp, is done
+        _curErCols->_timestamps.push_back(_defClkVal);
+        break;
+    }
+
+    case Element::Kind::EVENT_RECORD_END:
+        _curErCols = nullptr;
+        break;
+
+    case Element::Kind::FIXED_LENGTH_BIT_ARRAY:
+    {
+        auto& dataElem = elem.asFixedLengthBitArrayElement();
+
+        if (const auto col = this->_curCol()) {
+            col->_uIntVals.push_back(dataElem.unsignedIntegerValue());
+        }
+
+        break;
+    }
+
+    case Element::Kind::FIXED_LENGTH_BOOLEAN:
+    {
+        auto& dataElem = elem.asFixedLengthBooleanElement();
+
+        if (const auto col = this->_curCol()) {
+            col->_uIntVals.push_back(dataElem.value() ? 1 : 0);
+        }
+
+        break;
+    }
+
+    case Element::Kind::FIXED_LENGTH_SIGNED_INTEGER:
+    case Element::Kind::FIXED_LENGTH_SIGNED_ENUMERATION:
+    {
+        auto& dataElem = elem.asFixedLengthSignedIntegerElement();
+
+        if (const auto col = this->_curCol()) {
+            col->_sIntVals.push_back(dataElem.value());
+        }
+
+        break;
+    }
+
+    case Element::Kind::FIXED_LENGTH_UNSIGNED_INTEGER:
+    case Element::Kind::FIXED_LENGTH_UNSIGNED_ENUMERATION:
+    {
+        auto& dataElem = elem.asFixedLengthUnsignedIntegerElement();
+
+        if (const auto col = this->_curCol()) {
+            col->_uIntVals.push_back(dataElem.value());
+        }
+
+        break;
+    }
+
+    case Element::Kind::FIXED_LENGTH_FLOATING_POINT_NUMBER:
+    {
+        auto& dataElem = elem.asFixedLengthFloatingPointNumberElement();
+
+        if (const auto col = this->_curCol()) {
+            col->_floatVals.push_back(dataElem.value());
+        }
+
+        break;
+    }
+
+    case Element::Kind::VARIABLE_LENGTH_SIGNED_INTEGER:
+    case Element::Kind::VARIABLE_LENGTH_SIGNED_ENUMERATION:
+    {
+        auto& dataElem = elem.asVariableLengthSignedIntegerElement();
+
+        if (const auto col = this->_curCol()) {
+            col->_sIntVals.push_back(dataElem.value());
+        }
+
+        break;
+    }
+
+    case Element::Kind::VARIABLE_LENGTH_UNSIGNED_INTEGER:
+    case Element::Kind::VARIABLE_LENGTH_UNSIGNED_ENUMERATION:
+    {
+        auto& dataElem = elem.asVariableLengthUnsignedIntegerElement();
+
+        if (const auto col = this->_curCol()) {
+            col->_uIntVals.push_back(dataElem.value());
+        }
+
+        break;
+    }
+
+    case Element::Kind::NULL_TERMINATED_STRING_BEGINNING:
+    case Element::Kind::STATIC_LENGTH_STRING_BEGINNING:
+    case Element::Kind::DYNAMIC_LENGTH_STRING_BEGINNING:
+        _curStrCol = this->_curCol();
+        _curStrEnded = false;
+        break;
+
+    case Element::Kind::SUBSTRING:
+    {
+        if (!_curStrCol || _curStrEnded) {
+            break;
+        }
+
+        auto& substrElem = elem.asSubstringElement();
+        const auto end = std::find(substrElem.begin(), substrElem.end(), '\0');
+
+        _curStrCol->_strData.insert(_curStrCol->_strData.end(), substrElem.begin(), end);
+        _curStrEnded = end != substrElem.end();
+        break;
+    }
+
+    case Element::Kind::NULL_TERMINATED_STRING_END:
+    case Element::Kind::STATIC_LENGTH_STRING_END:
+    case Element::Kind::DYNAMIC_LENGTH_STRING_END:
+        if (_curStrCol) {
+            _curStrCol->_strOffsets.push_back(_curStrCol->_strData.size());
+            _curStrCol = nullptr;
+        }
+
+        break;
+
+    default:
+        break;
+    }
+}
+
+} // namespace yactfr
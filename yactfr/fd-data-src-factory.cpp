@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <vector>
+
+#include <yactfr/fd-data-src-factory.hpp>
+
+#include "internal/fd-data-src-factory-impl.hpp"
+
+namespace yactfr {
+namespace internal {
+
+class FdDataSource final :
+    public DataSource
+{
+public:
+    explicit FdDataSource(std::shared_ptr<internal::FdDataSrcFactoryImpl> fdDataSrcFactoryImpl);
+
+private:
+    boost::optional<DataBlock> _data(Index offset, Size minSize) override;
+
+private:
+    std::shared_ptr<internal::FdDataSrcFactoryImpl> _fdDataSrcFactoryImpl;
+    std::vector<std::uint8_t> _buf;
+
+    // current block: offset within the data stream and size
+    Index _blkOffset = 0;
+    Size _blkSize = 0;
+};
+
+FdDataSource::FdDataSource(std::shared_ptr<internal::FdDataSrcFactoryImpl> fdDataSrcFactoryImpl) :
+    _fdDataSrcFactoryImpl {std::move(fdDataSrcFactoryImpl)},
+    _buf(_fdDataSrcFactoryImpl->blockSize())
+{
+}
+
+boost::optional<DataBlock> FdDataSource::_data(const Index offset, const Size minSize)
+{
+    if (offset >= _blkOffset && (offset + minSize) <= (_blkOffset + _blkSize)) {
+        // requested data is within the current block
+        const auto offsetFromBlkOffset = offset - _blkOffset;
+
+        return DataBlock {
+            static_cast<const void *>(_buf.data() + offsetFromBlkOffset),
+            _blkSize - offsetFromBlkOffset
+        };
+    }
+
+    _blkSize = _fdDataSrcFactoryImpl->copy(offset, _buf.data(), minSize, _buf.size());
+    _blkOffset = offset;
+
+    if (_blkSize == 0) {
+        // no more data
+        return boost::none;
+    }
+
+    return DataBlock {static_cast<const void *>(_buf.data()), _blkSize};
+}
+
+} // namespace internal
+
+FileDescriptorDataSourceFactory::FileDescriptorDataSourceFactory(const int fd,
+                                                                 const boost::optional<Size>& bufferSize) :
+    _pimpl {std::make_shared<internal::FdDataSrcFactoryImpl>(fd, bufferSize)}
+{
+}
+
+int FileDescriptorDataSourceFactory::fd() const noexcept
+{
+    return _pimpl->fd();
+}
+
+Size FileDescriptorDataSourceFactory::bufferSize() const noexcept
+{
+    return _pimpl->bufSize();
+}
+
+DataSource::UP FileDescriptorDataSourceFactory::_createDataSource()
+{
+    return std::make_unique<internal::FdDataSource>(_pimpl);
+}
+
+} // namespace yactfr
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cerrno>
+#include <cassert>
+#include <sstream>
+#include <unistd.h>
+
+#include <yactfr/io-error.hpp>
+
+#include "async-file-reader.hpp"
+#include "utils.hpp"
+
+namespace yactfr {
+namespace internal {
+
+AsyncFileReader::AsyncFileReader(const int fd, std::string path) :
+    _theFd {fd},
+    _path {std::move(path)}
+{
+}
+
+void AsyncFileReader::_throwReadError(const Index offset, const Size size, const int error) const
+{
+    errno = error;
+
+    const auto errorStr = internal::strError();
+    std::ostringstream ss;
+
+    ss << "Cannot read region [" << offset << ", " << (offset + size) <<
+          "[ of file \"" << _path << "\": " << errorStr;
+    throw IOError {ss.str()};
+}
+
+ThreadAsyncFileReader::ThreadAsyncFileReader(const int fd, std::string path,
+                                             const Size maxReqCount) :
+    AsyncFileReader {fd, std::move(path)},
+    _reqs(maxReqCount)
+{
+    _worker = std::thread {&ThreadAsyncFileReader::_workerFunc, this};
+}
+
+ThreadAsyncFileReader::~ThreadAsyncFileReader()
+{
+    {
+        std::lock_guard<std::mutex> lock {_mutex};
+
+        // cancel the queued requests: the worker finishes its current one
+        _queue.clear();
+        _stop = true;
+    }
+
+    _queueCv.notify_one();
+    _worker.join();
+}
+
+void ThreadAsyncFileReader::_submit(const Index id, std::uint8_t * const buf, const Size size,
+                                    const Index offset)
+{
+    {
+        std::lock_guard<std::mutex> lock {_mutex};
+        auto& req = _reqs[id];
+
+        assert(!req.isPending);
+        req.buf = buf;
+        req.size = size;
+        req.offset = offset;
+        req.isPending = true;
+        req.readSize = 0;
+        req.error = 0;
+        _queue.push_back(id);
+    }
+
+    _queueCv.notify_one();
+}
+
+boost::optional<Size> ThreadAsyncFileReader::_result(const Index id, const bool wait)
+{
+    std::unique_lock<std::mutex> lock {_mutex};
+    auto& req = _reqs[id];
+
+    if (wait) {
+        _doneCv.wait(lock, [&req] {
+            return !req.isPending;
+        });
+    } else if (req.isPending) {
+        return boost::none;
+    }
+
+    if (req.error != 0) {
+        this->_throwReadError(req.offset, req.size, req.error);
+    }
+
+    return req.readSize;
+}
+
+void ThreadAsyncFileReader::_workerFunc()
+{
+    std::unique_lock<std::mutex> lock {_mutex};
+
+    while (true) {
+        _queueCv.wait(lock, [this] {
+            return _stop || !_queue.empty();
+        });
+
+        if (_stop) {
+            return;
+        }
+
+        auto& req = _reqs[_queue.front()];
+
+        _queue.pop_front();
+
+        // read without holding the lock
+        const auto buf = req.buf;
+        const auto size = req.size;
+        const auto offset = req.offset;
+
+        lock.unlock();
+
+        Size readSize = 0;
+        int error = 0;
+
+        while (readSize < size) {
+            const auto ret = pread(this->_fd(), buf + readSize,
+                                   static_cast<size_t>(size - readSize),
+                                   static_cast<off_t>(offset + readSize));
+
+            if (ret < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                error = errno;
+                break;
+            }
+
+            if (ret == 0) {
+                // end of file
+                break;
+            }
+
+            readSize += static_cast<Size>(ret);
+        }
+
+        lock.lock();
+        req.readSize = readSize;
+        req.error = error;
+        req.isPending = false;
+        _doneCv.notify_all();
+    }
+}
+
+} // namespace internal
+} // namespace yactfr
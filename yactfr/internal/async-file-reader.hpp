@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_INTERNAL_ASYNC_FILE_READER_HPP
+#define _YACTFR_INTERNAL_ASYNC_FILE_READER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <boost/optional/optional.hpp>
+
+#include <yactfr/aliases.hpp>
+
+namespace yactfr {
+namespace internal {
+
+/*
+ * Asynchronous file reader.
+ *
+ * An asynchronous file reader manages up to `maxReqCount` concurrent
+ * read requests on a given file descriptor, each one having an ID
+ * within [0, `maxReqCount`[.
+ *
+ * A request reads the whole requested region, unless it reaches the
+ * end of the file.
+ *
+ * The destructor of a concrete asynchronous file reader waits for the
+ * completion of, or cancels, all its pending requests: the buffers of
+ * the pending requests must outlive the reader.
+ */
+class AsyncFileReader
+{
+protected:
+    explicit AsyncFileReader(int fd, std::string path);
+
+public:
+    virtual ~AsyncFileReader() = default;
+
+    /*
+     * Submits the request `id` to read `size` bytes at the offset
+     * `offset` of the file into `buf`.
+     *
+     * The request `id` must not be pending.
+     */
+    void submit(const Index id, std::uint8_t * const buf, const Size size, const Index offset)
+    {
+        this->_submit(id, buf, size, offset);
+    }
+
+    /*
+     * Returns the number of bytes which the request `id` read if it's
+     * complete, waiting for its completion if `wait` is true, or
+     * `boost::none` if it's still pending.
+     *
+     * Throws `IOError` if the request failed.
+     */
+    boost::optional<Size> result(const Index id, const bool wait)
+    {
+        return this->_result(id, wait);
+    }
+
+protected:
+    int _fd() const noexcept
+    {
+        return _theFd;
+    }
+
+    // throws `IOError` for the failed read of [`offset`, `offset + size`[
+    [[noreturn]] void _throwReadError(Index offset, Size size, int error) const;
+
+private:
+    virtual void _submit(Index id, std::uint8_t *buf, Size size, Index offset) = 0;
+    virtual boost::optional<Size> _result(Index id, bool wait) = 0;
+
+private:
+    int _theFd;
+    std::string _path;
+};
+
+/*
+ * Asynchronous file reader which performs its read requests with
+ * `pread()` on a dedicated thread, in submission order.
+ */
+class ThreadAsyncFileReader final :
+    public AsyncFileReader
+{
+public:
+    explicit ThreadAsyncFileReader(int fd, std::string path, Size maxReqCount);
+    ~ThreadAsyncFileReader();
+
+private:
+    struct _Req final
+    {
+        std::uint8_t *buf = nullptr;
+        Size size = 0;
+        Index offset = 0;
+        bool isPending = false;
+
+        // number of read bytes or error number once not pending
+        Size readSize = 0;
+        int error = 0;
+    };
+
+private:
+    void _submit(Index id, std::uint8_t *buf, Size size, Index offset) override;
+    boost::optional<Size> _result(Index id, bool wait) override;
+    void _workerFunc();
+
+private:
+    // all the following members are protected by `_mutex`
+    std::vector<_Req> _reqs;
+    std::deque<Index> _queue;
+    bool _stop = false;
+    std::mutex _mutex;
+
+    // signaled when `_queue` or `_stop` changes
+    std::condition_variable _queueCv;
+
+    // signaled when a request completes
+    std::condition_variable _doneCv;
+
+    std::thread _worker;
+};
+
+/*
+ * Returns whether or not this build and the running kernel support
+ * io_uring.
+ */
+bool ioUringIsAvailable() noexcept;
+
+/*
+ * Creates an io_uring asynchronous file reader, or returns `nullptr`
+ * if io_uring isn't available.
+ */
+std::unique_ptr<AsyncFileReader> createIoUringAsyncFileReader(int fd, std::string path,
+                                                              Size maxReqCount);
+
+} // namespace internal
+} // namespace yactfr
+
+#endif // _YACTFR_INTERNAL_ASYNC_FILE_READER_HPP
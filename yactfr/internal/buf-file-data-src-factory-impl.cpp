@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cerrno>
+#include <sstream>
+#include <cassert>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#include <yactfr/io-error.hpp>
+
+#include "buf-file-data-src-factory-impl.hpp"
+#include "utils.hpp"
+
+namespace yactfr {
+namespace internal {
+
+BufFileDataSrcBuf::BufFileDataSrcBuf(const Size blockSize, const Size alignment) :
+    _mem(carryOverSize + blockSize + alignment),
+    _blockSize {blockSize}
+{
+    assert(isPowOfTwo(alignment));
+
+    // first aligned address after the carry-over area
+    const auto addr = reinterpret_cast<std::uintptr_t>(_mem.data()) + carryOverSize;
+
+    _readArea = reinterpret_cast<std::uint8_t *>((addr + alignment - 1) & ~(alignment - 1));
+}
+
+BufFileDataSrcFactoryImpl::BufFileDataSrcFactoryImpl(std::string path,
+                                                     const boost::optional<Size>& blockSize,
+                                                     const BufferedFileDataSourceFactory::CacheMode cacheMode) :
+    _path {std::move(path)},
+    _cacheMode {cacheMode}
+{
+    if (_cacheMode == BufferedFileDataSourceFactory::CacheMode::DIRECT) {
+        _fd = open(_path.c_str(), O_RDONLY | O_DIRECT);
+
+        if (_fd < 0 && errno == EINVAL) {
+            // file system doesn't support direct I/O
+            _cacheMode = BufferedFileDataSourceFactory::CacheMode::DROP_BEHIND;
+        }
+    }
+
+    if (_fd < 0) {
+        _fd = open(_path.c_str(), O_RDONLY);
+    }
+
+    if (_fd < 0) {
+        const auto error = internal::strError();
+        std::ostringstream ss;
+
+        ss << "Cannot open \"" << _path << "\" for reading: " << error;
+        throw IOError {ss.str()};
+    }
+
+    struct stat stat;
+
+    const auto ret = fstat(_fd, &stat);
+
+    if (ret < 0) {
+        const auto error = internal::strError();
+        std::ostringstream ss;
+
+        ss << "Cannot get file status for \"" << _path << "\": " << error;
+        this->_close();
+        throw IOError {ss.str()};
+    }
+
+    _fileSize = static_cast<Size>(stat.st_size);
+    _alignment = sysconf(_SC_PAGE_SIZE);
+    assert(_alignment >= 1);
+
+    if (blockSize) {
+        _blockSize = std::max(*blockSize, static_cast<Size>(1));
+    } else {
+        // 1 MiB
+        _blockSize = 1 << 20;
+    }
+
+    _blockSize = (_blockSize + _alignment - 1) & ~(_alignment - 1);
+
+    if (_cacheMode == BufferedFileDataSourceFactory::CacheMode::DIRECT) {
+        _blockSize = std::max(_blockSize, _alignment * 2);
+    }
+
+    assert(_blockSize >= BufFileDataSrcBuf::carryOverSize);
+
+    /*
+     * Advise the kernel that the data sources mostly read this file
+     * sequentially (more read ahead).
+     */
+    (void) posix_fadvise(_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+}
+
+std::unique_ptr<BufFileDataSrcBuf> BufFileDataSrcFactoryImpl::takeBuf()
+{
+    {
+        std::lock_guard<std::mutex> lock {_bufsMutex};
+
+        if (!_bufs.empty()) {
+            auto buf = std::move(_bufs.back());
+
+            _bufs.pop_back();
+            return buf;
+        }
+    }
+
+    return std::make_unique<BufFileDataSrcBuf>(_blockSize, _alignment);
+}
+
+void BufFileDataSrcFactoryImpl::giveBackBuf(std::unique_ptr<BufFileDataSrcBuf> buf)
+{
+    assert(buf);
+
+    std::lock_guard<std::mutex> lock {_bufsMutex};
+
+    _bufs.push_back(std::move(buf));
+}
+
+void BufFileDataSrcFactoryImpl::_close()
+{
+    assert(_fd >= 0);
+
+    // TODO: check return value and log (do not throw) on error
+    static_cast<void>(close(_fd));
+    _fd = -1;
+}
+
+BufFileDataSrcFactoryImpl::~BufFileDataSrcFactoryImpl()
+{
+    this->_close();
+}
+
+} // namespace internal
+} // namespace yactfr
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_INTERNAL_BUF_FILE_DATA_SRC_FACTORY_IMPL_HPP
+#define _YACTFR_INTERNAL_BUF_FILE_DATA_SRC_FACTORY_IMPL_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <boost/optional/optional.hpp>
+
+#include <yactfr/aliases.hpp>
+#include <yactfr/buf-file-data-src-factory.hpp>
+
+namespace yactfr {
+namespace internal {
+
+/*
+ * Buffer of a buffered or read-ahead file data source.
+ *
+ * A buffer is made of a carry-over area followed with a read area of
+ * the block size which starts at an address aligned to the page size:
+ *
+ *     +------------+--------------------------------------+
+ *     | carry-over | read area                            |
+ *     +------------+--------------------------------------+
+ *                  ^ page-aligned
+ *
+ * When the VM requests `minSize` bytes at an offset of which the
+ * remaining bytes within the read area are fewer than `minSize`, the
+ * data source copies those bytes to the end of the carry-over area and
+ * reads the following block into the read area: the requested bytes
+ * are then contiguous without any additional temporary buffer.
+ */
+class BufFileDataSrcBuf final
+{
+public:
+    // the VM can request a minimum size of at most 9 bytes
+    static constexpr Size carryOverSize = 16;
+
+public:
+    explicit BufFileDataSrcBuf(Size blockSize, Size alignment);
+
+    std::uint8_t *readArea() noexcept
+    {
+        return _readArea;
+    }
+
+    Size blockSize() const noexcept
+    {
+        return _blockSize;
+    }
+
+private:
+    std::vector<std::uint8_t> _mem;
+    std::uint8_t *_readArea;
+    Size _blockSize;
+};
+
+/*
+ * A `BufFileDataSrcFactoryImpl` object is shared by zero or more
+ * `BufferedFileDataSource` (or `ReadAheadFileDataSource`) objects, and
+ * also by the public `BufferedFileDataSourceFactory` (or
+ * `ReadAheadFileDataSourceFactory`) object which builds it. It opens a
+ * file and keeps its file descriptor open so that a data source can
+ * read it and guarantee its lifetime.
+ *
+ * It also keeps the buffers of destroyed data sources so that new data
+ * sources may reuse them.
+ *
+ * With the `DIRECT` cache mode, the file descriptor has the `O_DIRECT`
+ * flag: a data source must read whole blocks at offsets which are
+ * multiples of alignment() into its read area. The block size is then
+ * at least twice the alignment so that a block which begins at the
+ * aligned offset preceding a requested offset always contains the
+ * requested data.
+ */
+class BufFileDataSrcFactoryImpl final
+{
+public:
+    explicit BufFileDataSrcFactoryImpl(std::string path, const boost::optional<Size>& blockSize,
+                                       BufferedFileDataSourceFactory::CacheMode cacheMode =
+                                           BufferedFileDataSourceFactory::CacheMode::NORMAL);
+    ~BufFileDataSrcFactoryImpl();
+
+    int fd() const noexcept
+    {
+        return _fd;
+    }
+
+    Size fileSize() const noexcept
+    {
+        return _fileSize;
+    }
+
+    const std::string& path() const noexcept
+    {
+        return _path;
+    }
+
+    Size blockSize() const noexcept
+    {
+        return _blockSize;
+    }
+
+    Size alignment() const noexcept
+    {
+        return _alignment;
+    }
+
+    BufferedFileDataSourceFactory::CacheMode cacheMode() const noexcept
+    {
+        return _cacheMode;
+    }
+
+    /*
+     * Returns a recycled buffer or a new one.
+     */
+    std::unique_ptr<BufFileDataSrcBuf> takeBuf();
+
+    /*
+     * Keeps the buffer `buf` for a future call to takeBuf().
+     */
+    void giveBackBuf(std::unique_ptr<BufFileDataSrcBuf> buf);
+
+private:
+    void _close();
+
+private:
+    const std::string _path;
+    Size _blockSize;
+    Size _alignment;
+    BufferedFileDataSourceFactory::CacheMode _cacheMode;
+    int _fd = -1;
+    Size _fileSize;
+
+    // recycled buffers, protected by `_bufsMutex`
+    std::vector<std::unique_ptr<BufFileDataSrcBuf>> _bufs;
+    std::mutex _bufsMutex;
+};
+
+} // namespace internal
+} // namespace yactfr
+
+#endif // _YACTFR_INTERNAL_BUF_FILE_DATA_SRC_FACTORY_IMPL_HPP
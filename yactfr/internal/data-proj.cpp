@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <yactfr/metadata/dst.hpp>
+#include <yactfr/metadata/ert.hpp>
+#include <yactfr/metadata/struct-type.hpp>
+#include <yactfr/metadata/array-type.hpp>
+#include <yactfr/metadata/opt-type.hpp>
+#include <yactfr/metadata/var-type.hpp>
+
+#include "data-proj.hpp"
+
+namespace yactfr {
+namespace internal {
+
+DataProj::DataProj(const PktProc& pktProc, const std::vector<DataLocation>& dataLocs)
+{
+    const auto& traceType = pktProc.traceType();
+
+    for (const auto& dataLoc : dataLocs) {
+        switch (dataLoc.scope()) {
+        case Scope::PACKET_HEADER:
+            this->_addDataLoc(traceType.packetHeaderType(), dataLoc);
+            break;
+
+        case Scope::PACKET_CONTEXT:
+        case Scope::EVENT_RECORD_HEADER:
+        case Scope::EVENT_RECORD_COMMON_CONTEXT:
+            for (const auto& dst : traceType.dataStreamTypes()) {
+                if (dataLoc.scope() == Scope::PACKET_CONTEXT) {
+                    this->_addDataLoc(dst->packetContextType(), dataLoc);
+                } else if (dataLoc.scope() == Scope::EVENT_RECORD_HEADER) {
+                    this->_addDataLoc(dst->eventRecordHeaderType(), dataLoc);
+                } else {
+                    this->_addDataLoc(dst->eventRecordCommonContextType(), dataLoc);
+                }
+            }
+
+            break;
+
+        case Scope::EVENT_RECORD_SPECIFIC_CONTEXT:
+        case Scope::EVENT_RECORD_PAYLOAD:
+            for (const auto& dst : traceType.dataStreamTypes()) {
+                for (const auto& ert : dst->eventRecordTypes()) {
+                    if (dataLoc.scope() == Scope::EVENT_RECORD_SPECIFIC_CONTEXT) {
+                        this->_addDataLoc(ert->specificContextType(), dataLoc);
+                    } else {
+                        this->_addDataLoc(ert->payloadType(), dataLoc);
+                    }
+                }
+            }
+
+            break;
+        }
+    }
+
+    _instrVisibilities.reserve(pktProc.instrs().size());
+
+    for (const auto instr : pktProc.instrs()) {
+        _instrVisibilities.push_back(this->_computeInstrVisibility(*instr));
+    }
+}
+
+void DataProj::_addDataLoc(const StructureType * const scopeDt, const DataLocation& dataLoc)
+{
+    if (!scopeDt) {
+        // no such scope
+        return;
+    }
+
+    if (this->_addDataLoc(*scopeDt, dataLoc.pathElements().begin(), dataLoc.pathElements().end())) {
+        _visibleScopes.insert(static_cast<int>(dataLoc.scope()));
+    }
+}
+
+bool DataProj::_addDataLoc(const DataType& dt,
+                           const DataLocation::PathElements::const_iterator pathElemIt,
+                           const DataLocation::PathElements::const_iterator pathElemEndIt)
+{
+    if (pathElemIt == pathElemEndIt) {
+        // target
+        this->_setFullVisibility(dt);
+        return true;
+    }
+
+    auto found = false;
+
+    // go through arrays, optionals, and variants to find structures
+    if (dt.isStructureType()) {
+        const auto memberType = dt.asStructureType()[*pathElemIt];
+
+        if (memberType) {
+            found = this->_addDataLoc(memberType->dataType(), std::next(pathElemIt),
+                                      pathElemEndIt);
+        }
+    } else if (dt.isArrayType()) {
+        found = this->_addDataLoc(dt.asArrayType().elementType(), pathElemIt, pathElemEndIt);
+    } else if (dt.isOptionalType()) {
+        found = this->_addDataLoc(dt.asOptionalType().dataType(), pathElemIt, pathElemEndIt);
+    } else if (dt.isVariantWithUnsignedIntegerSelectorType()) {
+        for (const auto& opt : dt.asVariantWithUnsignedIntegerSelectorType().options()) {
+            found = this->_addDataLoc(opt->dataType(), pathElemIt, pathElemEndIt) || found;
+        }
+    } else if (dt.isVariantWithSignedIntegerSelectorType()) {
+        for (const auto& opt : dt.asVariantWithSignedIntegerSelectorType().options()) {
+            found = this->_addDataLoc(opt->dataType(), pathElemIt, pathElemEndIt) || found;
+        }
+    }
+
+    if (found) {
+        // contains projected data: keep any existing full visibility
+        _dtVisibilities.emplace(&dt, _Visibility::PATH);
+    }
+
+    return found;
+}
+
+void DataProj::_setFullVisibility(const DataType& dt)
+{
+    _dtVisibilities[&dt] = _Visibility::FULL;
+
+    if (dt.isStructureType()) {
+        for (const auto& memberType : dt.asStructureType().memberTypes()) {
+            this->_setFullVisibility(memberType->dataType());
+        }
+    } else if (dt.isArrayType()) {
+        this->_setFullVisibility(dt.asArrayType().elementType());
+    } else if (dt.isOptionalType()) {
+        this->_setFullVisibility(dt.asOptionalType().dataType());
+    } else if (dt.isVariantWithUnsignedIntegerSelectorType()) {
+        for (const auto& opt : dt.asVariantWithUnsignedIntegerSelectorType().options()) {
+            this->_setFullVisibility(opt->dataType());
+        }
+    } else if (dt.isVariantWithSignedIntegerSelectorType()) {
+        for (const auto& opt : dt.asVariantWithSignedIntegerSelectorType().options()) {
+            this->_setFullVisibility(opt->dataType());
+        }
+    }
+}
+
+DataProj::InstrVisibility DataProj::_computeInstrVisibility(const Instr& instr) const
+{
+    switch (instr.kind()) {
+    case Instr::Kind::BEGIN_READ_SCOPE:
+        return {this->_isScopeHidden(static_cast<const BeginReadScopeInstr&>(instr).scope()), false};
+
+    case Instr::Kind::END_READ_SCOPE:
+        return {this->_isScopeHidden(static_cast<const EndReadScopeInstr&>(instr).scope()), false};
+
+    default:
+        break;
+    }
+
+    if (!instr.isBeginReadData() && !instr.isEndReadData()) {
+        // doesn't emit any data element
+        return {false, false};
+    }
+
+    const auto& dt = static_cast<const ReadDataInstr&>(instr).dt();
+    const auto isHidden = this->_isDataHidden(dt);
+
+    // only the sections of projected data are visible
+    return {isHidden, !isHidden && this->_isDataFull(dt)};
+}
+
+} // namespace internal
+} // namespace yactfr
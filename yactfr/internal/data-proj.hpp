@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_INTERNAL_DATA_PROJ_HPP
+#define _YACTFR_INTERNAL_DATA_PROJ_HPP
+
+#include <cassert>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <yactfr/metadata/fwd.hpp>
+#include <yactfr/metadata/dt.hpp>
+#include <yactfr/metadata/scope.hpp>
+#include <yactfr/metadata/data-loc.hpp>
+#include <yactfr/metadata/trace-type.hpp>
+
+#include "proc.hpp"
+
+namespace yactfr {
+namespace internal {
+
+/*
+ * Data projection.
+ *
+ * A data projection indicates which data elements an element sequence
+ * iterator produces considering a list of data locations: the elements
+ * of the projected data, of any data which it contains, and of the data
+ * which contains it (the path to reach it).
+ *
+ * A data location may target more than one data type as the same event
+ * record scope exists for many event record types, and as a variant
+ * type contains more than one option.
+ *
+ * A data projection computes the visibility of the elements of each
+ * instruction of a packet procedure once, when it's built, so that a
+ * VM only needs to index a vector with Instr::index() to know it.
+ */
+class DataProj final
+{
+public:
+    // visibility of the elements which an instruction emits
+    struct InstrVisibility final
+    {
+        /*
+         * Whether or not the beginning, end, and scalar data elements
+         * of the instruction are hidden.
+         */
+        bool isHidden;
+
+        /*
+         * Whether or not the substring, BLOB section, and array section
+         * elements of the string, BLOB, or array which the instruction
+         * reads are visible.
+         */
+        bool areSectionsVisible;
+    };
+
+public:
+    explicit DataProj(const PktProc& pktProc, const std::vector<DataLocation>& dataLocs);
+
+    /*
+     * Returns the visibility of the elements which the instruction
+     * `instr`, which is part of the packet procedure of this data
+     * projection, emits.
+     */
+    const InstrVisibility& instrVisibility(const Instr& instr) const noexcept
+    {
+        assert(instr.index() < _instrVisibilities.size());
+        return _instrVisibilities[instr.index()];
+    }
+
+private:
+    enum class _Visibility {
+        // contains projected data
+        PATH,
+
+        // projected or within projected data
+        FULL,
+    };
+
+private:
+    void _addDataLoc(const StructureType *scopeDt, const DataLocation& dataLoc);
+    bool _addDataLoc(const DataType& dt, DataLocation::PathElements::const_iterator pathElemIt,
+                     DataLocation::PathElements::const_iterator pathElemEndIt);
+    void _setFullVisibility(const DataType& dt);
+    InstrVisibility _computeInstrVisibility(const Instr& instr) const;
+
+    bool _isDataHidden(const DataType& dt) const
+    {
+        return _dtVisibilities.find(&dt) == _dtVisibilities.end();
+    }
+
+    bool _isDataFull(const DataType& dt) const
+    {
+        const auto it = _dtVisibilities.find(&dt);
+
+        return it != _dtVisibilities.end() && it->second == _Visibility::FULL;
+    }
+
+    bool _isScopeHidden(const Scope scope) const
+    {
+        return _visibleScopes.find(static_cast<int>(scope)) == _visibleScopes.end();
+    }
+
+private:
+    std::unordered_map<const DataType *, _Visibility> _dtVisibilities;
+    std::unordered_set<int> _visibleScopes;
+
+    // visibility of each instruction, indexed with Instr::index()
+    std::vector<InstrVisibility> _instrVisibilities;
+};
+
+} // namespace internal
+} // namespace yactfr
+
+#endif // _YACTFR_INTERNAL_DATA_PROJ_HPP
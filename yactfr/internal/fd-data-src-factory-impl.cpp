@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <cassert>
+#include <algorithm>
+#include <unistd.h>
+
+#include <yactfr/io-error.hpp>
+
+#include "fd-data-src-factory-impl.hpp"
+#include "utils.hpp"
+
+namespace yactfr {
+namespace internal {
+
+FdDataSrcFactoryImpl::FdDataSrcFactoryImpl(const int fd, const boost::optional<Size>& bufSize) :
+    _fd {fd}
+{
+    /*
+     * 4 MiB by default.
+     *
+     * The minimum size is four times the minimum block size so that
+     * discarding the oldest block never discards the data of a request
+     * which straddles two blocks.
+     */
+    _ring.resize(std::max(bufSize.value_or(4 << 20), static_cast<Size>(64)));
+
+    // a data source copies at most a quarter of the ring buffer at once
+    _blockSize = std::min(static_cast<Size>(_ring.size() / 4), static_cast<Size>(64 << 10));
+    _blockSize = std::max(_blockSize, static_cast<Size>(16));
+}
+
+void FdDataSrcFactoryImpl::_read()
+{
+    assert(!_isEof);
+
+    const auto ringSize = static_cast<Size>(_ring.size());
+
+    if (_endOffset - _beginOffset == ringSize) {
+        // ring buffer is full: discard the oldest block
+        _beginOffset += std::min(_blockSize, ringSize);
+    }
+
+    // read into the free space up to the end of the ring buffer
+    const auto pos = _endOffset % ringSize;
+    const auto freeSize = ringSize - (_endOffset - _beginOffset);
+    const auto size = std::min(freeSize, ringSize - pos);
+
+    while (true) {
+        const auto ret = ::read(_fd, &_ring[pos], static_cast<size_t>(size));
+
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            const auto error = internal::strError();
+            std::ostringstream ss;
+
+            ss << "Cannot read data at offset " << _endOffset <<
+                  " from file descriptor " << _fd << ": " << error;
+            throw IOError {ss.str()};
+        }
+
+        if (ret == 0) {
+            _isEof = true;
+        } else {
+            _endOffset += static_cast<Size>(ret);
+        }
+
+        return;
+    }
+}
+
+Size FdDataSrcFactoryImpl::copy(const Index offset, std::uint8_t * const buf, const Size minSize,
+                                const Size maxSize)
+{
+    assert(minSize <= maxSize);
+
+    std::lock_guard<std::mutex> lock {_mutex};
+
+    while (_endOffset < offset + minSize && !_isEof) {
+        this->_read();
+    }
+
+    if (offset < _beginOffset) {
+        std::ostringstream ss;
+
+        ss << "Cannot get data at offset " << offset << " from file descriptor " << _fd <<
+              ": data was discarded from the ring buffer (buffered data: [" <<
+              _beginOffset << ", " << _endOffset << "[)";
+        throw IOError {ss.str()};
+    }
+
+    if (_endOffset < offset + minSize) {
+        // end of data stream
+        return 0;
+    }
+
+    // copy up to two parts (the data can wrap around)
+    const auto ringSize = static_cast<Size>(_ring.size());
+    const auto size = std::min(_endOffset - offset, maxSize);
+    const auto pos = offset % ringSize;
+    const auto firstSize = std::min(size, ringSize - pos);
+
+    std::memcpy(buf, &_ring[pos], firstSize);
+    std::memcpy(buf + firstSize, _ring.data(), size - firstSize);
+    return size;
+}
+
+} // namespace internal
+} // namespace yactfr
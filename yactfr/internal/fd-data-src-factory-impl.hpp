@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_INTERNAL_FD_DATA_SRC_FACTORY_IMPL_HPP
+#define _YACTFR_INTERNAL_FD_DATA_SRC_FACTORY_IMPL_HPP
+
+#include <cstdint>
+#include <vector>
+#include <mutex>
+#include <boost/optional/optional.hpp>
+
+#include <yactfr/aliases.hpp>
+
+namespace yactfr {
+namespace internal {
+
+/*
+ * An `FdDataSrcFactoryImpl` object is shared by zero or more
+ * `FdDataSource` objects, and also by the public
+ * `FileDescriptorDataSourceFactory` object which builds it.
+ *
+ * It owns a ring buffer which contains the data of the range
+ * [`_beginOffset`, `_endOffset`[ of the data stream. When a data source
+ * needs data beyond `_endOffset`, the factory reads more data from the
+ * file descriptor, discarding the oldest data if the ring buffer is
+ * full.
+ *
+ * All the methods are thread-safe.
+ */
+class FdDataSrcFactoryImpl final
+{
+public:
+    explicit FdDataSrcFactoryImpl(int fd, const boost::optional<Size>& bufSize);
+
+    int fd() const noexcept
+    {
+        return _fd;
+    }
+
+    Size bufSize() const noexcept
+    {
+        return _ring.size();
+    }
+
+    // size of the block buffer of a data source
+    Size blockSize() const noexcept
+    {
+        return _blockSize;
+    }
+
+    /*
+     * Copies at least `minSize` and at most `maxSize` bytes of data at
+     * `offset` to `buf`, reading from the file descriptor if needed.
+     *
+     * Returns the number of copied bytes, or 0 if the data stream ends
+     * before `offset + minSize`.
+     *
+     * Throws `IOError` if the data at `offset` was discarded.
+     */
+    Size copy(Index offset, std::uint8_t *buf, Size minSize, Size maxSize);
+
+private:
+    void _read();
+
+private:
+    const int _fd;
+    Size _blockSize;
+
+    // all the following members are protected by `_mutex`
+    std::vector<std::uint8_t> _ring;
+    Index _beginOffset = 0;
+    Index _endOffset = 0;
+    bool _isEof = false;
+    std::mutex _mutex;
+};
+
+} // namespace internal
+} // namespace yactfr
+
+#endif // _YACTFR_INTERNAL_FD_DATA_SRC_FACTORY_IMPL_HPP
@@ -0,0 +1,386 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include "async-file-reader.hpp"
+
+#ifdef YACTFR_HAVE_IO_URING
+
+#include <cerrno>
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+#include <yactfr/io-error.hpp>
+
+#include "utils.hpp"
+
+namespace yactfr {
+namespace internal {
+
+/*
+ * Asynchronous file reader which submits its read requests to an
+ * io_uring instance.
+ *
+ * This implementation uses the io_uring system calls directly (no
+ * liburing) and only needs a single submission queue entry per
+ * request: the ring size is at least `maxReqCount`.
+ *
+ * A short read (which isn't the end of the file) makes the reader
+ * resubmit the remaining part of the request.
+ */
+class IoUringAsyncFileReader final :
+    public AsyncFileReader
+{
+public:
+    explicit IoUringAsyncFileReader(int fd, std::string path, Size maxReqCount, int ringFd,
+                                    const io_uring_params& params);
+    ~IoUringAsyncFileReader();
+
+    /*
+     * Sets up an io_uring instance having at least `entryCount`
+     * entries, returning its file descriptor, or a negative value on
+     * error.
+     */
+    static int setUp(Size entryCount, io_uring_params& params) noexcept;
+
+private:
+    struct _Req final
+    {
+        std::uint8_t *buf = nullptr;
+        Size size = 0;
+        Index offset = 0;
+        struct iovec iov;
+        bool isPending = false;
+        Size readSize = 0;
+        int error = 0;
+    };
+
+private:
+    void _submit(Index id, std::uint8_t *buf, Size size, Index offset) override;
+    boost::optional<Size> _result(Index id, bool wait) override;
+    void _submitRemaining(Index id);
+    void _reap();
+    void _waitOne();
+    void _mapRings(const io_uring_params& params);
+    void _unmapRings() noexcept;
+
+private:
+    std::vector<_Req> _reqs;
+    Size _pendingCount = 0;
+    int _ringFd;
+
+    // mapped memory regions (addresses and sizes)
+    void *_sqRing = MAP_FAILED;
+    Size _sqRingSize = 0;
+    void *_cqRing = MAP_FAILED;
+    Size _cqRingSize = 0;
+    void *_sqes = MAP_FAILED;
+    Size _sqesSize = 0;
+
+    // submission queue
+    unsigned *_sqTail;
+    unsigned _sqMask;
+    unsigned *_sqArray;
+
+    // completion queue
+    unsigned *_cqHead;
+    unsigned *_cqTail;
+    unsigned _cqMask;
+    io_uring_cqe *_cqes = nullptr;
+};
+
+IoUringAsyncFileReader::IoUringAsyncFileReader(const int fd, std::string path,
+                                               const Size maxReqCount, const int ringFd,
+                                               const io_uring_params& params) :
+    AsyncFileReader {fd, std::move(path)},
+    _reqs(maxReqCount),
+    _ringFd {ringFd}
+{
+    try {
+        this->_mapRings(params);
+    } catch (...) {
+        this->_unmapRings();
+        throw;
+    }
+}
+
+IoUringAsyncFileReader::~IoUringAsyncFileReader()
+{
+    // wait for all the pending requests: the kernel writes to their buffers
+    while (_pendingCount > 0) {
+        this->_waitOne();
+        this->_reap();
+    }
+
+    this->_unmapRings();
+}
+
+void IoUringAsyncFileReader::_unmapRings() noexcept
+{
+    if (_sqes != MAP_FAILED) {
+        static_cast<void>(munmap(_sqes, _sqesSize));
+        _sqes = MAP_FAILED;
+    }
+
+    if (_cqRing != MAP_FAILED && _cqRing != _sqRing) {
+        static_cast<void>(munmap(_cqRing, _cqRingSize));
+    }
+
+    _cqRing = MAP_FAILED;
+
+    if (_sqRing != MAP_FAILED) {
+        static_cast<void>(munmap(_sqRing, _sqRingSize));
+        _sqRing = MAP_FAILED;
+    }
+
+    if (_ringFd >= 0) {
+        static_cast<void>(close(_ringFd));
+        _ringFd = -1;
+    }
+}
+
+int IoUringAsyncFileReader::setUp(const Size entryCount, io_uring_params& params) noexcept
+{
+    std::memset(&params, 0, sizeof params);
+    return static_cast<int>(syscall(__NR_io_uring_setup, static_cast<unsigned>(entryCount),
+                                    &params));
+}
+
+void IoUringAsyncFileReader::_mapRings(const io_uring_params& params)
+{
+    _sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    _cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+    const bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+
+    if (singleMmap) {
+        _sqRingSize = std::max(_sqRingSize, _cqRingSize);
+        _cqRingSize = _sqRingSize;
+    }
+
+    _sqRing = mmap(nullptr, _sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   _ringFd, IORING_OFF_SQ_RING);
+
+    if (_sqRing == MAP_FAILED) {
+        throw IOError {"Cannot map io_uring submission queue: " + internal::strError()};
+    }
+
+    if (singleMmap) {
+        _cqRing = _sqRing;
+    } else {
+        _cqRing = mmap(nullptr, _cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       _ringFd, IORING_OFF_CQ_RING);
+
+        if (_cqRing == MAP_FAILED) {
+            throw IOError {"Cannot map io_uring completion queue: " + internal::strError()};
+        }
+    }
+
+    _sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    _sqes = mmap(nullptr, _sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ringFd,
+                 IORING_OFF_SQES);
+
+    if (_sqes == MAP_FAILED) {
+        throw IOError {"Cannot map io_uring submission queue entries: " + internal::strError()};
+    }
+
+    const auto sqRing = static_cast<std::uint8_t *>(_sqRing);
+    const auto cqRing = static_cast<std::uint8_t *>(_cqRing);
+
+    _sqTail = reinterpret_cast<unsigned *>(sqRing + params.sq_off.tail);
+    _sqMask = *reinterpret_cast<unsigned *>(sqRing + params.sq_off.ring_mask);
+    _sqArray = reinterpret_cast<unsigned *>(sqRing + params.sq_off.array);
+    _cqHead = reinterpret_cast<unsigned *>(cqRing + params.cq_off.head);
+    _cqTail = reinterpret_cast<unsigned *>(cqRing + params.cq_off.tail);
+    _cqMask = *reinterpret_cast<unsigned *>(cqRing + params.cq_off.ring_mask);
+    _cqes = reinterpret_cast<io_uring_cqe *>(cqRing + params.cq_off.cqes);
+}
+
+void IoUringAsyncFileReader::_submit(const Index id, std::uint8_t * const buf, const Size size,
+                                     const Index offset)
+{
+    auto& req = _reqs[id];
+
+    assert(!req.isPending);
+    req.buf = buf;
+    req.size = size;
+    req.offset = offset;
+    req.readSize = 0;
+    req.error = 0;
+    req.isPending = true;
+    ++_pendingCount;
+    this->_submitRemaining(id);
+}
+
+void IoUringAsyncFileReader::_submitRemaining(const Index id)
+{
+    auto& req = _reqs[id];
+
+    req.iov.iov_base = req.buf + req.readSize;
+    req.iov.iov_len = static_cast<size_t>(req.size - req.readSize);
+
+    // this reader is the only producer of the submission queue
+    const auto tail = *_sqTail;
+    const auto index = tail & _sqMask;
+    auto& sqe = static_cast<io_uring_sqe *>(_sqes)[index];
+
+    std::memset(&sqe, 0, sizeof sqe);
+    sqe.opcode = IORING_OP_READV;
+    sqe.fd = this->_fd();
+    sqe.addr = reinterpret_cast<std::uint64_t>(&req.iov);
+    sqe.len = 1;
+    sqe.off = static_cast<std::uint64_t>(req.offset + req.readSize);
+    sqe.user_data = static_cast<std::uint64_t>(id);
+    _sqArray[index] = index;
+    __atomic_store_n(_sqTail, tail + 1, __ATOMIC_RELEASE);
+
+    while (true) {
+        const auto ret = syscall(__NR_io_uring_enter, _ringFd, 1U, 0U, 0U, nullptr, 0);
+
+        if (ret >= 0) {
+            break;
+        }
+
+        if (errno == EINTR || errno == EAGAIN) {
+            continue;
+        }
+
+        // the kernel didn't consume the entry: forget it
+        __atomic_store_n(_sqTail, tail, __ATOMIC_RELEASE);
+        req.isPending = false;
+        --_pendingCount;
+        this->_throwReadError(req.offset, req.size, errno);
+    }
+}
+
+void IoUringAsyncFileReader::_reap()
+{
+    auto head = *_cqHead;
+    const auto tail = __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE);
+
+    while (head != tail) {
+        const auto& cqe = _cqes[head & _cqMask];
+        const auto id = static_cast<Index>(cqe.user_data);
+        const auto res = cqe.res;
+
+        ++head;
+        __atomic_store_n(_cqHead, head, __ATOMIC_RELEASE);
+
+        auto& req = _reqs[id];
+
+        assert(req.isPending);
+
+        if (res < 0) {
+            if (res == -EINTR || res == -EAGAIN) {
+                this->_submitRemaining(id);
+                continue;
+            }
+
+            req.error = -res;
+        } else if (res > 0) {
+            req.readSize += static_cast<Size>(res);
+
+            if (req.readSize < req.size) {
+                // short read: read the remaining part
+                this->_submitRemaining(id);
+                continue;
+            }
+        }
+
+        // complete (a result of 0 means the end of the file)
+        req.isPending = false;
+        --_pendingCount;
+    }
+}
+
+void IoUringAsyncFileReader::_waitOne()
+{
+    const auto ret = syscall(__NR_io_uring_enter, _ringFd, 0U, 1U, IORING_ENTER_GETEVENTS,
+                             nullptr, 0);
+
+    // on `EINTR`, the caller reaps and waits again
+    assert(ret >= 0 || errno == EINTR || errno == EAGAIN);
+    static_cast<void>(ret);
+}
+
+boost::optional<Size> IoUringAsyncFileReader::_result(const Index id, const bool wait)
+{
+    auto& req = _reqs[id];
+
+    this->_reap();
+
+    while (wait && req.isPending) {
+        this->_waitOne();
+        this->_reap();
+    }
+
+    if (req.isPending) {
+        return boost::none;
+    }
+
+    if (req.error != 0) {
+        this->_throwReadError(req.offset, req.size, req.error);
+    }
+
+    return req.readSize;
+}
+
+bool ioUringIsAvailable() noexcept
+{
+    io_uring_params params;
+    const auto ringFd = IoUringAsyncFileReader::setUp(1, params);
+
+    if (ringFd < 0) {
+        // for example, `ENOSYS` or `EPERM` (disabled or filtered out)
+        return false;
+    }
+
+    static_cast<void>(close(ringFd));
+    return true;
+}
+
+std::unique_ptr<AsyncFileReader> createIoUringAsyncFileReader(const int fd, std::string path,
+                                                              const Size maxReqCount)
+{
+    io_uring_params params;
+    const auto ringFd = IoUringAsyncFileReader::setUp(maxReqCount, params);
+
+    if (ringFd < 0) {
+        return nullptr;
+    }
+
+    return std::make_unique<IoUringAsyncFileReader>(fd, std::move(path), maxReqCount, ringFd,
+                                                    params);
+}
+
+} // namespace internal
+} // namespace yactfr
+
+#else // YACTFR_HAVE_IO_URING
+
+namespace yactfr {
+namespace internal {
+
+bool ioUringIsAvailable() noexcept
+{
+    return false;
+}
+
+std::unique_ptr<AsyncFileReader> createIoUringAsyncFileReader(int, std::string, Size)
+{
+    return nullptr;
+}
+
+} // namespace internal
+} // namespace yactfr
+
+#endif // YACTFR_HAVE_IO_URING
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cassert>
+#include <algorithm>
+
+#include "mem-data-src-factory-impl.hpp"
+
+namespace yactfr {
+namespace internal {
+
+MemDataSrcFactoryImpl::MemDataSrcFactoryImpl(const std::vector<DataBlock>& chunks) :
+    _chunkCount {chunks.size()}
+{
+    for (const auto& chunk : chunks) {
+        if (chunk.size() == 0) {
+            // nothing to read there
+            continue;
+        }
+
+        _chunks.push_back(MemChunk {
+            static_cast<const std::uint8_t *>(chunk.address()), _size, chunk.size()
+        });
+
+        _size += chunk.size();
+    }
+}
+
+Index MemDataSrcFactoryImpl::chunkIndex(const Index offset) const noexcept
+{
+    assert(offset < _size);
+
+    // find the last chunk of which the offset is less than or equal to `offset`
+    const auto it = std::upper_bound(_chunks.begin(), _chunks.end(), offset,
+                                     [](const Index offset, const MemChunk& chunk) {
+        return offset < chunk.offset;
+    });
+
+    assert(it != _chunks.begin());
+    return static_cast<Index>(it - 1 - _chunks.begin());
+}
+
+} // namespace internal
+} // namespace yactfr
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_INTERNAL_MEM_DATA_SRC_FACTORY_IMPL_HPP
+#define _YACTFR_INTERNAL_MEM_DATA_SRC_FACTORY_IMPL_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <yactfr/aliases.hpp>
+#include <yactfr/data-blk.hpp>
+
+namespace yactfr {
+namespace internal {
+
+/*
+ * Non-empty chunk of a memory data source factory.
+ */
+struct MemChunk final
+{
+    const std::uint8_t *addr;
+
+    // offset within the concatenated data
+    Index offset;
+
+    Size size;
+};
+
+/*
+ * A `MemDataSrcFactoryImpl` object is shared by zero or more
+ * `MemoryDataSource` objects, and also by the public
+ * `MemoryDataSourceFactory` object which builds it.
+ *
+ * It only keeps the non-empty chunks, with their offsets within the
+ * concatenated data, so that a data source can find the chunk which
+ * contains a given offset with a binary search. It's immutable once
+ * built.
+ */
+class MemDataSrcFactoryImpl final
+{
+public:
+    explicit MemDataSrcFactoryImpl(const std::vector<DataBlock>& chunks);
+
+    const std::vector<MemChunk>& chunks() const noexcept
+    {
+        return _chunks;
+    }
+
+    Size size() const noexcept
+    {
+        return _size;
+    }
+
+    Size chunkCount() const noexcept
+    {
+        return _chunkCount;
+    }
+
+    /*
+     * Index, within chunks(), of the chunk which contains the byte at
+     * `offset`.
+     */
+    Index chunkIndex(Index offset) const noexcept;
+
+private:
+    std::vector<MemChunk> _chunks;
+    Size _size = 0;
+    Size _chunkCount;
+};
+
+} // namespace internal
+} // namespace yactfr
+
+#endif // _YACTFR_INTERNAL_MEM_DATA_SRC_FACTORY_IMPL_HPP
@@ -12,6 +12,7 @@
 #include <cassert>
 #include <memory>
 #include <vector>
+#include <array>
 #include <limits>
 #include <regex>
 #include <cmath>
@@ -7,11 +7,13 @@
 
 #include <sstream>
 #include <vector>
+#include <algorithm>
 #include <cassert>
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <string.h>
 #include <errno.h>
 
@@ -25,9 +27,12 @@ namespace internal {
 
 MmapFileViewFactoryImpl::MmapFileViewFactoryImpl(std::string path,
                                                  const boost::optional<Size>& preferredMmapSize,
-                                                 const MemoryMappedFileViewFactory::AccessPattern accessPattern) :
+                                                 const MemoryMappedFileViewFactory::AccessPattern accessPattern,
+                                                 const boost::optional<Size>& maxCachedMmapSize,
+                                                 const bool isLive) :
     _path {std::move(path)},
-    _accessPattern {accessPattern}
+    _accessPattern {accessPattern},
+    _isLive {isLive}
 {
     _fd = open(_path.c_str(), O_RDONLY);
 
@@ -66,6 +71,135 @@ MmapFileViewFactoryImpl::MmapFileViewFactoryImpl(std::string path,
         // 512 MiB
         _mmapSize = 512 << 20;
     }
+
+    if (maxCachedMmapSize) {
+        _maxCachedMmapSize = *maxCachedMmapSize;
+    } else {
+        _maxCachedMmapSize = _mmapSize * 4;
+    }
+}
+
+Size MmapFileViewFactoryImpl::updateFileSize()
+{
+    struct stat stat;
+
+    if (fstat(_fd, &stat) < 0) {
+        const auto error = internal::strError();
+        std::ostringstream ss;
+
+        ss << "Cannot get file status for \"" << _path << "\": " << error;
+        throw IOError {ss.str()};
+    }
+
+    // the file never shrinks: keep the largest known size
+    const auto fileSize = static_cast<Size>(stat.st_size);
+    auto curFileSize = _fileSize.load();
+
+    while (fileSize > curFileSize && !_fileSize.compare_exchange_weak(curFileSize, fileSize)) {
+    }
+
+    return std::max(fileSize, curFileSize);
+}
+
+const MmapRegion& MmapFileViewFactoryImpl::pinRegion(const Index offset)
+{
+    assert(offset < _fileSize);
+
+    std::lock_guard<std::mutex> lock {_regionsMutex};
+    const auto index = offset / _mmapSize;
+    const auto it = _regions.find(index);
+
+    if (it != _regions.end()) {
+        auto& region = it->second;
+
+        if (region.pinCount == 0) {
+            _lru.erase(region.lruIt);
+        }
+
+        ++region.pinCount;
+        ++_counters.cachedRegionHitCount;
+        return region;
+    }
+
+    const auto regionOffset = index * _mmapSize;
+
+    /*
+     * In live mode, map the whole window, even beyond the current end
+     * of the file: the pages of a shared mapping become accessible as
+     * the file grows.
+     */
+    const auto length = _isLive ? _mmapSize : std::min(_fileSize - regionOffset, _mmapSize);
+    const auto addr = mmap(NULL, static_cast<size_t>(length), PROT_READ,
+                           _isLive ? MAP_SHARED : MAP_PRIVATE, _fd,
+                           static_cast<off_t>(regionOffset));
+
+    if (addr == MAP_FAILED) {
+        const auto error = internal::strError();
+        std::ostringstream ss;
+
+        ss << "Cannot memory-map region [" << regionOffset << ", " <<
+              (regionOffset + length) << "[ of file \"" << _path << "\": " << error;
+        throw IOError {ss.str()};
+    }
+
+    ++_counters.mmapCount;
+
+    switch (_accessPattern) {
+    case MemoryMappedFileViewFactory::AccessPattern::NORMAL:
+    case MemoryMappedFileViewFactory::AccessPattern::ADAPTIVE:
+        // with `ADAPTIVE`, each view advises the ranges it accesses
+        (void) madvise(addr, static_cast<size_t>(length), MADV_NORMAL);
+        break;
+    case MemoryMappedFileViewFactory::AccessPattern::SEQUENTIAL:
+        (void) madvise(addr, static_cast<size_t>(length), MADV_SEQUENTIAL);
+        break;
+    case MemoryMappedFileViewFactory::AccessPattern::RANDOM:
+        (void) madvise(addr, static_cast<size_t>(length), MADV_RANDOM);
+        break;
+    }
+
+    auto& region = _regions[index];
+
+    region.addr = addr;
+    region.offset = regionOffset;
+    region.length = length;
+    region.pinCount = 1;
+    _mappedSize += length;
+
+    // make room for the new region if possible
+    this->_evict();
+    return region;
+}
+
+void MmapFileViewFactoryImpl::unpinRegion(const MmapRegion& region)
+{
+    std::lock_guard<std::mutex> lock {_regionsMutex};
+    auto& mutRegion = _regions.at(region.offset / _mmapSize);
+
+    assert(mutRegion.pinCount > 0);
+    --mutRegion.pinCount;
+
+    if (mutRegion.pinCount == 0) {
+        _lru.push_front(region.offset / _mmapSize);
+        mutRegion.lruIt = _lru.begin();
+        this->_evict();
+    }
+}
+
+void MmapFileViewFactoryImpl::_evict()
+{
+    // only unpinned regions are candidates
+    while (_mappedSize > _maxCachedMmapSize && !_lru.empty()) {
+        const auto it = _regions.find(_lru.back());
+
+        assert(it != _regions.end());
+        assert(it->second.pinCount == 0);
+        munmap(it->second.addr, static_cast<size_t>(it->second.length));
+        ++_counters.munmapCount;
+        _mappedSize -= it->second.length;
+        _regions.erase(it);
+        _lru.pop_back();
+    }
 }
 
 void MmapFileViewFactoryImpl::_close()
@@ -79,6 +213,12 @@ void MmapFileViewFactoryImpl::_close()
 
 MmapFileViewFactoryImpl::~MmapFileViewFactoryImpl()
 {
+    // no more views: all the regions are unpinned
+    for (auto& indexRegionPair : _regions) {
+        assert(indexRegionPair.second.pinCount == 0);
+        munmap(indexRegionPair.second.addr, static_cast<size_t>(indexRegionPair.second.length));
+    }
+
     this->_close();
 }
 
@@ -9,30 +9,85 @@
 #define _YACTFR_INTERNAL_MMAP_FILE_VIEW_FACTORY_IMPL_HPP
 
 #include <string>
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
 #include <yactfr/aliases.hpp>
 #include <yactfr/mmap-file-view-factory.hpp>
 
 namespace yactfr {
 namespace internal {
 
+/*
+ * Memory mapped region of a file.
+ *
+ * The offset of a region is a multiple of the memory map size of its
+ * factory.
+ */
+struct MmapRegion final
+{
+    void *addr;
+    Index offset;
+    Size length;
+
+    // number of memory mapped file views which currently use this region
+    Size pinCount;
+
+    // position within the LRU list of unpinned regions (if `pinCount` is 0)
+    std::list<Index>::iterator lruIt;
+};
+
+/*
+ * Counters of an `MmapFileViewFactoryImpl` object and of its views.
+ *
+ * See `MemoryMappedFileViewFactory::Counters`.
+ */
+struct MmapCounters final
+{
+    std::atomic<Size> mmapCount {0};
+    std::atomic<Size> munmapCount {0};
+    std::atomic<Size> cachedRegionHitCount {0};
+    std::atomic<Size> readAheadSize {0};
+    std::atomic<Size> releasedSize {0};
+    std::atomic<Size> sequentialSwitchCount {0};
+    std::atomic<Size> randomSwitchCount {0};
+};
+
 /*
  * An `MmapFileViewFactoryImpl` object is shared by zero or more
  * `MemoryMappedFileView` objects, and also by the public
- * `MemoryMappedFileViewFactory` object which builds it. Its only
- * purpose is to open a file and keep its file descriptor open so that a
- * `MemoryMappedFileView` object can perform memory map operations on it
- * and guarantee its lifetime.
+ * `MemoryMappedFileViewFactory` object which builds it. It opens a
+ * file and keeps its file descriptor open so that it can perform memory
+ * map operations on it and guarantee its lifetime.
+ *
+ * It also owns a cache of memory mapped regions which its
+ * `MemoryMappedFileView` objects share: a view pins the region which
+ * contains its current data and unpins it when it needs another one.
+ * The cache keeps unpinned regions mapped, unmapping the least
+ * recently used ones when the total size of the mapped regions exceeds
+ * a maximum cached size. Therefore, copying an element sequence
+ * iterator or seeking back and forth usually doesn't involve any
+ * memory map operation.
  *
  * `MemoryMappedFileView` objects also have access to some parameters
  * like the preferred memory map size and the expected data access
  * pattern.
+ *
+ * In live mode, the file can grow while views read it: the factory
+ * always maps whole `mmapSize()` windows, even beyond the current end
+ * of the file, so that a mapped region remains valid as the file
+ * grows, and updateFileSize() gets the current size of the file. The
+ * file must never shrink.
  */
 class MmapFileViewFactoryImpl final
 {
 public:
     explicit MmapFileViewFactoryImpl(std::string path,
                                      const boost::optional<Size>& preferredMmapSize,
-                                     MemoryMappedFileViewFactory::AccessPattern accessPattern);
+                                     MemoryMappedFileViewFactory::AccessPattern accessPattern,
+                                     const boost::optional<Size>& maxCachedMmapSize,
+                                     bool isLive = false);
     ~MmapFileViewFactoryImpl();
 
     int fd() const noexcept
@@ -40,11 +95,33 @@ public:
         return _fd;
     }
 
+    // last known file size
     Size fileSize() const noexcept
     {
         return _fileSize;
     }
 
+    /*
+     * Gets the current size of the file, updating the last known file
+     * size, and returns it.
+     */
+    Size updateFileSize();
+
+    bool isLive() const noexcept
+    {
+        return _isLive;
+    }
+
+    bool isComplete() const noexcept
+    {
+        return _isComplete;
+    }
+
+    void markComplete() noexcept
+    {
+        _isComplete = true;
+    }
+
     Size mmapOffsetGranularity() const noexcept
     {
         return _mmapOffsetGranularity;
@@ -70,16 +147,58 @@ public:
         _accessPattern = accessPattern;
     }
 
+    Size maxCachedMmapSize() const noexcept
+    {
+        return _maxCachedMmapSize;
+    }
+
+    MmapCounters& counters() noexcept
+    {
+        return _counters;
+    }
+
+    /*
+     * Pins and returns the region which contains the byte at `offset`,
+     * memory mapping it if needed.
+     *
+     * The returned region remains valid until the caller unpins it
+     * with unpinRegion().
+     */
+    const MmapRegion& pinRegion(Index offset);
+
+    /*
+     * Unpins the region `region`, which pinRegion() returned.
+     */
+    void unpinRegion(const MmapRegion& region);
+
 private:
     void _close();
+    void _evict();
 
 private:
     const std::string _path;
     Size _mmapSize;
     MemoryMappedFileViewFactory::AccessPattern _accessPattern;
+    const bool _isLive;
+    std::atomic<bool> _isComplete {false};
     int _fd = -1;
-    Size _fileSize;
+    std::atomic<Size> _fileSize;
     Size _mmapOffsetGranularity;
+    Size _maxCachedMmapSize;
+    MmapCounters _counters;
+
+    // all the following members are protected by `_regionsMutex`
+
+    // memory mapped regions, keyed by index (offset / `_mmapSize`)
+    std::unordered_map<Index, MmapRegion> _regions;
+
+    // indexes of unpinned regions, most recently used first
+    std::list<Index> _lru;
+
+    // total length of all the memory mapped regions
+    Size _mappedSize = 0;
+
+    std::mutex _regionsMutex;
 };
 
 } // namespace internal
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2017-2018 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_INTERNAL_MMAP_FILE_VIEW_HPP
+#define _YACTFR_INTERNAL_MMAP_FILE_VIEW_HPP
+
+#include <array>
+#include <memory>
+#include <boost/optional/optional.hpp>
+
+#include <yactfr/aliases.hpp>
+#include <yactfr/data-src.hpp>
+#include <yactfr/data-blk.hpp>
+
+#include "mmap-file-view-factory-impl.hpp"
+
+namespace yactfr {
+namespace internal {
+
+/*
+ * Memory mapped file view, the data source of both
+ * `MemoryMappedFileViewFactory` and `LiveFileDataSourceFactory`.
+ */
+class MemoryMappedFileView final :
+    public DataSource
+{
+public:
+    explicit MemoryMappedFileView(std::shared_ptr<internal::MmapFileViewFactoryImpl> mmapFileViewFactoryImpl);
+    ~MemoryMappedFileView();
+
+private:
+    boost::optional<DataBlock> _data(Index offset, Size minSize) override;
+    void _pinRegion(Index offset);
+    void _adapt(Index offset, Index blkEndOffset);
+    Size _advise(Index beginOffset, Index endOffset, int advice);
+    Size _release(Index beginOffset, Index endOffset);
+
+private:
+    /*
+     * With the adaptive access pattern, maximum size of a returned data
+     * block so that this view gets called regularly, and size of the
+     * consumed range to keep before releasing it.
+     */
+    static constexpr Size _adaptiveBlkSize = 2 << 20;
+
+    // with the adaptive access pattern, size of the range to read ahead
+    static constexpr Size _adaptiveReadAheadSize = 8 << 20;
+
+private:
+    std::shared_ptr<internal::MmapFileViewFactoryImpl> _mmapFileViewFactoryImpl;
+
+    // current pinned region of the cache of the factory
+    const MmapRegion *_region = nullptr;
+
+    std::array<std::uint8_t, 16> _tmpBuf;
+
+    // adaptive access pattern: previous data block
+    bool _hasPrevBlk = false;
+    Index _prevBlkOffset = 0;
+    Index _prevBlkEndOffset = 0;
+
+    // adaptive access pattern: number of consecutive sequential accesses
+    Size _seqAccessCount = 0;
+
+    // adaptive access pattern: current mode
+    bool _isSequential = false;
+
+    // adaptive access pattern: end of the advised read-ahead/released ranges
+    Index _readAheadEndOffset = 0;
+    Index _releasedEndOffset = 0;
+};
+
+} // namespace internal
+} // namespace yactfr
+
+#endif // _YACTFR_INTERNAL_MMAP_FILE_VIEW_HPP
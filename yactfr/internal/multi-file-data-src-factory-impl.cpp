@@ -0,0 +1,310 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cerrno>
+#include <sstream>
+#include <cassert>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#include <yactfr/io-error.hpp>
+
+#include "multi-file-data-src-factory-impl.hpp"
+#include "utils.hpp"
+
+namespace yactfr {
+namespace internal {
+
+MultiFileDataSrcFactoryImpl::MultiFileDataSrcFactoryImpl(std::vector<std::string> paths,
+                                                         const boost::optional<Size>& maxOpenFileCount,
+                                                         const boost::optional<Size>& blockSize) :
+    _paths {std::move(paths)}
+{
+    _alignment = sysconf(_SC_PAGE_SIZE);
+    assert(_alignment >= 1);
+
+    if (maxOpenFileCount) {
+        _maxOpenFileCount = std::max(*maxOpenFileCount, static_cast<Size>(1));
+    } else {
+        _maxOpenFileCount = 64;
+    }
+
+    if (blockSize) {
+        _blockSize = std::max(*blockSize, static_cast<Size>(1));
+    } else {
+        // 1 MiB
+        _blockSize = 1 << 20;
+    }
+
+    _blockSize = (_blockSize + _alignment - 1) & ~(_alignment - 1);
+    assert(_blockSize >= BufFileDataSrcBuf::carryOverSize);
+    _files.reserve(_paths.size());
+}
+
+MultiFileDataSrcFactoryImpl::~MultiFileDataSrcFactoryImpl()
+{
+    for (auto& file : _files) {
+        if (file.fd >= 0) {
+            this->_closeFile(file);
+        }
+    }
+}
+
+void MultiFileDataSrcFactoryImpl::_discoverFile()
+{
+    assert(_files.size() < _paths.size());
+
+    const auto& path = _paths[_files.size()];
+    struct stat stat;
+
+    if (::stat(path.c_str(), &stat) < 0) {
+        const auto error = internal::strError();
+        std::ostringstream ss;
+
+        ss << "Cannot get file status for \"" << path << "\": " << error;
+        throw IOError {ss.str()};
+    }
+
+    _File file;
+
+    file.offset = _files.empty() ? 0 : _files.back().offset + _files.back().size;
+    file.size = static_cast<Size>(stat.st_size);
+    _files.push_back(file);
+}
+
+bool MultiFileDataSrcFactoryImpl::_discoverUntil(const Index endOffset)
+{
+    while (_files.empty() || _files.back().offset + _files.back().size < endOffset) {
+        if (_files.size() == _paths.size()) {
+            return false;
+        }
+
+        this->_discoverFile();
+    }
+
+    return true;
+}
+
+boost::optional<MultiFileDataSourceFactory::Location> MultiFileDataSrcFactoryImpl::location(const Index offset)
+{
+    std::lock_guard<std::mutex> lock {_mutex};
+
+    if (!this->_discoverUntil(offset + 1)) {
+        return boost::none;
+    }
+
+    /*
+     * Find the last file of which the offset is less than or equal to
+     * `offset`: this skips the empty files.
+     */
+    const auto it = std::upper_bound(_files.begin(), _files.end(), offset,
+                                     [](const Index offset, const _File& file) {
+        return offset < file.offset;
+    });
+
+    assert(it != _files.begin());
+
+    const auto fileIt = it - 1;
+
+    assert(offset < fileIt->offset + fileIt->size);
+    return MultiFileDataSourceFactory::Location {
+        static_cast<Index>(fileIt - _files.begin()),
+        offset - fileIt->offset
+    };
+}
+
+Index MultiFileDataSrcFactoryImpl::fileOffset(const Index fileIndex)
+{
+    assert(fileIndex < _paths.size());
+
+    std::lock_guard<std::mutex> lock {_mutex};
+
+    while (_files.size() <= fileIndex) {
+        this->_discoverFile();
+    }
+
+    return _files[fileIndex].offset;
+}
+
+Size MultiFileDataSrcFactoryImpl::fileSize(const Index fileIndex)
+{
+    assert(fileIndex < _paths.size());
+
+    std::lock_guard<std::mutex> lock {_mutex};
+
+    while (_files.size() <= fileIndex) {
+        this->_discoverFile();
+    }
+
+    return _files[fileIndex].size;
+}
+
+bool MultiFileDataSrcFactoryImpl::hasSize(const Size size)
+{
+    std::lock_guard<std::mutex> lock {_mutex};
+
+    return this->_discoverUntil(size);
+}
+
+int MultiFileDataSrcFactoryImpl::_pinFd(const Index fileIndex)
+{
+    auto& file = _files[fileIndex];
+
+    if (file.fd >= 0) {
+        if (file.pinCount == 0) {
+            _lru.erase(file.lruIt);
+        }
+
+        ++file.pinCount;
+        return file.fd;
+    }
+
+    // make room for this file
+    while (_openFileCount >= _maxOpenFileCount && !_lru.empty()) {
+        this->_closeFile(_files[_lru.back()]);
+    }
+
+    const auto& path = _paths[fileIndex];
+
+    file.fd = open(path.c_str(), O_RDONLY);
+
+    if (file.fd < 0) {
+        const auto error = internal::strError();
+        std::ostringstream ss;
+
+        ss << "Cannot open \"" << path << "\" for reading: " << error;
+        throw IOError {ss.str()};
+    }
+
+    /*
+     * Advise the kernel that the data sources mostly read this file
+     * sequentially (more read ahead).
+     */
+    (void) posix_fadvise(file.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    ++_openFileCount;
+    ++file.pinCount;
+    return file.fd;
+}
+
+void MultiFileDataSrcFactoryImpl::_unpinFd(const Index fileIndex)
+{
+    auto& file = _files[fileIndex];
+
+    assert(file.pinCount > 0);
+    --file.pinCount;
+
+    if (file.pinCount > 0) {
+        return;
+    }
+
+    _lru.push_front(fileIndex);
+    file.lruIt = _lru.begin();
+
+    // other files could be open beyond the limit while all were pinned
+    while (_openFileCount > _maxOpenFileCount && !_lru.empty()) {
+        this->_closeFile(_files[_lru.back()]);
+    }
+}
+
+void MultiFileDataSrcFactoryImpl::_closeFile(_File& file)
+{
+    assert(file.fd >= 0);
+    assert(file.pinCount == 0);
+
+    // an open unpinned file is always within `_lru`
+    _lru.erase(file.lruIt);
+
+    // TODO: check return value and log (do not throw) on error
+    static_cast<void>(close(file.fd));
+    file.fd = -1;
+    --_openFileCount;
+}
+
+Size MultiFileDataSrcFactoryImpl::read(const Index fileIndex, const Index offset,
+                                       std::uint8_t * const buf, const Size size)
+{
+    int fd;
+
+    {
+        std::lock_guard<std::mutex> lock {_mutex};
+
+        assert(fileIndex < _files.size());
+        fd = this->_pinFd(fileIndex);
+    }
+
+    Size readSize = 0;
+    int error = 0;
+
+    while (readSize < size) {
+        const auto ret = pread(fd, buf + readSize, static_cast<size_t>(size - readSize),
+                               static_cast<off_t>(offset + readSize));
+
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            error = errno;
+            break;
+        }
+
+        if (ret == 0) {
+            // end of file
+            break;
+        }
+
+        readSize += static_cast<Size>(ret);
+    }
+
+    std::lock_guard<std::mutex> lock {_mutex};
+
+    this->_unpinFd(fileIndex);
+
+    if (error != 0) {
+        errno = error;
+
+        const auto errorStr = internal::strError();
+        std::ostringstream ss;
+
+        ss << "Cannot read region [" << offset << ", " << (offset + size) <<
+              "[ of file \"" << _paths[fileIndex] << "\": " << errorStr;
+        throw IOError {ss.str()};
+    }
+
+    return readSize;
+}
+
+std::unique_ptr<BufFileDataSrcBuf> MultiFileDataSrcFactoryImpl::takeBuf()
+{
+    {
+        std::lock_guard<std::mutex> lock {_mutex};
+
+        if (!_bufs.empty()) {
+            auto buf = std::move(_bufs.back());
+
+            _bufs.pop_back();
+            return buf;
+        }
+    }
+
+    return std::make_unique<BufFileDataSrcBuf>(_blockSize, _alignment);
+}
+
+void MultiFileDataSrcFactoryImpl::giveBackBuf(std::unique_ptr<BufFileDataSrcBuf> buf)
+{
+    assert(buf);
+
+    std::lock_guard<std::mutex> lock {_mutex};
+
+    _bufs.push_back(std::move(buf));
+}
+
+} // namespace internal
+} // namespace yactfr
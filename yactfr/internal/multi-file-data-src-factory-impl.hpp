@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_INTERNAL_MULTI_FILE_DATA_SRC_FACTORY_IMPL_HPP
+#define _YACTFR_INTERNAL_MULTI_FILE_DATA_SRC_FACTORY_IMPL_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <list>
+#include <mutex>
+#include <memory>
+#include <boost/optional/optional.hpp>
+
+#include <yactfr/aliases.hpp>
+#include <yactfr/multi-file-data-src-factory.hpp>
+
+#include "buf-file-data-src-factory-impl.hpp"
+
+namespace yactfr {
+namespace internal {
+
+/*
+ * A `MultiFileDataSrcFactoryImpl` object is shared by zero or more
+ * `MultiFileDataSource` objects, and also by the public
+ * `MultiFileDataSourceFactory` object which builds it.
+ *
+ * It discovers the sizes of its files lazily, in order, to map
+ * offsets within the concatenated data to file locations, and owns a
+ * pool of file descriptors: read() opens a file if needed, closing the
+ * least recently used one if there are already `maxOpenFileCount` open
+ * files.
+ *
+ * It also keeps the buffers of destroyed `MultiFileDataSource` objects
+ * so that new data sources may reuse them.
+ *
+ * All the methods are thread-safe.
+ */
+class MultiFileDataSrcFactoryImpl final
+{
+public:
+    explicit MultiFileDataSrcFactoryImpl(std::vector<std::string> paths,
+                                         const boost::optional<Size>& maxOpenFileCount,
+                                         const boost::optional<Size>& blockSize);
+    ~MultiFileDataSrcFactoryImpl();
+
+    const std::vector<std::string>& paths() const noexcept
+    {
+        return _paths;
+    }
+
+    Size maxOpenFileCount() const noexcept
+    {
+        return _maxOpenFileCount;
+    }
+
+    Size blockSize() const noexcept
+    {
+        return _blockSize;
+    }
+
+    /*
+     * Location of the byte at `offset` within the concatenated data,
+     * or `boost::none` if there's no such byte.
+     */
+    boost::optional<MultiFileDataSourceFactory::Location> location(Index offset);
+
+    /*
+     * Offset of the first byte of the file `fileIndex` within the
+     * concatenated data.
+     */
+    Index fileOffset(Index fileIndex);
+
+    /*
+     * Size of the file `fileIndex`.
+     */
+    Size fileSize(Index fileIndex);
+
+    /*
+     * Whether or not the concatenated data contains at least `size`
+     * bytes.
+     */
+    bool hasSize(Size size);
+
+    /*
+     * Reads up to `size` bytes at the offset `offset` of the file
+     * `fileIndex` into `buf`, returning the number of read bytes.
+     */
+    Size read(Index fileIndex, Index offset, std::uint8_t *buf, Size size);
+
+    /*
+     * Returns a recycled buffer or a new one.
+     */
+    std::unique_ptr<BufFileDataSrcBuf> takeBuf();
+
+    /*
+     * Keeps the buffer `buf` for a future call to takeBuf().
+     */
+    void giveBackBuf(std::unique_ptr<BufFileDataSrcBuf> buf);
+
+private:
+    struct _File final
+    {
+        // offset within the concatenated data
+        Index offset;
+
+        Size size;
+
+        // file descriptor, or -1 if not open
+        int fd = -1;
+
+        // number of current read() calls on this file
+        Size pinCount = 0;
+
+        // position within `_lru` (if open and `pinCount` is 0)
+        std::list<Index>::iterator lruIt;
+    };
+
+private:
+    void _discoverFile();
+    bool _discoverUntil(Index endOffset);
+    int _pinFd(Index fileIndex);
+    void _unpinFd(Index fileIndex);
+    void _closeFile(_File& file);
+
+private:
+    const std::vector<std::string> _paths;
+    Size _maxOpenFileCount;
+    Size _blockSize;
+    Size _alignment;
+
+    // all the following members are protected by `_mutex`
+
+    // files of which the size is known (first ones of `_paths`)
+    std::vector<_File> _files;
+
+    // indexes of open unpinned files, most recently used first
+    std::list<Index> _lru;
+
+    Size _openFileCount = 0;
+
+    // recycled buffers
+    std::vector<std::unique_ptr<BufFileDataSrcBuf>> _bufs;
+
+    std::mutex _mutex;
+};
+
+} // namespace internal
+} // namespace yactfr
+
+#endif // _YACTFR_INTERNAL_MULTI_FILE_DATA_SRC_FACTORY_IMPL_HPP
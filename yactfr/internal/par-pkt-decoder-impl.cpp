@@ -0,0 +1,259 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+#include <yactfr/elem.hpp>
+
+#include "par-pkt-decoder-impl.hpp"
+
+namespace yactfr {
+namespace internal {
+
+// approximate size (bytes) of a packet range when not specified
+static constexpr Size defTargetRangeSize = 1024 * 1024;
+
+// minimum number of packet ranges per worker thread when not specified
+static constexpr Size defMinRangesPerWorker = 4;
+
+// number of reorder buffer slots per worker thread when not specified
+static constexpr Size defSlotsPerWorker = 2;
+
+static Size defPktsPerRange(const PacketIndex& pktIndex, const Size workerCount)
+{
+    if (pktIndex.size() < 2) {
+        return 1;
+    }
+
+    // average packet size from the offsets of the first and last packets
+    const auto avgPktSize = std::max<Size>((pktIndex[pktIndex.size() - 1].offsetInElementSequence() -
+                                            pktIndex[0].offsetInElementSequence()) /
+                                           (pktIndex.size() - 1), 1);
+    const auto bySize = (defTargetRangeSize + avgPktSize - 1) / avgPktSize;
+
+    // make sure all the worker threads can get work
+    const auto byCount = (pktIndex.size() + workerCount * defMinRangesPerWorker - 1) /
+                         (workerCount * defMinRangesPerWorker);
+
+    return std::max<Size>(std::min(bySize, byCount), 1);
+}
+
+/*
+ * Returns a copy of `opts` which makes the iterators also produce
+ * packet beginning elements: a worker thread needs them to find where
+ * the next packet range begins.
+ */
+static ElementSequenceOptions withPktBeginningElems(const ElementSequenceOptions& opts)
+{
+    auto newOpts = opts;
+
+    if (newOpts.elementKinds()) {
+        auto kinds = *newOpts.elementKinds();
+
+        kinds.insert(Element::Kind::PACKET_BEGINNING);
+        newOpts.elementKinds(std::move(kinds));
+    }
+
+    return newOpts;
+}
+
+ParPktDecoderImpl::ParPktDecoderImpl(const TraceType& traceType, DataSourceFactory& dataSrcFactory,
+                                     const PacketIndex& pktIndex,
+                                     const ElementSequenceOptions& opts,
+                                     const boost::optional<Size>& workerCount,
+                                     const boost::optional<Size>& pktsPerRange,
+                                     const boost::optional<Size>& maxPendingRangeCount) :
+    _elemSeq {traceType, dataSrcFactory, withPktBeginningElems(opts)},
+    _recordPktBeginningElems {
+        !opts.elementKinds() || opts.elementKinds()->count(Element::Kind::PACKET_BEGINNING) > 0
+    }
+{
+    auto actualWorkerCount = workerCount.value_or(std::thread::hardware_concurrency());
+
+    actualWorkerCount = std::max<Size>(actualWorkerCount, 1);
+    _pktsPerRange = std::max<Size>(pktsPerRange.value_or(defPktsPerRange(pktIndex,
+                                                                         actualWorkerCount)),
+                                   1);
+
+    for (Index i = 0; i < pktIndex.size(); i += _pktsPerRange) {
+        const auto endIndex = i + _pktsPerRange;
+        boost::optional<Index> endOffsetBits;
+
+        if (endIndex < pktIndex.size()) {
+            endOffsetBits = pktIndex[endIndex].offsetInElementSequence() * 8;
+        }
+
+        _ranges.push_back(_Range {pktIndex[i].offsetInElementSequence(), endOffsetBits});
+    }
+
+    // no need for more worker threads than packet ranges
+    actualWorkerCount = std::min<Size>(actualWorkerCount, _ranges.size());
+    _slots = std::vector<_Slot>(std::max<Size>(maxPendingRangeCount.value_or(actualWorkerCount *
+                                                                            defSlotsPerWorker),
+                                               1));
+
+    /*
+     * Create the element sequence iterators of the worker threads on
+     * this thread: creating the first iterator of an element sequence
+     * builds the packet procedure of its trace type, which isn't
+     * thread-safe, and the worker threads only seek packets afterwards.
+     */
+    std::vector<ElementSequence::Iterator> its;
+
+    for (Index i = 0; i < actualWorkerCount; ++i) {
+        its.push_back(_elemSeq.begin());
+    }
+
+    try {
+        for (auto& it : its) {
+            _workers.emplace_back(&ParPktDecoderImpl::_workerFunc, this, std::move(it));
+        }
+    } catch (...) {
+        // the destructor won't run: stop the started worker threads
+        this->_stopWorkers();
+        throw;
+    }
+}
+
+ParPktDecoderImpl::~ParPktDecoderImpl()
+{
+    this->_stopWorkers();
+}
+
+void ParPktDecoderImpl::_stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock {_mutex};
+
+        _stop = true;
+    }
+
+    _freeCv.notify_all();
+
+    for (auto& worker : _workers) {
+        worker.join();
+    }
+}
+
+void ParPktDecoderImpl::_decodeRange(ElementSequence::Iterator& it, const _Range& range,
+                                     ElementBatch& batch)
+{
+    const auto endIt = _elemSeq.end();
+
+    if (it == endIt) {
+        // an iterator at the end has no VM to seek with
+        it = _elemSeq.at(range.offset);
+    } else {
+        it.seekPacket(range.offset);
+    }
+
+    /*
+     * The packet range ends with the element preceding the packet
+     * beginning element of the next packet range.
+     *
+     * Comparing the offset of any other element isn't enough: the
+     * offset of a packet end element is the offset of the next packet.
+     */
+    for (; it != endIt; ++it) {
+        if (it->kind() == Element::Kind::PACKET_BEGINNING) {
+            if (range.endOffsetBits && it.offset() >= *range.endOffsetBits) {
+                break;
+            }
+
+            if (!_recordPktBeginningElems) {
+                continue;
+            }
+        }
+
+        batch._append(*it, it.offset());
+    }
+}
+
+void ParPktDecoderImpl::_workerFunc(ElementSequence::Iterator it)
+{
+    while (true) {
+        Index rangeIndex;
+        _Slot *slot;
+
+        {
+            std::unique_lock<std::mutex> lock {_mutex};
+
+            _freeCv.wait(lock, [this] {
+                return _stop || _nextClaimedRangeIndex >= _ranges.size() ||
+                       _nextClaimedRangeIndex < _nextDeliveredRangeIndex + _slots.size();
+            });
+
+            if (_stop || _nextClaimedRangeIndex >= _ranges.size()) {
+                return;
+            }
+
+            rangeIndex = _nextClaimedRangeIndex;
+            ++_nextClaimedRangeIndex;
+            slot = &_slots[rangeIndex % _slots.size()];
+        }
+
+        assert(!slot->isReady);
+        slot->batch._clear();
+        slot->exc = nullptr;
+
+        try {
+            this->_decodeRange(it, _ranges[rangeIndex], slot->batch);
+        } catch (...) {
+            slot->exc = std::current_exception();
+        }
+
+        slot->batch._finish();
+
+        {
+            std::lock_guard<std::mutex> lock {_mutex};
+
+            slot->isReady = true;
+        }
+
+        _readyCv.notify_one();
+    }
+}
+
+bool ParPktDecoderImpl::next(ElementBatch& batch)
+{
+    std::unique_lock<std::mutex> lock {_mutex};
+
+    if (_nextDeliveredRangeIndex >= _ranges.size()) {
+        return false;
+    }
+
+    auto& slot = _slots[_nextDeliveredRangeIndex % _slots.size()];
+
+    _readyCv.wait(lock, [&slot] {
+        return slot.isReady;
+    });
+
+    if (slot.exc) {
+        // stop all the worker threads: `slot` remains ready
+        _stop = true;
+        lock.unlock();
+        _freeCv.notify_all();
+        std::rethrow_exception(slot.exc);
+    }
+
+    /*
+     * Swapping the vectors keeps the section beginnings of the records
+     * valid: they point to the buffer of the section data vector.
+     */
+    std::swap(batch._records, slot.batch._records);
+    std::swap(batch._sectionData, slot.batch._sectionData);
+    slot.isReady = false;
+    ++_nextDeliveredRangeIndex;
+    lock.unlock();
+    _freeCv.notify_all();
+    return true;
+}
+
+} // namespace internal
+} // namespace yactfr
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_INTERNAL_PAR_PKT_DECODER_IMPL_HPP
+#define _YACTFR_INTERNAL_PAR_PKT_DECODER_IMPL_HPP
+
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <exception>
+#include <condition_variable>
+#include <boost/optional/optional.hpp>
+
+#include <yactfr/aliases.hpp>
+#include <yactfr/elem-batch.hpp>
+#include <yactfr/elem-seq.hpp>
+#include <yactfr/elem-seq-it.hpp>
+#include <yactfr/pkt-index.hpp>
+
+namespace yactfr {
+namespace internal {
+
+/*
+ * Parallel packet decoder implementation.
+ *
+ * The packet range `i` uses the slot `i % _slots.size()` of the
+ * reorder buffer. A worker thread only claims the packet range `i` when
+ * `i < _nextDeliveredRangeIndex + _slots.size()`, so that the slot is
+ * free: the consumer already delivered the packet range which
+ * previously used it.
+ *
+ * A worker thread fills the element batch of its slot without holding
+ * `_mutex`: nothing else accesses a claimed slot until it's ready.
+ */
+class ParPktDecoderImpl final
+{
+public:
+    explicit ParPktDecoderImpl(const TraceType& traceType, DataSourceFactory& dataSrcFactory,
+                               const PacketIndex& pktIndex, const ElementSequenceOptions& opts,
+                               const boost::optional<Size>& workerCount,
+                               const boost::optional<Size>& pktsPerRange,
+                               const boost::optional<Size>& maxPendingRangeCount);
+
+    ~ParPktDecoderImpl();
+
+    Size workerCount() const noexcept
+    {
+        return _workers.size();
+    }
+
+    Size pktsPerRange() const noexcept
+    {
+        return _pktsPerRange;
+    }
+
+    Size rangeCount() const noexcept
+    {
+        return _ranges.size();
+    }
+
+    Size maxPendingRangeCount() const noexcept
+    {
+        return _slots.size();
+    }
+
+    bool next(ElementBatch& batch);
+
+private:
+    // range of consecutive packets
+    struct _Range final
+    {
+        // offset (bytes) of the first packet
+        Index offset;
+
+        // offset (bits) of the packet which follows the last one, if any
+        boost::optional<Index> endOffsetBits;
+    };
+
+    // reorder buffer slot
+    struct _Slot final
+    {
+        ElementBatch batch;
+        std::exception_ptr exc;
+        bool isReady = false;
+    };
+
+private:
+    void _stopWorkers();
+    void _workerFunc(ElementSequence::Iterator it);
+    void _decodeRange(ElementSequence::Iterator& it, const _Range& range, ElementBatch& batch);
+
+private:
+    ElementSequence _elemSeq;
+
+    // whether or not the user options select packet beginning elements
+    bool _recordPktBeginningElems;
+
+    std::vector<_Range> _ranges;
+    Size _pktsPerRange;
+
+    // all the following members are protected by `_mutex`
+    std::vector<_Slot> _slots;
+    Index _nextClaimedRangeIndex = 0;
+    Index _nextDeliveredRangeIndex = 0;
+    bool _stop = false;
+    std::mutex _mutex;
+
+    // signaled when a slot becomes free or when `_stop` changes
+    std::condition_variable _freeCv;
+
+    // signaled when a slot becomes ready
+    std::condition_variable _readyCv;
+
+    std::vector<std::thread> _workers;
+};
+
+} // namespace internal
+} // namespace yactfr
+
+#endif // _YACTFR_INTERNAL_PAR_PKT_DECODER_IMPL_HPP
@@ -0,0 +1,587 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <cassert>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/file.h>
+#include <fcntl.h>
+
+#include <yactfr/io-error.hpp>
+#include <yactfr/metadata/trace-type.hpp>
+#include <yactfr/metadata/dst.hpp>
+
+#include "pkt-index-file-impl.hpp"
+#include "pkt-indexer.hpp"
+#include "utils.hpp"
+
+namespace yactfr {
+namespace internal {
+
+static constexpr char pktIndexFileMagic[] = {'Y', 'A', 'C', 'T', 'F', 'R', 'P', 'I'};
+static constexpr std::uint32_t pktIndexFileVersion = 1;
+static constexpr Size pktIndexFileHeaderSize = 64;
+static constexpr Size pktIndexFileRecSize = 80;
+static constexpr std::uint64_t pktIndexFileNoOffset = ~static_cast<std::uint64_t>(0);
+
+// presence flags of a record
+enum {
+    PKT_INDEX_FILE_REC_FLAG_TOTAL_LEN = 1 << 0,
+    PKT_INDEX_FILE_REC_FLAG_CONTENT_LEN = 1 << 1,
+    PKT_INDEX_FILE_REC_FLAG_DST = 1 << 2,
+    PKT_INDEX_FILE_REC_FLAG_DS_ID = 1 << 3,
+    PKT_INDEX_FILE_REC_FLAG_SEQ_NUM = 1 << 4,
+    PKT_INDEX_FILE_REC_FLAG_DISC_ER_COUNTER_SNAP = 1 << 5,
+    PKT_INDEX_FILE_REC_FLAG_BEGIN_DEF_CLK_VAL = 1 << 6,
+    PKT_INDEX_FILE_REC_FLAG_END_DEF_CLK_VAL = 1 << 7,
+};
+
+static std::uint32_t readLe32(const std::uint8_t * const buf) noexcept
+{
+    return static_cast<std::uint32_t>(buf[0]) |
+           (static_cast<std::uint32_t>(buf[1]) << 8) |
+           (static_cast<std::uint32_t>(buf[2]) << 16) |
+           (static_cast<std::uint32_t>(buf[3]) << 24);
+}
+
+static std::uint64_t readLe64(const std::uint8_t * const buf) noexcept
+{
+    return static_cast<std::uint64_t>(readLe32(buf)) |
+           (static_cast<std::uint64_t>(readLe32(buf + 4)) << 32);
+}
+
+static void appendLe(std::vector<std::uint8_t>& buf, const std::uint64_t val, const Size size)
+{
+    for (Index i = 0; i < size; ++i) {
+        buf.push_back(static_cast<std::uint8_t>(val >> (i * 8)));
+    }
+}
+
+static std::uint64_t fnv1a64(const std::string& str) noexcept
+{
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (const auto ch : str) {
+        hash ^= static_cast<std::uint8_t>(ch);
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+PktIndexFileImpl::PktIndexFileImpl(std::string path, const TraceType& traceType,
+                                   const std::string& metadataText, std::string dsPath,
+                                   DataSourceFactory& dataSrcFactory) :
+    _path {std::move(path)},
+    _dsPath {std::move(dsPath)},
+    _traceType {&traceType},
+    _dataSrcFactory {&dataSrcFactory}
+{
+    /*
+     * Get the key before indexing anything: if the data stream file
+     * grows meanwhile, the next update indexes what's missing.
+     */
+    _key = this->_curKey(metadataText);
+
+    while (true) {
+        bool isWritable;
+        const auto fd = this->_open(isWritable);
+
+        try {
+            this->_lock(fd, LOCK_SH);
+
+            if (this->_isReplaced(fd)) {
+                // another process replaced the file meanwhile: reopen
+                this->_close(fd);
+                continue;
+            }
+
+            auto header = this->_readHeader(fd);
+
+            if (this->_state(header) != _State::FRESH) {
+                if (!isWritable) {
+                    std::ostringstream ss;
+
+                    ss << "Cannot update packet index file \"" << _path <<
+                          "\": file is read-only";
+                    throw IOError {ss.str()};
+                }
+
+                // converting the lock can let another process update it
+                this->_lock(fd, LOCK_EX);
+
+                if (this->_isReplaced(fd)) {
+                    this->_close(fd);
+                    continue;
+                }
+
+                header = this->_readHeader(fd);
+
+                const auto state = this->_state(header);
+
+                if (state == _State::APPEND) {
+                    this->_append(fd, *header);
+                    header = this->_readHeader(fd);
+                    assert(header);
+                    _wasUpdated = true;
+                } else if (state == _State::REBUILD) {
+                    this->_rebuild();
+                    _wasUpdated = true;
+
+                    // map the new file
+                    this->_close(fd);
+                    continue;
+                }
+            }
+
+            this->_map(fd, *header);
+        } catch (...) {
+            this->_close(fd);
+            throw;
+        }
+
+        // the mapping remains valid without the file descriptor
+        this->_close(fd);
+        break;
+    }
+}
+
+PktIndexFileImpl::~PktIndexFileImpl()
+{
+    if (_mmapAddr) {
+        // TODO: check return value and log (do not throw) on error
+        static_cast<void>(munmap(_mmapAddr, _mmapSize));
+    }
+}
+
+void PktIndexFileImpl::_throwIOError(const std::string& what, const std::string& path) const
+{
+    const auto error = internal::strError();
+    std::ostringstream ss;
+
+    ss << what << " \"" << path << "\": " << error;
+    throw IOError {ss.str()};
+}
+
+PktIndexFileImpl::_Key PktIndexFileImpl::_curKey(const std::string& metadataText) const
+{
+    struct stat stat;
+
+    if (::stat(_dsPath.c_str(), &stat) < 0) {
+        this->_throwIOError("Cannot get file status for", _dsPath);
+    }
+
+    _Key key;
+
+    key.dsFileSize = static_cast<Size>(stat.st_size);
+    key.dsFileMtime = static_cast<std::uint64_t>(stat.st_mtim.tv_sec) * 1000000000ULL +
+                      static_cast<std::uint64_t>(stat.st_mtim.tv_nsec);
+    key.metadataHash = fnv1a64(metadataText);
+    return key;
+}
+
+int PktIndexFileImpl::_open(bool& isWritable) const
+{
+    auto fd = open(_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+    isWritable = true;
+
+    if (fd < 0 && (errno == EACCES || errno == EROFS)) {
+        // share an existing packet index file read-only
+        fd = open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+        isWritable = false;
+    }
+
+    if (fd < 0) {
+        this->_throwIOError("Cannot open packet index file", _path);
+    }
+
+    return fd;
+}
+
+bool PktIndexFileImpl::_isReplaced(const int fd) const
+{
+    struct stat fdStat, pathStat;
+
+    if (fstat(fd, &fdStat) < 0) {
+        this->_throwIOError("Cannot get file status for", _path);
+    }
+
+    if (::stat(_path.c_str(), &pathStat) < 0) {
+        if (errno == ENOENT) {
+            return true;
+        }
+
+        this->_throwIOError("Cannot get file status for", _path);
+    }
+
+    return fdStat.st_dev != pathStat.st_dev || fdStat.st_ino != pathStat.st_ino;
+}
+
+void PktIndexFileImpl::_close(const int fd) const noexcept
+{
+    /*
+     * Unlock explicitly: a mapping keeps a reference to the open file
+     * description, and therefore to its lock.
+     */
+    static_cast<void>(flock(fd, LOCK_UN));
+
+    // TODO: check return value and log (do not throw) on error
+    static_cast<void>(close(fd));
+}
+
+void PktIndexFileImpl::_lock(const int fd, const int op) const
+{
+    while (flock(fd, op) < 0) {
+        if (errno != EINTR) {
+            this->_throwIOError("Cannot lock packet index file", _path);
+        }
+    }
+}
+
+boost::optional<PktIndexFileImpl::_Header> PktIndexFileImpl::_readHeader(const int fd) const
+{
+    struct stat stat;
+
+    if (fstat(fd, &stat) < 0) {
+        this->_throwIOError("Cannot get file status for", _path);
+    }
+
+    const auto fileSize = static_cast<Size>(stat.st_size);
+
+    if (fileSize < pktIndexFileHeaderSize) {
+        // new or truncated file
+        return boost::none;
+    }
+
+    std::uint8_t buf[pktIndexFileHeaderSize];
+    Size readSize = 0;
+
+    while (readSize < pktIndexFileHeaderSize) {
+        const auto ret = pread(fd, buf + readSize,
+                               static_cast<size_t>(pktIndexFileHeaderSize - readSize),
+                               static_cast<off_t>(readSize));
+
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            this->_throwIOError("Cannot read header of packet index file", _path);
+        }
+
+        if (ret == 0) {
+            return boost::none;
+        }
+
+        readSize += static_cast<Size>(ret);
+    }
+
+    if (std::memcmp(buf, pktIndexFileMagic, sizeof pktIndexFileMagic) != 0 ||
+            readLe32(&buf[8]) != pktIndexFileVersion ||
+            readLe32(&buf[12]) != pktIndexFileRecSize) {
+        // not a packet index file or unsupported version
+        return boost::none;
+    }
+
+    _Header header;
+
+    header.key.dsFileSize = readLe64(&buf[16]);
+    header.key.dsFileMtime = readLe64(&buf[24]);
+    header.key.metadataHash = readLe64(&buf[32]);
+    header.recCount = readLe64(&buf[40]);
+    header.nextPktOffset = readLe64(&buf[48]);
+
+    if (header.recCount > (fileSize - pktIndexFileHeaderSize) / pktIndexFileRecSize) {
+        // truncated file
+        return boost::none;
+    }
+
+    return header;
+}
+
+PktIndexFileImpl::_State PktIndexFileImpl::_state(const boost::optional<_Header>& header) const noexcept
+{
+    if (!header || header->key.metadataHash != _key.metadataHash) {
+        return _State::REBUILD;
+    }
+
+    if (header->key.dsFileSize == _key.dsFileSize) {
+        return header->key.dsFileMtime == _key.dsFileMtime ? _State::FRESH : _State::REBUILD;
+    }
+
+    /*
+     * Assume that a data stream file which grew only got new data
+     * (tracer appending packets).
+     */
+    return header->key.dsFileSize < _key.dsFileSize ? _State::APPEND : _State::REBUILD;
+}
+
+std::vector<std::uint8_t> PktIndexFileImpl::_encodeHeader(const _Header& header) const
+{
+    std::vector<std::uint8_t> buf;
+
+    buf.reserve(pktIndexFileHeaderSize);
+    buf.insert(buf.end(), std::begin(pktIndexFileMagic), std::end(pktIndexFileMagic));
+    appendLe(buf, pktIndexFileVersion, 4);
+    appendLe(buf, pktIndexFileRecSize, 4);
+    appendLe(buf, header.key.dsFileSize, 8);
+    appendLe(buf, header.key.dsFileMtime, 8);
+    appendLe(buf, header.key.metadataHash, 8);
+    appendLe(buf, header.recCount, 8);
+    appendLe(buf, header.nextPktOffset, 8);
+    appendLe(buf, 0, 8);
+    assert(buf.size() == pktIndexFileHeaderSize);
+    return buf;
+}
+
+Index PktIndexFileImpl::_index(const Index offset, std::vector<std::uint8_t>& recs)
+{
+    Index nextPktOffset = offset;
+
+    PktIndexer::index(*_traceType, *_dataSrcFactory, offset, true,
+                      [&recs, &nextPktOffset](const PacketIndexEntry& entry) {
+        std::uint64_t flags = 0;
+        const auto dstId = entry._dst ? entry._dst->id() : 0;
+
+        if (entry._expectedTotalLen) {
+            flags |= PKT_INDEX_FILE_REC_FLAG_TOTAL_LEN;
+        }
+
+        if (entry._expectedContentLen) {
+            flags |= PKT_INDEX_FILE_REC_FLAG_CONTENT_LEN;
+        }
+
+        if (entry._dst) {
+            flags |= PKT_INDEX_FILE_REC_FLAG_DST;
+        }
+
+        if (entry._dsId) {
+            flags |= PKT_INDEX_FILE_REC_FLAG_DS_ID;
+        }
+
+        if (entry._seqNum) {
+            flags |= PKT_INDEX_FILE_REC_FLAG_SEQ_NUM;
+        }
+
+        if (entry._discErCounterSnap) {
+            flags |= PKT_INDEX_FILE_REC_FLAG_DISC_ER_COUNTER_SNAP;
+        }
+
+        if (entry._beginDefClkVal) {
+            flags |= PKT_INDEX_FILE_REC_FLAG_BEGIN_DEF_CLK_VAL;
+        }
+
+        if (entry._endDefClkVal) {
+            flags |= PKT_INDEX_FILE_REC_FLAG_END_DEF_CLK_VAL;
+        }
+
+        appendLe(recs, flags, 8);
+        appendLe(recs, entry._offset, 8);
+        appendLe(recs, entry._expectedTotalLen.value_or(0), 8);
+        appendLe(recs, entry._expectedContentLen.value_or(0), 8);
+        appendLe(recs, dstId, 8);
+        appendLe(recs, entry._dsId.value_or(0), 8);
+        appendLe(recs, entry._seqNum.value_or(0), 8);
+        appendLe(recs, entry._discErCounterSnap.value_or(0), 8);
+        appendLe(recs, entry._beginDefClkVal.value_or(0), 8);
+        appendLe(recs, entry._endDefClkVal.value_or(0), 8);
+
+        const auto entryNextPktOffset = PktIndexer::nextPktOffset(entry);
+
+        nextPktOffset = entryNextPktOffset ? *entryNextPktOffset : pktIndexFileNoOffset;
+    });
+
+    assert(recs.size() % pktIndexFileRecSize == 0);
+    return nextPktOffset;
+}
+
+void PktIndexFileImpl::_write(const int fd, const std::vector<std::uint8_t>& buf,
+                              const Index offset, const std::string& path) const
+{
+    Size writtenSize = 0;
+
+    while (writtenSize < buf.size()) {
+        const auto ret = pwrite(fd, buf.data() + writtenSize,
+                                static_cast<size_t>(buf.size() - writtenSize),
+                                static_cast<off_t>(offset + writtenSize));
+
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            this->_throwIOError("Cannot write packet index file", path);
+        }
+
+        writtenSize += static_cast<Size>(ret);
+    }
+}
+
+void PktIndexFileImpl::_append(const int fd, const _Header& header)
+{
+    auto newHeader = header;
+
+    newHeader.key = _key;
+
+    if (header.nextPktOffset != pktIndexFileNoOffset) {
+        std::vector<std::uint8_t> recs;
+
+        newHeader.nextPktOffset = this->_index(header.nextPktOffset, recs);
+        newHeader.recCount += recs.size() / pktIndexFileRecSize;
+
+        // records first: the old header remains valid until the end
+        this->_write(fd, recs, pktIndexFileHeaderSize + header.recCount * pktIndexFileRecSize,
+                     _path);
+    }
+
+    this->_write(fd, this->_encodeHeader(newHeader), 0, _path);
+}
+
+void PktIndexFileImpl::_rebuild()
+{
+    std::vector<std::uint8_t> recs;
+    _Header header;
+
+    header.key = _key;
+    header.nextPktOffset = this->_index(0, recs);
+    header.recCount = recs.size() / pktIndexFileRecSize;
+
+    std::ostringstream ss;
+
+    ss << _path << ".tmp." << getpid();
+
+    const auto tmpPath = ss.str();
+    const auto fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (fd < 0) {
+        this->_throwIOError("Cannot open packet index file", tmpPath);
+    }
+
+    try {
+        this->_write(fd, this->_encodeHeader(header), 0, tmpPath);
+        this->_write(fd, recs, pktIndexFileHeaderSize, tmpPath);
+
+        if (rename(tmpPath.c_str(), _path.c_str()) < 0) {
+            this->_throwIOError("Cannot replace packet index file", _path);
+        }
+    } catch (...) {
+        static_cast<void>(close(fd));
+        static_cast<void>(unlink(tmpPath.c_str()));
+        throw;
+    }
+
+    static_cast<void>(close(fd));
+}
+
+void PktIndexFileImpl::_map(const int fd, const _Header& header)
+{
+    _mmapSize = pktIndexFileHeaderSize + header.recCount * pktIndexFileRecSize;
+    _mmapAddr = mmap(nullptr, _mmapSize, PROT_READ, MAP_SHARED, fd, 0);
+
+    if (_mmapAddr == MAP_FAILED) {
+        _mmapAddr = nullptr;
+        this->_throwIOError("Cannot memory map packet index file", _path);
+    }
+
+    _recCount = header.recCount;
+}
+
+const std::uint8_t *PktIndexFileImpl::_rec(const Index index) const noexcept
+{
+    assert(index < _recCount);
+    return static_cast<const std::uint8_t *>(_mmapAddr) + pktIndexFileHeaderSize +
+           index * pktIndexFileRecSize;
+}
+
+Index PktIndexFileImpl::_recOffset(const Index index) const noexcept
+{
+    return readLe64(this->_rec(index) + 8);
+}
+
+PacketIndexEntry PktIndexFileImpl::entry(const Index index) const noexcept
+{
+    const auto rec = this->_rec(index);
+    const auto flags = readLe64(rec);
+    PacketIndexEntry entry;
+
+    entry._offset = readLe64(rec + 8);
+
+    if (flags & PKT_INDEX_FILE_REC_FLAG_TOTAL_LEN) {
+        entry._expectedTotalLen = readLe64(rec + 16);
+    }
+
+    if (flags & PKT_INDEX_FILE_REC_FLAG_CONTENT_LEN) {
+        entry._expectedContentLen = readLe64(rec + 24);
+    }
+
+    if (flags & PKT_INDEX_FILE_REC_FLAG_DST) {
+        entry._dst = (*_traceType)[readLe64(rec + 32)];
+    }
+
+    if (flags & PKT_INDEX_FILE_REC_FLAG_DS_ID) {
+        entry._dsId = readLe64(rec + 40);
+    }
+
+    if (flags & PKT_INDEX_FILE_REC_FLAG_SEQ_NUM) {
+        entry._seqNum = readLe64(rec + 48);
+    }
+
+    if (flags & PKT_INDEX_FILE_REC_FLAG_DISC_ER_COUNTER_SNAP) {
+        entry._discErCounterSnap = readLe64(rec + 56);
+    }
+
+    if (flags & PKT_INDEX_FILE_REC_FLAG_BEGIN_DEF_CLK_VAL) {
+        entry._beginDefClkVal = readLe64(rec + 64);
+    }
+
+    if (flags & PKT_INDEX_FILE_REC_FLAG_END_DEF_CLK_VAL) {
+        entry._endDefClkVal = readLe64(rec + 72);
+    }
+
+    return entry;
+}
+
+boost::optional<PacketIndexEntry> PktIndexFileImpl::findEntry(const Index offset) const noexcept
+{
+    // find the last record of which the offset is less than or equal to `offset`
+    Index lo = 0;
+    Index hi = _recCount;
+
+    while (lo < hi) {
+        const auto mid = lo + (hi - lo) / 2;
+
+        if (offset < this->_recOffset(mid)) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+
+    if (lo == 0) {
+        return boost::none;
+    }
+
+    auto entry = this->entry(lo - 1);
+    const auto nextOffset = PktIndexer::nextPktOffset(entry);
+
+    if (nextOffset && offset >= *nextOffset) {
+        // after the end of the packet
+        return boost::none;
+    }
+
+    return entry;
+}
+
+} // namespace internal
+} // namespace yactfr
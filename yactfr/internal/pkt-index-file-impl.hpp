@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_INTERNAL_PKT_INDEX_FILE_IMPL_HPP
+#define _YACTFR_INTERNAL_PKT_INDEX_FILE_IMPL_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <boost/optional/optional.hpp>
+
+#include <yactfr/aliases.hpp>
+#include <yactfr/metadata/fwd.hpp>
+#include <yactfr/pkt-index.hpp>
+
+namespace yactfr {
+
+class DataSourceFactory;
+
+namespace internal {
+
+/*
+ * Implementation of a packet index file.
+ *
+ * Format (version 1), all the integers being little-endian:
+ *
+ * Header (64 bytes):
+ *
+ *     0   magic number (8 bytes: `YACTFRPI`)
+ *     8   version (32-bit)
+ *     12  size of a record (32-bit)
+ *     16  size of the data stream file (64-bit)
+ *     24  modification time of the data stream file (64-bit, ns)
+ *     32  hash of the metadata text (64-bit, FNV-1a)
+ *     40  number of records (64-bit)
+ *     48  offset of the next packet to index (64-bit, all bits set if
+ *         none)
+ *     56  reserved (64-bit)
+ *
+ * Record (80 bytes), one per packet:
+ *
+ *     0   presence flags of the following optional values (64-bit)
+ *     8   offset of the packet (64-bit, bytes)
+ *     16  expected total length (64-bit, bits)
+ *     24  expected content length (64-bit, bits)
+ *     32  data stream type ID (64-bit)
+ *     40  data stream ID (64-bit)
+ *     48  sequence number (64-bit)
+ *     56  discarded event record counter snapshot (64-bit)
+ *     64  beginning default clock value (64-bit)
+ *     72  end default clock value (64-bit)
+ *
+ * The constructor opens the packet index file with a shared lock and
+ * maps it if it's up to date. Otherwise, it converts the lock to an
+ * exclusive lock and either appends the records of the new packets
+ * (then updates the header) or writes a whole new file which replaces
+ * the current one (rename). Therefore an update never modifies the
+ * mapped records of another object.
+ */
+class PktIndexFileImpl final
+{
+public:
+    explicit PktIndexFileImpl(std::string path, const TraceType& traceType,
+                              const std::string& metadataText, std::string dsPath,
+                              DataSourceFactory& dataSrcFactory);
+    ~PktIndexFileImpl();
+
+    const std::string& path() const noexcept
+    {
+        return _path;
+    }
+
+    const std::string& dsPath() const noexcept
+    {
+        return _dsPath;
+    }
+
+    Size size() const noexcept
+    {
+        return _recCount;
+    }
+
+    bool wasUpdated() const noexcept
+    {
+        return _wasUpdated;
+    }
+
+    PacketIndexEntry entry(Index index) const noexcept;
+    boost::optional<PacketIndexEntry> findEntry(Index offset) const noexcept;
+
+private:
+    // key of a packet index file
+    struct _Key final
+    {
+        Size dsFileSize;
+        std::uint64_t dsFileMtime;
+        std::uint64_t metadataHash;
+    };
+
+    // decoded header
+    struct _Header final
+    {
+        _Key key;
+        Size recCount;
+        Index nextPktOffset;
+    };
+
+    enum class _State
+    {
+        // up to date
+        FRESH,
+
+        // data stream file grew: append the records of the new packets
+        APPEND,
+
+        // invalid or stale: rebuild
+        REBUILD,
+    };
+
+private:
+    _Key _curKey(const std::string& metadataText) const;
+    int _open(bool& isWritable) const;
+    bool _isReplaced(int fd) const;
+    void _lock(int fd, int op) const;
+    void _close(int fd) const noexcept;
+    boost::optional<_Header> _readHeader(int fd) const;
+    _State _state(const boost::optional<_Header>& header) const noexcept;
+    void _append(int fd, const _Header& header);
+    void _rebuild();
+    void _map(int fd, const _Header& header);
+    Index _index(Index offset, std::vector<std::uint8_t>& recs);
+    void _write(int fd, const std::vector<std::uint8_t>& buf, Index offset,
+                const std::string& path) const;
+    std::vector<std::uint8_t> _encodeHeader(const _Header& header) const;
+    const std::uint8_t *_rec(Index index) const noexcept;
+    Index _recOffset(Index index) const noexcept;
+
+    [[noreturn]] void _throwIOError(const std::string& what, const std::string& path) const;
+
+private:
+    const std::string _path;
+    const std::string _dsPath;
+    const TraceType *_traceType;
+    DataSourceFactory *_dataSrcFactory;
+    _Key _key;
+    bool _wasUpdated = false;
+
+    // mapping of the packet index file
+    void *_mmapAddr = nullptr;
+    Size _mmapSize = 0;
+
+    // number of mapped records
+    Size _recCount = 0;
+};
+
+} // namespace internal
+} // namespace yactfr
+
+#endif // _YACTFR_INTERNAL_PKT_INDEX_FILE_IMPL_HPP
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cassert>
+#include <set>
+
+#include <yactfr/elem.hpp>
+#include <yactfr/elem-seq.hpp>
+#include <yactfr/elem-seq-it.hpp>
+#include <yactfr/elem-seq-opts.hpp>
+#include <yactfr/decoding-errors.hpp>
+
+#include "pkt-indexer.hpp"
+
+namespace yactfr {
+namespace internal {
+
+void PktIndexer::index(const TraceType& traceType, DataSourceFactory& dataSrcFactory,
+                       const Index offset, const bool stopAtPrematureEnd, const Func& func)
+{
+    ElementSequenceOptions opts;
+
+    /*
+     * Only produce the elements of the packet preamble which the
+     * entries need: the iterator seeks the next packet as soon as it
+     * has the packet info element, so that it never decodes any event
+     * record.
+     */
+    opts.elementKinds(std::set<Element::Kind> {
+        Element::Kind::PACKET_BEGINNING,
+        Element::Kind::PACKET_END,
+        Element::Kind::DATA_STREAM_INFO,
+        Element::Kind::DEFAULT_CLOCK_VALUE,
+        Element::Kind::PACKET_INFO,
+    });
+
+    ElementSequence elemSeq {traceType, dataSrcFactory, opts};
+    const auto endIt = elemSeq.end();
+
+    try {
+        auto it = elemSeq.at(offset);
+
+        while (it != endIt) {
+            assert(it->kind() == Element::Kind::PACKET_BEGINNING);
+            assert((it.offset() & 7) == 0);
+
+            PacketIndexEntry entry;
+
+            entry._offset = it.offset() / 8;
+            ++it;
+
+            // read the preamble of the packet
+            while (it->kind() != Element::Kind::PACKET_INFO &&
+                    it->kind() != Element::Kind::PACKET_END) {
+                if (it->kind() == Element::Kind::DATA_STREAM_INFO) {
+                    auto& dsInfoElem = it->asDataStreamInfoElement();
+
+                    entry._dst = dsInfoElem.type();
+                    entry._dsId = dsInfoElem.id();
+                } else if (it->kind() == Element::Kind::DEFAULT_CLOCK_VALUE) {
+                    entry._beginDefClkVal = it->asDefaultClockValueElement().cycles();
+                }
+
+                ++it;
+            }
+
+            if (it->kind() == Element::Kind::PACKET_INFO) {
+                auto& pktInfoElem = it->asPacketInfoElement();
+
+                entry._expectedTotalLen = pktInfoElem.expectedTotalLength();
+                entry._expectedContentLen = pktInfoElem.expectedContentLength();
+                entry._seqNum = pktInfoElem.sequenceNumber();
+                entry._discErCounterSnap = pktInfoElem.discardedEventRecordCounterSnapshot();
+                entry._endDefClkVal = pktInfoElem.endDefaultClockValue();
+            }
+
+            func(entry);
+
+            const auto nextOffset = PktIndexer::nextPktOffset(entry);
+
+            if (!nextOffset) {
+                /*
+                 * Without a packet total length, the element sequence
+                 * contains a single packet.
+                 */
+                break;
+            }
+
+            // go to the beginning of the next packet, if any
+            it.seekPacket(*nextOffset);
+        }
+    } catch (const PrematureEndOfDataDecodingError&) {
+        if (!stopAtPrematureEnd) {
+            throw;
+        }
+    }
+}
+
+boost::optional<Index> PktIndexer::nextPktOffset(const PacketIndexEntry& entry) noexcept
+{
+    if (!entry.expectedTotalLength()) {
+        return boost::none;
+    }
+
+    assert((*entry.expectedTotalLength() & 7) == 0);
+    return entry.offsetInElementSequence() + *entry.expectedTotalLength() / 8;
+}
+
+} // namespace internal
+} // namespace yactfr
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_INTERNAL_PKT_INDEXER_HPP
+#define _YACTFR_INTERNAL_PKT_INDEXER_HPP
+
+#include <functional>
+
+#include <yactfr/aliases.hpp>
+#include <yactfr/metadata/fwd.hpp>
+#include <yactfr/pkt-index.hpp>
+
+namespace yactfr {
+
+class DataSourceFactory;
+
+namespace internal {
+
+/*
+ * Packet indexer.
+ *
+ * index() calls `func` with the entry of each packet of the element
+ * sequence which `traceType` describes and of which the data sources
+ * come from `dataSrcFactory`, in element sequence order, starting with
+ * the packet at `offset` (bytes).
+ *
+ * It only decodes the preamble of each packet: as soon as it has the
+ * packet info element, it seeks the next packet.
+ *
+ * If `stopAtPrematureEnd` is true, then index() returns instead of
+ * throwing when the data ends within the preamble of a packet (for
+ * example, a tracer is still writing it): `func` doesn't get the entry
+ * of this packet.
+ */
+class PktIndexer final
+{
+public:
+    using Func = std::function<void (const PacketIndexEntry&)>;
+
+public:
+    static void index(const TraceType& traceType, DataSourceFactory& dataSrcFactory,
+                      Index offset, bool stopAtPrematureEnd, const Func& func);
+
+    /*
+     * Offset (bytes) of the packet which follows the packet of `entry`
+     * within its element sequence, or `boost::none` if there's no such
+     * packet (no expected packet total length).
+     */
+    static boost::optional<Index> nextPktOffset(const PacketIndexEntry& entry) noexcept;
+};
+
+} // namespace internal
+} // namespace yactfr
+
+#endif // _YACTFR_INTERNAL_PKT_INDEXER_HPP
@@ -7,6 +7,7 @@
 
 #include <functional>
 #include <algorithm>
+#include <iterator>
 #include <type_traits>
 #include <boost/optional/optional.hpp>
 
@@ -141,12 +142,30 @@ void PktProcBuilder::_buildPktProc()
      *
      * 5. Insert "end procedure" instructions at the end of each
      *    top-level procedure.
+     *
+     * 6. Set the section element instruction of the "begin read
+     *    static-length array" and "begin read dynamic-length array"
+     *    instructions of which the items are contiguous standard
+     *    fixed-length integers, enumerations, or floating point
+     *    numbers.
+     *
+     * 7. Replace runs of consecutive "read standard fixed-length
+     *    integer" instructions with `ReadStdFlIntRunInstr` objects.
+     *
+     * 8. Set the static layout of the instructions and scopes which
+     *    have one.
+     *
+     * 9. Set the index of each instruction.
      */
     this->_buildBasePktProc();
     this->_subUuidInstr();
     this->_insertSpecialInstrs();
     this->_setSavedValPoss();
     this->_insertEndInstrs();
+    this->_setArraySectionElemInstrs();
+    this->_fuseReadStdFlIntInstrs();
+    this->_setStaticLayouts();
+    this->_setInstrIndexes();
 }
 
 static bool instrIsSpecScope(const Instr& instr, const Scope scope) noexcept
@@ -846,6 +865,748 @@ void PktProcBuilder::_insertEndInstrs()
     }
 }
 
+/*
+ * This procedure instruction visitor sets, recursively, the section
+ * element instruction of each "begin read static-length array" and
+ * "begin read dynamic-length array" instruction of which the
+ * subprocedure only contains a "read standard fixed-length integer,
+ * enumeration, or floating point number" instruction with an alignment
+ * which is less than or equal to its length.
+ *
+ * In that case, the items of the array are contiguous, therefore the
+ * VM may read many of them at once as an array section.
+ */
+class ArraySectionElemInstrSetterVisitor :
+    public InstrVisitor
+{
+public:
+    explicit ArraySectionElemInstrSetterVisitor(Proc& proc)
+    {
+        this->_visitProc(proc);
+    }
+
+    void visit(BeginReadStructInstr& instr) override
+    {
+        this->_visitProc(instr.proc());
+    }
+
+    void visit(BeginReadSlArrayInstr& instr) override
+    {
+        instr.sectionElemInstr(this->_sectionElemInstr(instr.proc()));
+        this->_visitProc(instr.proc());
+    }
+
+    void visit(BeginReadDlArrayInstr& instr) override
+    {
+        instr.sectionElemInstr(this->_sectionElemInstr(instr.proc()));
+        this->_visitProc(instr.proc());
+    }
+
+    void visit(BeginReadVarUIntSelInstr& instr) override
+    {
+        this->_visitBeginReadVarInstr(instr);
+    }
+
+    void visit(BeginReadVarSIntSelInstr& instr) override
+    {
+        this->_visitBeginReadVarInstr(instr);
+    }
+
+    void visit(BeginReadOptBoolSelInstr& instr) override
+    {
+        this->_visitProc(instr.proc());
+    }
+
+    void visit(BeginReadOptUIntSelInstr& instr) override
+    {
+        this->_visitProc(instr.proc());
+    }
+
+    void visit(BeginReadOptSIntSelInstr& instr) override
+    {
+        this->_visitProc(instr.proc());
+    }
+
+    void visit(BeginReadScopeInstr& instr) override
+    {
+        this->_visitProc(instr.proc());
+    }
+
+private:
+    template <typename BeginReadVarInstrT>
+    void _visitBeginReadVarInstr(BeginReadVarInstrT& instr)
+    {
+        for (auto& opt : instr.opts()) {
+            this->_visitProc(opt.proc());
+        }
+    }
+
+    void _visitProc(Proc& proc)
+    {
+        for (auto& instr : proc) {
+            instr->accept(*this);
+        }
+    }
+
+    static const ReadFlBitArrayInstr *_sectionElemInstr(const Proc& proc) noexcept
+    {
+        if (proc.sharedProc().size() != 1) {
+            return nullptr;
+        }
+
+        const auto& instr = *proc.sharedProc().front();
+
+        switch (instr.kind()) {
+        case Instr::Kind::READ_FL_FLOAT_A32_BE:
+        case Instr::Kind::READ_FL_FLOAT_A32_LE:
+        case Instr::Kind::READ_FL_FLOAT_A64_BE:
+        case Instr::Kind::READ_FL_FLOAT_A64_LE:
+            break;
+
+        default:
+            if (!ReadStdFlIntRunInstr::isStdFlIntInstr(instr)) {
+                return nullptr;
+            }
+        }
+
+        const auto& readFlBitArrayInstr = static_cast<const ReadFlBitArrayInstr&>(instr);
+
+        if (readFlBitArrayInstr.align() > readFlBitArrayInstr.len()) {
+            // padding between items
+            return nullptr;
+        }
+
+        return &readFlBitArrayInstr;
+    }
+};
+
+void PktProcBuilder::_setArraySectionElemInstrs()
+{
+    ArraySectionElemInstrSetterVisitor {_pktProc->preambleProc()};
+
+    for (auto& dsPktProcPair : _pktProc->dsPktProcs()) {
+        auto& dsPktProc = dsPktProcPair.second;
+
+        ArraySectionElemInstrSetterVisitor {dsPktProc->pktPreambleProc()};
+        ArraySectionElemInstrSetterVisitor {dsPktProc->erPreambleProc()};
+
+        dsPktProc->forEachErProc([](ErProc& erProc) {
+            ArraySectionElemInstrSetterVisitor {erProc.proc()};
+        });
+    }
+}
+
+/*
+ * This procedure instruction visitor replaces, recursively, each run of
+ * two or more consecutive "read standard fixed-length integer"
+ * instructions with a single `ReadStdFlIntRunInstr` superinstruction,
+ * splitting runs of more than `ReadStdFlIntRunInstr::maxMemberCount`
+ * instructions.
+ *
+ * Any other instruction, including "save value" and "update default
+ * clock value" ones, breaks a run.
+ */
+class ReadStdFlIntRunFuserVisitor :
+    public InstrVisitor
+{
+public:
+    explicit ReadStdFlIntRunFuserVisitor(Proc& proc)
+    {
+        this->_fuse(proc);
+    }
+
+    void visit(BeginReadStructInstr& instr) override
+    {
+        this->_fuse(instr.proc());
+    }
+
+    void visit(BeginReadSlArrayInstr& instr) override
+    {
+        this->_fuse(instr.proc());
+    }
+
+    void visit(BeginReadDlArrayInstr& instr) override
+    {
+        this->_fuse(instr.proc());
+    }
+
+    void visit(BeginReadVarUIntSelInstr& instr) override
+    {
+        this->_visitBeginReadVarInstr(instr);
+    }
+
+    void visit(BeginReadVarSIntSelInstr& instr) override
+    {
+        this->_visitBeginReadVarInstr(instr);
+    }
+
+    void visit(BeginReadOptBoolSelInstr& instr) override
+    {
+        this->_fuse(instr.proc());
+    }
+
+    void visit(BeginReadOptUIntSelInstr& instr) override
+    {
+        this->_fuse(instr.proc());
+    }
+
+    void visit(BeginReadOptSIntSelInstr& instr) override
+    {
+        this->_fuse(instr.proc());
+    }
+
+    void visit(BeginReadScopeInstr& instr) override
+    {
+        this->_fuse(instr.proc());
+    }
+
+private:
+    template <typename BeginReadVarInstrT>
+    void _visitBeginReadVarInstr(BeginReadVarInstrT& instr)
+    {
+        for (auto& opt : instr.opts()) {
+            this->_fuse(opt.proc());
+        }
+    }
+
+    void _fuse(Proc& proc)
+    {
+        // fuse nested procedures first
+        for (auto& instr : proc) {
+            instr->accept(*this);
+        }
+
+        auto& sharedProc = proc.sharedProc();
+        auto it = sharedProc.begin();
+
+        while (it != sharedProc.end()) {
+            if (!ReadStdFlIntRunInstr::isStdFlIntInstr(**it)) {
+                ++it;
+                continue;
+            }
+
+            const auto runAlign = static_cast<const ReadFlIntInstr&>(**it).align();
+            auto runEndIt = std::next(it);
+            Size memberCount = 1;
+
+            while (runEndIt != sharedProc.end() &&
+                    memberCount < ReadStdFlIntRunInstr::maxMemberCount &&
+                    ReadStdFlIntRunInstr::isStdFlIntInstr(**runEndIt) &&
+                    ReadStdFlIntRunInstr::canAppendToRun(**runEndIt, runAlign)) {
+                ++runEndIt;
+                ++memberCount;
+            }
+
+            if (memberCount < 2) {
+                // not worth it
+                it = runEndIt;
+                continue;
+            }
+
+            // move the instructions of the run to the superinstruction
+            Proc::Shared runInstrs;
+
+            runInstrs.splice(runInstrs.end(), sharedProc, it, runEndIt);
+            sharedProc.insert(runEndIt, std::make_shared<ReadStdFlIntRunInstr>(std::move(runInstrs)));
+            it = runEndIt;
+        }
+    }
+};
+
+void PktProcBuilder::_fuseReadStdFlIntInstrs()
+{
+    ReadStdFlIntRunFuserVisitor {_pktProc->preambleProc()};
+
+    for (auto& dsPktProcPair : _pktProc->dsPktProcs()) {
+        auto& dsPktProc = dsPktProcPair.second;
+
+        ReadStdFlIntRunFuserVisitor {dsPktProc->pktPreambleProc()};
+        ReadStdFlIntRunFuserVisitor {dsPktProc->erPreambleProc()};
+
+        dsPktProc->forEachErProc([](ErProc& erProc) {
+            ReadStdFlIntRunFuserVisitor {erProc.proc()};
+        });
+    }
+}
+
+/*
+ * This procedure instruction visitor accumulates the static layouts of
+ * the instructions of a procedure, in order, as if the procedure
+ * started at an offset aligned to some base alignment.
+ *
+ * After visiting an instruction, `isStatic()` is false if the layout
+ * of the procedure isn't static (unknown instruction, instruction
+ * without a static layout, instruction with an alignment which is
+ * greater than the base alignment, or fixed-length bit arrays having
+ * different byte orders).
+ */
+class StaticLayoutAccumulatorVisitor :
+    public InstrVisitor
+{
+public:
+    explicit StaticLayoutAccumulatorVisitor(const unsigned int baseAlign) :
+        _baseAlign {baseAlign}
+    {
+    }
+
+    bool isStatic() const noexcept
+    {
+        return _isStatic;
+    }
+
+    const StaticLayout& layout() const noexcept
+    {
+        return _layout;
+    }
+
+    void accumulate(Instr& instr)
+    {
+        if (!_isStatic) {
+            return;
+        }
+
+        // an overridden visit() method sets `_isStatic` back to true
+        _isStatic = false;
+        instr.accept(*this);
+    }
+
+    void visit(ReadFlBitArrayInstr& instr) override
+    {
+        this->_visitReadFlBitArrayInstr(instr);
+    }
+
+    void visit(ReadFlBoolInstr& instr) override
+    {
+        this->_visitReadFlBitArrayInstr(instr);
+    }
+
+    void visit(ReadFlSIntInstr& instr) override
+    {
+        this->_visitReadFlBitArrayInstr(instr);
+    }
+
+    void visit(ReadFlUIntInstr& instr) override
+    {
+        this->_visitReadFlBitArrayInstr(instr);
+    }
+
+    void visit(ReadFlFloatInstr& instr) override
+    {
+        this->_visitReadFlBitArrayInstr(instr);
+    }
+
+    void visit(ReadFlSEnumInstr& instr) override
+    {
+        this->_visitReadFlBitArrayInstr(instr);
+    }
+
+    void visit(ReadFlUEnumInstr& instr) override
+    {
+        this->_visitReadFlBitArrayInstr(instr);
+    }
+
+    void visit(ReadStdFlIntRunInstr& instr) override
+    {
+        // same layout as the original instructions
+        _isStatic = true;
+
+        for (auto& memberInstr : instr.proc()) {
+            this->accumulate(*memberInstr);
+        }
+    }
+
+    void visit(BeginReadStructInstr& instr) override
+    {
+        this->_visitReadDataInstr(instr);
+    }
+
+    void visit(BeginReadSlArrayInstr& instr) override
+    {
+        this->_visitReadDataInstr(instr);
+    }
+
+    void visit(BeginReadSlStrInstr& instr) override
+    {
+        this->_visitReadDataInstr(instr);
+    }
+
+    void visit(BeginReadSlBlobInstr& instr) override
+    {
+        this->_visitReadDataInstr(instr);
+    }
+
+    void visit(BeginReadScopeInstr& instr) override
+    {
+        if (instr.staticLayout()) {
+            this->_append(instr.align(), *instr.staticLayout());
+        }
+    }
+
+    void visit(EndReadDataInstr&) override
+    {
+        // end element
+        this->_append(1, 0, 1, 1);
+    }
+
+    void visit(EndReadScopeInstr&) override
+    {
+        // scope end element
+        this->_append(1, 0, 1, 1);
+    }
+
+private:
+    void _append(const Size align, const Size len, const Size elemCount,
+                 const Size elemCountWithArraySections,
+                 const boost::optional<ByteOrder>& bo = boost::none) noexcept
+    {
+        if (align > _baseAlign) {
+            // padding before this instruction depends on the offset
+            return;
+        }
+
+        if (bo) {
+            if (_layout.bo && *_layout.bo != *bo) {
+                // the VM must check the byte order changes
+                return;
+            }
+
+            _layout.bo = bo;
+        }
+
+        _layout.len = ((_layout.len + align - 1) & -align) + len;
+        _layout.elemCount += elemCount;
+        _layout.elemCountWithArraySections += elemCountWithArraySections;
+        _isStatic = true;
+    }
+
+    void _append(const Size align, const StaticLayout& layout) noexcept
+    {
+        this->_append(align, layout.len, layout.elemCount, layout.elemCountWithArraySections,
+                      layout.bo);
+    }
+
+    void _visitReadFlBitArrayInstr(const ReadFlBitArrayInstr& instr) noexcept
+    {
+        this->_append(instr.align(), instr.len(), 1, 1, instr.bo());
+    }
+
+    void _visitReadDataInstr(const ReadDataInstr& instr) noexcept
+    {
+        if (instr.staticLayout()) {
+            this->_append(instr.align(), *instr.staticLayout());
+        }
+    }
+
+private:
+    const unsigned int _baseAlign;
+    StaticLayout _layout;
+    bool _isStatic = true;
+};
+
+/*
+ * This procedure instruction visitor sets, recursively (innermost
+ * instructions first), the static layout of the "begin read
+ * structure", "begin read static-length array", "begin read
+ * static-length string", "begin read static-length BLOB", and "begin
+ * read scope" instructions which have one.
+ */
+class StaticLayoutSetterVisitor :
+    public InstrVisitor
+{
+public:
+    explicit StaticLayoutSetterVisitor(Proc& proc)
+    {
+        this->_visitProc(proc);
+    }
+
+    /*
+     * Returns the static layout of the procedure `proc`, starting at an
+     * offset aligned to `baseAlign`, if any.
+     */
+    static boost::optional<StaticLayout> procStaticLayout(Proc& proc, const unsigned int baseAlign)
+    {
+        StaticLayoutAccumulatorVisitor accVisitor {baseAlign};
+
+        for (auto& instr : proc) {
+            accVisitor.accumulate(*instr);
+        }
+
+        if (!accVisitor.isStatic()) {
+            return boost::none;
+        }
+
+        return accVisitor.layout();
+    }
+
+    void visit(BeginReadStructInstr& instr) override
+    {
+        this->_visitProc(instr.proc());
+
+        auto layout = procStaticLayout(instr.proc(), instr.align());
+
+        if (!layout) {
+            return;
+        }
+
+        // structure beginning element
+        ++layout->elemCount;
+        ++layout->elemCountWithArraySections;
+        instr.staticLayout(*layout);
+    }
+
+    void visit(BeginReadSlArrayInstr& instr) override
+    {
+        this->_visitProc(instr.proc());
+
+        const auto itemLayout = procStaticLayout(instr.proc(), instr.align());
+
+        if (!itemLayout) {
+            return;
+        }
+
+        // array beginning element
+        StaticLayout layout;
+
+        layout.elemCount = 1;
+        layout.elemCountWithArraySections = 1;
+        layout.bo = itemLayout->bo;
+
+        if (instr.len() > 0) {
+            /*
+             * Each item is aligned to the alignment of the element
+             * type, which is greater than or equal to the alignment of
+             * anything within an item.
+             */
+            const Size itemAlign = instr.slArrayType().elementType().alignment();
+            const auto itemStride = (itemLayout->len + itemAlign - 1) & -itemAlign;
+
+            layout.len = (instr.len() - 1) * itemStride + itemLayout->len;
+            layout.elemCount += instr.len() * itemLayout->elemCount;
+
+            if (instr.sectionElemInstr()) {
+                ++layout.elemCountWithArraySections;
+            } else {
+                layout.elemCountWithArraySections += instr.len() *
+                                                     itemLayout->elemCountWithArraySections;
+            }
+        }
+
+        instr.staticLayout(layout);
+    }
+
+    void visit(BeginReadSlStrInstr& instr) override
+    {
+        this->_setBytesStaticLayout(instr, instr.maxLen());
+    }
+
+    void visit(BeginReadSlBlobInstr& instr) override
+    {
+        this->_setBytesStaticLayout(instr, instr.len());
+    }
+
+    void visit(BeginReadDlArrayInstr& instr) override
+    {
+        this->_visitProc(instr.proc());
+    }
+
+    void visit(BeginReadVarUIntSelInstr& instr) override
+    {
+        this->_visitBeginReadVarInstr(instr);
+    }
+
+    void visit(BeginReadVarSIntSelInstr& instr) override
+    {
+        this->_visitBeginReadVarInstr(instr);
+    }
+
+    void visit(BeginReadOptBoolSelInstr& instr) override
+    {
+        this->_visitProc(instr.proc());
+    }
+
+    void visit(BeginReadOptUIntSelInstr& instr) override
+    {
+        this->_visitProc(instr.proc());
+    }
+
+    void visit(BeginReadOptSIntSelInstr& instr) override
+    {
+        this->_visitProc(instr.proc());
+    }
+
+    void visit(BeginReadScopeInstr& instr) override
+    {
+        this->_visitProc(instr.proc());
+
+        auto layout = procStaticLayout(instr.proc(), instr.align());
+
+        if (!layout) {
+            return;
+        }
+
+        // scope beginning element
+        ++layout->elemCount;
+        ++layout->elemCountWithArraySections;
+        instr.staticLayout(*layout);
+    }
+
+private:
+    template <typename BeginReadVarInstrT>
+    void _visitBeginReadVarInstr(BeginReadVarInstrT& instr)
+    {
+        for (auto& opt : instr.opts()) {
+            this->_visitProc(opt.proc());
+        }
+    }
+
+    void _visitProc(Proc& proc)
+    {
+        for (auto& instr : proc) {
+            instr->accept(*this);
+        }
+    }
+
+    static void _setBytesStaticLayout(ReadDataInstr& instr, const Size len)
+    {
+        StaticLayout layout;
+
+        layout.len = len * 8;
+
+        // beginning element and, if not empty, a single section
+        layout.elemCount = len > 0 ? 2 : 1;
+        layout.elemCountWithArraySections = layout.elemCount;
+        instr.staticLayout(layout);
+    }
+};
+
+void PktProcBuilder::_setStaticLayouts()
+{
+    StaticLayoutSetterVisitor {_pktProc->preambleProc()};
+
+    for (auto& dsPktProcPair : _pktProc->dsPktProcs()) {
+        auto& dsPktProc = dsPktProcPair.second;
+
+        StaticLayoutSetterVisitor {dsPktProc->pktPreambleProc()};
+        StaticLayoutSetterVisitor {dsPktProc->erPreambleProc()};
+
+        dsPktProc->forEachErProc([](ErProc& erProc) {
+            StaticLayoutSetterVisitor {erProc.proc()};
+        });
+    }
+}
+
+/*
+ * This procedure instruction visitor sets, recursively, the index of
+ * each instruction, appending it to `*instrs`.
+ */
+class InstrIndexSetterVisitor :
+    public InstrVisitor
+{
+public:
+    explicit InstrIndexSetterVisitor(Proc& proc, std::vector<const Instr *>& instrs) :
+        _instrs {&instrs}
+    {
+        this->_setIndexes(proc);
+    }
+
+    void visit(BeginReadStructInstr& instr) override
+    {
+        this->_setIndexes(instr.proc());
+    }
+
+    void visit(BeginReadSlArrayInstr& instr) override
+    {
+        this->_setIndexes(instr.proc());
+    }
+
+    void visit(BeginReadSlUuidArrayInstr& instr) override
+    {
+        this->_setIndexes(instr.proc());
+    }
+
+    void visit(BeginReadDlArrayInstr& instr) override
+    {
+        this->_setIndexes(instr.proc());
+    }
+
+    void visit(BeginReadVarUIntSelInstr& instr) override
+    {
+        this->_visitBeginReadVarInstr(instr);
+    }
+
+    void visit(BeginReadVarSIntSelInstr& instr) override
+    {
+        this->_visitBeginReadVarInstr(instr);
+    }
+
+    void visit(BeginReadOptBoolSelInstr& instr) override
+    {
+        this->_setIndexes(instr.proc());
+    }
+
+    void visit(BeginReadOptUIntSelInstr& instr) override
+    {
+        this->_setIndexes(instr.proc());
+    }
+
+    void visit(BeginReadOptSIntSelInstr& instr) override
+    {
+        this->_setIndexes(instr.proc());
+    }
+
+    void visit(BeginReadScopeInstr& instr) override
+    {
+        this->_setIndexes(instr.proc());
+    }
+
+    void visit(ReadStdFlIntRunInstr& instr) override
+    {
+        // the VM emits the elements of the original instructions
+        this->_setIndexes(instr.proc());
+    }
+
+private:
+    template <typename BeginReadVarInstrT>
+    void _visitBeginReadVarInstr(BeginReadVarInstrT& instr)
+    {
+        for (auto& opt : instr.opts()) {
+            this->_setIndexes(opt.proc());
+        }
+    }
+
+    void _setIndexes(Proc& proc)
+    {
+        for (auto& instr : proc) {
+            instr->index(_instrs->size());
+            _instrs->push_back(instr.get());
+            instr->accept(*this);
+        }
+    }
+
+private:
+    std::vector<const Instr *> *_instrs;
+};
+
+void PktProcBuilder::_setInstrIndexes()
+{
+    std::vector<const Instr *> instrs;
+
+    InstrIndexSetterVisitor {_pktProc->preambleProc(), instrs};
+
+    for (auto& dsPktProcPair : _pktProc->dsPktProcs()) {
+        auto& dsPktProc = dsPktProcPair.second;
+
+        InstrIndexSetterVisitor {dsPktProc->pktPreambleProc(), instrs};
+        InstrIndexSetterVisitor {dsPktProc->erPreambleProc(), instrs};
+
+        dsPktProc->forEachErProc([&instrs](ErProc& erProc) {
+            InstrIndexSetterVisitor {erProc.proc(), instrs};
+        });
+    }
+
+    _pktProc->instrs(std::move(instrs));
+}
+
 void PktProcBuilder::_buildBasePktProc()
 {
     _pktProc = std::make_unique<PktProc>(*_traceType);
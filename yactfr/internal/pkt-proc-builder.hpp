@@ -62,6 +62,10 @@ private:
     _DtReadLenSelInstrMap _createDtReadLenSelInstrMap() const;
     void _setSavedValPoss();
     void _insertEndInstrs();
+    void _setArraySectionElemInstrs();
+    void _fuseReadStdFlIntInstrs();
+    void _setStaticLayouts();
+    void _setInstrIndexes();
     std::unique_ptr<DsPktProc> _buildDsPktProc(const DataStreamType& dst);
     std::unique_ptr<ErProc> _buildErProc(const EventRecordType& ert);
     void _buildReadScopeInstr(Scope scope, const DataType *dt, Proc& baseProc);
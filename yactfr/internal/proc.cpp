@@ -398,6 +398,10 @@ std::string Instr::toStr(const Size indent) const
         kindStr = "READ_NT_STR";
         break;
 
+    case Kind::READ_STD_FL_INT_RUN:
+        kindStr = "READ_STD_FL_INT_RUN";
+        break;
+
     case Kind::BEGIN_READ_SCOPE:
         kindStr = "BEGIN_READ_SCOPE";
         break;
@@ -1156,6 +1160,95 @@ std::string ReadNtStrInstr::_toStr(Size) const
     return ss.str();
 }
 
+ReadStdFlIntRunInstr::ReadStdFlIntRunInstr(Proc::Shared instrs) :
+    Instr {Kind::READ_STD_FL_INT_RUN}
+{
+    assert(instrs.size() >= 2);
+    assert(instrs.size() <= maxMemberCount);
+    _align = static_cast<const ReadFlIntInstr&>(*instrs.front()).align();
+
+    for (auto& instr : instrs) {
+        assert(ReadStdFlIntRunInstr::isStdFlIntInstr(*instr));
+        assert(ReadStdFlIntRunInstr::canAppendToRun(*instr, _align));
+
+        auto& readFlIntInstr = static_cast<const ReadFlIntInstr&>(*instr);
+
+        /*
+         * The beginning of the run is aligned to `_align` and
+         * `readFlIntInstr.align() <= _align`: the padding before this
+         * member is static.
+         */
+        const Size align = readFlIntInstr.align();
+        const auto memberOffset = (_len + align - 1) & -align;
+        const auto& dt = readFlIntInstr.dt();
+
+        _members.push_back({
+            &readFlIntInstr, memberOffset - _len, readFlIntInstr.len(),
+            dt.isFixedLengthSignedIntegerType(), dt.isFixedLengthEnumerationType()
+        });
+        _len = memberOffset + readFlIntInstr.len();
+        _proc.pushBack(std::move(instr));
+    }
+}
+
+bool ReadStdFlIntRunInstr::isStdFlIntInstr(const Instr& instr) noexcept
+{
+    switch (instr.kind()) {
+    case Kind::READ_FL_SINT_A8:
+    case Kind::READ_FL_SINT_A16_LE:
+    case Kind::READ_FL_SINT_A32_LE:
+    case Kind::READ_FL_SINT_A64_LE:
+    case Kind::READ_FL_SINT_A16_BE:
+    case Kind::READ_FL_SINT_A32_BE:
+    case Kind::READ_FL_SINT_A64_BE:
+    case Kind::READ_FL_UINT_A8:
+    case Kind::READ_FL_UINT_A16_LE:
+    case Kind::READ_FL_UINT_A32_LE:
+    case Kind::READ_FL_UINT_A64_LE:
+    case Kind::READ_FL_UINT_A16_BE:
+    case Kind::READ_FL_UINT_A32_BE:
+    case Kind::READ_FL_UINT_A64_BE:
+    case Kind::READ_FL_SENUM_A8:
+    case Kind::READ_FL_SENUM_A16_LE:
+    case Kind::READ_FL_SENUM_A32_LE:
+    case Kind::READ_FL_SENUM_A64_LE:
+    case Kind::READ_FL_SENUM_A16_BE:
+    case Kind::READ_FL_SENUM_A32_BE:
+    case Kind::READ_FL_SENUM_A64_BE:
+    case Kind::READ_FL_UENUM_A8:
+    case Kind::READ_FL_UENUM_A16_LE:
+    case Kind::READ_FL_UENUM_A32_LE:
+    case Kind::READ_FL_UENUM_A64_LE:
+    case Kind::READ_FL_UENUM_A16_BE:
+    case Kind::READ_FL_UENUM_A32_BE:
+    case Kind::READ_FL_UENUM_A64_BE:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+bool ReadStdFlIntRunInstr::canAppendToRun(const Instr& instr, const unsigned int runAlign) noexcept
+{
+    assert(ReadStdFlIntRunInstr::isStdFlIntInstr(instr));
+    return static_cast<const ReadFlIntInstr&>(instr).align() <= runAlign;
+}
+
+void ReadStdFlIntRunInstr::buildRawProcFromShared()
+{
+    _proc.buildRawProcFromShared();
+}
+
+std::string ReadStdFlIntRunInstr::_toStr(const Size indent) const
+{
+    std::ostringstream ss;
+
+    ss << " " << _strProp("align") << _align << " " << _strProp("len") << _len << std::endl;
+    ss << _proc.toStr(indent + 1);
+    return ss.str();
+}
+
 BeginReadCompoundInstr::BeginReadCompoundInstr(const Kind kind,
                                                const StructureMemberType * const member,
                                                const DataType& dt) :
@@ -126,6 +126,7 @@ class ReadFlFloatInstr;
 class ReadFlSEnumInstr;
 class ReadFlSIntInstr;
 class ReadNtStrInstr;
+class ReadStdFlIntRunInstr;
 class ReadFlUEnumInstr;
 class ReadFlUIntInstr;
 class ReadVlIntInstr;
@@ -194,6 +195,10 @@ public:
     {
     }
 
+    virtual void visit(ReadStdFlIntRunInstr&)
+    {
+    }
+
     virtual void visit(BeginReadScopeInstr&)
     {
     }
@@ -420,6 +425,48 @@ struct InstrLoc final
  */
 using InstrLocs = std::vector<InstrLoc>;
 
+/*
+ * Static layout of the data which a procedure instruction (and its
+ * subprocedure, if any) reads.
+ *
+ * A procedure instruction only has a static layout when the length of
+ * its data doesn't depend on the data itself and when executing it has
+ * no effect other than emitting elements (no saved value, no clock
+ * value update, no type selection, and the rest), so that the VM may
+ * skip it without decoding it.
+ *
+ * Decoding such data may only fail when a fixed-length bit array which
+ * doesn't start on a byte boundary doesn't have the byte order of the
+ * previous one: for the VM to report this error, data of which the
+ * fixed-length bit arrays don't all have the same byte order has no
+ * static layout.
+ */
+struct StaticLayout final
+{
+    /*
+     * Length (bits) of the data, starting at an offset which is aligned
+     * to the alignment of the instruction.
+     */
+    Size len = 0;
+
+    /*
+     * Number of elements which the VM emits when executing the
+     * instruction, considering a single substring or BLOB section for
+     * each non-empty static-length string or BLOB.
+     */
+    Size elemCount = 0;
+
+    /*
+     * Same as `elemCount`, but when the VM also emits a single array
+     * section for each non-empty qualifying array (see
+     * `BeginReadSlArrayInstr::sectionElemInstr()`).
+     */
+    Size elemCountWithArraySections = 0;
+
+    // byte order of all the fixed-length bit arrays, if any
+    boost::optional<ByteOrder> bo;
+};
+
 /*
  * Procedure instruction abstract class.
  */
@@ -499,6 +546,7 @@ public:
         READ_FL_SINT_BE,
         READ_FL_SINT_LE,
         READ_NT_STR,
+        READ_STD_FL_INT_RUN,
         READ_FL_UENUM_A16_BE,
         READ_FL_UENUM_A16_LE,
         READ_FL_UENUM_A32_BE,
@@ -564,7 +612,6 @@ public:
     // only used for debugging purposes
     std::string toStr(Size indent = 0) const;
 
-    // only used to debug and for assertions
     bool isBeginReadData() const noexcept
     {
         switch (_theKind) {
@@ -657,7 +704,6 @@ public:
         }
     }
 
-    // only used to debug and for assertions
     bool isEndReadData() const noexcept
     {
         switch (_theKind) {
@@ -686,11 +732,23 @@ public:
         return _theKind;
     }
 
+    // index of this instruction within `PktProc::instrs()`
+    Index index() const noexcept
+    {
+        return _index;
+    }
+
+    void index(const Index index) noexcept
+    {
+        _index = index;
+    }
+
 private:
     virtual std::string _toStr(Size indent = 0) const;
 
 private:
     const Kind _theKind = Kind::UNSET;
+    Index _index = 0;
 };
 
 /*
@@ -724,6 +782,16 @@ public:
         return _align;
     }
 
+    const boost::optional<StaticLayout>& staticLayout() const noexcept
+    {
+        return _staticLayout;
+    }
+
+    void staticLayout(const StaticLayout& staticLayout) noexcept
+    {
+        _staticLayout = staticLayout;
+    }
+
 protected:
     std::string _commonToStr() const;
 
@@ -731,6 +799,7 @@ private:
     const StructureMemberType * const _memberType;
     const DataType * const _dt;
     const unsigned int _align;
+    boost::optional<StaticLayout> _staticLayout;
 };
 
 /*
@@ -1033,6 +1102,111 @@ private:
     std::string _toStr(Size indent = 0) const override;
 };
 
+/*
+ * "Read run of standard fixed-length integers" procedure instruction.
+ *
+ * This is a superinstruction which replaces a sequence of two or more
+ * consecutive "read fixed-length integer/enumeration" instructions of
+ * which the data types are byte-aligned and have a standard length (8,
+ * 16, 32, or 64 bits).
+ *
+ * Knowing the alignment of the first member, the offset of each member
+ * relative to the first one is static, so that the VM only needs to
+ * align its head and to check the bounds once for the whole run, and
+ * then decodes all the members back to back. The VM still emits one
+ * element per member, as if it executed the original instructions
+ * which the subprocedure of this instruction contains.
+ */
+class ReadStdFlIntRunInstr final :
+    public Instr
+{
+public:
+    // maximum number of members of a run
+    static constexpr Size maxMemberCount = 16;
+
+    // single member of a run
+    struct Member final
+    {
+        // original "read fixed-length integer/enumeration" instruction
+        const ReadFlIntInstr *instr;
+
+        // padding between the previous member, if any, and this one (bits)
+        Size padding;
+
+        // length of this member (bits)
+        Size len;
+
+        // whether or not this member is signed
+        bool isSigned;
+
+        // whether or not this member is an enumeration
+        bool isEnum;
+    };
+
+public:
+    /*
+     * Builds a run from the consecutive "read fixed-length
+     * integer/enumeration" instructions `instrs`.
+     *
+     * Call isStdFlIntInstr() and canAppendToRun() to build a valid
+     * sequence of at most `maxMemberCount` instructions.
+     */
+    explicit ReadStdFlIntRunInstr(Proc::Shared instrs);
+
+    // true if `instr` can be part of a run
+    static bool isStdFlIntInstr(const Instr& instr) noexcept;
+
+    /*
+     * True if `instr` (for which isStdFlIntInstr() is true) can follow
+     * a run of which the first member has the alignment `runAlign`.
+     */
+    static bool canAppendToRun(const Instr& instr, unsigned int runAlign) noexcept;
+
+    void accept(InstrVisitor& visitor) override
+    {
+        visitor.visit(*this);
+    }
+
+    void buildRawProcFromShared() override;
+
+    // subprocedure containing the original instructions
+    const Proc& proc() const noexcept
+    {
+        return _proc;
+    }
+
+    Proc& proc() noexcept
+    {
+        return _proc;
+    }
+
+    const std::vector<Member>& members() const noexcept
+    {
+        return _members;
+    }
+
+    // alignment of the first member
+    unsigned int align() const noexcept
+    {
+        return _align;
+    }
+
+    // total length of the run, including any padding (bits)
+    Size len() const noexcept
+    {
+        return _len;
+    }
+
+private:
+    std::string _toStr(Size indent = 0) const override;
+
+private:
+    Proc _proc;
+    std::vector<Member> _members;
+    unsigned int _align;
+    Size _len = 0;
+};
+
 /*
  * "Begin reading compound data" procedure instruction abstract class.
  *
@@ -1154,6 +1328,16 @@ public:
         return _align;
     }
 
+    const boost::optional<StaticLayout>& staticLayout() const noexcept
+    {
+        return _staticLayout;
+    }
+
+    void staticLayout(const StaticLayout& staticLayout) noexcept
+    {
+        _staticLayout = staticLayout;
+    }
+
 private:
     std::string _toStr(Size indent = 0) const override;
 
@@ -1161,6 +1345,7 @@ private:
     const Scope _scope;
     const unsigned int _align = 1;
     Proc _proc;
+    boost::optional<StaticLayout> _staticLayout;
 };
 
 /*
@@ -1222,11 +1407,26 @@ public:
         return _len;
     }
 
+    /*
+     * Single instruction of the subprocedure if the VM may read the
+     * items of this array as array sections, or `nullptr`.
+     */
+    const ReadFlBitArrayInstr *sectionElemInstr() const noexcept
+    {
+        return _sectionElemInstr;
+    }
+
+    void sectionElemInstr(const ReadFlBitArrayInstr * const instr) noexcept
+    {
+        _sectionElemInstr = instr;
+    }
+
 private:
     std::string _toStr(Size indent = 0) const override;
 
 private:
     const Size _len;
+    const ReadFlBitArrayInstr *_sectionElemInstr = nullptr;
 };
 
 /*
@@ -1314,11 +1514,26 @@ public:
         _lenPos = lenPos;
     }
 
+    /*
+     * Single instruction of the subprocedure if the VM may read the
+     * items of this array as array sections, or `nullptr`.
+     */
+    const ReadFlBitArrayInstr *sectionElemInstr() const noexcept
+    {
+        return _sectionElemInstr;
+    }
+
+    void sectionElemInstr(const ReadFlBitArrayInstr * const instr) noexcept
+    {
+        _sectionElemInstr = instr;
+    }
+
 private:
     std::string _toStr(Size indent = 0) const override;
 
 private:
     Index _lenPos = UINT64_C(-1);
+    const ReadFlBitArrayInstr *_sectionElemInstr = nullptr;
 };
 
 /*
@@ -2371,10 +2586,22 @@ public:
         _savedValsCount = savedValsCount;
     }
 
+    // all the instructions, indexed with Instr::index()
+    const std::vector<const Instr *>& instrs() const noexcept
+    {
+        return _instrs;
+    }
+
+    void instrs(std::vector<const Instr *> instrs)
+    {
+        _instrs = std::move(instrs);
+    }
+
 private:
     const TraceType * const _traceType;
     DsPktProcs _dsPktProcs;
     Size _savedValsCount = 0;
+    std::vector<const Instr *> _instrs;
     Proc _preambleProc;
 };
 
@@ -5,6 +5,7 @@
  * of the MIT license. See the LICENSE file for details.
  */
 
+#include <cstddef>
 #include <cstdint>
 
 #include "vm.hpp"
@@ -13,6 +14,139 @@
 namespace yactfr {
 namespace internal {
 
+/*
+ * Instruction kind to instruction handler mapping, in `Instr::Kind`
+ * order.
+ *
+ * `_x` is a macro taking an instruction kind name and the name of the
+ * corresponding `Vm` method.
+ *
+ * `_xNone` is a macro taking the name of an instruction kind which the
+ * VM never executes.
+ */
+#define _YACTFR_VM_INSTR_HANDLERS(_x, _xNone) \
+    _xNone(UNSET) \
+    _x(BEGIN_READ_DL_ARRAY, _execBeginReadDlArray) \
+    _x(BEGIN_READ_DL_STR, _execBeginReadDlStr) \
+    _x(BEGIN_READ_DL_BLOB, _execBeginReadDlBlob) \
+    _x(BEGIN_READ_SCOPE, _execBeginReadScope) \
+    _x(BEGIN_READ_SL_ARRAY, _execBeginReadSlArray) \
+    _x(BEGIN_READ_SL_STR, _execBeginReadSlStr) \
+    _x(BEGIN_READ_SL_UUID_ARRAY, _execBeginReadSlUuidArray) \
+    _x(BEGIN_READ_SL_BLOB, _execBeginReadSlBlob) \
+    _x(BEGIN_READ_SL_UUID_BLOB, _execBeginReadSlUuidBlob) \
+    _x(BEGIN_READ_STRUCT, _execBeginReadStruct) \
+    _x(BEGIN_READ_VAR_SINT_SEL, _execBeginReadVarSIntSel) \
+    _x(BEGIN_READ_VAR_UINT_SEL, _execBeginReadVarUIntSel) \
+    _x(BEGIN_READ_OPT_BOOL_SEL, _execBeginReadOptBoolSel) \
+    _x(BEGIN_READ_OPT_SINT_SEL, _execBeginReadOptSIntSel) \
+    _x(BEGIN_READ_OPT_UINT_SEL, _execBeginReadOptUIntSel) \
+    _xNone(DECR_REMAINING_ELEMS) \
+    _x(END_DS_ER_PREAMBLE_PROC, _execEndDsErPreambleProc) \
+    _x(END_DS_PKT_PREAMBLE_PROC, _execEndDsPktPreambleProc) \
+    _x(END_ER_PROC, _execEndErProc) \
+    _x(END_PKT_PREAMBLE_PROC, _execEndPktPreambleProc) \
+    _x(END_READ_SL_ARRAY, _execEndReadSlArray) \
+    _x(END_READ_DL_ARRAY, _execEndReadDlArray) \
+    _x(END_READ_SCOPE, _execEndReadScope) \
+    _x(END_READ_SL_STR, _execEndReadSlStr) \
+    _x(END_READ_DL_STR, _execEndReadDlStr) \
+    _x(END_READ_SL_BLOB, _execEndReadSlBlob) \
+    _x(END_READ_DL_BLOB, _execEndReadDlBlob) \
+    _x(END_READ_STRUCT, _execEndReadStruct) \
+    _x(END_READ_VAR_SINT_SEL, _execEndReadVarSIntSel) \
+    _x(END_READ_VAR_UINT_SEL, _execEndReadVarUIntSel) \
+    _x(END_READ_OPT_BOOL_SEL, _execEndReadOptBoolSel) \
+    _x(END_READ_OPT_SINT_SEL, _execEndReadOptSIntSel) \
+    _x(END_READ_OPT_UINT_SEL, _execEndReadOptUIntSel) \
+    _x(READ_FL_BIT_ARRAY_A16_BE, _execReadFlBitArrayA16Be) \
+    _x(READ_FL_BIT_ARRAY_A16_LE, _execReadFlBitArrayA16Le) \
+    _x(READ_FL_BIT_ARRAY_A32_BE, _execReadFlBitArrayA32Be) \
+    _x(READ_FL_BIT_ARRAY_A32_LE, _execReadFlBitArrayA32Le) \
+    _x(READ_FL_BIT_ARRAY_A64_BE, _execReadFlBitArrayA64Be) \
+    _x(READ_FL_BIT_ARRAY_A64_LE, _execReadFlBitArrayA64Le) \
+    _x(READ_FL_BIT_ARRAY_A8, _execReadFlBitArrayA8) \
+    _x(READ_FL_BIT_ARRAY_BE, _execReadFlBitArrayBe) \
+    _x(READ_FL_BIT_ARRAY_LE, _execReadFlBitArrayLe) \
+    _x(READ_FL_FLOAT_32_BE, _execReadFlFloat32Be) \
+    _x(READ_FL_FLOAT_32_LE, _execReadFlFloat32Le) \
+    _x(READ_FL_FLOAT_64_BE, _execReadFlFloat64Be) \
+    _x(READ_FL_FLOAT_64_LE, _execReadFlFloat64Le) \
+    _x(READ_FL_FLOAT_A32_BE, _execReadFlFloatA32Be) \
+    _x(READ_FL_FLOAT_A32_LE, _execReadFlFloatA32Le) \
+    _x(READ_FL_FLOAT_A64_BE, _execReadFlFloatA64Be) \
+    _x(READ_FL_FLOAT_A64_LE, _execReadFlFloatA64Le) \
+    _x(READ_FL_SENUM_A16_BE, _execReadFlSEnumA16Be) \
+    _x(READ_FL_SENUM_A16_LE, _execReadFlSEnumA16Le) \
+    _x(READ_FL_SENUM_A32_BE, _execReadFlSEnumA32Be) \
+    _x(READ_FL_SENUM_A32_LE, _execReadFlSEnumA32Le) \
+    _x(READ_FL_SENUM_A64_BE, _execReadFlSEnumA64Be) \
+    _x(READ_FL_SENUM_A64_LE, _execReadFlSEnumA64Le) \
+    _x(READ_FL_SENUM_A8, _execReadFlSEnumA8) \
+    _x(READ_FL_SENUM_BE, _execReadFlSEnumBe) \
+    _x(READ_FL_SENUM_LE, _execReadFlSEnumLe) \
+    _x(READ_FL_SINT_A16_BE, _execReadFlSIntA16Be) \
+    _x(READ_FL_SINT_A16_LE, _execReadFlSIntA16Le) \
+    _x(READ_FL_SINT_A32_BE, _execReadFlSIntA32Be) \
+    _x(READ_FL_SINT_A32_LE, _execReadFlSIntA32Le) \
+    _x(READ_FL_SINT_A64_BE, _execReadFlSIntA64Be) \
+    _x(READ_FL_SINT_A64_LE, _execReadFlSIntA64Le) \
+    _x(READ_FL_SINT_A8, _execReadFlSIntA8) \
+    _x(READ_FL_SINT_BE, _execReadFlSIntBe) \
+    _x(READ_FL_SINT_LE, _execReadFlSIntLe) \
+    _x(READ_NT_STR, _execReadNtStr) \
+    _x(READ_STD_FL_INT_RUN, _execReadStdFlIntRun) \
+    _x(READ_FL_UENUM_A16_BE, _execReadFlUEnumA16Be) \
+    _x(READ_FL_UENUM_A16_LE, _execReadFlUEnumA16Le) \
+    _x(READ_FL_UENUM_A32_BE, _execReadFlUEnumA32Be) \
+    _x(READ_FL_UENUM_A32_LE, _execReadFlUEnumA32Le) \
+    _x(READ_FL_UENUM_A64_BE, _execReadFlUEnumA64Be) \
+    _x(READ_FL_UENUM_A64_LE, _execReadFlUEnumA64Le) \
+    _x(READ_FL_UENUM_A8, _execReadFlUEnumA8) \
+    _x(READ_FL_UENUM_BE, _execReadFlUEnumBe) \
+    _x(READ_FL_UENUM_LE, _execReadFlUEnumLe) \
+    _x(READ_FL_UINT_A16_BE, _execReadFlUIntA16Be) \
+    _x(READ_FL_UINT_A16_LE, _execReadFlUIntA16Le) \
+    _x(READ_FL_UINT_A32_BE, _execReadFlUIntA32Be) \
+    _x(READ_FL_UINT_A32_LE, _execReadFlUIntA32Le) \
+    _x(READ_FL_UINT_A64_BE, _execReadFlUIntA64Be) \
+    _x(READ_FL_UINT_A64_LE, _execReadFlUIntA64Le) \
+    _x(READ_FL_UINT_A8, _execReadFlUIntA8) \
+    _x(READ_FL_UINT_BE, _execReadFlUIntBe) \
+    _x(READ_FL_UINT_LE, _execReadFlUIntLe) \
+    _x(READ_FL_BOOL_A16_BE, _execReadFlBoolA16Be) \
+    _x(READ_FL_BOOL_A16_LE, _execReadFlBoolA16Le) \
+    _x(READ_FL_BOOL_A32_BE, _execReadFlBoolA32Be) \
+    _x(READ_FL_BOOL_A32_LE, _execReadFlBoolA32Le) \
+    _x(READ_FL_BOOL_A64_BE, _execReadFlBoolA64Be) \
+    _x(READ_FL_BOOL_A64_LE, _execReadFlBoolA64Le) \
+    _x(READ_FL_BOOL_A8, _execReadFlBoolA8) \
+    _x(READ_FL_BOOL_BE, _execReadFlBoolBe) \
+    _x(READ_FL_BOOL_LE, _execReadFlBoolLe) \
+    _x(READ_VL_UINT, _execReadVlUInt) \
+    _x(READ_VL_SINT, _execReadVlSInt) \
+    _x(READ_VL_UENUM, _execReadVlUEnum) \
+    _x(READ_VL_SENUM, _execReadVlSEnum) \
+    _x(SAVE_VAL, _execSaveVal) \
+    _x(SET_CUR_ID, _execSetCurrentId) \
+    _x(SET_DS_ID, _execSetDsId) \
+    _x(SET_DS_INFO, _execSetDsInfo) \
+    _x(SET_DST, _execSetDst) \
+    _x(SET_ERT, _execSetErt) \
+    _x(SET_ER_INFO, _execSetErInfo) \
+    _x(SET_PKT_CONTENT_LEN, _execSetPktContentLen) \
+    _x(SET_PKT_END_DEF_CLK_VAL, _execSetPktEndDefClkVal) \
+    _x(SET_PKT_MAGIC_NUMBER, _execSetPktMagicNumber) \
+    _x(SET_PKT_SEQ_NUM, _execSetPktSeqNum) \
+    _x(SET_PKT_DISC_ER_COUNTER_SNAP, _execSetPktDiscErCounterSnap) \
+    _x(SET_PKT_TOTAL_LEN, _execSetPktTotalLen) \
+    _x(SET_PKT_INFO, _execSetPktInfo) \
+    _x(UPDATE_DEF_CLK_VAL, _execUpdateDefClkVal) \
+    _x(UPDATE_DEF_CLK_VAL_FL, _execUpdateDefClkValFl)
+
+// expands to nothing (ignores an `_x*` macro entry)
+#define _YACTFR_VM_IGNORE(...)
+
 VmPos::VmPos(const PktProc& pktProc) :
     pktProc {&pktProc}
 {
@@ -44,11 +178,24 @@ void VmPos::_setSimpleFromOther(const VmPos& other)
     theState = other.theState;
     nextState = other.nextState;
     lastFlBitArrayBo = other.lastFlBitArrayBo;
+    erFilterState = other.erFilterState;
+    nextPendingErElemIndex = other.nextPendingErElemIndex;
+    dataProjSectionsVisible = other.dataProjSectionsVisible;
+    isNextSectionFirst = other.isNextSectionFirst;
     remBitsToSkip = other.remBitsToSkip;
     lastIntVal = other.lastIntVal;
     curVlIntLenBits = other.curVlIntLenBits;
     curVlIntElem = &this->elemFromOther(other, *other.curVlIntElem);
     curId = other.curId;
+    curStdFlIntRunMemberIndex = other.curStdFlIntRunMemberIndex;
+    curStdFlIntRunIsDecoded = other.curStdFlIntRunIsDecoded;
+
+    if (curStdFlIntRunMemberIndex > 0 && curStdFlIntRunIsDecoded) {
+        // only the values of the members to emit
+        std::copy(other.curStdFlIntRunVals.begin() + curStdFlIntRunMemberIndex,
+                  other.curStdFlIntRunVals.end(),
+                  curStdFlIntRunVals.begin() + curStdFlIntRunMemberIndex);
+    }
     pktProc = other.pktProc;
     curDsPktProc = other.curDsPktProc;
     curErProc = other.curErProc;
@@ -63,6 +210,139 @@ void VmPos::_setFromOther(const VmPos& other)
     stack = other.stack;
     savedVals = other.savedVals;
     defClkVal = other.defClkVal;
+    pendingErElems = other.pendingErElems;
+}
+
+/*
+ * Element kind to current element (member of `VmPos::elems`) mapping.
+ *
+ * `_x` is a macro taking an element kind name and the name of the
+ * corresponding member.
+ *
+ * `_xSection` is the same as `_x`, but for a substring, BLOB section,
+ * or array section element, which refers to the data of its data
+ * block.
+ */
+#define _YACTFR_VM_ELEMS(_x, _xSection) \
+    _x(PACKET_BEGINNING, pktBeginning) \
+    _x(PACKET_END, pktEnd) \
+    _x(SCOPE_BEGINNING, scopeBeginning) \
+    _x(SCOPE_END, scopeEnd) \
+    _x(PACKET_CONTENT_BEGINNING, pktContentBeginning) \
+    _x(PACKET_CONTENT_END, pktContentEnd) \
+    _x(EVENT_RECORD_BEGINNING, erBeginning) \
+    _x(EVENT_RECORD_END, erEnd) \
+    _x(PACKET_MAGIC_NUMBER, pktMagicNumber) \
+    _x(METADATA_STREAM_UUID, metadataStreamUuid) \
+    _x(DATA_STREAM_INFO, dsInfo) \
+    _x(PACKET_INFO, pktInfo) \
+    _x(EVENT_RECORD_INFO, erInfo) \
+    _x(DEFAULT_CLOCK_VALUE, defClkVal) \
+    _x(FIXED_LENGTH_BIT_ARRAY, flBitArray) \
+    _x(FIXED_LENGTH_BOOLEAN, flBool) \
+    _x(FIXED_LENGTH_SIGNED_INTEGER, flSInt) \
+    _x(FIXED_LENGTH_UNSIGNED_INTEGER, flUInt) \
+    _x(FIXED_LENGTH_SIGNED_ENUMERATION, flSEnum) \
+    _x(FIXED_LENGTH_UNSIGNED_ENUMERATION, flUEnum) \
+    _x(FIXED_LENGTH_FLOATING_POINT_NUMBER, flFloat) \
+    _x(VARIABLE_LENGTH_SIGNED_INTEGER, vlSInt) \
+    _x(VARIABLE_LENGTH_UNSIGNED_INTEGER, vlUInt) \
+    _x(VARIABLE_LENGTH_SIGNED_ENUMERATION, vlSEnum) \
+    _x(VARIABLE_LENGTH_UNSIGNED_ENUMERATION, vlUEnum) \
+    _x(NULL_TERMINATED_STRING_BEGINNING, ntStrBeginning) \
+    _x(NULL_TERMINATED_STRING_END, ntStrEnd) \
+    _xSection(SUBSTRING, substr) \
+    _xSection(BLOB_SECTION, blobSection) \
+    _xSection(ARRAY_SECTION, arraySection) \
+    _x(STATIC_LENGTH_ARRAY_BEGINNING, slArrayBeginning) \
+    _x(STATIC_LENGTH_ARRAY_END, slArrayEnd) \
+    _x(DYNAMIC_LENGTH_ARRAY_BEGINNING, dlArrayBeginning) \
+    _x(DYNAMIC_LENGTH_ARRAY_END, dlArrayEnd) \
+    _x(STATIC_LENGTH_STRING_BEGINNING, slStrBeginning) \
+    _x(STATIC_LENGTH_STRING_END, slStrEnd) \
+    _x(DYNAMIC_LENGTH_STRING_BEGINNING, dlStrBeginning) \
+    _x(DYNAMIC_LENGTH_STRING_END, dlStrEnd) \
+    _x(STATIC_LENGTH_BLOB_BEGINNING, slBlobBeginning) \
+    _x(STATIC_LENGTH_BLOB_END, slBlobEnd) \
+    _x(DYNAMIC_LENGTH_BLOB_BEGINNING, dlBlobBeginning) \
+    _x(DYNAMIC_LENGTH_BLOB_END, dlBlobEnd) \
+    _x(STRUCTURE_BEGINNING, structBeginning) \
+    _x(STRUCTURE_END, structEnd) \
+    _x(VARIANT_WITH_SIGNED_INTEGER_SELECTOR_BEGINNING, varSIntSelBeginning) \
+    _x(VARIANT_WITH_SIGNED_INTEGER_SELECTOR_END, varSIntSelEnd) \
+    _x(VARIANT_WITH_UNSIGNED_INTEGER_SELECTOR_BEGINNING, varUIntSelBeginning) \
+    _x(VARIANT_WITH_UNSIGNED_INTEGER_SELECTOR_END, varUIntSelEnd) \
+    _x(OPTIONAL_WITH_BOOLEAN_SELECTOR_BEGINNING, optBoolSelBeginning) \
+    _x(OPTIONAL_WITH_BOOLEAN_SELECTOR_END, optBoolSelEnd) \
+    _x(OPTIONAL_WITH_SIGNED_INTEGER_SELECTOR_BEGINNING, optSIntSelBeginning) \
+    _x(OPTIONAL_WITH_SIGNED_INTEGER_SELECTOR_END, optSIntSelEnd) \
+    _x(OPTIONAL_WITH_UNSIGNED_INTEGER_SELECTOR_BEGINNING, optUIntSelBeginning) \
+    _x(OPTIONAL_WITH_UNSIGNED_INTEGER_SELECTOR_END, optUIntSelEnd)
+
+template <typename ElemT>
+std::shared_ptr<const Element> VmPos::_copySectionElem(const ElemT& elem,
+                                                       std::shared_ptr<const std::vector<std::uint8_t>>& data)
+{
+    // the data block of `elem` won't exist anymore: copy its data
+    const auto begin = reinterpret_cast<const std::uint8_t *>(elem._begin);
+    const auto end = reinterpret_cast<const std::uint8_t *>(elem._end);
+    auto dataCopy = std::make_shared<std::vector<std::uint8_t>>(begin, end);
+    auto elemCopy = std::make_shared<ElemT>(elem);
+
+    elemCopy->_begin = reinterpret_cast<decltype(elemCopy->_begin)>(dataCopy->data());
+    elemCopy->_end = elemCopy->_begin + dataCopy->size();
+    data = std::move(dataCopy);
+    return elemCopy;
+}
+
+void VmPos::appendPendingErElem(const Element& elem, const Index offset, const Instr * const instr,
+                                const bool isDataProjHidden, const bool incrsMark)
+{
+    VmPendingErElem pendingElem;
+
+    switch (elem.kind()) {
+#define _YACTFR_VM_COPY_ELEM(_kind, _member) \
+    case Element::Kind::_kind: \
+        pendingElem.elem = std::make_shared<decltype(elems._member)>(static_cast<const decltype(elems._member)&>(elem)); \
+        break;
+
+#define _YACTFR_VM_COPY_SECTION_ELEM(_kind, _member) \
+    case Element::Kind::_kind: \
+        pendingElem.elem = this->_copySectionElem(static_cast<const decltype(elems._member)&>(elem), \
+                                                  pendingElem.sectionData); \
+        break;
+
+    _YACTFR_VM_ELEMS(_YACTFR_VM_COPY_ELEM, _YACTFR_VM_COPY_SECTION_ELEM)
+
+#undef _YACTFR_VM_COPY_ELEM
+#undef _YACTFR_VM_COPY_SECTION_ELEM
+
+    default:
+        std::abort();
+    }
+
+    pendingElem.offset = offset;
+    pendingElem.instr = instr;
+    pendingElem.isDataProjHidden = isDataProjHidden;
+    pendingElem.incrsMark = incrsMark;
+    pendingErElems.push_back(std::move(pendingElem));
+}
+
+const Element& VmPos::restorePendingErElem(const VmPendingErElem& pendingElem) noexcept
+{
+    switch (pendingElem.elem->kind()) {
+#define _YACTFR_VM_RESTORE_ELEM(_kind, _member) \
+    case Element::Kind::_kind: \
+        elems._member = static_cast<const decltype(elems._member)&>(*pendingElem.elem); \
+        return elems._member;
+
+    _YACTFR_VM_ELEMS(_YACTFR_VM_RESTORE_ELEM, _YACTFR_VM_RESTORE_ELEM)
+
+#undef _YACTFR_VM_RESTORE_ELEM
+
+    default:
+        std::abort();
+    }
 }
 
 } // namespace internal
@@ -161,12 +441,158 @@ bool ElementSequenceIteratorPosition::operator>=(const ElementSequenceIteratorPo
 
 namespace internal {
 
-Vm::Vm(DataSourceFactory& dataSrcFactory, const PktProc& pktProc, ElementSequenceIterator& it) :
+using K = Element::Kind;
+
+// all the element kinds
+static constexpr K allElemKinds[] = {
+    K::PACKET_BEGINNING,
+    K::PACKET_END,
+    K::SCOPE_BEGINNING,
+    K::SCOPE_END,
+    K::PACKET_CONTENT_BEGINNING,
+    K::PACKET_CONTENT_END,
+    K::EVENT_RECORD_BEGINNING,
+    K::EVENT_RECORD_END,
+    K::PACKET_MAGIC_NUMBER,
+    K::METADATA_STREAM_UUID,
+    K::DATA_STREAM_INFO,
+    K::DEFAULT_CLOCK_VALUE,
+    K::PACKET_INFO,
+    K::EVENT_RECORD_INFO,
+    K::FIXED_LENGTH_BIT_ARRAY,
+    K::FIXED_LENGTH_BOOLEAN,
+    K::FIXED_LENGTH_SIGNED_INTEGER,
+    K::FIXED_LENGTH_UNSIGNED_INTEGER,
+    K::FIXED_LENGTH_FLOATING_POINT_NUMBER,
+    K::FIXED_LENGTH_SIGNED_ENUMERATION,
+    K::FIXED_LENGTH_UNSIGNED_ENUMERATION,
+    K::VARIABLE_LENGTH_SIGNED_INTEGER,
+    K::VARIABLE_LENGTH_UNSIGNED_INTEGER,
+    K::VARIABLE_LENGTH_SIGNED_ENUMERATION,
+    K::VARIABLE_LENGTH_UNSIGNED_ENUMERATION,
+    K::NULL_TERMINATED_STRING_BEGINNING,
+    K::NULL_TERMINATED_STRING_END,
+    K::SUBSTRING,
+    K::BLOB_SECTION,
+    K::ARRAY_SECTION,
+    K::STRUCTURE_BEGINNING,
+    K::STRUCTURE_END,
+    K::STATIC_LENGTH_ARRAY_BEGINNING,
+    K::STATIC_LENGTH_ARRAY_END,
+    K::DYNAMIC_LENGTH_ARRAY_BEGINNING,
+    K::DYNAMIC_LENGTH_ARRAY_END,
+    K::STATIC_LENGTH_BLOB_BEGINNING,
+    K::STATIC_LENGTH_BLOB_END,
+    K::DYNAMIC_LENGTH_BLOB_BEGINNING,
+    K::DYNAMIC_LENGTH_BLOB_END,
+    K::STATIC_LENGTH_STRING_BEGINNING,
+    K::STATIC_LENGTH_STRING_END,
+    K::DYNAMIC_LENGTH_STRING_BEGINNING,
+    K::DYNAMIC_LENGTH_STRING_END,
+    K::VARIANT_WITH_SIGNED_INTEGER_SELECTOR_BEGINNING,
+    K::VARIANT_WITH_SIGNED_INTEGER_SELECTOR_END,
+    K::VARIANT_WITH_UNSIGNED_INTEGER_SELECTOR_BEGINNING,
+    K::VARIANT_WITH_UNSIGNED_INTEGER_SELECTOR_END,
+    K::OPTIONAL_WITH_BOOLEAN_SELECTOR_BEGINNING,
+    K::OPTIONAL_WITH_BOOLEAN_SELECTOR_END,
+    K::OPTIONAL_WITH_SIGNED_INTEGER_SELECTOR_BEGINNING,
+    K::OPTIONAL_WITH_SIGNED_INTEGER_SELECTOR_END,
+    K::OPTIONAL_WITH_UNSIGNED_INTEGER_SELECTOR_BEGINNING,
+    K::OPTIONAL_WITH_UNSIGNED_INTEGER_SELECTOR_END,
+};
+
+/*
+ * Returns whether or not elemKindIndex() maps each element kind to a
+ * distinct index.
+ */
+static constexpr bool elemKindIndexesAreUnique() noexcept
+{
+    for (Index i = 0; i < sizeof allElemKinds / sizeof allElemKinds[0]; ++i) {
+        for (Index j = i + 1; j < sizeof allElemKinds / sizeof allElemKinds[0]; ++j) {
+            if (elemKindIndex(allElemKinds[i]) == elemKindIndex(allElemKinds[j])) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static_assert(elemKindIndexesAreUnique(), "Element kind indexes are unique.");
+
+/*
+ * Returns the table of hidden element kinds (see elemKindIndex()) of
+ * the iterators considering the options `opts`.
+ */
+static std::array<bool, ELEM_KIND_TABLE_SIZE> hiddenElemKinds(const ElementSequenceOptions& opts)
+{
+    std::array<bool, ELEM_KIND_TABLE_SIZE> table;
+
+    table.fill(false);
+
+    if (opts.elementKinds()) {
+        for (const auto kind : allElemKinds) {
+            table[elemKindIndex(kind)] = opts.elementKinds()->count(kind) == 0;
+        }
+    }
+
+    return table;
+}
+
+/*
+ * Returns whether or not the iterators don't produce, considering the
+ * options `opts`, any element of which the kind is one of the kinds of
+ * the elements of data having a static layout.
+ */
+static bool canJumpOverHiddenStaticData(const ElementSequenceOptions& opts)
+{
+    if (!opts.elementKinds()) {
+        return false;
+    }
+
+    static const std::array<K, 20> staticDataKinds {
+        K::SCOPE_BEGINNING,
+        K::SCOPE_END,
+        K::STRUCTURE_BEGINNING,
+        K::STRUCTURE_END,
+        K::STATIC_LENGTH_ARRAY_BEGINNING,
+        K::STATIC_LENGTH_ARRAY_END,
+        K::STATIC_LENGTH_STRING_BEGINNING,
+        K::STATIC_LENGTH_STRING_END,
+        K::STATIC_LENGTH_BLOB_BEGINNING,
+        K::STATIC_LENGTH_BLOB_END,
+        K::SUBSTRING,
+        K::BLOB_SECTION,
+        K::ARRAY_SECTION,
+        K::FIXED_LENGTH_BIT_ARRAY,
+        K::FIXED_LENGTH_BOOLEAN,
+        K::FIXED_LENGTH_SIGNED_INTEGER,
+        K::FIXED_LENGTH_UNSIGNED_INTEGER,
+        K::FIXED_LENGTH_SIGNED_ENUMERATION,
+        K::FIXED_LENGTH_UNSIGNED_ENUMERATION,
+        K::FIXED_LENGTH_FLOATING_POINT_NUMBER,
+    };
+
+    return std::none_of(staticDataKinds.begin(), staticDataKinds.end(), [&opts](const K kind) {
+        return opts.elementKinds()->count(kind) > 0;
+    });
+}
+
+Vm::Vm(DataSourceFactory& dataSrcFactory, const PktProc& pktProc,
+       const ElementSequenceOptions& opts, ElementSequenceIterator& it) :
     _dataSrcFactory {&dataSrcFactory},
     _dataSrc {dataSrcFactory.createDataSource()},
     _it {&it},
+    _opts {&opts},
+    _canJumpOverHiddenStaticData {canJumpOverHiddenStaticData(opts)},
+    _hiddenElemKinds {hiddenElemKinds(opts)},
     _pos {pktProc}
 {
+    if (opts.projectedDataLocations()) {
+        _dataProj = std::make_shared<const DataProj>(pktProc,
+                                                     *opts.projectedDataLocations());
+    }
+
     this->_initExecFuncs();
 }
 
@@ -174,6 +600,10 @@ Vm::Vm(const Vm& other, ElementSequenceIterator& it) :
     _dataSrcFactory {other._dataSrcFactory},
     _dataSrc {_dataSrcFactory->createDataSource()},
     _it {&it},
+    _opts {other._opts},
+    _canJumpOverHiddenStaticData {other._canJumpOverHiddenStaticData},
+    _hiddenElemKinds {other._hiddenElemKinds},
+    _dataProj {other._dataProj},
     _pos {other._pos}
 {
     this->_initExecFuncs();
@@ -183,6 +613,7 @@ Vm::Vm(const Vm& other, ElementSequenceIterator& it) :
 void Vm::setFromOther(const Vm& other, ElementSequenceIterator& it)
 {
     assert(_dataSrcFactory == other._dataSrcFactory);
+    assert(_opts == other._opts);
     _it = &it;
     _pos = other._pos;
     this->_resetBuffer();
@@ -190,121 +621,12 @@ void Vm::setFromOther(const Vm& other, ElementSequenceIterator& it)
 
 void Vm::_initExecFuncs() noexcept
 {
-    this->_initExecFunc<Instr::Kind::READ_FL_BIT_ARRAY_LE>(&Vm::_execReadFlBitArrayLe);
-    this->_initExecFunc<Instr::Kind::READ_FL_BIT_ARRAY_BE>(&Vm::_execReadFlBitArrayBe);
-    this->_initExecFunc<Instr::Kind::READ_FL_BIT_ARRAY_A8>(&Vm::_execReadFlBitArrayA8);
-    this->_initExecFunc<Instr::Kind::READ_FL_BIT_ARRAY_A16_LE>(&Vm::_execReadFlBitArrayA16Le);
-    this->_initExecFunc<Instr::Kind::READ_FL_BIT_ARRAY_A32_LE>(&Vm::_execReadFlBitArrayA32Le);
-    this->_initExecFunc<Instr::Kind::READ_FL_BIT_ARRAY_A64_LE>(&Vm::_execReadFlBitArrayA64Le);
-    this->_initExecFunc<Instr::Kind::READ_FL_BIT_ARRAY_A16_BE>(&Vm::_execReadFlBitArrayA16Be);
-    this->_initExecFunc<Instr::Kind::READ_FL_BIT_ARRAY_A32_BE>(&Vm::_execReadFlBitArrayA32Be);
-    this->_initExecFunc<Instr::Kind::READ_FL_BIT_ARRAY_A64_BE>(&Vm::_execReadFlBitArrayA64Be);
-    this->_initExecFunc<Instr::Kind::READ_FL_BOOL_LE>(&Vm::_execReadFlBoolLe);
-    this->_initExecFunc<Instr::Kind::READ_FL_BOOL_BE>(&Vm::_execReadFlBoolBe);
-    this->_initExecFunc<Instr::Kind::READ_FL_BOOL_A8>(&Vm::_execReadFlBoolA8);
-    this->_initExecFunc<Instr::Kind::READ_FL_BOOL_A16_LE>(&Vm::_execReadFlBoolA16Le);
-    this->_initExecFunc<Instr::Kind::READ_FL_BOOL_A32_LE>(&Vm::_execReadFlBoolA32Le);
-    this->_initExecFunc<Instr::Kind::READ_FL_BOOL_A64_LE>(&Vm::_execReadFlBoolA64Le);
-    this->_initExecFunc<Instr::Kind::READ_FL_BOOL_A16_BE>(&Vm::_execReadFlBoolA16Be);
-    this->_initExecFunc<Instr::Kind::READ_FL_BOOL_A32_BE>(&Vm::_execReadFlBoolA32Be);
-    this->_initExecFunc<Instr::Kind::READ_FL_BOOL_A64_BE>(&Vm::_execReadFlBoolA64Be);
-    this->_initExecFunc<Instr::Kind::READ_FL_SINT_LE>(&Vm::_execReadFlSIntLe);
-    this->_initExecFunc<Instr::Kind::READ_FL_SINT_BE>(&Vm::_execReadFlSIntBe);
-    this->_initExecFunc<Instr::Kind::READ_FL_SINT_A8>(&Vm::_execReadFlSIntA8);
-    this->_initExecFunc<Instr::Kind::READ_FL_SINT_A16_LE>(&Vm::_execReadFlSIntA16Le);
-    this->_initExecFunc<Instr::Kind::READ_FL_SINT_A32_LE>(&Vm::_execReadFlSIntA32Le);
-    this->_initExecFunc<Instr::Kind::READ_FL_SINT_A64_LE>(&Vm::_execReadFlSIntA64Le);
-    this->_initExecFunc<Instr::Kind::READ_FL_SINT_A16_BE>(&Vm::_execReadFlSIntA16Be);
-    this->_initExecFunc<Instr::Kind::READ_FL_SINT_A32_BE>(&Vm::_execReadFlSIntA32Be);
-    this->_initExecFunc<Instr::Kind::READ_FL_SINT_A64_BE>(&Vm::_execReadFlSIntA64Be);
-    this->_initExecFunc<Instr::Kind::READ_FL_UINT_LE>(&Vm::_execReadFlUIntLe);
-    this->_initExecFunc<Instr::Kind::READ_FL_UINT_BE>(&Vm::_execReadFlUIntBe);
-    this->_initExecFunc<Instr::Kind::READ_FL_UINT_A8>(&Vm::_execReadFlUIntA8);
-    this->_initExecFunc<Instr::Kind::READ_FL_UINT_A16_LE>(&Vm::_execReadFlUIntA16Le);
-    this->_initExecFunc<Instr::Kind::READ_FL_UINT_A32_LE>(&Vm::_execReadFlUIntA32Le);
-    this->_initExecFunc<Instr::Kind::READ_FL_UINT_A64_LE>(&Vm::_execReadFlUIntA64Le);
-    this->_initExecFunc<Instr::Kind::READ_FL_UINT_A16_BE>(&Vm::_execReadFlUIntA16Be);
-    this->_initExecFunc<Instr::Kind::READ_FL_UINT_A32_BE>(&Vm::_execReadFlUIntA32Be);
-    this->_initExecFunc<Instr::Kind::READ_FL_UINT_A64_BE>(&Vm::_execReadFlUIntA64Be);
-    this->_initExecFunc<Instr::Kind::READ_FL_FLOAT_32_LE>(&Vm::_execReadFlFloat32Le);
-    this->_initExecFunc<Instr::Kind::READ_FL_FLOAT_32_BE>(&Vm::_execReadFlFloat32Be);
-    this->_initExecFunc<Instr::Kind::READ_FL_FLOAT_A32_LE>(&Vm::_execReadFlFloatA32Le);
-    this->_initExecFunc<Instr::Kind::READ_FL_FLOAT_A32_BE>(&Vm::_execReadFlFloatA32Be);
-    this->_initExecFunc<Instr::Kind::READ_FL_FLOAT_64_LE>(&Vm::_execReadFlFloat64Le);
-    this->_initExecFunc<Instr::Kind::READ_FL_FLOAT_64_BE>(&Vm::_execReadFlFloat64Be);
-    this->_initExecFunc<Instr::Kind::READ_FL_FLOAT_A64_LE>(&Vm::_execReadFlFloatA64Le);
-    this->_initExecFunc<Instr::Kind::READ_FL_FLOAT_A64_BE>(&Vm::_execReadFlFloatA64Be);
-    this->_initExecFunc<Instr::Kind::READ_FL_SENUM_LE>(&Vm::_execReadFlSEnumLe);
-    this->_initExecFunc<Instr::Kind::READ_FL_SENUM_BE>(&Vm::_execReadFlSEnumBe);
-    this->_initExecFunc<Instr::Kind::READ_FL_SENUM_A8>(&Vm::_execReadFlSEnumA8);
-    this->_initExecFunc<Instr::Kind::READ_FL_SENUM_A16_LE>(&Vm::_execReadFlSEnumA16Le);
-    this->_initExecFunc<Instr::Kind::READ_FL_SENUM_A32_LE>(&Vm::_execReadFlSEnumA32Le);
-    this->_initExecFunc<Instr::Kind::READ_FL_SENUM_A64_LE>(&Vm::_execReadFlSEnumA64Le);
-    this->_initExecFunc<Instr::Kind::READ_FL_SENUM_A16_BE>(&Vm::_execReadFlSEnumA16Be);
-    this->_initExecFunc<Instr::Kind::READ_FL_SENUM_A32_BE>(&Vm::_execReadFlSEnumA32Be);
-    this->_initExecFunc<Instr::Kind::READ_FL_SENUM_A64_BE>(&Vm::_execReadFlSEnumA64Be);
-    this->_initExecFunc<Instr::Kind::READ_FL_UENUM_LE>(&Vm::_execReadFlUEnumLe);
-    this->_initExecFunc<Instr::Kind::READ_FL_UENUM_BE>(&Vm::_execReadFlUEnumBe);
-    this->_initExecFunc<Instr::Kind::READ_FL_UENUM_A8>(&Vm::_execReadFlUEnumA8);
-    this->_initExecFunc<Instr::Kind::READ_FL_UENUM_A16_LE>(&Vm::_execReadFlUEnumA16Le);
-    this->_initExecFunc<Instr::Kind::READ_FL_UENUM_A32_LE>(&Vm::_execReadFlUEnumA32Le);
-    this->_initExecFunc<Instr::Kind::READ_FL_UENUM_A64_LE>(&Vm::_execReadFlUEnumA64Le);
-    this->_initExecFunc<Instr::Kind::READ_FL_UENUM_A16_BE>(&Vm::_execReadFlUEnumA16Be);
-    this->_initExecFunc<Instr::Kind::READ_FL_UENUM_A32_BE>(&Vm::_execReadFlUEnumA32Be);
-    this->_initExecFunc<Instr::Kind::READ_FL_UENUM_A64_BE>(&Vm::_execReadFlUEnumA64Be);
-    this->_initExecFunc<Instr::Kind::READ_VL_UINT>(&Vm::_execReadVlUInt);
-    this->_initExecFunc<Instr::Kind::READ_VL_SINT>(&Vm::_execReadVlSInt);
-    this->_initExecFunc<Instr::Kind::READ_VL_UENUM>(&Vm::_execReadVlUEnum);
-    this->_initExecFunc<Instr::Kind::READ_VL_SENUM>(&Vm::_execReadVlSEnum);
-    this->_initExecFunc<Instr::Kind::READ_NT_STR>(&Vm::_execReadNtStr);
-    this->_initExecFunc<Instr::Kind::BEGIN_READ_SCOPE>(&Vm::_execBeginReadScope);
-    this->_initExecFunc<Instr::Kind::END_READ_SCOPE>(&Vm::_execEndReadScope);
-    this->_initExecFunc<Instr::Kind::BEGIN_READ_STRUCT>(&Vm::_execBeginReadStruct);
-    this->_initExecFunc<Instr::Kind::END_READ_STRUCT>(&Vm::_execEndReadStruct);
-    this->_initExecFunc<Instr::Kind::BEGIN_READ_SL_ARRAY>(&Vm::_execBeginReadSlArray);
-    this->_initExecFunc<Instr::Kind::END_READ_SL_ARRAY>(&Vm::_execEndReadSlArray);
-    this->_initExecFunc<Instr::Kind::BEGIN_READ_SL_UUID_ARRAY>(&Vm::_execBeginReadSlUuidArray);
-    this->_initExecFunc<Instr::Kind::BEGIN_READ_SL_STR>(&Vm::_execBeginReadSlStr);
-    this->_initExecFunc<Instr::Kind::END_READ_SL_STR>(&Vm::_execEndReadSlStr);
-    this->_initExecFunc<Instr::Kind::BEGIN_READ_SL_BLOB>(&Vm::_execBeginReadSlBlob);
-    this->_initExecFunc<Instr::Kind::END_READ_SL_BLOB>(&Vm::_execEndReadSlBlob);
-    this->_initExecFunc<Instr::Kind::BEGIN_READ_SL_UUID_BLOB>(&Vm::_execBeginReadSlUuidBlob);
-    this->_initExecFunc<Instr::Kind::BEGIN_READ_DL_ARRAY>(&Vm::_execBeginReadDlArray);
-    this->_initExecFunc<Instr::Kind::END_READ_DL_ARRAY>(&Vm::_execEndReadDlArray);
-    this->_initExecFunc<Instr::Kind::BEGIN_READ_DL_STR>(&Vm::_execBeginReadDlStr);
-    this->_initExecFunc<Instr::Kind::END_READ_DL_STR>(&Vm::_execEndReadDlStr);
-    this->_initExecFunc<Instr::Kind::BEGIN_READ_DL_BLOB>(&Vm::_execBeginReadDlBlob);
-    this->_initExecFunc<Instr::Kind::END_READ_DL_BLOB>(&Vm::_execEndReadDlBlob);
-    this->_initExecFunc<Instr::Kind::BEGIN_READ_VAR_SINT_SEL>(&Vm::_execBeginReadVarSIntSel);
-    this->_initExecFunc<Instr::Kind::BEGIN_READ_VAR_UINT_SEL>(&Vm::_execBeginReadVarUIntSel);
-    this->_initExecFunc<Instr::Kind::END_READ_VAR_UINT_SEL>(&Vm::_execEndReadVarUIntSel);
-    this->_initExecFunc<Instr::Kind::END_READ_VAR_SINT_SEL>(&Vm::_execEndReadVarSIntSel);
-    this->_initExecFunc<Instr::Kind::BEGIN_READ_OPT_BOOL_SEL>(&Vm::_execBeginReadOptBoolSel);
-    this->_initExecFunc<Instr::Kind::BEGIN_READ_OPT_SINT_SEL>(&Vm::_execBeginReadOptSIntSel);
-    this->_initExecFunc<Instr::Kind::BEGIN_READ_OPT_UINT_SEL>(&Vm::_execBeginReadOptUIntSel);
-    this->_initExecFunc<Instr::Kind::END_READ_OPT_BOOL_SEL>(&Vm::_execEndReadOptBoolSel);
-    this->_initExecFunc<Instr::Kind::END_READ_OPT_UINT_SEL>(&Vm::_execEndReadOptUIntSel);
-    this->_initExecFunc<Instr::Kind::END_READ_OPT_SINT_SEL>(&Vm::_execEndReadOptSIntSel);
-    this->_initExecFunc<Instr::Kind::SAVE_VAL>(&Vm::_execSaveVal);
-    this->_initExecFunc<Instr::Kind::SET_PKT_END_DEF_CLK_VAL>(&Vm::_execSetPktEndDefClkVal);
-    this->_initExecFunc<Instr::Kind::UPDATE_DEF_CLK_VAL_FL>(&Vm::_execUpdateDefClkValFl);
-    this->_initExecFunc<Instr::Kind::UPDATE_DEF_CLK_VAL>(&Vm::_execUpdateDefClkVal);
-    this->_initExecFunc<Instr::Kind::SET_CUR_ID>(&Vm::_execSetCurrentId);
-    this->_initExecFunc<Instr::Kind::SET_DST>(&Vm::_execSetDst);
-    this->_initExecFunc<Instr::Kind::SET_ERT>(&Vm::_execSetErt);
-    this->_initExecFunc<Instr::Kind::SET_DS_ID>(&Vm::_execSetDsId);
-    this->_initExecFunc<Instr::Kind::SET_PKT_SEQ_NUM>(&Vm::_execSetPktSeqNum);
-    this->_initExecFunc<Instr::Kind::SET_PKT_DISC_ER_COUNTER_SNAP>(&Vm::_execSetPktDiscErCounterSnap);
-    this->_initExecFunc<Instr::Kind::SET_PKT_TOTAL_LEN>(&Vm::_execSetPktTotalLen);
-    this->_initExecFunc<Instr::Kind::SET_PKT_CONTENT_LEN>(&Vm::_execSetPktContentLen);
-    this->_initExecFunc<Instr::Kind::SET_PKT_MAGIC_NUMBER>(&Vm::_execSetPktMagicNumber);
-    this->_initExecFunc<Instr::Kind::END_PKT_PREAMBLE_PROC>(&Vm::_execEndPktPreambleProc);
-    this->_initExecFunc<Instr::Kind::END_DS_PKT_PREAMBLE_PROC>(&Vm::_execEndDsPktPreambleProc);
-    this->_initExecFunc<Instr::Kind::END_DS_ER_PREAMBLE_PROC>(&Vm::_execEndDsErPreambleProc);
-    this->_initExecFunc<Instr::Kind::END_ER_PROC>(&Vm::_execEndErProc);
-    this->_initExecFunc<Instr::Kind::SET_DS_INFO>(&Vm::_execSetDsInfo);
-    this->_initExecFunc<Instr::Kind::SET_PKT_INFO>(&Vm::_execSetPktInfo);
-    this->_initExecFunc<Instr::Kind::SET_ER_INFO>(&Vm::_execSetErInfo);
+#define _YACTFR_VM_INIT_EXEC_FUNC(_kind, _func) \
+    this->_initExecFunc<Instr::Kind::_kind>(&Vm::_func);
+
+    _YACTFR_VM_INSTR_HANDLERS(_YACTFR_VM_INIT_EXEC_FUNC, _YACTFR_VM_IGNORE)
+
+#undef _YACTFR_VM_INIT_EXEC_FUNC
 }
 
 void Vm::seekPkt(const Index offsetBytes)
@@ -370,6 +692,371 @@ void Vm::restorePos(const ElementSequenceIteratorPosition& pos)
     this->_resetBuffer();
 }
 
+/*
+ * Returns the stack size when the innermost frame of which the
+ * procedure ends with an instruction having the kind `endInstrKind` is
+ * the top frame, or 0 if there's no such frame.
+ */
+Size Vm::_innermostFrameStackSize(const Instr::Kind endInstrKind) const noexcept
+{
+    for (auto stackSize = _pos.stack.size(); stackSize > 0; --stackSize) {
+        const auto& frame = _pos.stack[stackSize - 1];
+
+        if (frame.proc && !frame.proc->empty() && frame.proc->back()->kind() == endInstrKind) {
+            return stackSize;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Executes the VM until the current element of the iterator is an
+ * element having the kind `endElemKind` and the stack size is
+ * `stackSize` after having emitted it, or until the end of the element
+ * sequence.
+ *
+ * This doesn't return to the user between the skipped elements, and
+ * jumps over the data having a static layout when possible.
+ */
+void Vm::_skipUntilEndElem(const Element::Kind endElemKind, const Size stackSize)
+{
+    // the VM doesn't make the skipped elements current
+    auto elem = _it->_curElem;
+
+    while (true) {
+        assert(elem);
+
+        if (elem->isStructureBeginningElement() || elem->isScopeBeginningElement()) {
+            this->_tryJumpToCurProcEnd();
+        }
+
+        if (this->_tryJumpOverNextInstr()) {
+            continue;
+        }
+
+        this->_nextElemOnce();
+
+        if (_it->_offset == ElementSequenceIterator::_END_OFFSET) {
+            return;
+        }
+
+        elem = _lastElem;
+        assert(elem);
+
+        if (elem->kind() == endElemKind && _pos.stack.size() == stackSize) {
+            // the user might not want this element
+            this->_nextVisibleElem();
+            return;
+        }
+    }
+}
+
+/*
+ * Like _skipUntilEndElem(), but while the VM emits the kept elements
+ * of the current event record (see _stateEmitPendingErElem()), of
+ * which the frames don't exist anymore.
+ *
+ * Stops at the first element having the kind `endElemKind` which
+ * doesn't match a following element having the kind `begElemKind`.
+ */
+void Vm::_skipPendingErElemsUntilEndElem(const Element::Kind begElemKind,
+                                         const Element::Kind endElemKind)
+{
+    Size level = 0;
+
+    while (true) {
+        this->_nextElemOnce();
+        assert(_lastElem);
+
+        if (_lastElem->kind() == begElemKind) {
+            ++level;
+        } else if (_lastElem->kind() == endElemKind) {
+            if (level == 0) {
+                // the user might not want this element
+                this->_nextVisibleElem();
+                return;
+            }
+
+            --level;
+        }
+    }
+}
+
+/*
+ * Returns the static layout of the instruction `instr` if the VM may
+ * jump over its data, or `nullptr` otherwise.
+ *
+ * The VM may jump over the data of a "begin read structure", "begin
+ * read static-length array", "begin read static-length string", "begin
+ * read static-length BLOB", or "begin read scope" instruction having a
+ * static layout of which the data starts and ends on a byte boundary:
+ * this makes it possible to ignore the byte order of the last
+ * fixed-length bit array.
+ */
+const StaticLayout *Vm::_jumpableStaticLayout(const Instr& instr) const noexcept
+{
+    const boost::optional<StaticLayout> *layout;
+    unsigned int align;
+
+    switch (instr.kind()) {
+    case Instr::Kind::BEGIN_READ_STRUCT:
+    case Instr::Kind::BEGIN_READ_SL_ARRAY:
+    case Instr::Kind::BEGIN_READ_SL_STR:
+    case Instr::Kind::BEGIN_READ_SL_BLOB:
+    {
+        auto& readDataInstr = static_cast<const ReadDataInstr&>(instr);
+
+        layout = &readDataInstr.staticLayout();
+        align = readDataInstr.align();
+        break;
+    }
+
+    case Instr::Kind::BEGIN_READ_SCOPE:
+    {
+        auto& beginReadScopeInstr = static_cast<const BeginReadScopeInstr&>(instr);
+
+        layout = &beginReadScopeInstr.staticLayout();
+        align = beginReadScopeInstr.align();
+        break;
+    }
+
+    default:
+        return nullptr;
+    }
+
+    if (!*layout || (align & 7) != 0 || ((*layout)->len & 7) != 0) {
+        return nullptr;
+    }
+
+    return &**layout;
+}
+
+/*
+ * Skips the `layout.len` next bits of packet content at once and
+ * updates the mark of the iterator as if the VM had emitted the
+ * elements of `layout`, which counts a single section per string,
+ * BLOB, or array as _emitSectionElem() does.
+ */
+void Vm::_jumpOverStaticLayout(const StaticLayout& layout)
+{
+    assert(layout.len <= _pos.remContentBitsInPkt());
+
+    if (_opts->arraySectionsEnabled()) {
+        _it->_mark += layout.elemCountWithArraySections;
+    } else {
+        _it->_mark += layout.elemCount;
+    }
+
+    _pos.remBitsToSkip = layout.len;
+    _pos.nextState = _pos.state();
+    _pos.state(VmState::CONTINUE_SKIP_CONTENT_PADDING_BITS);
+    this->_continueSkipPaddingBits(true);
+}
+
+/*
+ * Returns whether or not the data projection of this VM hides all the
+ * elements of the data which the instruction `instr` reads.
+ */
+bool Vm::_isInstrDataProjHidden(const Instr& instr) const noexcept
+{
+    return _dataProj && _dataProj->instrVisibility(instr).isHidden;
+}
+
+/*
+ * If the next instruction to execute has a jumpable static layout (see
+ * _jumpableStaticLayout()), and, if `onlyDataProjHidden` is true, the
+ * data projection of this VM hides all its elements, then jumps over
+ * its data without emitting any element and returns `true`.
+ *
+ * Otherwise, returns `false`: the caller must execute the VM normally.
+ */
+bool Vm::_tryJumpOverNextInstr(const bool onlyDataProjHidden)
+{
+    if (_pos.stack.empty()) {
+        return false;
+    }
+
+    auto& stackTop = _pos.stackTop();
+
+    if (_pos.state() == VmState::EXEC_ARRAY_INSTR) {
+        if (stackTop.rem == 0) {
+            return false;
+        }
+
+        if (stackTop.it == stackTop.proc->end()) {
+            if (stackTop.rem == 1) {
+                // last item: the VM pops the array frame
+                return false;
+            }
+
+            // next item (same as _stateExecArrayInstr())
+            --stackTop.rem;
+            stackTop.it = stackTop.proc->begin();
+        }
+    } else if (_pos.state() != VmState::EXEC_INSTR || stackTop.it == stackTop.proc->end()) {
+        return false;
+    }
+
+    const auto& instr = **stackTop.it;
+    const auto layout = this->_jumpableStaticLayout(instr);
+
+    if (!layout || (onlyDataProjHidden && !this->_isInstrDataProjHidden(instr))) {
+        return false;
+    }
+
+    if (instr.kind() == Instr::Kind::BEGIN_READ_SCOPE) {
+        this->_alignHead(static_cast<const BeginReadScopeInstr&>(instr).align());
+    } else {
+        this->_alignHead(instr);
+    }
+
+    if (layout->len > _pos.remContentBitsInPkt()) {
+        // let the VM report the decoding error
+        return false;
+    }
+
+    _pos.gotoNextInstr();
+    this->_jumpOverStaticLayout(*layout);
+    return true;
+}
+
+/*
+ * If the current element of the iterator is the beginning of a
+ * structure or scope of which the instruction has a jumpable static
+ * layout (see _jumpableStaticLayout()), then jumps to the last
+ * instruction of its procedure (the "end read structure" or "end read
+ * scope" one).
+ *
+ * Otherwise, doesn't do anything.
+ */
+void Vm::_tryJumpToCurProcEnd()
+{
+    if (_pos.stack.size() < 2) {
+        return;
+    }
+
+    auto& stackTop = _pos.stackTop();
+
+    if (!stackTop.proc || stackTop.it != stackTop.proc->begin()) {
+        return;
+    }
+
+    /*
+     * The VM advances the parent frame before pushing the frame of a
+     * structure or scope.
+     */
+    const auto& parentFrame = _pos.stack[_pos.stack.size() - 2];
+    const auto layout = this->_jumpableStaticLayout(**(parentFrame.it - 1));
+
+    if (!layout || layout->len > _pos.remContentBitsInPkt()) {
+        return;
+    }
+
+    /*
+     * `*layout` counts the beginning element, which the VM already
+     * emitted, and the end element, which the VM is about to emit.
+     */
+    auto innerLayout = *layout;
+
+    innerLayout.elemCount -= 2;
+    innerLayout.elemCountWithArraySections -= 2;
+    stackTop.it = stackTop.proc->end() - 1;
+    this->_jumpOverStaticLayout(innerLayout);
+}
+
+void Vm::skipCurScope()
+{
+    assert(_it->_curElem);
+
+    if (_it->_curElem->isScopeEndElement()) {
+        // already there
+        return;
+    }
+
+    if (_pos.state() == VmState::EMIT_PENDING_ER_ELEM) {
+        this->_skipPendingErElemsUntilEndElem(Element::Kind::SCOPE_BEGINNING,
+                                              Element::Kind::SCOPE_END);
+        return;
+    }
+
+    const auto stackSize = this->_innermostFrameStackSize(Instr::Kind::END_READ_SCOPE);
+
+    // an "end read scope" instruction pops the scope frame
+    assert(stackSize > 0);
+
+    this->_skipUntilEndElem(Element::Kind::SCOPE_END, stackSize - 1);
+}
+
+void Vm::skipCurStruct()
+{
+    assert(_it->_curElem);
+
+    if (_it->_curElem->isStructureEndElement()) {
+        // already there
+        return;
+    }
+
+    if (_pos.state() == VmState::EMIT_PENDING_ER_ELEM) {
+        this->_skipPendingErElemsUntilEndElem(Element::Kind::STRUCTURE_BEGINNING,
+                                              Element::Kind::STRUCTURE_END);
+        return;
+    }
+
+    const auto stackSize = this->_innermostFrameStackSize(Instr::Kind::END_READ_STRUCT);
+
+    // an "end read structure" instruction pops the structure frame
+    assert(stackSize > 0);
+
+    this->_skipUntilEndElem(Element::Kind::STRUCTURE_END, stackSize - 1);
+}
+
+void Vm::skipToErEnd()
+{
+    assert(_it->_curElem);
+
+    if (_it->_curElem->isEventRecordEndElement()) {
+        // already there
+        return;
+    }
+
+    // the stack is empty when the VM emits an event record end element
+    this->_skipUntilEndElem(Element::Kind::EVENT_RECORD_END, 0);
+}
+
+void Vm::nextBatch(ElementBatch& batch, const Size maxCount)
+{
+    assert(_it->_curElem);
+    assert(maxCount >= 1);
+
+    // current element of the iterator
+    batch._append(*_it->_curElem, _it->_offset);
+
+    /*
+     * _emitElem() appends the records of the next visible elements as
+     * it emits them, the last one being the current element of the
+     * iterator when this loop ends.
+     */
+    _batch = &batch;
+
+    try {
+        while (batch.size() < maxCount &&
+                _it->_offset != ElementSequenceIterator::_END_OFFSET) {
+            this->nextElem();
+        }
+    } catch (...) {
+        _batch = nullptr;
+        throw;
+    }
+
+    _batch = nullptr;
+
+    // go to the element following the last record
+    if (_it->_offset != ElementSequenceIterator::_END_OFFSET) {
+        this->nextElem();
+    }
+}
+
 Vm::_ExecReaction Vm::_execReadFlBitArrayLe(const Instr& instr)
 {
     this->_execReadFlBitArray<readFlUIntLeFuncs>(instr);
@@ -767,12 +1454,177 @@ Vm::_ExecReaction Vm::_execReadNtStr(const Instr& instr)
     this->_alignHead(instr);
     this->_setDataElemFromInstr(_pos.elems.ntStrBeginning, instr);
     this->_setDataElemFromInstr(_pos.elems.ntStrEnd, instr);
-    this->_updateItForUser(_pos.elems.ntStrBeginning);
+    this->_emitInstrElem(_pos.elems.ntStrBeginning, instr);
+    _pos.isNextSectionFirst = true;
     _pos.nextState = _pos.state();
     _pos.state(VmState::READ_SUBSTR_UNTIL_NULL);
     return _ExecReaction::FETCH_NEXT_INSTR_AND_STOP;
 }
 
+/*
+ * Reads the value of the standard fixed-length integer which the
+ * instruction `instr` reads from `buf`, returning signed values as
+ * their two's complement.
+ */
+static std::uint64_t readStdFlIntRunMemberVal(const Instr& instr,
+                                              const std::uint8_t * const buf) noexcept
+{
+    switch (instr.kind()) {
+    case Instr::Kind::READ_FL_SINT_A8:
+    case Instr::Kind::READ_FL_SENUM_A8:
+        return static_cast<std::uint64_t>(readFlSInt8(buf));
+
+    case Instr::Kind::READ_FL_SINT_A16_LE:
+    case Instr::Kind::READ_FL_SENUM_A16_LE:
+        return static_cast<std::uint64_t>(readFlSIntLe16(buf));
+
+    case Instr::Kind::READ_FL_SINT_A32_LE:
+    case Instr::Kind::READ_FL_SENUM_A32_LE:
+        return static_cast<std::uint64_t>(readFlSIntLe32(buf));
+
+    case Instr::Kind::READ_FL_SINT_A64_LE:
+    case Instr::Kind::READ_FL_SENUM_A64_LE:
+        return static_cast<std::uint64_t>(readFlSIntLe64(buf));
+
+    case Instr::Kind::READ_FL_SINT_A16_BE:
+    case Instr::Kind::READ_FL_SENUM_A16_BE:
+        return static_cast<std::uint64_t>(readFlSIntBe16(buf));
+
+    case Instr::Kind::READ_FL_SINT_A32_BE:
+    case Instr::Kind::READ_FL_SENUM_A32_BE:
+        return static_cast<std::uint64_t>(readFlSIntBe32(buf));
+
+    case Instr::Kind::READ_FL_SINT_A64_BE:
+    case Instr::Kind::READ_FL_SENUM_A64_BE:
+        return static_cast<std::uint64_t>(readFlSIntBe64(buf));
+
+    case Instr::Kind::READ_FL_UINT_A8:
+    case Instr::Kind::READ_FL_UENUM_A8:
+        return readFlUInt8(buf);
+
+    case Instr::Kind::READ_FL_UINT_A16_LE:
+    case Instr::Kind::READ_FL_UENUM_A16_LE:
+        return readFlUIntLe16(buf);
+
+    case Instr::Kind::READ_FL_UINT_A32_LE:
+    case Instr::Kind::READ_FL_UENUM_A32_LE:
+        return readFlUIntLe32(buf);
+
+    case Instr::Kind::READ_FL_UINT_A64_LE:
+    case Instr::Kind::READ_FL_UENUM_A64_LE:
+        return readFlUIntLe64(buf);
+
+    case Instr::Kind::READ_FL_UINT_A16_BE:
+    case Instr::Kind::READ_FL_UENUM_A16_BE:
+        return readFlUIntBe16(buf);
+
+    case Instr::Kind::READ_FL_UINT_A32_BE:
+    case Instr::Kind::READ_FL_UENUM_A32_BE:
+        return readFlUIntBe32(buf);
+
+    case Instr::Kind::READ_FL_UINT_A64_BE:
+    case Instr::Kind::READ_FL_UENUM_A64_BE:
+        return readFlUIntBe64(buf);
+
+    default:
+        std::abort();
+    }
+}
+
+/*
+ * Decodes all the members of the run `instr`, which the buffer
+ * contains from the current head, to `_pos.curStdFlIntRunVals`.
+ */
+void Vm::_decodeStdFlIntRun(const ReadStdFlIntRunInstr& instr) noexcept
+{
+    assert(instr.len() <= this->_remBitsInBuf());
+
+    const auto buf = this->_bufAtHead();
+    Size offsetBits = 0;
+    auto valIt = _pos.curStdFlIntRunVals.begin();
+
+    for (auto& member : instr.members()) {
+        offsetBits += member.padding;
+        *valIt = readStdFlIntRunMemberVal(*member.instr, &buf[offsetBits / 8]);
+        offsetBits += member.len;
+        ++valIt;
+    }
+}
+
+/*
+ * Emits the element of the member `member` of the current run, of which
+ * the decoded value is `val`, as its original instruction would.
+ */
+void Vm::_emitDecodedStdFlIntRunMember(const ReadStdFlIntRunInstr::Member& member,
+                                       const std::uint64_t val) noexcept
+{
+    auto& instr = *member.instr;
+
+    this->_consumeDecodedBits(member.padding);
+    _pos.lastFlBitArrayBo = instr.bo();
+
+    if (member.isEnum) {
+        if (member.isSigned) {
+            this->_setFlEnumElem(static_cast<std::int64_t>(val), instr);
+        } else {
+            this->_setFlEnumElem(val, instr);
+        }
+    } else {
+        if (member.isSigned) {
+            this->_setFlIntElem(static_cast<std::int64_t>(val), instr);
+        } else {
+            this->_setFlIntElem(val, instr);
+        }
+    }
+
+    this->_consumeDecodedBits(member.len);
+}
+
+Vm::_ExecReaction Vm::_execReadStdFlIntRun(const Instr& instr)
+{
+    auto& runInstr = static_cast<const ReadStdFlIntRunInstr&>(instr);
+    auto& members = runInstr.members();
+
+    if (_pos.curStdFlIntRunMemberIndex == 0) {
+        // align once and check the packet content bounds once
+        this->_alignHead(runInstr.align());
+        _pos.curStdFlIntRunIsDecoded = false;
+
+        if (runInstr.len() <= _pos.remContentBitsInPkt() &&
+                runInstr.len() <= this->_remBitsInBuf()) {
+            // decode all the members at once
+            this->_decodeStdFlIntRun(runInstr);
+            _pos.curStdFlIntRunIsDecoded = true;
+        }
+    }
+
+    const auto index = _pos.curStdFlIntRunMemberIndex;
+
+    assert(index < members.size());
+
+    if (_pos.curStdFlIntRunIsDecoded) {
+        this->_emitDecodedStdFlIntRunMember(members[index], _pos.curStdFlIntRunVals[index]);
+    } else {
+        /*
+         * The current data block doesn't contain the whole run, or the
+         * run goes beyond the packet content: execute the original
+         * instruction to get the exact same data requests, and the
+         * exact same decoding error at the exact same offset.
+         */
+        this->_exec(*members[index].instr);
+    }
+
+    if (index + 1 == members.size()) {
+        // run is complete
+        _pos.curStdFlIntRunMemberIndex = 0;
+        return _ExecReaction::FETCH_NEXT_INSTR_AND_STOP;
+    }
+
+    // execute this instruction again for the next member
+    _pos.curStdFlIntRunMemberIndex = index + 1;
+    return _ExecReaction::STOP;
+}
+
 Vm::_ExecReaction Vm::_execBeginReadScope(const Instr& instr)
 {
     const auto& beginReadScopeInstr = static_cast<const BeginReadScopeInstr&>(instr);
@@ -781,7 +1633,7 @@ Vm::_ExecReaction Vm::_execBeginReadScope(const Instr& instr)
     this->_alignHead(beginReadScopeInstr.align());
 
     _pos.elems.scopeBeginning._scope = beginReadScopeInstr.scope();
-    this->_updateItForUser(_pos.elems.scopeBeginning);
+    this->_emitInstrElem(_pos.elems.scopeBeginning, instr);
     _pos.gotoNextInstr();
     _pos.stackPush(&beginReadScopeInstr.proc());
     return _ExecReaction::STOP;
@@ -790,7 +1642,7 @@ Vm::_ExecReaction Vm::_execBeginReadScope(const Instr& instr)
 Vm::_ExecReaction Vm::_execEndReadScope(const Instr& instr)
 {
     _pos.elems.scopeEnd._scope = static_cast<const EndReadScopeInstr&>(instr).scope();
-    this->_updateItForUser(_pos.elems.scopeEnd);
+    this->_emitInstrElem(_pos.elems.scopeEnd, instr);
     _pos.stackPop();
     assert(_pos.state() == VmState::EXEC_INSTR);
     return _ExecReaction::STOP;
@@ -802,7 +1654,7 @@ Vm::_ExecReaction Vm::_execBeginReadStruct(const Instr& instr)
 
     this->_alignHead(instr);
     this->_setDataElemFromInstr(_pos.elems.structBeginning, instr);
-    this->_updateItForUser(_pos.elems.structBeginning);
+    this->_emitInstrElem(_pos.elems.structBeginning, instr);
     _pos.gotoNextInstr();
     _pos.stackPush(&beginReadStructInstr.proc());
     _pos.state(VmState::EXEC_INSTR);
@@ -812,20 +1664,22 @@ Vm::_ExecReaction Vm::_execBeginReadStruct(const Instr& instr)
 Vm::_ExecReaction Vm::_execEndReadStruct(const Instr& instr)
 {
     this->_setDataElemFromInstr(_pos.elems.structEnd, instr);
-    this->_updateItForUser(_pos.elems.structEnd);
+    this->_emitInstrElem(_pos.elems.structEnd, instr);
     _pos.setParentStateAndStackPop();
     return _ExecReaction::STOP;
 }
 
 Vm::_ExecReaction Vm::_execBeginReadSlArray(const Instr& instr)
 {
-    return this->_execBeginReadSlArray(instr, VmState::EXEC_ARRAY_INSTR);
+    const auto& beginReadSlArrayInstr = static_cast<const BeginReadSlArrayInstr&>(instr);
+
+    return this->_execBeginReadSlArray(instr, this->_arrayItemsState(beginReadSlArrayInstr));
 }
 
 Vm::_ExecReaction Vm::_execEndReadSlArray(const Instr& instr)
 {
     this->_setDataElemFromInstr(_pos.elems.slArrayEnd, instr);
-    this->_updateItForUser(_pos.elems.slArrayEnd);
+    this->_emitInstrElem(_pos.elems.slArrayEnd, instr);
     return _ExecReaction::FETCH_NEXT_INSTR_AND_STOP;
 }
 
@@ -842,7 +1696,7 @@ Vm::_ExecReaction Vm::_execBeginReadSlStr(const Instr& instr)
 Vm::_ExecReaction Vm::_execEndReadSlStr(const Instr& instr)
 {
     this->_setDataElemFromInstr(_pos.elems.slStrEnd, instr);
-    this->_updateItForUser(_pos.elems.slStrEnd);
+    this->_emitInstrElem(_pos.elems.slStrEnd, instr);
     return _ExecReaction::FETCH_NEXT_INSTR_AND_STOP;
 }
 
@@ -857,14 +1711,15 @@ Vm::_ExecReaction Vm::_execBeginReadDlArray(const Instr& instr)
 
     this->_execBeginReadDynData(beginReadDlArrayInstr, _pos.elems.dlArrayBeginning,
                                 beginReadDlArrayInstr.lenPos(), _pos.elems.dlArrayBeginning._len,
-                                &beginReadDlArrayInstr.proc(), VmState::EXEC_ARRAY_INSTR);
+                                &beginReadDlArrayInstr.proc(),
+                                this->_arrayItemsState(beginReadDlArrayInstr));
     return _ExecReaction::STOP;
 }
 
 Vm::_ExecReaction Vm::_execEndReadDlArray(const Instr& instr)
 {
     this->_setDataElemFromInstr(_pos.elems.dlArrayEnd, instr);
-    this->_updateItForUser(_pos.elems.dlArrayEnd);
+    this->_emitInstrElem(_pos.elems.dlArrayEnd, instr);
     return _ExecReaction::FETCH_NEXT_INSTR_AND_STOP;
 }
 
@@ -881,7 +1736,7 @@ Vm::_ExecReaction Vm::_execBeginReadDlStr(const Instr& instr)
 Vm::_ExecReaction Vm::_execEndReadDlStr(const Instr& instr)
 {
     this->_setDataElemFromInstr(_pos.elems.dlStrEnd, instr);
-    this->_updateItForUser(_pos.elems.dlStrEnd);
+    this->_emitInstrElem(_pos.elems.dlStrEnd, instr);
     return _ExecReaction::FETCH_NEXT_INSTR_AND_STOP;
 }
 
@@ -898,7 +1753,7 @@ Vm::_ExecReaction Vm::_execBeginReadSlUuidBlob(const Instr& instr)
 Vm::_ExecReaction Vm::_execEndReadSlBlob(const Instr& instr)
 {
     this->_setDataElemFromInstr(_pos.elems.slBlobEnd, instr);
-    this->_updateItForUser(_pos.elems.slBlobEnd);
+    this->_emitInstrElem(_pos.elems.slBlobEnd, instr);
     return _ExecReaction::FETCH_NEXT_INSTR_AND_STOP;
 }
 
@@ -915,7 +1770,7 @@ Vm::_ExecReaction Vm::_execBeginReadDlBlob(const Instr& instr)
 Vm::_ExecReaction Vm::_execEndReadDlBlob(const Instr& instr)
 {
     this->_setDataElemFromInstr(_pos.elems.dlBlobEnd, instr);
-    this->_updateItForUser(_pos.elems.dlBlobEnd);
+    this->_emitInstrElem(_pos.elems.dlBlobEnd, instr);
     return _ExecReaction::FETCH_NEXT_INSTR_AND_STOP;
 }
 
@@ -959,7 +1814,7 @@ Vm::_ExecReaction Vm::_execBeginReadOptUIntSel(const Instr& instr)
 Vm::_ExecReaction Vm::_execEndReadVarUIntSel(const Instr& instr)
 {
     this->_setDataElemFromInstr(_pos.elems.varUIntSelEnd, instr);
-    this->_updateItForUser(_pos.elems.varUIntSelEnd);
+    this->_emitInstrElem(_pos.elems.varUIntSelEnd, instr);
     _pos.setParentStateAndStackPop();
     return _ExecReaction::STOP;
 }
@@ -967,7 +1822,7 @@ Vm::_ExecReaction Vm::_execEndReadVarUIntSel(const Instr& instr)
 Vm::_ExecReaction Vm::_execEndReadVarSIntSel(const Instr& instr)
 {
     this->_setDataElemFromInstr(_pos.elems.varSIntSelEnd, instr);
-    this->_updateItForUser(_pos.elems.varSIntSelEnd);
+    this->_emitInstrElem(_pos.elems.varSIntSelEnd, instr);
     _pos.setParentStateAndStackPop();
     return _ExecReaction::STOP;
 }
@@ -975,7 +1830,7 @@ Vm::_ExecReaction Vm::_execEndReadVarSIntSel(const Instr& instr)
 Vm::_ExecReaction Vm::_execEndReadOptBoolSel(const Instr& instr)
 {
     this->_setDataElemFromInstr(_pos.elems.optBoolSelEnd, instr);
-    this->_updateItForUser(_pos.elems.optBoolSelEnd);
+    this->_emitInstrElem(_pos.elems.optBoolSelEnd, instr);
     _pos.setParentStateAndStackPop();
     return _ExecReaction::STOP;
 }
@@ -983,7 +1838,7 @@ Vm::_ExecReaction Vm::_execEndReadOptBoolSel(const Instr& instr)
 Vm::_ExecReaction Vm::_execEndReadOptUIntSel(const Instr& instr)
 {
     this->_setDataElemFromInstr(_pos.elems.optUIntSelEnd, instr);
-    this->_updateItForUser(_pos.elems.optUIntSelEnd);
+    this->_emitInstrElem(_pos.elems.optUIntSelEnd, instr);
     _pos.setParentStateAndStackPop();
     return _ExecReaction::STOP;
 }
@@ -991,7 +1846,7 @@ Vm::_ExecReaction Vm::_execEndReadOptUIntSel(const Instr& instr)
 Vm::_ExecReaction Vm::_execEndReadOptSIntSel(const Instr& instr)
 {
     this->_setDataElemFromInstr(_pos.elems.optSIntSelEnd, instr);
-    this->_updateItForUser(_pos.elems.optSIntSelEnd);
+    this->_emitInstrElem(_pos.elems.optSIntSelEnd, instr);
     _pos.setParentStateAndStackPop();
     return _ExecReaction::STOP;
 }
@@ -1064,6 +1919,30 @@ Vm::_ExecReaction Vm::_execSetErt(const Instr& instr)
 
     _pos.curErProc = erProc;
     _pos.elems.erInfo._ert = &erProc->ert();
+
+    if (_pos.erFilterState == VmErFilterState::PENDING) {
+        if (!_opts->eventRecordTypeFilter()(erProc->ert())) {
+            // decode the rest of this event record without showing it
+            _pos.erFilterState = VmErFilterState::DISCARDED;
+            _pos.pendingErElems.clear();
+            return _ExecReaction::EXEC_NEXT_INSTR;
+        }
+
+        /*
+         * Selected event record: emit the elements which the VM kept
+         * so far (see _stateEmitPendingErElem()), then continue with
+         * the next instruction.
+         *
+         * This doesn't decode anything again, therefore the data
+         * source only needs to provide increasing offsets.
+         */
+        _pos.erFilterState = VmErFilterState::NONE;
+        _pos.nextPendingErElemIndex = 0;
+        _pos.gotoNextInstr();
+        _pos.state(VmState::EMIT_PENDING_ER_ELEM);
+        return _ExecReaction::CHANGE_STATE;
+    }
+
     return _ExecReaction::EXEC_NEXT_INSTR;
 }
 
@@ -1151,7 +2030,7 @@ Vm::_ExecReaction Vm::_execSetPktContentLen(const Instr&)
 
 Vm::_ExecReaction Vm::_execSetDsInfo(const Instr&)
 {
-    this->_updateItForUser(_pos.elems.dsInfo);
+    this->_emitElem(_pos.elems.dsInfo);
     return _ExecReaction::FETCH_NEXT_INSTR_AND_STOP;
 }
 
@@ -1167,20 +2046,20 @@ Vm::_ExecReaction Vm::_execSetPktInfo(const Instr&)
     if (_pos.curExpectedPktContentLenBits != SIZE_MAX) {
         _pos.elems.pktInfo._expectedContentLen = _pos.curExpectedPktContentLenBits;
     }
-    this->_updateItForUser(_pos.elems.pktInfo);
+    this->_emitElem(_pos.elems.pktInfo);
     return _ExecReaction::FETCH_NEXT_INSTR_AND_STOP;
 }
 
 Vm::_ExecReaction Vm::_execSetErInfo(const Instr&)
 {
-    this->_updateItForUser(_pos.elems.erInfo);
+    this->_emitElem(_pos.elems.erInfo);
     return _ExecReaction::FETCH_NEXT_INSTR_AND_STOP;
 }
 
 Vm::_ExecReaction Vm::_execSetPktMagicNumber(const Instr&)
 {
     _pos.elems.pktMagicNumber._val = _pos.lastIntVal.u;
-    this->_updateItForUser(_pos.elems.pktMagicNumber);
+    this->_emitElem(_pos.elems.pktMagicNumber);
     return _ExecReaction::FETCH_NEXT_INSTR_AND_STOP;
 }
 
@@ -1234,5 +2113,274 @@ Vm::_ExecReaction Vm::_execEndErProc(const Instr&)
     return _ExecReaction::CHANGE_STATE;
 }
 
+#ifdef YACTFR_VM_DIRECT_THREADED
+
+/*
+ * VM state to state handler mapping, in `VmState` order.
+ *
+ * `_x` is a macro taking a VM state name and an expression which
+ * handles this state, returning `true` if an element is ready for the
+ * iterator.
+ *
+ * `_xInstr` is a macro taking the name of a VM state which the threaded
+ * interpreter handles itself (`EXEC_INSTR` and `EXEC_ARRAY_INSTR`).
+ */
+#define _YACTFR_VM_STATE_HANDLERS(_x, _xInstr) \
+    _x(BEGIN_PKT, this->_stateBeginPkt()) \
+    _x(BEGIN_PKT_CONTENT, this->_stateBeginPktContent()) \
+    _x(END_PKT_CONTENT, this->_stateEndPktContent()) \
+    _x(END_PKT, this->_stateEndPkt()) \
+    _x(BEGIN_ER, this->_stateBeginEr()) \
+    _x(END_ER, this->_stateEndEr()) \
+    _x(EMIT_PENDING_ER_ELEM, this->_stateEmitPendingErElem()) \
+    _xInstr(EXEC_INSTR) \
+    _xInstr(EXEC_ARRAY_INSTR) \
+    _x(READ_UUID_BYTE, this->_stateReadUuidByte()) \
+    _x(READ_SUBSTR_UNTIL_NULL, this->_stateReadSubstrUntilNull()) \
+    _x(READ_SUBSTR, this->_stateReadSubstr()) \
+    _x(READ_BLOB_SECTION, this->_stateReadBlobSection()) \
+    _x(READ_UUID_BLOB_SECTION, this->_stateReadUuidBlobSection()) \
+    _x(READ_ARRAY_SECTION, this->_stateReadArraySection()) \
+    _x(CONTINUE_READ_VL_UINT, this->_stateContinueReadVlInt<false>()) \
+    _x(CONTINUE_READ_VL_SINT, this->_stateContinueReadVlInt<true>()) \
+    _x(END_STR, this->_stateEndStr()) \
+    _x(SET_METADATA_STREAM_UUID, this->_stateSetMetadataStreamUuid()) \
+    _x(CONTINUE_SKIP_PADDING_BITS, this->_stateContinueSkipPaddingBits()) \
+    _x(CONTINUE_SKIP_CONTENT_PADDING_BITS, this->_stateContinueSkipPaddingBits())
+
+/*
+ * Checks that `vals` contains all the enumerators from 0 to `LenV - 1`,
+ * in order.
+ */
+template <typename EnumT, std::size_t LenV>
+static constexpr bool isEnumOrdered(const EnumT (&vals)[LenV]) noexcept
+{
+    for (std::size_t i = 0; i < LenV; ++i) {
+        if (static_cast<std::size_t>(vals[i]) != i) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+#define _YACTFR_VM_STATE(_state, _expr) VmState::_state,
+#define _YACTFR_VM_INSTR_STATE(_state) VmState::_state,
+
+static constexpr VmState vmStates[] = {
+    _YACTFR_VM_STATE_HANDLERS(_YACTFR_VM_STATE, _YACTFR_VM_INSTR_STATE)
+};
+
+#undef _YACTFR_VM_STATE
+#undef _YACTFR_VM_INSTR_STATE
+
+#define _YACTFR_VM_INSTR_KIND(_kind, _func) Instr::Kind::_kind,
+#define _YACTFR_VM_NONE_INSTR_KIND(_kind) Instr::Kind::_kind,
+
+static constexpr Instr::Kind instrKinds[] = {
+    _YACTFR_VM_INSTR_HANDLERS(_YACTFR_VM_INSTR_KIND, _YACTFR_VM_NONE_INSTR_KIND)
+};
+
+#undef _YACTFR_VM_INSTR_KIND
+#undef _YACTFR_VM_NONE_INSTR_KIND
+
+static_assert(isEnumOrdered(vmStates) &&
+              std::extent<decltype(vmStates)>::value ==
+              static_cast<std::size_t>(VmState::CONTINUE_SKIP_CONTENT_PADDING_BITS) + 1,
+              "State handler mapping contains all the VM states in order.");
+static_assert(isEnumOrdered(instrKinds) &&
+              std::extent<decltype(instrKinds)>::value ==
+              static_cast<std::size_t>(Instr::Kind::UPDATE_DEF_CLK_VAL_FL) + 1,
+              "Instruction handler mapping contains all the instruction kinds in order.");
+
+/*
+ * Direct-threaded version of nextElem().
+ *
+ * VM states and instruction kinds share a single label space: each
+ * state handler and each instruction handler jumps directly to the
+ * label of what comes next instead of returning to a central dispatch
+ * loop. Instruction handlers are called directly (not through
+ * `_execFuncs`) so that the compiler may inline them.
+ *
+ * With labels as values (GCC and Clang), the dispatch is an indirect
+ * jump through the static `stateLabels` or `instrLabels` table, which
+ * the state and instruction handler mappings index in enumerator order.
+ *
+ * Without labels as values, the dispatch is a `switch` statement which
+ * jumps to the same labels.
+ */
+void Vm::_nextElemThreaded()
+{
+#ifdef YACTFR_VM_HAVE_LABELS_AS_VALUES
+# define _YACTFR_VM_STATE_LABEL_ADDR(_state, _expr) &&state_##_state,
+# define _YACTFR_VM_INSTR_STATE_LABEL_ADDR(_state) &&state_##_state,
+# define _YACTFR_VM_INSTR_LABEL_ADDR(_kind, _func) &&instr_##_kind,
+# define _YACTFR_VM_INVALID_INSTR_LABEL_ADDR(_kind) &&invalidInstr,
+
+    // label addresses, indexed by VM state
+    static const void * const stateLabels[] = {
+        _YACTFR_VM_STATE_HANDLERS(_YACTFR_VM_STATE_LABEL_ADDR, _YACTFR_VM_INSTR_STATE_LABEL_ADDR)
+    };
+
+    // label addresses, indexed by instruction kind
+    static const void * const instrLabels[] = {
+        _YACTFR_VM_INSTR_HANDLERS(_YACTFR_VM_INSTR_LABEL_ADDR, _YACTFR_VM_INVALID_INSTR_LABEL_ADDR)
+    };
+
+# undef _YACTFR_VM_STATE_LABEL_ADDR
+# undef _YACTFR_VM_INSTR_STATE_LABEL_ADDR
+# undef _YACTFR_VM_INSTR_LABEL_ADDR
+# undef _YACTFR_VM_INVALID_INSTR_LABEL_ADDR
+
+# define _YACTFR_VM_DISPATCH_STATE() \
+    goto *stateLabels[static_cast<Index>(_pos.state())]
+
+# define _YACTFR_VM_DISPATCH_INSTR() \
+    goto *instrLabels[static_cast<Index>(instr->kind())]
+#else
+# define _YACTFR_VM_DISPATCH_STATE() goto dispatchState
+# define _YACTFR_VM_DISPATCH_INSTR() goto dispatchInstr
+#endif
+
+    const Instr *instr = nullptr;
+    _ExecReaction reaction;
+
+    _YACTFR_VM_DISPATCH_STATE();
+
+#ifndef YACTFR_VM_HAVE_LABELS_AS_VALUES
+dispatchState:
+    switch (_pos.state()) {
+#define _YACTFR_VM_STATE_CASE(_state, _expr) \
+    case VmState::_state: \
+        goto state_##_state;
+
+#define _YACTFR_VM_INSTR_STATE_CASE(_state) \
+    case VmState::_state: \
+        goto state_##_state;
+
+    _YACTFR_VM_STATE_HANDLERS(_YACTFR_VM_STATE_CASE, _YACTFR_VM_INSTR_STATE_CASE)
+
+#undef _YACTFR_VM_STATE_CASE
+#undef _YACTFR_VM_INSTR_STATE_CASE
+
+    default:
+        goto invalidState;
+    }
+
+dispatchInstr:
+    switch (instr->kind()) {
+#define _YACTFR_VM_INSTR_CASE(_kind, _func) \
+    case Instr::Kind::_kind: \
+        goto instr_##_kind;
+
+    _YACTFR_VM_INSTR_HANDLERS(_YACTFR_VM_INSTR_CASE, _YACTFR_VM_IGNORE)
+
+#undef _YACTFR_VM_INSTR_CASE
+
+    default:
+        goto invalidInstr;
+    }
+#endif
+
+state_EXEC_INSTR:
+    instr = &_pos.nextInstr();
+    _YACTFR_VM_DISPATCH_INSTR();
+
+state_EXEC_ARRAY_INSTR:
+    {
+        auto& stackTop = _pos.stackTop();
+
+        if (stackTop.rem == 0) {
+            _pos.setParentStateAndStackPop();
+            _YACTFR_VM_DISPATCH_STATE();
+        }
+
+        if (stackTop.it == stackTop.proc->end()) {
+            --stackTop.rem;
+
+            if (stackTop.rem == 0) {
+                _pos.setParentStateAndStackPop();
+                _YACTFR_VM_DISPATCH_STATE();
+            }
+
+            stackTop.it = stackTop.proc->begin();
+            goto state_EXEC_ARRAY_INSTR;
+        }
+    }
+
+    instr = &_pos.nextInstr();
+    _YACTFR_VM_DISPATCH_INSTR();
+
+    /*
+     * Fast path: when an instruction handler asks for the next
+     * instruction, go back to the current state label (executing
+     * the next instruction of the current procedure or array
+     * element) without going through the reaction switch below.
+     */
+#define _YACTFR_VM_INSTR_LABEL(_kind, _func) \
+instr_##_kind: \
+    reaction = this->_func(*instr); \
+    \
+    if (reaction == _ExecReaction::EXEC_NEXT_INSTR) { \
+        _pos.gotoNextInstr(); \
+        _YACTFR_VM_DISPATCH_STATE(); \
+    } \
+    \
+    goto handleReaction;
+
+    _YACTFR_VM_INSTR_HANDLERS(_YACTFR_VM_INSTR_LABEL, _YACTFR_VM_IGNORE)
+
+#undef _YACTFR_VM_INSTR_LABEL
+
+handleReaction:
+    switch (reaction) {
+    case _ExecReaction::FETCH_NEXT_INSTR_AND_STOP:
+        _pos.gotoNextInstr();
+        return;
+
+    case _ExecReaction::STOP:
+        return;
+
+    case _ExecReaction::EXEC_NEXT_INSTR:
+        _pos.gotoNextInstr();
+        _YACTFR_VM_DISPATCH_STATE();
+
+    case _ExecReaction::EXEC_CUR_INSTR:
+        // the handler loaded a new procedure: execute its first instruction
+        assert(_pos.state() == VmState::EXEC_INSTR);
+        goto state_EXEC_INSTR;
+
+    case _ExecReaction::CHANGE_STATE:
+        // the handler changed the state
+        _YACTFR_VM_DISPATCH_STATE();
+
+    default:
+        std::abort();
+    }
+
+#define _YACTFR_VM_STATE_LABEL(_state, _expr) \
+state_##_state: \
+    if (_expr) { \
+        return; \
+    } \
+    \
+    _YACTFR_VM_DISPATCH_STATE();
+
+    _YACTFR_VM_STATE_HANDLERS(_YACTFR_VM_STATE_LABEL, _YACTFR_VM_IGNORE)
+
+#undef _YACTFR_VM_STATE_LABEL
+
+#ifndef YACTFR_VM_HAVE_LABELS_AS_VALUES
+invalidState:
+#endif
+invalidInstr:
+    std::abort();
+
+#undef _YACTFR_VM_DISPATCH_STATE
+#undef _YACTFR_VM_DISPATCH_INSTR
+}
+
+#endif // YACTFR_VM_DIRECT_THREADED
+
 } // namespace yactfr
 } // namespace internal
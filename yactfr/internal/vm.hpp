@@ -17,23 +17,52 @@
 #include <type_traits>
 #include <cstdint>
 #include <array>
+#include <memory>
 
 #include <yactfr/aliases.hpp>
 #include <yactfr/elem.hpp>
 #include <yactfr/data-src-factory.hpp>
 #include <yactfr/elem.hpp>
 #include <yactfr/elem-seq-it.hpp>
+#include <yactfr/elem-batch.hpp>
+#include <yactfr/elem-seq-opts.hpp>
 #include <yactfr/decoding-errors.hpp>
 
 #include "proc.hpp"
+#include "data-proj.hpp"
 #include "std-fl-int-reader.hpp"
 
 namespace yactfr {
 namespace internal {
 
+/*
+ * The direct-threaded interpreter (see Vm::_nextElemThreaded()) uses
+ * labels as values when the compiler supports them.
+ */
+#if defined(YACTFR_VM_DIRECT_THREADED) && defined(__GNUC__)
+# define YACTFR_VM_HAVE_LABELS_AS_VALUES
+#endif
+
 constexpr auto SIZE_UNSET = std::numeric_limits<Size>::max();
 constexpr auto SAVED_VAL_UNSET = std::numeric_limits<std::uint64_t>::max();
 
+/*
+ * Size of a table indexed with elemKindIndex().
+ *
+ * This is the smallest divisor which maps each element kind to a
+ * distinct index (`vm.cpp` asserts it).
+ */
+constexpr Size ELEM_KIND_TABLE_SIZE = 361;
+
+/*
+ * Returns the index of the element kind `kind` within a table of
+ * `ELEM_KIND_TABLE_SIZE` entries.
+ */
+constexpr Index elemKindIndex(const Element::Kind kind) noexcept
+{
+    return static_cast<Index>(kind) % ELEM_KIND_TABLE_SIZE;
+}
+
 // possible VM states
 enum class VmState {
     BEGIN_PKT,
@@ -42,6 +71,7 @@ enum class VmState {
     END_PKT,
     BEGIN_ER,
     END_ER,
+    EMIT_PENDING_ER_ELEM,
     EXEC_INSTR,
     EXEC_ARRAY_INSTR,
     READ_UUID_BYTE,
@@ -49,6 +79,7 @@ enum class VmState {
     READ_SUBSTR,
     READ_BLOB_SECTION,
     READ_UUID_BLOB_SECTION,
+    READ_ARRAY_SECTION,
     CONTINUE_READ_VL_UINT,
     CONTINUE_READ_VL_SINT,
     END_STR,
@@ -57,6 +88,18 @@ enum class VmState {
     CONTINUE_SKIP_CONTENT_PADDING_BITS,
 };
 
+// event record filtering states
+enum class VmErFilterState {
+    // no filtering or current event record is visible
+    NONE,
+
+    // event record type is unknown: hide and keep elements
+    PENDING,
+
+    // event record isn't selected: hide elements
+    DISCARDED,
+};
+
 // VM stack frame
 struct VmStackFrame final
 {
@@ -99,6 +142,39 @@ struct VmStackFrame final
     Size rem = 0;
 };
 
+/*
+ * Element which the VM emitted while the type of the current event
+ * record was unknown (see `VmErFilterState::PENDING`), to emit again
+ * once the event record is selected.
+ */
+struct VmPendingErElem final
+{
+    /*
+     * Copy of the element.
+     *
+     * Immutable: copies of a VM position share it.
+     */
+    std::shared_ptr<const Element> elem;
+
+    /*
+     * Copy of the data of `*elem` if it's a substring, BLOB section,
+     * or array section element (`*elem` refers to it).
+     */
+    std::shared_ptr<const std::vector<std::uint8_t>> sectionData;
+
+    // offset of the element within its element sequence (bits)
+    Index offset;
+
+    // instruction which emitted the element, if any
+    const Instr *instr;
+
+    // whether or not the data projection of the VM hides the element
+    bool isDataProjHidden;
+
+    // whether or not emitting the element incremented the mark
+    bool incrsMark;
+};
+
 /*
  * This contains the whole state of a yactfr VM _except_ for everything
  * related to data source/buffering.
@@ -236,6 +312,10 @@ public:
         headOffsetInCurPktBits = 0;
         theState = VmState::BEGIN_PKT;
         lastFlBitArrayBo = boost::none;
+        erFilterState = VmErFilterState::NONE;
+        pendingErElems.clear();
+        nextPendingErElemIndex = 0;
+        curStdFlIntRunMemberIndex = 0;
         curDsPktProc = nullptr;
         curErProc = nullptr;
         curExpectedPktTotalLenBits = SIZE_UNSET;
@@ -266,7 +346,20 @@ public:
         return *reinterpret_cast<ElemT *>(thisAddr + diff);
     }
 
+    void appendPendingErElem(const Element& elem, Index offset, const Instr *instr,
+                             bool isDataProjHidden, bool incrsMark);
+
+    /*
+     * Copies the element of `pendingElem` to the corresponding current
+     * element of this position and returns the latter.
+     */
+    const Element& restorePendingErElem(const VmPendingErElem& pendingElem) noexcept;
+
 private:
+    template <typename ElemT>
+    std::shared_ptr<const Element> _copySectionElem(const ElemT& elem,
+                                                    std::shared_ptr<const std::vector<std::uint8_t>>& data);
+
     void _initVectorsFromPktProc();
     void _setSimpleFromOther(const VmPos& other);
     void _setFromOther(const VmPos& other);
@@ -309,6 +402,7 @@ public:
         NullTerminatedStringEndElement ntStrEnd;
         SubstringElement substr;
         BlobSectionElement blobSection;
+        ArraySectionElement arraySection;
         StaticLengthArrayBeginningElement slArrayBeginning;
         StaticLengthArrayEndElement slArrayEnd;
         DynamicLengthArrayBeginningElement dlArrayBeginning;
@@ -344,6 +438,34 @@ public:
     // last fixed-length bit array byte order
     boost::optional<ByteOrder> lastFlBitArrayBo;
 
+    // current event record filtering state
+    VmErFilterState erFilterState = VmErFilterState::NONE;
+
+    /*
+     * Elements which the VM emitted while `erFilterState` is
+     * `VmErFilterState::PENDING`.
+     */
+    std::vector<VmPendingErElem> pendingErElems;
+
+    /*
+     * Index of the next element of `pendingErElems` to emit in the
+     * `VmState::EMIT_PENDING_ER_ELEM` state.
+     */
+    Index nextPendingErElemIndex = 0;
+
+    /*
+     * Whether or not the current substring, BLOB section, and array
+     * section elements are visible considering the data projection of
+     * the VM, if any.
+     */
+    bool dataProjSectionsVisible = false;
+
+    /*
+     * Whether or not the next substring, BLOB section, or array section
+     * element is the first one of its string, BLOB, or array.
+     */
+    bool isNextSectionFirst = false;
+
     // remaining padding bits to skip for alignment
     Size remBitsToSkip = 0;
 
@@ -362,6 +484,27 @@ public:
     // current ID (event record or data stream type)
     TypeId curId;
 
+    /*
+     * Index of the next member to emit within the current
+     * `ReadStdFlIntRunInstr` instruction (0 when not within a run).
+     */
+    Index curStdFlIntRunMemberIndex = 0;
+
+    /*
+     * Whether or not `curStdFlIntRunVals` contains the values of all
+     * the members of the current `ReadStdFlIntRunInstr` instruction.
+     *
+     * If not, then the VM executes the original instruction of each
+     * member.
+     */
+    bool curStdFlIntRunIsDecoded = false;
+
+    /*
+     * Values of the members of the current `ReadStdFlIntRunInstr`
+     * instruction (signed values as their two's complement).
+     */
+    std::array<std::uint64_t, ReadStdFlIntRunInstr::maxMemberCount> curStdFlIntRunVals;
+
     // packet procedure
     const PktProc *pktProc = nullptr;
 
@@ -443,12 +586,16 @@ class Vm final
 {
 public:
     explicit Vm(DataSourceFactory& dataSrcFactory, const PktProc& pktProc,
-                ElementSequenceIterator& it);
+                const ElementSequenceOptions& opts, ElementSequenceIterator& it);
     Vm(const Vm& vm, ElementSequenceIterator& it);
     void setFromOther(const Vm& vm, ElementSequenceIterator& it);
     void seekPkt(Index offset);
     void savePos(ElementSequenceIteratorPosition& pos) const;
     void restorePos(const ElementSequenceIteratorPosition& pos);
+    void skipCurScope();
+    void skipCurStruct();
+    void skipToErEnd();
+    void nextBatch(ElementBatch& batch, Size maxCount);
 
     const VmPos& pos() const
     {
@@ -457,7 +604,8 @@ public:
 
     void nextElem()
     {
-        while (!this->_handleState());
+        this->_nextElemOnce();
+        this->_nextVisibleElem();
     }
 
     void updateItElemFromOtherPos(const VmPos& otherPos, const Element * const otherElem)
@@ -484,6 +632,17 @@ public:
         return *_it;
     }
 
+    /*
+     * Instruction which emitted the last scope or data element, if any.
+     *
+     * This is only meaningful when such an element is the current
+     * element of the iterator.
+     */
+    const Instr *lastInstr() const noexcept
+    {
+        return _lastInstr;
+    }
+
 private:
     // instruction handler reaction
     enum class _ExecReaction {
@@ -499,6 +658,11 @@ private:
     void _initExecFunc(_ExecReaction (Vm::*)(const Instr&)) noexcept;
 
     void _initExecFuncs() noexcept;
+
+#ifdef YACTFR_VM_DIRECT_THREADED
+    void _nextElemThreaded();
+#endif
+
     bool _newDataBlock(Index offsetInElemSeqBytes, Size sizeBytes);
 
     bool _handleState()
@@ -516,6 +680,9 @@ private:
         case VmState::END_ER:
             return this->_stateEndEr();
 
+        case VmState::EMIT_PENDING_ER_ELEM:
+            return this->_stateEmitPendingErElem();
+
         case VmState::READ_SUBSTR:
             return this->_stateReadSubstr();
 
@@ -525,6 +692,9 @@ private:
         case VmState::READ_UUID_BLOB_SECTION:
             return this->_stateReadUuidBlobSection();
 
+        case VmState::READ_ARRAY_SECTION:
+            return this->_stateReadArraySection();
+
         case VmState::CONTINUE_READ_VL_UINT:
             return this->_stateContinueReadVlInt<false>();
 
@@ -671,7 +841,7 @@ private:
             }
         }
 
-        this->_updateItForUser(_pos.elems.pktBeginning);
+        this->_emitElem(_pos.elems.pktBeginning);
         _pos.loadNewProc(_pos.pktProc->preambleProc());
         _pos.state(VmState::BEGIN_PKT_CONTENT);
         return true;
@@ -679,7 +849,7 @@ private:
 
     bool _stateBeginPktContent()
     {
-        this->_updateItForUser(_pos.elems.pktContentBeginning);
+        this->_emitElem(_pos.elems.pktContentBeginning);
 
         /*
          * The preamble procedure of the packet is already loaded at
@@ -714,7 +884,7 @@ private:
             _pos.state(VmState::END_PKT);
         }
 
-        this->_updateItForUser(_pos.elems.pktContentEnd);
+        this->_emitElem(_pos.elems.pktContentEnd);
         return true;
     }
 
@@ -739,7 +909,7 @@ private:
             _bufLenBits -= (_bufAddr - oldBufAddr) * 8;
         }
 
-        this->_updateItForUser(_pos.elems.pktEnd, offset);
+        this->_emitElem(_pos.elems.pktEnd, offset);
         _pos.state(VmState::BEGIN_PKT);
         return true;
     }
@@ -772,7 +942,15 @@ private:
          */
         this->_alignHead(_pos.curDsPktProc->erAlign());
 
-        this->_updateItForUser(_pos.elems.erBeginning);
+        if (_opts->eventRecordTypeFilter()) {
+            /*
+             * Hide the elements of this event record until
+             * _execSetErt() knows its type.
+             */
+            _pos.erFilterState = VmErFilterState::PENDING;
+        }
+
+        this->_emitElem(_pos.elems.erBeginning);
         _pos.loadNewProc(_pos.curDsPktProc->erPreambleProc());
         _pos.state(VmState::EXEC_INSTR);
         return true;
@@ -782,11 +960,43 @@ private:
     {
         assert(_pos.curErProc);
         _pos.curErProc = nullptr;
-        this->_updateItForUser(_pos.elems.erEnd);
+
+        if (_pos.erFilterState == VmErFilterState::DISCARDED) {
+            // no event record end element for a discarded event record
+            _pos.erFilterState = VmErFilterState::NONE;
+            _pos.state(VmState::BEGIN_ER);
+            return false;
+        }
+
+        this->_emitElem(_pos.elems.erEnd);
         _pos.state(VmState::BEGIN_ER);
         return true;
     }
 
+    bool _stateEmitPendingErElem()
+    {
+        if (_pos.nextPendingErElemIndex == _pos.pendingErElems.size()) {
+            // continue after the "set event record type" instruction
+            _pos.pendingErElems.clear();
+            _pos.nextPendingErElemIndex = 0;
+            _pos.state(VmState::EXEC_INSTR);
+            return false;
+        }
+
+        const auto& pendingElem = _pos.pendingErElems[_pos.nextPendingErElemIndex];
+
+        ++_pos.nextPendingErElemIndex;
+        _lastInstr = pendingElem.instr;
+
+        if (pendingElem.incrsMark) {
+            ++_it->_mark;
+        }
+
+        this->_emitElemSameMark(_pos.restorePendingErElem(pendingElem), pendingElem.offset,
+                                pendingElem.isDataProjHidden);
+        return true;
+    }
+
     bool _stateReadUuidByte()
     {
         if (_pos.stackTop().rem == 0) {
@@ -806,7 +1016,7 @@ private:
     bool _stateSetMetadataStreamUuid()
     {
         _pos.elems.metadataStreamUuid._uuid = _pos.metadataStreamUuid;
-        this->_updateItForUser(_pos.elems.metadataStreamUuid);
+        this->_emitElem(_pos.elems.metadataStreamUuid);
         _pos.setParentStateAndStackPop();
         return true;
     }
@@ -838,7 +1048,7 @@ private:
         elem._begin = reinterpret_cast<const ByteT *>(buf);
         elem._end = reinterpret_cast<const ByteT *>(buf + sectionSizeBytes);
         assert(elem.size() > 0);
-        this->_updateItForUser(elem);
+        this->_emitSectionElem(elem);
         this->_consumeExistingBits(sectionSizeBytes * 8);
         _pos.stackTop().rem -= sectionSizeBytes;
         return true;
@@ -866,6 +1076,49 @@ private:
         return cont;
     }
 
+    bool _stateReadArraySection()
+    {
+        auto& stackTop = _pos.stackTop();
+
+        if (stackTop.rem == 0) {
+            _pos.setParentStateAndStackPop();
+            return false;
+        }
+
+        /*
+         * The single instruction of the array subprocedure reads one
+         * item (see `BeginReadSlArrayInstr::sectionElemInstr()`).
+         */
+        assert(stackTop.proc->size() == 1);
+
+        const auto& elemInstr = static_cast<const ReadFlBitArrayInstr&>(*stackTop.proc->front());
+        const Size itemLenBits = elemInstr.len();
+
+        assert((_pos.headOffsetInCurPktBits & (elemInstr.align() - 1)) == 0);
+
+        // require at least one item
+        this->_requireContentBits(itemLenBits);
+
+        /*
+         * Don't go beyond the packet content: if the array doesn't fit,
+         * then the next call throws when requiring the first item which
+         * doesn't fit, as when reading one item at a time.
+         */
+        const auto availBits = std::min(this->_remBitsInBuf(), _pos.remContentBitsInPkt());
+        const auto sectionLen = std::min(availBits / itemLenBits, stackTop.rem);
+        const auto sectionLenBits = sectionLen * itemLenBits;
+        const auto buf = this->_bufAtHead();
+
+        assert(sectionLen > 0);
+        _pos.elems.arraySection._begin = buf;
+        _pos.elems.arraySection._end = buf + sectionLenBits / 8;
+        _pos.elems.arraySection._elemType = &elemInstr.flBitArrayType();
+        this->_emitSectionElem(_pos.elems.arraySection);
+        this->_consumeExistingBits(sectionLenBits);
+        stackTop.rem -= sectionLen;
+        return true;
+    }
+
     bool _stateReadUuidBlobSection()
     {
         if (this->_stateReadBytes<std::uint8_t>(_pos.elems.blobSection)) {
@@ -1021,7 +1274,7 @@ private:
         }
 
         assert(_pos.elems.substr.size() > 0);
-        this->_updateItForUser(_pos.elems.substr);
+        this->_emitSectionElem(_pos.elems.substr);
         this->_consumeExistingBits(_pos.elems.substr.size() * 8);
         return true;
     }
@@ -1031,13 +1284,67 @@ private:
         /*
          * NOTE: _setDataElemFromInstr() was already called from
          * _execReadNtStr() for `_pos.elems.ntStrEnd`.
+         *
+         * A data projection shows a null-terminated string completely
+         * or not at all: its end element is visible if and only if its
+         * substring elements are.
          */
-        this->_updateItForUser(_pos.elems.ntStrEnd);
+        this->_emitElem(_pos.elems.ntStrEnd, _pos.headOffsetInElemSeqBits(),
+                        this->_areSectionsDataProjHidden());
         _pos.state(_pos.nextState);
         assert(_pos.state() == VmState::EXEC_INSTR || _pos.state() == VmState::EXEC_ARRAY_INSTR);
         return true;
     }
 
+    void _nextElemOnce()
+    {
+#ifdef YACTFR_VM_DIRECT_THREADED
+        this->_nextElemThreaded();
+#else
+        while (!this->_handleState());
+#endif
+    }
+
+    /*
+     * Returns whether or not the element `elem`, which the VM is about
+     * to emit, is hidden, that is, the VM must continue without
+     * returning it to the user.
+     *
+     * `isDataProjHidden` indicates whether or not the data projection
+     * of this VM hides `elem`.
+     */
+    bool _isElemHidden(const Element& elem, const bool isDataProjHidden) const noexcept
+    {
+        return _pos.erFilterState == VmErFilterState::PENDING ||
+               _pos.erFilterState == VmErFilterState::DISCARDED || isDataProjHidden ||
+               _hiddenElemKinds[elemKindIndex(elem.kind())];
+    }
+
+    /*
+     * Executes the VM while the last emitted element is hidden (see
+     * _isElemHidden()).
+     */
+    void _nextVisibleElem()
+    {
+        while (_isLastElemHidden) {
+            /*
+             * Hidden data: jump over it when possible.
+             *
+             * Within a visible event record, or one of which the
+             * VM keeps the elements, only jump over data of which
+             * all the elements are hidden.
+             */
+            const auto onlyDataProjHidden = _pos.erFilterState != VmErFilterState::DISCARDED &&
+                                            !_canJumpOverHiddenStaticData;
+
+            if (this->_tryJumpOverNextInstr(onlyDataProjHidden)) {
+                continue;
+            }
+
+            this->_nextElemOnce();
+        }
+    }
+
     _ExecReaction _exec(const Instr& instr)
     {
         return (this->*_execFuncs[static_cast<Index>(instr.kind())])(instr);
@@ -1047,16 +1354,125 @@ private:
     {
         _it->_curElem = &elem;
         _it->_offset = offset;
+    }
+
+    /*
+     * Emits the element `elem` at the offset `offset`.
+     *
+     * This increments the mark of the iterator, and then makes `elem`
+     * its current element unless it's hidden (see _isElemHidden()).
+     *
+     * While nextBatch() runs, this also appends the record of a visible
+     * `elem` to the element batch being filled.
+     */
+    void _emitElem(const Element& elem, const Index offset,
+                   const bool isDataProjHidden = false) noexcept
+    {
         ++_it->_mark;
+        this->_emitElemSameMark(elem, offset, isDataProjHidden, true);
+    }
+
+    /*
+     * Like _emitElem(), but without incrementing the mark of the
+     * iterator.
+     *
+     * `incrsMark` indicates whether or not the caller incremented the
+     * mark for `elem`: while the type of the current event record is
+     * unknown, this keeps a copy of `elem` to emit it again once
+     * _execSetErt() selects the event record.
+     */
+    void _emitElemSameMark(const Element& elem, const Index offset,
+                           const bool isDataProjHidden, const bool incrsMark = false) noexcept
+    {
+        _lastElem = &elem;
+        _isLastElemHidden = this->_isElemHidden(elem, isDataProjHidden);
+
+        if (_pos.erFilterState == VmErFilterState::PENDING) {
+            _pos.appendPendingErElem(elem, offset, _lastInstr, isDataProjHidden, incrsMark);
+        }
+
+        if (!_isLastElemHidden) {
+            this->_updateItForUser(elem, offset);
+
+            if (_batch) {
+                _batch->_append(elem, offset);
+            }
+        }
     }
 
-    void _updateItForUser(const Element& elem) noexcept
+    void _emitElem(const Element& elem) noexcept
     {
-        this->_updateItForUser(elem, _pos.headOffsetInElemSeqBits());
+        this->_emitElem(elem, _pos.headOffsetInElemSeqBits());
     }
 
-    void _setItEnd() const noexcept
+    /*
+     * Emits the scope or data element `elem` of the instruction `instr`
+     * at the offset `offset`, considering the data projection of this
+     * VM, if any.
+     *
+     * This also sets the visibility of any following substring, BLOB
+     * section, or array section element (see _emitSectionElem()).
+     */
+    void _emitInstrElem(const Element& elem, const Instr& instr, const Index offset) noexcept
     {
+        _lastInstr = &instr;
+
+        if (!_dataProj) {
+            this->_emitElem(elem, offset);
+            return;
+        }
+
+        const auto& visibility = _dataProj->instrVisibility(instr);
+
+        _pos.dataProjSectionsVisible = visibility.areSectionsVisible;
+        this->_emitElem(elem, offset, visibility.isHidden);
+    }
+
+    void _emitInstrElem(const Element& elem, const Instr& instr) noexcept
+    {
+        this->_emitInstrElem(elem, instr, _pos.headOffsetInElemSeqBits());
+    }
+
+    bool _areSectionsDataProjHidden() const noexcept
+    {
+        return _dataProj && !_pos.dataProjSectionsVisible;
+    }
+
+    /*
+     * Emits the substring, BLOB section, or array section element
+     * `elem`, considering the data projection of this VM, if any.
+     *
+     * Only the first section of a string, BLOB, or array increments
+     * the mark of the iterator: this makes the mark independent of how
+     * the data source splits the data into blocks, and the same as
+     * after jumping over data having a static layout (see
+     * _jumpOverStaticLayout()).
+     */
+    void _emitSectionElem(const Element& elem) noexcept
+    {
+        const auto offset = _pos.headOffsetInElemSeqBits();
+
+        if (_pos.isNextSectionFirst) {
+            _pos.isNextSectionFirst = false;
+            this->_emitElem(elem, offset, this->_areSectionsDataProjHidden());
+        } else {
+            this->_emitElemSameMark(elem, offset, this->_areSectionsDataProjHidden());
+        }
+    }
+
+    Size _innermostFrameStackSize(Instr::Kind endInstrKind) const noexcept;
+    void _skipUntilEndElem(Element::Kind endElemKind, Size stackSize);
+    void _skipPendingErElemsUntilEndElem(Element::Kind begElemKind, Element::Kind endElemKind);
+    const StaticLayout *_jumpableStaticLayout(const Instr& instr) const noexcept;
+    bool _tryJumpOverNextInstr(bool onlyDataProjHidden = false);
+    bool _isInstrDataProjHidden(const Instr& instr) const noexcept;
+    void _tryJumpToCurProcEnd();
+    void _jumpOverStaticLayout(const StaticLayout& layout);
+
+    void _setItEnd() noexcept
+    {
+        _lastElem = nullptr;
+        _isLastElemHidden = false;
         _it->_mark = 0;
         _it->_offset = ElementSequenceIterator::_END_OFFSET;
     }
@@ -1178,6 +1594,20 @@ private:
         _pos.headOffsetInCurPktBits += bitsToConsume;
     }
 
+    /*
+     * Like _consumeExistingBits(), but for bits which the VM already
+     * decoded and which the buffer might not contain anymore (copied
+     * iterator or restored position).
+     */
+    void _consumeDecodedBits(const Size bitsToConsume) noexcept
+    {
+        _pos.headOffsetInCurPktBits += bitsToConsume;
+
+        if (_pos.headOffsetInCurPktBits > _bufOffsetInCurPktBits + _bufLenBits) {
+            this->_resetBuffer();
+        }
+    }
+
     void _resetBuffer() noexcept
     {
         _bufAddr = nullptr;
@@ -1253,6 +1683,7 @@ private:
     _ExecReaction _execReadVlUEnum(const Instr& instr);
     _ExecReaction _execReadVlSEnum(const Instr& instr);
     _ExecReaction _execReadNtStr(const Instr& instr);
+    _ExecReaction _execReadStdFlIntRun(const Instr& instr);
     _ExecReaction _execBeginReadScope(const Instr& instr);
     _ExecReaction _execEndReadScope(const Instr& instr);
     _ExecReaction _execBeginReadStruct(const Instr& instr);
@@ -1329,7 +1760,7 @@ private:
         Vm::_setDataElemFromInstr(elem, instr);
         this->_setLastIntVal(val);
         elem._val(val);
-        this->_updateItForUser(elem, offset);
+        this->_emitInstrElem(elem, instr, offset);
     }
 
     template <typename ValT, typename ElemT>
@@ -1362,7 +1793,7 @@ private:
     {
         Vm::_setDataElemFromInstr(_pos.elems.flFloat, instr);
         _pos.elems.flFloat._val(val);
-        this->_updateItForUser(_pos.elems.flFloat);
+        this->_emitInstrElem(_pos.elems.flFloat, instr);
     }
 
     void _execReadFlBitArrayPreamble(const Instr& instr, const Size len)
@@ -1419,6 +1850,10 @@ private:
         this->_consumeExistingBits(LenBits);
     }
 
+    void _decodeStdFlIntRun(const ReadStdFlIntRunInstr& instr) noexcept;
+    void _emitDecodedStdFlIntRunMember(const ReadStdFlIntRunInstr::Member& member,
+                                       std::uint64_t val) noexcept;
+
     template <typename RetT, RetT (*Funcs[])(const std::uint8_t *)>
     RetT _readFlInt(const Instr& instr)
     {
@@ -1562,7 +1997,7 @@ private:
 
         Vm::_setDataElemFromInstr(elem, instr);
         elem._selVal = selVal;
-        this->_updateItForUser(elem);
+        this->_emitInstrElem(elem, instr);
         _pos.gotoNextInstr();
         _pos.stackPush(proc);
         _pos.state(VmState::EXEC_INSTR);
@@ -1585,7 +2020,7 @@ private:
         const auto isEnabled = beginReadOptInstr.isEnabled(selVal);
 
         Vm::_setDataElemFromInstr(elem, instr);
-        this->_updateItForUser(elem);
+        this->_emitInstrElem(elem, instr);
         _pos.gotoNextInstr();
         _pos.stackPush(&beginReadOptInstr.proc());
 
@@ -1614,7 +2049,8 @@ private:
     {
         this->_alignHead(instr);
         Vm::_setDataElemFromInstr(elem, instr);
-        this->_updateItForUser(elem);
+        this->_emitInstrElem(elem, instr);
+        _pos.isNextSectionFirst = true;
         _pos.gotoNextInstr();
         _pos.stackPush(proc);
         _pos.stackTop().rem = len;
@@ -1632,6 +2068,16 @@ private:
         return _ExecReaction::STOP;
     }
 
+    template <typename BeginReadArrayInstrT>
+    VmState _arrayItemsState(const BeginReadArrayInstrT& instr) const noexcept
+    {
+        if (_opts->arraySectionsEnabled() && instr.sectionElemInstr()) {
+            return VmState::READ_ARRAY_SECTION;
+        }
+
+        return VmState::EXEC_ARRAY_INSTR;
+    }
+
     _ExecReaction _execBeginReadSlBlob(const Instr& instr, const VmState nextState)
     {
         const auto& beginReadSlBlobInstr = static_cast<const BeginReadSlBlobInstr&>(instr);
@@ -1650,7 +2096,8 @@ private:
         assert(len != SAVED_VAL_UNSET);
         this->_alignHead(instr);
         Vm::_setDataElemFromInstr(elem, instr);
-        this->_updateItForUser(elem);
+        this->_emitInstrElem(elem, instr);
+        _pos.isNextSectionFirst = true;
         _pos.gotoNextInstr();
         _pos.stackPush(proc);
         _pos.stackTop().rem = len;
@@ -1662,7 +2109,7 @@ private:
         const auto newVal = _pos.updateDefClkVal(len);
 
         _pos.elems.defClkVal._cycles = newVal;
-        this->_updateItForUser(_pos.elems.defClkVal);
+        this->_emitElem(_pos.elems.defClkVal);
         return _ExecReaction::FETCH_NEXT_INSTR_AND_STOP;
     }
 
@@ -1685,6 +2132,38 @@ private:
     // owning element sequence iterator
     ElementSequenceIterator *_it;
 
+    // options of the element sequence of `_it`
+    const ElementSequenceOptions *_opts;
+
+    /*
+     * Whether or not the VM may jump over data having a static layout
+     * within a visible event record when the iterator doesn't produce
+     * elements of some kinds, that is, whether or not the iterator
+     * doesn't produce any element which such data contains.
+     */
+    bool _canJumpOverHiddenStaticData;
+
+    /*
+     * Whether or not the elements of a given kind are hidden, indexed
+     * with elemKindIndex().
+     */
+    std::array<bool, ELEM_KIND_TABLE_SIZE> _hiddenElemKinds;
+
+    // last element which the VM emitted, visible or not
+    const Element *_lastElem = nullptr;
+
+    // whether or not `*_lastElem` is hidden
+    bool _isLastElemHidden = false;
+
+    // instruction which emitted the last scope or data element, if any
+    const Instr *_lastInstr = nullptr;
+
+    // element batch which nextBatch() is filling, if any
+    ElementBatch *_batch = nullptr;
+
+    // data projection, if any
+    std::shared_ptr<const DataProj> _dataProj;
+
     // array of instruction handler functions
     std::array<ExecFunc, 128> _execFuncs;
 
@@ -0,0 +1,358 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cerrno>
+#include <sstream>
+#include <cassert>
+#include <algorithm>
+#include <new>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#ifdef YACTFR_HAVE_ZSTD
+# include <zstd.h>
+#endif
+
+#include <yactfr/io-error.hpp>
+
+#include "zstd-file-data-src-factory-impl.hpp"
+#include "utils.hpp"
+
+namespace yactfr {
+namespace internal {
+
+// magic number of the skippable frame which contains the seek table
+static constexpr std::uint32_t zstdSeekTableSkippableMagic = 0x184d2a5e;
+
+// magic number of the seek table footer
+static constexpr std::uint32_t zstdSeekTableFooterMagic = 0x8f92eab1;
+
+// size of the seek table footer
+static constexpr Size zstdSeekTableFooterSize = 9;
+
+// size of the header of a skippable frame
+static constexpr Size zstdSkippableHeaderSize = 8;
+
+static std::uint32_t readLe32(const std::uint8_t * const buf) noexcept
+{
+    return static_cast<std::uint32_t>(buf[0]) |
+           (static_cast<std::uint32_t>(buf[1]) << 8) |
+           (static_cast<std::uint32_t>(buf[2]) << 16) |
+           (static_cast<std::uint32_t>(buf[3]) << 24);
+}
+
+ZstdFileDataSrcFactoryImpl::ZstdFileDataSrcFactoryImpl(std::string path,
+                                                       const boost::optional<Size>& maxCachedFrameCount) :
+    _path {std::move(path)}
+{
+#ifndef YACTFR_HAVE_ZSTD
+    {
+        std::ostringstream ss;
+
+        ss << "Cannot read zstd-seekable file \"" << _path <<
+              "\": yactfr was built without libzstd";
+        throw IOError {ss.str()};
+    }
+#endif
+
+    if (maxCachedFrameCount) {
+        _maxCachedFrameCount = std::max(*maxCachedFrameCount, static_cast<Size>(1));
+    } else {
+        _maxCachedFrameCount = 4;
+    }
+
+    _fd = open(_path.c_str(), O_RDONLY);
+
+    if (_fd < 0) {
+        const auto error = internal::strError();
+        std::ostringstream ss;
+
+        ss << "Cannot open \"" << _path << "\" for reading: " << error;
+        throw IOError {ss.str()};
+    }
+
+    struct stat stat;
+
+    const auto ret = fstat(_fd, &stat);
+
+    if (ret < 0) {
+        const auto error = internal::strError();
+        std::ostringstream ss;
+
+        ss << "Cannot get file status for \"" << _path << "\": " << error;
+        this->_close();
+        throw IOError {ss.str()};
+    }
+
+    _fileSize = static_cast<Size>(stat.st_size);
+
+    try {
+        this->_readSeekTable();
+    } catch (...) {
+        this->_close();
+        throw;
+    }
+}
+
+void ZstdFileDataSrcFactoryImpl::_throwInvalidSeekTable(const std::string& reason) const
+{
+    std::ostringstream ss;
+
+    ss << "Invalid seek table in zstd-seekable file \"" << _path << "\": " << reason;
+    throw IOError {ss.str()};
+}
+
+void ZstdFileDataSrcFactoryImpl::_readSeekTable()
+{
+    if (_fileSize < zstdSkippableHeaderSize + zstdSeekTableFooterSize) {
+        this->_throwInvalidSeekTable("file is too small");
+    }
+
+    std::uint8_t footer[zstdSeekTableFooterSize];
+
+    this->_read(footer, zstdSeekTableFooterSize, _fileSize - zstdSeekTableFooterSize);
+
+    if (readLe32(&footer[5]) != zstdSeekTableFooterMagic) {
+        this->_throwInvalidSeekTable("unexpected footer magic number");
+    }
+
+    const Size frameCount = readLe32(&footer[0]);
+    const auto descr = footer[4];
+
+    if (descr & 0x7c) {
+        this->_throwInvalidSeekTable("reserved bits of the descriptor are set");
+    }
+
+    // an entry may contain a checksum
+    const Size entrySize = (descr & 0x80) ? 12 : 8;
+    const auto tableSize = frameCount * entrySize + zstdSeekTableFooterSize;
+
+    if (_fileSize < zstdSkippableHeaderSize + tableSize) {
+        this->_throwInvalidSeekTable("file is too small for the number of frames");
+    }
+
+    const auto tableFrameOffset = _fileSize - tableSize - zstdSkippableHeaderSize;
+    std::vector<std::uint8_t> table(zstdSkippableHeaderSize + tableSize);
+
+    this->_read(table.data(), table.size(), tableFrameOffset);
+
+    if (readLe32(&table[0]) != zstdSeekTableSkippableMagic ||
+            readLe32(&table[4]) != tableSize) {
+        this->_throwInvalidSeekTable("unexpected skippable frame header");
+    }
+
+    _frames.reserve(frameCount);
+
+    Index comprOffset = 0;
+
+    for (Index i = 0; i < frameCount; ++i) {
+        const auto entry = &table[zstdSkippableHeaderSize + i * entrySize];
+        ZstdFrame frame;
+
+        frame.comprOffset = comprOffset;
+        frame.comprSize = readLe32(&entry[0]);
+        frame.offset = _decompressedSize;
+        frame.size = readLe32(&entry[4]);
+        comprOffset += frame.comprSize;
+        _decompressedSize += frame.size;
+        _frames.push_back(frame);
+    }
+
+    if (comprOffset != tableFrameOffset) {
+        this->_throwInvalidSeekTable("compressed frame sizes don't match the file size");
+    }
+}
+
+void ZstdFileDataSrcFactoryImpl::_read(std::uint8_t * const buf, const Size size,
+                                       const Index offset)
+{
+    Size readSize = 0;
+
+    while (readSize < size) {
+        const auto ret = pread(_fd, buf + readSize, static_cast<size_t>(size - readSize),
+                               static_cast<off_t>(offset + readSize));
+
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            const auto error = internal::strError();
+            std::ostringstream ss;
+
+            ss << "Cannot read region [" << offset << ", " << (offset + size) <<
+                  "[ of file \"" << _path << "\": " << error;
+            throw IOError {ss.str()};
+        }
+
+        if (ret == 0) {
+            std::ostringstream ss;
+
+            ss << "Cannot read region [" << offset << ", " << (offset + size) <<
+                  "[ of file \"" << _path << "\": unexpected end of file";
+            throw IOError {ss.str()};
+        }
+
+        readSize += static_cast<Size>(ret);
+    }
+}
+
+Index ZstdFileDataSrcFactoryImpl::frameIndex(const Index offset) const noexcept
+{
+    assert(offset < _decompressedSize);
+
+    /*
+     * Find the last frame of which the offset is less than or equal to
+     * `offset`: this skips the empty frames.
+     */
+    const auto it = std::upper_bound(_frames.begin(), _frames.end(), offset,
+                                     [](const Index offset, const ZstdFrame& frame) {
+        return offset < frame.offset;
+    });
+
+    assert(it != _frames.begin());
+    return static_cast<Index>(it - 1 - _frames.begin());
+}
+
+ZstdFrameData ZstdFileDataSrcFactoryImpl::frameData(const Index frameIndex)
+{
+    assert(frameIndex < _frames.size());
+
+    ZstdFrameData data;
+    std::unique_ptr<std::vector<std::uint8_t>> comprBuf;
+    std::shared_ptr<void> dctx;
+
+    {
+        std::lock_guard<std::mutex> lock {_cacheMutex};
+        const auto it = _cache.find(frameIndex);
+
+        if (it != _cache.end()) {
+            // cache hit: now the most recently used
+            _lru.splice(_lru.begin(), _lru, it->second.lruIt);
+            return it->second.data;
+        }
+
+        // take a free buffer, a compressed data buffer, and a context
+        if (_freeBufs.empty()) {
+            data = std::make_shared<std::vector<std::uint8_t>>();
+        } else {
+            data = std::move(_freeBufs.back());
+            _freeBufs.pop_back();
+        }
+
+        if (_comprBufs.empty()) {
+            comprBuf = std::make_unique<std::vector<std::uint8_t>>();
+        } else {
+            comprBuf = std::move(_comprBufs.back());
+            _comprBufs.pop_back();
+        }
+
+        if (!_dctxs.empty()) {
+            dctx = std::move(_dctxs.back());
+            _dctxs.pop_back();
+        }
+    }
+
+#ifdef YACTFR_HAVE_ZSTD
+    if (!dctx) {
+        dctx = std::shared_ptr<void> {ZSTD_createDCtx(), [](void * const dctx) {
+            ZSTD_freeDCtx(static_cast<ZSTD_DCtx *>(dctx));
+        }};
+
+        if (!dctx.get()) {
+            throw std::bad_alloc {};
+        }
+    }
+#endif
+
+    // decompress without holding the lock
+    const auto& frame = _frames[frameIndex];
+    std::string error;
+
+    try {
+        comprBuf->resize(frame.comprSize);
+        this->_read(comprBuf->data(), frame.comprSize, frame.comprOffset);
+        data->resize(frame.size);
+
+#ifdef YACTFR_HAVE_ZSTD
+        const auto ret = ZSTD_decompressDCtx(static_cast<ZSTD_DCtx *>(dctx.get()), data->data(),
+                                             data->size(), comprBuf->data(), comprBuf->size());
+
+        if (ZSTD_isError(ret)) {
+            error = ZSTD_getErrorName(ret);
+        } else if (ret != frame.size) {
+            error = "decompressed size doesn't match the seek table";
+        }
+#endif
+    } catch (...) {
+        std::lock_guard<std::mutex> lock {_cacheMutex};
+
+        _comprBufs.push_back(std::move(comprBuf));
+        _dctxs.push_back(std::move(dctx));
+        throw;
+    }
+
+    std::lock_guard<std::mutex> lock {_cacheMutex};
+
+    _comprBufs.push_back(std::move(comprBuf));
+    _dctxs.push_back(std::move(dctx));
+
+    if (!error.empty()) {
+        std::ostringstream ss;
+
+        ss << "Cannot decompress frame " << frameIndex << " of zstd-seekable file \"" <<
+              _path << "\": " << error;
+        throw IOError {ss.str()};
+    }
+
+    // another data source could have decompressed the same frame
+    const auto it = _cache.find(frameIndex);
+
+    if (it != _cache.end()) {
+        _freeBufs.push_back(std::move(data));
+        return it->second.data;
+    }
+
+    // evict the least recently used frames
+    while (_cache.size() >= _maxCachedFrameCount) {
+        const auto evictIt = _cache.find(_lru.back());
+
+        assert(evictIt != _cache.end());
+
+        // reuse the buffer later if no data source uses it
+        if (evictIt->second.data.use_count() == 1 &&
+                _freeBufs.size() < _maxCachedFrameCount) {
+            _freeBufs.push_back(std::move(evictIt->second.data));
+        }
+
+        _cache.erase(evictIt);
+        _lru.pop_back();
+    }
+
+    _lru.push_front(frameIndex);
+    _cache[frameIndex] = _CachedFrame {data, _lru.begin()};
+    return data;
+}
+
+void ZstdFileDataSrcFactoryImpl::_close()
+{
+    assert(_fd >= 0);
+
+    // TODO: check return value and log (do not throw) on error
+    static_cast<void>(close(_fd));
+    _fd = -1;
+}
+
+ZstdFileDataSrcFactoryImpl::~ZstdFileDataSrcFactoryImpl()
+{
+    this->_close();
+}
+
+} // namespace internal
+} // namespace yactfr
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#ifndef _YACTFR_INTERNAL_ZSTD_FILE_DATA_SRC_FACTORY_IMPL_HPP
+#define _YACTFR_INTERNAL_ZSTD_FILE_DATA_SRC_FACTORY_IMPL_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <memory>
+#include <boost/optional/optional.hpp>
+
+#include <yactfr/aliases.hpp>
+
+namespace yactfr {
+namespace internal {
+
+/*
+ * Frame of a zstd-seekable file, as found in its seek table.
+ */
+struct ZstdFrame final
+{
+    // offset and size within the compressed file
+    Index comprOffset;
+    Size comprSize;
+
+    // offset and size within the decompressed data
+    Index offset;
+    Size size;
+};
+
+/*
+ * Decompressed data of a frame.
+ */
+using ZstdFrameData = std::shared_ptr<std::vector<std::uint8_t>>;
+
+/*
+ * A `ZstdFileDataSrcFactoryImpl` object is shared by zero or more
+ * `ZstdSeekableFileDataSource` objects, and also by the public
+ * `ZstdSeekableFileDataSourceFactory` object which builds it. It opens
+ * a zstd-seekable file, keeps its file descriptor open, and reads its
+ * seek table.
+ *
+ * It also owns a cache of at most `maxCachedFrameCount` decompressed
+ * frames which its data sources share: frameData() returns a cached
+ * frame or decompresses it, evicting the least recently used one.
+ * A data source keeps a reference to the data of its current frame, so
+ * that evicting a frame never invalidates a data block; the cache only
+ * reuses the buffer of an evicted frame which no data source uses.
+ *
+ * All the methods are thread-safe.
+ */
+class ZstdFileDataSrcFactoryImpl final
+{
+public:
+    explicit ZstdFileDataSrcFactoryImpl(std::string path,
+                                        const boost::optional<Size>& maxCachedFrameCount);
+    ~ZstdFileDataSrcFactoryImpl();
+
+    const std::string& path() const noexcept
+    {
+        return _path;
+    }
+
+    const std::vector<ZstdFrame>& frames() const noexcept
+    {
+        return _frames;
+    }
+
+    Size decompressedSize() const noexcept
+    {
+        return _decompressedSize;
+    }
+
+    Size maxCachedFrameCount() const noexcept
+    {
+        return _maxCachedFrameCount;
+    }
+
+    /*
+     * Index of the frame which contains the byte at `offset` within the
+     * decompressed data.
+     */
+    Index frameIndex(Index offset) const noexcept;
+
+    /*
+     * Decompressed data of the frame `frameIndex`.
+     */
+    ZstdFrameData frameData(Index frameIndex);
+
+private:
+    struct _CachedFrame final
+    {
+        ZstdFrameData data;
+
+        // position within `_lru`
+        std::list<Index>::iterator lruIt;
+    };
+
+private:
+    void _readSeekTable();
+    void _read(std::uint8_t *buf, Size size, Index offset);
+    void _close();
+
+    [[noreturn]] void _throwInvalidSeekTable(const std::string& reason) const;
+
+private:
+    const std::string _path;
+    Size _maxCachedFrameCount;
+    int _fd = -1;
+    Size _fileSize;
+    std::vector<ZstdFrame> _frames;
+    Size _decompressedSize = 0;
+
+    // all the following members are protected by `_cacheMutex`
+
+    // cached frames, keyed by frame index
+    std::unordered_map<Index, _CachedFrame> _cache;
+
+    // indexes of cached frames, most recently used first
+    std::list<Index> _lru;
+
+    // buffers of evicted frames
+    std::vector<ZstdFrameData> _freeBufs;
+
+    // compressed data buffers (one per concurrent decompression)
+    std::vector<std::unique_ptr<std::vector<std::uint8_t>>> _comprBufs;
+
+    // decompression contexts (one per concurrent decompression)
+    std::vector<std::shared_ptr<void>> _dctxs;
+
+    std::mutex _cacheMutex;
+};
+
+} // namespace internal
+} // namespace yactfr
+
+#endif // _YACTFR_INTERNAL_ZSTD_FILE_DATA_SRC_FACTORY_IMPL_HPP
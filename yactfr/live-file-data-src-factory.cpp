@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <yactfr/live-file-data-src-factory.hpp>
+
+#include "internal/mmap-file-view-factory-impl.hpp"
+#include "internal/mmap-file-view.hpp"
+
+namespace yactfr {
+
+LiveFileDataSourceFactory::LiveFileDataSourceFactory(std::string path,
+                                                     const boost::optional<Size>& preferredMmapSize) :
+    /*
+     * A live file data source maps whole windows, even beyond the end
+     * of the file: use smaller windows than a memory mapped file view
+     * by default (64 MiB).
+     */
+    _pimpl {
+        std::make_shared<internal::MmapFileViewFactoryImpl>(std::move(path),
+                                                            preferredMmapSize.value_or(64 << 20),
+                                                            MemoryMappedFileViewFactory::AccessPattern::SEQUENTIAL,
+                                                            boost::none, true)
+    }
+{
+}
+
+Size LiveFileDataSourceFactory::fileSize() const noexcept
+{
+    return _pimpl->fileSize();
+}
+
+Size LiveFileDataSourceFactory::updateFileSize()
+{
+    return _pimpl->updateFileSize();
+}
+
+void LiveFileDataSourceFactory::markComplete() noexcept
+{
+    _pimpl->markComplete();
+}
+
+bool LiveFileDataSourceFactory::isComplete() const noexcept
+{
+    return _pimpl->isComplete();
+}
+
+DataSource::UP LiveFileDataSourceFactory::_createDataSource()
+{
+    return std::make_unique<internal::MemoryMappedFileView>(_pimpl);
+}
+
+} // namespace yactfr
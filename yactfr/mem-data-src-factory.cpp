@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstring>
+#include <cassert>
+#include <array>
+#include <algorithm>
+
+#include <yactfr/mem-data-src-factory.hpp>
+
+#include "internal/mem-data-src-factory-impl.hpp"
+
+namespace yactfr {
+namespace internal {
+
+class MemoryDataSource final :
+    public DataSource
+{
+public:
+    explicit MemoryDataSource(std::shared_ptr<const internal::MemDataSrcFactoryImpl> memDataSrcFactoryImpl);
+
+private:
+    boost::optional<DataBlock> _data(Index offset, Size minSize) override;
+    Index _chunkIndex(Index offset) const noexcept;
+
+private:
+    std::shared_ptr<const internal::MemDataSrcFactoryImpl> _memDataSrcFactoryImpl;
+
+    // index of the chunk of the last returned data block
+    Index _curChunkIndex = 0;
+
+    // stitched data which spans more than one chunk
+    std::array<std::uint8_t, 16> _tmpBuf;
+};
+
+MemoryDataSource::MemoryDataSource(std::shared_ptr<const internal::MemDataSrcFactoryImpl> memDataSrcFactoryImpl) :
+    _memDataSrcFactoryImpl {std::move(memDataSrcFactoryImpl)}
+{
+}
+
+Index MemoryDataSource::_chunkIndex(const Index offset) const noexcept
+{
+    const auto& chunks = _memDataSrcFactoryImpl->chunks();
+
+    /*
+     * Try the current chunk and the following one first: an element
+     * sequence iterator mostly requests increasing offsets.
+     */
+    const auto endIndex = std::min(_curChunkIndex + 2, static_cast<Index>(chunks.size()));
+
+    for (auto index = _curChunkIndex; index < endIndex; ++index) {
+        const auto& chunk = chunks[index];
+
+        if (offset >= chunk.offset && offset < chunk.offset + chunk.size) {
+            return index;
+        }
+    }
+
+    return _memDataSrcFactoryImpl->chunkIndex(offset);
+}
+
+boost::optional<DataBlock> MemoryDataSource::_data(const Index offset, const Size minSize)
+{
+    assert(minSize <= _tmpBuf.size());
+
+    if ((offset + minSize) > _memDataSrcFactoryImpl->size()) {
+        // no more data
+        return boost::none;
+    }
+
+    const auto& chunks = _memDataSrcFactoryImpl->chunks();
+
+    _curChunkIndex = this->_chunkIndex(offset);
+
+    const auto& chunk = chunks[_curChunkIndex];
+    const auto offsetInChunk = offset - chunk.offset;
+    const auto availSize = chunk.size - offsetInChunk;
+
+    if (availSize >= minSize) {
+        // zero copy
+        return DataBlock {static_cast<const void *>(chunk.addr + offsetInChunk), availSize};
+    }
+
+    /*
+     * The requested data spans more than one chunk: copy it to our
+     * temporary buffer, from as many (small) chunks as needed.
+     */
+    std::memcpy(_tmpBuf.data(), chunk.addr + offsetInChunk, availSize);
+
+    auto stitchedSize = availSize;
+    auto index = _curChunkIndex + 1;
+
+    while (stitchedSize < minSize) {
+        assert(index < chunks.size());
+
+        const auto& nextChunk = chunks[index];
+        const auto size = std::min(nextChunk.size, minSize - stitchedSize);
+
+        std::memcpy(_tmpBuf.data() + stitchedSize, nextChunk.addr, size);
+        stitchedSize += size;
+        ++index;
+    }
+
+    return DataBlock {static_cast<const void *>(_tmpBuf.data()), minSize};
+}
+
+} // namespace internal
+
+MemoryDataSourceFactory::MemoryDataSourceFactory(const void * const address, const Size size) :
+    _pimpl {
+        std::make_shared<internal::MemDataSrcFactoryImpl>(std::vector<DataBlock> {
+            DataBlock {address, size}
+        })
+    }
+{
+}
+
+MemoryDataSourceFactory::MemoryDataSourceFactory(const std::vector<DataBlock>& chunks) :
+    _pimpl {std::make_shared<internal::MemDataSrcFactoryImpl>(chunks)}
+{
+}
+
+Size MemoryDataSourceFactory::size() const noexcept
+{
+    return _pimpl->size();
+}
+
+Size MemoryDataSourceFactory::chunkCount() const noexcept
+{
+    return _pimpl->chunkCount();
+}
+
+DataSource::UP MemoryDataSourceFactory::_createDataSource()
+{
+    return std::make_unique<internal::MemoryDataSource>(_pimpl);
+}
+
+} // namespace yactfr
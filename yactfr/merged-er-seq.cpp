@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <algorithm>
+
+#include <yactfr/merged-er-seq.hpp>
+#include <yactfr/elem.hpp>
+
+namespace yactfr {
+
+MergedEventRecordSequence::_Stream::_Stream(ElementSequence& seq) :
+    it {seq.begin()},
+    endIt {seq.end()}
+{
+}
+
+MergedEventRecordSequence::MergedEventRecordSequence(const std::vector<ElementSequence *>& elemSeqs)
+{
+    _streams.reserve(elemSeqs.size());
+    _heap.reserve(elemSeqs.size());
+
+    for (const auto elemSeq : elemSeqs) {
+        assert(elemSeq);
+        _streams.emplace_back(*elemSeq);
+    }
+}
+
+/*
+ * Advances the iterator of `stream` to the EventRecordBeginningElement
+ * of its next event record, setting `stream.nextCycles` to its default
+ * clock value.
+ *
+ * Returns false if there's no next event record.
+ */
+bool MergedEventRecordSequence::_advance(_Stream& stream)
+{
+    auto& it = stream.it;
+
+    while (it != stream.endIt) {
+        switch (it->kind()) {
+        case Element::Kind::DEFAULT_CLOCK_VALUE:
+            // for example, the beginning default clock value of a packet
+            stream.lastCycles = it->asDefaultClockValueElement().cycles();
+            break;
+
+        case Element::Kind::EVENT_RECORD_BEGINNING:
+        {
+            /*
+             * Find the default clock value of this event record within
+             * its header, and then go back to its beginning.
+             */
+            it.savePosition(stream.erBeginPos);
+            ++it;
+
+            while (it != stream.endIt) {
+                const auto kind = it->kind();
+
+                if (kind == Element::Kind::DEFAULT_CLOCK_VALUE) {
+                    stream.lastCycles = it->asDefaultClockValueElement().cycles();
+                    break;
+                } else if (kind == Element::Kind::EVENT_RECORD_INFO ||
+                        kind == Element::Kind::EVENT_RECORD_END) {
+                    break;
+                }
+
+                ++it;
+            }
+
+            stream.nextCycles = stream.lastCycles;
+            it.restorePosition(stream.erBeginPos);
+            return true;
+        }
+
+        default:
+            break;
+        }
+
+        ++it;
+    }
+
+    return false;
+}
+
+/*
+ * Returns whether or not the next event record of the stream `a` comes
+ * after the one of the stream `b`.
+ *
+ * The standard heap algorithms build a max-heap: using this comparison
+ * puts the stream of the earliest event record at the top.
+ */
+bool MergedEventRecordSequence::_isAfter(const Index a, const Index b) const noexcept
+{
+    const auto aCycles = _streams[a].nextCycles;
+    const auto bCycles = _streams[b].nextCycles;
+
+    return aCycles > bCycles || (aCycles == bCycles && a > b);
+}
+
+void MergedEventRecordSequence::_pushHeap(const Index index)
+{
+    _heap.push_back(index);
+    std::push_heap(_heap.begin(), _heap.end(), [this](const Index a, const Index b) {
+        return this->_isAfter(a, b);
+    });
+}
+
+bool MergedEventRecordSequence::next()
+{
+    if (!_isPrimed) {
+        for (Index i = 0; i < _streams.size(); ++i) {
+            if (this->_advance(_streams[i])) {
+                this->_pushHeap(i);
+            }
+        }
+
+        _isPrimed = true;
+    } else if (_hasCur) {
+        // finish the current event record and find the next one of its stream
+        auto& stream = _streams[_curIndex];
+
+        _hasCur = false;
+        stream.it.skipToEventRecordEnd();
+        ++stream.it;
+
+        if (this->_advance(stream)) {
+            this->_pushHeap(_curIndex);
+        }
+    }
+
+    if (_heap.empty()) {
+        return false;
+    }
+
+    std::pop_heap(_heap.begin(), _heap.end(), [this](const Index a, const Index b) {
+        return this->_isAfter(a, b);
+    });
+    _curIndex = _heap.back();
+    _heap.pop_back();
+    _hasCur = true;
+    return true;
+}
+
+} // namespace yactfr
@@ -9,6 +9,7 @@
 #include <memory>
 #include <sstream>
 #include <vector>
+#include <array>
 #include <cassert>
 #include <boost/endian/conversion.hpp>
 #include <boost/uuid/nil_generator.hpp>
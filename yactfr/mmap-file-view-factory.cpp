@@ -6,37 +6,18 @@
  */
 
 #include <cstring>
-#include <sstream>
+#include <algorithm>
 #include <sys/mman.h>
 
 #include <yactfr/mmap-file-view-factory.hpp>
-#include <yactfr/io-error.hpp>
-
 #include "internal/mmap-file-view-factory-impl.hpp"
-#include "internal/utils.hpp"
+#include "internal/mmap-file-view.hpp"
 
 namespace yactfr {
 namespace internal {
 
-class MemoryMappedFileView final :
-    public DataSource
-{
-public:
-    explicit MemoryMappedFileView(std::shared_ptr<internal::MmapFileViewFactoryImpl> mmapFileViewFactoryImpl);
-    ~MemoryMappedFileView();
-
-private:
-    boost::optional<DataBlock> _data(Index offset, Size minSize) override;
-    void _doMmap(Index offset);
-    void _doMunmap();
-
-private:
-    std::shared_ptr<internal::MmapFileViewFactoryImpl> _mmapFileViewFactoryImpl;
-    void *_mmapAddr = nullptr;
-    Size _mmapLength = 0;
-    Index _mmapOffset = 0;
-    std::array<std::uint8_t, 16> _tmpBuf;
-};
+constexpr Size MemoryMappedFileView::_adaptiveBlkSize;
+constexpr Size MemoryMappedFileView::_adaptiveReadAheadSize;
 
 MemoryMappedFileView::MemoryMappedFileView(std::shared_ptr<internal::MmapFileViewFactoryImpl> mmapFileViewFactoryImpl) :
     _mmapFileViewFactoryImpl {mmapFileViewFactoryImpl}
@@ -45,107 +26,238 @@ MemoryMappedFileView::MemoryMappedFileView(std::shared_ptr<internal::MmapFileVie
 
 MemoryMappedFileView::~MemoryMappedFileView()
 {
-    this->_doMunmap();
+    if (_region) {
+        _mmapFileViewFactoryImpl->unpinRegion(*_region);
+    }
 }
 
 boost::optional<DataBlock> MemoryMappedFileView::_data(const Index offset, const Size minSize)
 {
-    if ((offset + minSize) > _mmapFileViewFactoryImpl->fileSize()) {
-        // no more data
-        return boost::none;
-    }
+    auto fileSize = _mmapFileViewFactoryImpl->fileSize();
+
+    if ((offset + minSize) > fileSize) {
+        if (!_mmapFileViewFactoryImpl->isLive()) {
+            // no more data
+            return boost::none;
+        }
+
+        /*
+         * The file could have grown since the last check.
+         *
+         * Get the completion state _before_ the file size so that the
+         * new size includes everything written before completion.
+         */
+        const auto isComplete = _mmapFileViewFactoryImpl->isComplete();
+
+        fileSize = _mmapFileViewFactoryImpl->updateFileSize();
+
+        if ((offset + minSize) > fileSize) {
+            if (isComplete) {
+                // no more data
+                return boost::none;
+            }
 
-    if (!_mmapAddr) {
-        // no current memory map
-        this->_doMmap(offset);
+            // this is the current end of the file: try again later
+            throw DataNotAvailable {};
+        }
     }
 
-    if (offset < _mmapOffset || offset >= (_mmapOffset + _mmapLength)) {
+    if (!_region || offset < _region->offset ||
+            offset >= (_region->offset + _region->length)) {
         // requested offset is outside the current memory-mapped region
-        this->_doMmap(offset);
+        this->_pinRegion(offset);
     }
 
-    assert(_mmapAddr);
+    assert(_region);
 
-    const auto offsetFromMmapOffset = offset - _mmapOffset;
-    const void * const addr = static_cast<const void *>(static_cast<const std::uint8_t *>(_mmapAddr) + offsetFromMmapOffset);
-    const auto availSize = _mmapLength - offsetFromMmapOffset;
+    const auto offsetFromMmapOffset = offset - _region->offset;
+    const void * const addr = static_cast<const void *>(static_cast<const std::uint8_t *>(_region->addr) + offsetFromMmapOffset);
+
+    // in live mode, a region can extend beyond the end of the file
+    auto availSize = std::min(_region->offset + _region->length, fileSize) - offset;
+    const auto isAdaptive = _mmapFileViewFactoryImpl->accessPattern() ==
+                            MemoryMappedFileViewFactory::AccessPattern::ADAPTIVE;
 
     if (availSize < minSize) {
         /*
          * We don't have enough memory mapped data to satisfy the
          * requested minimum size.
          *
-         * Copy the available data to our temporary buffer, perform a
-         * new memory map operation to map the region just after the
-         * current region, and append what's left to get `minSize` bytes
-         * in the temporary buffer.
+         * Copy the available data to our temporary buffer, pin the
+         * region just after the current region, and append what's left
+         * to get `minSize` bytes in the temporary buffer.
          */
         std::memcpy(_tmpBuf.data(), addr, availSize);
-        this->_doMmap(_mmapOffset + _mmapLength);
-        std::memcpy(_tmpBuf.data() + availSize, _mmapAddr, minSize - availSize);
+        this->_pinRegion(_region->offset + _region->length);
+        std::memcpy(_tmpBuf.data() + availSize, _region->addr, minSize - availSize);
+
+        if (isAdaptive) {
+            this->_adapt(offset, offset + minSize);
+        }
 
         // return `minSize` bytes from our temporary buffer
         return DataBlock {static_cast<const void *>(_tmpBuf.data()), minSize};
     } else {
+        if (isAdaptive) {
+            // make sure this view gets called again soon
+            availSize = std::min(availSize, _adaptiveBlkSize);
+            this->_adapt(offset, offset + availSize);
+        }
+
         return DataBlock {addr, availSize};
     }
 }
 
-void MemoryMappedFileView::_doMunmap()
+void MemoryMappedFileView::_pinRegion(const Index offset)
 {
-    if (_mmapAddr) {
-        munmap(_mmapAddr, static_cast<size_t>(_mmapLength));
-        _mmapAddr = nullptr;
+    // pin the new region first so that the cache can't evict it
+    auto& region = _mmapFileViewFactoryImpl->pinRegion(offset);
+
+    if (_region) {
+        _mmapFileViewFactoryImpl->unpinRegion(*_region);
     }
+
+    _region = &region;
 }
 
-void MemoryMappedFileView::_doMmap(const Index offset)
+void MemoryMappedFileView::_adapt(const Index offset, const Index blkEndOffset)
 {
-    this->_doMunmap();
-    _mmapOffset = offset & ~(_mmapFileViewFactoryImpl->mmapOffsetGranularity() - 1);
-    _mmapLength = std::min(_mmapFileViewFactoryImpl->fileSize() - _mmapOffset,
-                           _mmapFileViewFactoryImpl->mmapSize());
-    _mmapAddr = mmap(NULL, static_cast<size_t>(_mmapLength), PROT_READ,
-                     MAP_PRIVATE, _mmapFileViewFactoryImpl->fd(),
-                     static_cast<off_t>(_mmapOffset));
-
-    if (_mmapAddr == MAP_FAILED) {
-        const auto error = internal::strError();
-        std::ostringstream ss;
-
-        ss << "Cannot memory-map region [" << _mmapOffset << ", " <<
-              (_mmapOffset + _mmapLength) << "[ of file \"" <<
-              _mmapFileViewFactoryImpl->path() << "\": " << error;
-        _mmapAddr = nullptr;
-        throw IOError {ss.str()};
+    auto& counters = _mmapFileViewFactoryImpl->counters();
+
+    /*
+     * An access is sequential if it's within the previous data block
+     * or not too far after it (the VM may skip some data).
+     */
+    const auto isSeqAccess = _hasPrevBlk && offset >= _prevBlkOffset &&
+                             offset <= _prevBlkEndOffset + _adaptiveBlkSize;
+
+    _hasPrevBlk = true;
+    _prevBlkOffset = offset;
+    _prevBlkEndOffset = blkEndOffset;
+
+    if (isSeqAccess) {
+        ++_seqAccessCount;
+    } else {
+        _seqAccessCount = 0;
+        _readAheadEndOffset = 0;
+        _releasedEndOffset = offset;
     }
 
-    switch (_mmapFileViewFactoryImpl->accessPattern()) {
-    case MemoryMappedFileViewFactory::AccessPattern::NORMAL:
-        (void) madvise(_mmapAddr, static_cast<size_t>(_mmapLength), MADV_NORMAL);
-        break;
-    case MemoryMappedFileViewFactory::AccessPattern::SEQUENTIAL:
-        (void) madvise(_mmapAddr, static_cast<size_t>(_mmapLength), MADV_SEQUENTIAL);
-        break;
-    case MemoryMappedFileViewFactory::AccessPattern::RANDOM:
-        (void) madvise(_mmapAddr, static_cast<size_t>(_mmapLength), MADV_RANDOM);
-        break;
+    if (!_isSequential && _seqAccessCount >= 2) {
+        _isSequential = true;
+        ++counters.sequentialSwitchCount;
+        this->_advise(offset, _region->offset + _region->length, MADV_SEQUENTIAL);
+    } else if (_isSequential && !isSeqAccess) {
+        _isSequential = false;
+        ++counters.randomSwitchCount;
+        this->_advise(offset, blkEndOffset, MADV_RANDOM);
     }
+
+    if (!_isSequential) {
+        return;
+    }
+
+    // read ahead what follows the returned data block
+    const auto readAheadBeginOffset = std::max(_readAheadEndOffset, blkEndOffset);
+    const auto readAheadEndOffset = blkEndOffset + _adaptiveReadAheadSize;
+
+    if (readAheadBeginOffset < readAheadEndOffset) {
+        counters.readAheadSize += this->_advise(readAheadBeginOffset, readAheadEndOffset,
+                                                MADV_WILLNEED);
+        _readAheadEndOffset = readAheadEndOffset;
+    }
+
+    // release what's well before the returned data block
+    if (offset > _releasedEndOffset + _adaptiveBlkSize) {
+        const auto releasedEndOffset = offset - _adaptiveBlkSize;
+
+        counters.releasedSize += this->_release(_releasedEndOffset, releasedEndOffset);
+        _releasedEndOffset = releasedEndOffset;
+    }
+}
+
+Size MemoryMappedFileView::_advise(Index beginOffset, Index endOffset, const int advice)
+{
+    const auto pageSize = _mmapFileViewFactoryImpl->mmapOffsetGranularity();
+
+    // only advise pages of the current region
+    beginOffset = std::max(beginOffset, _region->offset) & ~(pageSize - 1);
+    endOffset = std::min(endOffset, _region->offset + _region->length);
+
+    if (beginOffset >= endOffset) {
+        return 0;
+    }
+
+    const auto addr = static_cast<std::uint8_t *>(_region->addr) + (beginOffset - _region->offset);
+    const auto size = endOffset - beginOffset;
+
+    (void) madvise(addr, static_cast<size_t>(size), advice);
+    return size;
+}
+
+Size MemoryMappedFileView::_release(Index beginOffset, Index endOffset)
+{
+    const auto pageSize = _mmapFileViewFactoryImpl->mmapOffsetGranularity();
+
+    // only release whole pages of the current region
+    beginOffset = (std::max(beginOffset, _region->offset) + pageSize - 1) & ~(pageSize - 1);
+    endOffset = std::min(endOffset, _region->offset + _region->length) & ~(pageSize - 1);
+
+    if (beginOffset >= endOffset) {
+        return 0;
+    }
+
+    const auto addr = static_cast<std::uint8_t *>(_region->addr) + (beginOffset - _region->offset);
+    const auto size = static_cast<size_t>(endOffset - beginOffset);
+
+#ifdef MADV_COLD
+    /*
+     * Deactivate the pages so that the kernel reclaims them first,
+     * without discarding them for the other views.
+     */
+    if (madvise(addr, size, MADV_COLD) == 0) {
+        return endOffset - beginOffset;
+    }
+#endif
+
+    // older kernel: drop the pages from this mapping
+    (void) madvise(addr, size, MADV_DONTNEED);
+    return endOffset - beginOffset;
 }
 
 } // namespace internal
 
 MemoryMappedFileViewFactory::MemoryMappedFileViewFactory(std::string path,
                                                          const boost::optional<Size>& preferredMmapSize,
-                                                         const MemoryMappedFileViewFactory::AccessPattern accessPattern) :
+                                                         const MemoryMappedFileViewFactory::AccessPattern accessPattern,
+                                                         const boost::optional<Size>& maxCachedMmapSize) :
     _pimpl {
         std::make_shared<internal::MmapFileViewFactoryImpl>(std::move(path), preferredMmapSize,
-                                                            accessPattern)
+                                                            accessPattern, maxCachedMmapSize)
     }
 {
 }
 
+Size MemoryMappedFileViewFactory::maximumCachedMmapSize() const noexcept
+{
+    return _pimpl->maxCachedMmapSize();
+}
+
+MemoryMappedFileViewFactory::Counters MemoryMappedFileViewFactory::counters() const noexcept
+{
+    auto& counters = _pimpl->counters();
+
+    return Counters {
+        counters.mmapCount,
+        counters.munmapCount,
+        counters.cachedRegionHitCount,
+        counters.readAheadSize,
+        counters.releasedSize,
+        counters.sequentialSwitchCount,
+        counters.randomSwitchCount,
+    };
+}
+
 MemoryMappedFileViewFactory::AccessPattern MemoryMappedFileViewFactory::expectedAccessPattern() const noexcept
 {
     return _pimpl->accessPattern();
@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+
+#include <yactfr/multi-file-data-src-factory.hpp>
+
+#include "internal/multi-file-data-src-factory-impl.hpp"
+
+namespace yactfr {
+namespace internal {
+
+class MultiFileDataSource final :
+    public DataSource
+{
+public:
+    explicit MultiFileDataSource(std::shared_ptr<internal::MultiFileDataSrcFactoryImpl> multiFileDataSrcFactoryImpl);
+    ~MultiFileDataSource();
+
+private:
+    boost::optional<DataBlock> _data(Index offset, Size minSize) override;
+    Size _read(Index offset);
+
+private:
+    std::shared_ptr<internal::MultiFileDataSrcFactoryImpl> _multiFileDataSrcFactoryImpl;
+    std::unique_ptr<BufFileDataSrcBuf> _buf;
+
+    /*
+     * Current block: first byte, offset within the concatenated data,
+     * and size.
+     */
+    const std::uint8_t *_blkBegin = nullptr;
+    Index _blkOffset = 0;
+    Size _blkSize = 0;
+};
+
+MultiFileDataSource::MultiFileDataSource(std::shared_ptr<internal::MultiFileDataSrcFactoryImpl> multiFileDataSrcFactoryImpl) :
+    _multiFileDataSrcFactoryImpl {multiFileDataSrcFactoryImpl},
+    _buf {multiFileDataSrcFactoryImpl->takeBuf()}
+{
+}
+
+MultiFileDataSource::~MultiFileDataSource()
+{
+    _multiFileDataSrcFactoryImpl->giveBackBuf(std::move(_buf));
+}
+
+boost::optional<DataBlock> MultiFileDataSource::_data(const Index offset, const Size minSize)
+{
+    if (!_multiFileDataSrcFactoryImpl->hasSize(offset + minSize)) {
+        // no more data
+        return boost::none;
+    }
+
+    const auto blkEndOffset = _blkOffset + _blkSize;
+
+    if (offset >= _blkOffset && (offset + minSize) <= blkEndOffset) {
+        // requested data is within the current block
+        const auto offsetFromBlkOffset = offset - _blkOffset;
+
+        return DataBlock {
+            static_cast<const void *>(_blkBegin + offsetFromBlkOffset),
+            _blkSize - offsetFromBlkOffset
+        };
+    }
+
+    const auto readArea = _buf->readArea();
+
+    if (offset >= _blkOffset && offset < blkEndOffset) {
+        /*
+         * We don't have enough buffered data to satisfy the requested
+         * minimum size (the current block can end at the end of a
+         * file).
+         *
+         * Move the available data to the end of the carry-over area,
+         * just before the read area, and read the following block into
+         * the read area.
+         */
+        const auto availSize = blkEndOffset - offset;
+
+        assert(availSize < minSize);
+        assert(availSize <= BufFileDataSrcBuf::carryOverSize);
+
+        const auto carryOverBegin = readArea - availSize;
+
+        std::memmove(carryOverBegin, _blkBegin + (offset - _blkOffset), availSize);
+        _blkSize = 0;
+
+        const auto readSize = this->_read(blkEndOffset);
+
+        _blkSize = availSize + readSize;
+        _blkBegin = carryOverBegin;
+        _blkOffset = offset;
+
+        if (_blkSize < minSize && readSize > 0) {
+            /*
+             * The following block is the end of a file which is too
+             * small: carry over again.
+             */
+            return this->_data(offset, minSize);
+        }
+    } else {
+        // requested offset is outside the current block
+        _blkSize = 0;
+        _blkSize = this->_read(offset);
+        _blkBegin = readArea;
+        _blkOffset = offset;
+
+        if (_blkSize > 0 && _blkSize < minSize) {
+            // the requested data spans more than one file
+            return this->_data(offset, minSize);
+        }
+    }
+
+    if (_blkSize < minSize) {
+        // file is shorter than when the factory got its size
+        return boost::none;
+    }
+
+    return DataBlock {static_cast<const void *>(_blkBegin), _blkSize};
+}
+
+Size MultiFileDataSource::_read(const Index offset)
+{
+    const auto loc = _multiFileDataSrcFactoryImpl->location(offset);
+
+    if (!loc) {
+        return 0;
+    }
+
+    // a block never spans more than one file
+    const auto size = std::min(_multiFileDataSrcFactoryImpl->fileSize(loc->fileIndex) - loc->offset,
+                               _buf->blockSize());
+
+    return _multiFileDataSrcFactoryImpl->read(loc->fileIndex, loc->offset, _buf->readArea(),
+                                              size);
+}
+
+} // namespace internal
+
+MultiFileDataSourceFactory::MultiFileDataSourceFactory(std::vector<std::string> paths,
+                                                       const boost::optional<Size>& maximumOpenFileCount,
+                                                       const boost::optional<Size>& blockSize) :
+    _pimpl {
+        std::make_shared<internal::MultiFileDataSrcFactoryImpl>(std::move(paths),
+                                                                maximumOpenFileCount, blockSize)
+    }
+{
+}
+
+const std::vector<std::string>& MultiFileDataSourceFactory::paths() const noexcept
+{
+    return _pimpl->paths();
+}
+
+Size MultiFileDataSourceFactory::maximumOpenFileCount() const noexcept
+{
+    return _pimpl->maxOpenFileCount();
+}
+
+Size MultiFileDataSourceFactory::blockSize() const noexcept
+{
+    return _pimpl->blockSize();
+}
+
+boost::optional<MultiFileDataSourceFactory::Location> MultiFileDataSourceFactory::location(const Index offset) const
+{
+    return _pimpl->location(offset);
+}
+
+Index MultiFileDataSourceFactory::fileOffset(const Index fileIndex) const
+{
+    return _pimpl->fileOffset(fileIndex);
+}
+
+DataSource::UP MultiFileDataSourceFactory::_createDataSource()
+{
+    return std::make_unique<internal::MultiFileDataSource>(_pimpl);
+}
+
+} // namespace yactfr
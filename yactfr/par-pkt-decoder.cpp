@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <yactfr/par-pkt-decoder.hpp>
+
+#include "internal/par-pkt-decoder-impl.hpp"
+
+namespace yactfr {
+
+ParallelPacketDecoder::ParallelPacketDecoder(const TraceType& traceType,
+                                             DataSourceFactory& dataSrcFactory,
+                                             const PacketIndex& pktIndex,
+                                             const ElementSequenceOptions& opts,
+                                             const boost::optional<Size>& workerCount,
+                                             const boost::optional<Size>& pktsPerRange,
+                                             const boost::optional<Size>& maxPendingRangeCount) :
+    _pimpl {
+        std::make_unique<internal::ParPktDecoderImpl>(traceType, dataSrcFactory, pktIndex, opts,
+                                                      workerCount, pktsPerRange,
+                                                      maxPendingRangeCount)
+    }
+{
+}
+
+ParallelPacketDecoder::~ParallelPacketDecoder()
+{
+}
+
+Size ParallelPacketDecoder::workerCount() const noexcept
+{
+    return _pimpl->workerCount();
+}
+
+Size ParallelPacketDecoder::packetsPerRange() const noexcept
+{
+    return _pimpl->pktsPerRange();
+}
+
+Size ParallelPacketDecoder::rangeCount() const noexcept
+{
+    return _pimpl->rangeCount();
+}
+
+Size ParallelPacketDecoder::maximumPendingRangeCount() const noexcept
+{
+    return _pimpl->maxPendingRangeCount();
+}
+
+bool ParallelPacketDecoder::next(ElementBatch& batch)
+{
+    return _pimpl->next(batch);
+}
+
+} // namespace yactfr
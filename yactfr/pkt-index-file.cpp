@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <yactfr/pkt-index-file.hpp>
+
+#include "internal/pkt-index-file-impl.hpp"
+
+namespace yactfr {
+
+PacketIndexFile::PacketIndexFile(std::string path, const TraceType& traceType,
+                                 const std::string& metadataText, std::string dataStreamPath,
+                                 DataSourceFactory& dataSrcFactory) :
+    _pimpl {
+        std::make_unique<internal::PktIndexFileImpl>(std::move(path), traceType, metadataText,
+                                                     std::move(dataStreamPath), dataSrcFactory)
+    }
+{
+}
+
+PacketIndexFile::~PacketIndexFile()
+{
+}
+
+const std::string& PacketIndexFile::path() const noexcept
+{
+    return _pimpl->path();
+}
+
+const std::string& PacketIndexFile::dataStreamPath() const noexcept
+{
+    return _pimpl->dsPath();
+}
+
+Size PacketIndexFile::size() const noexcept
+{
+    return _pimpl->size();
+}
+
+bool PacketIndexFile::wasUpdated() const noexcept
+{
+    return _pimpl->wasUpdated();
+}
+
+PacketIndexEntry PacketIndexFile::operator[](const Index index) const noexcept
+{
+    return _pimpl->entry(index);
+}
+
+boost::optional<PacketIndexEntry> PacketIndexFile::findEntry(const Index offset) const noexcept
+{
+    return _pimpl->findEntry(offset);
+}
+
+} // namespace yactfr
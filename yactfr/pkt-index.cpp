@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <algorithm>
+#include <cassert>
+
+#include <yactfr/pkt-index.hpp>
+#include <yactfr/pkt-index-file.hpp>
+
+#include "internal/pkt-indexer.hpp"
+
+namespace yactfr {
+
+PacketIndex::PacketIndex(const TraceType& traceType, DataSourceFactory& dataSrcFactory)
+{
+    internal::PktIndexer::index(traceType, dataSrcFactory, 0, false,
+                                [this](const PacketIndexEntry& entry) {
+        _entries.push_back(entry);
+    });
+}
+
+PacketIndex::PacketIndex(const PacketIndexFile& file)
+{
+    _entries.reserve(file.size());
+
+    for (Index i = 0; i < file.size(); ++i) {
+        _entries.push_back(file[i]);
+    }
+}
+
+const PacketIndexEntry& PacketIndex::operator[](const Index index) const noexcept
+{
+    assert(index < _entries.size());
+    return _entries[index];
+}
+
+const PacketIndexEntry *PacketIndex::findEntry(const Index offset) const noexcept
+{
+    /*
+     * Find the last entry of which the offset is less than or equal to
+     * `offset`.
+     */
+    const auto it = std::upper_bound(_entries.begin(), _entries.end(), offset,
+                                     [](const Index offset, const PacketIndexEntry& entry) {
+        return offset < entry.offsetInElementSequence();
+    });
+
+    if (it == _entries.begin()) {
+        return nullptr;
+    }
+
+    const auto& entry = *(it - 1);
+    const auto nextOffset = internal::PktIndexer::nextPktOffset(entry);
+
+    if (nextOffset && offset >= *nextOffset) {
+        // after the end of the packet
+        return nullptr;
+    }
+
+    return &entry;
+}
+
+} // namespace yactfr
@@ -0,0 +1,326 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstring>
+#include <cassert>
+#include <array>
+#include <deque>
+#include <vector>
+#include <algorithm>
+
+#include <yactfr/read-ahead-file-data-src-factory.hpp>
+#include <yactfr/io-error.hpp>
+
+#include "internal/buf-file-data-src-factory-impl.hpp"
+#include "internal/async-file-reader.hpp"
+
+namespace yactfr {
+namespace internal {
+
+/*
+ * A read-ahead file data source owns `maxDepth + 1` buffers (slots):
+ * the one containing the current block and up to `maxDepth` ones which
+ * contain, or will contain once their read request completes, the
+ * following contiguous blocks of the file (the window).
+ *
+ * The ID of the read request of a slot is its index.
+ */
+class ReadAheadFileDataSource final :
+    public DataSource
+{
+public:
+    explicit ReadAheadFileDataSource(std::shared_ptr<internal::BufFileDataSrcFactoryImpl> bufFileDataSrcFactoryImpl,
+                                     Size maxDepth, bool isNonBlocking,
+                                     ReadAheadFileDataSourceFactory::Backend backend);
+    ~ReadAheadFileDataSource();
+
+private:
+    struct _Slot final
+    {
+        std::unique_ptr<BufFileDataSrcBuf> buf;
+
+        // requested region
+        Index offset = 0;
+        Size size = 0;
+    };
+
+private:
+    boost::optional<DataBlock> _data(Index offset, Size minSize) override;
+    void _fillWindow();
+    void _releaseWindowFront();
+    void _resetWindow();
+
+    Size _minDepth() const noexcept
+    {
+        return std::min(static_cast<Size>(2), _maxDepth);
+    }
+
+private:
+    std::shared_ptr<internal::BufFileDataSrcFactoryImpl> _bufFileDataSrcFactoryImpl;
+    Size _maxDepth;
+    bool _isNonBlocking;
+    std::vector<_Slot> _slots;
+    std::unique_ptr<AsyncFileReader> _reader;
+
+    // indexes of the slots of the window, in file order
+    std::deque<Index> _window;
+
+    // indexes of the slots which are neither current nor in the window
+    std::vector<Index> _freeSlotIndexes;
+
+    // index of the slot containing the current block
+    boost::optional<Index> _curSlotIndex;
+
+    // current read-ahead depth, within [_minDepth(), `_maxDepth`]
+    Size _depth;
+
+    // offset of the block following the window
+    Index _nextReadOffset = 0;
+
+    // current block: first byte, offset within the file, and size
+    const std::uint8_t *_blkBegin = nullptr;
+    Index _blkOffset = 0;
+    Size _blkSize = 0;
+};
+
+ReadAheadFileDataSource::ReadAheadFileDataSource(std::shared_ptr<internal::BufFileDataSrcFactoryImpl> bufFileDataSrcFactoryImpl,
+                                                 const Size maxDepth, const bool isNonBlocking,
+                                                 const ReadAheadFileDataSourceFactory::Backend backend) :
+    _bufFileDataSrcFactoryImpl {bufFileDataSrcFactoryImpl},
+    _maxDepth {maxDepth},
+    _isNonBlocking {isNonBlocking},
+    _slots(maxDepth + 1)
+{
+    assert(maxDepth >= 1);
+
+    for (auto i = _slots.size(); i > 0; --i) {
+        _slots[i - 1].buf = bufFileDataSrcFactoryImpl->takeBuf();
+        _freeSlotIndexes.push_back(i - 1);
+    }
+
+    if (backend == ReadAheadFileDataSourceFactory::Backend::IO_URING) {
+        _reader = internal::createIoUringAsyncFileReader(bufFileDataSrcFactoryImpl->fd(),
+                                                         bufFileDataSrcFactoryImpl->path(),
+                                                         _slots.size());
+    }
+
+    if (!_reader) {
+        _reader = std::make_unique<ThreadAsyncFileReader>(bufFileDataSrcFactoryImpl->fd(),
+                                                          bufFileDataSrcFactoryImpl->path(),
+                                                          _slots.size());
+    }
+
+    _depth = this->_minDepth();
+}
+
+ReadAheadFileDataSource::~ReadAheadFileDataSource()
+{
+    // wait for the pending requests before giving back their buffers
+    _reader.reset();
+
+    for (auto& slot : _slots) {
+        _bufFileDataSrcFactoryImpl->giveBackBuf(std::move(slot.buf));
+    }
+}
+
+void ReadAheadFileDataSource::_fillWindow()
+{
+    const auto fileSize = _bufFileDataSrcFactoryImpl->fileSize();
+
+    while (_window.size() < _depth && _nextReadOffset < fileSize && !_freeSlotIndexes.empty()) {
+        const auto slotIndex = _freeSlotIndexes.back();
+        auto& slot = _slots[slotIndex];
+
+        slot.offset = _nextReadOffset;
+        slot.size = std::min(fileSize - _nextReadOffset, slot.buf->blockSize());
+        _reader->submit(slotIndex, slot.buf->readArea(), slot.size, slot.offset);
+        _freeSlotIndexes.pop_back();
+        _window.push_back(slotIndex);
+        _nextReadOffset += slot.size;
+    }
+}
+
+void ReadAheadFileDataSource::_releaseWindowFront()
+{
+    assert(!_window.empty());
+
+    const auto slotIndex = _window.front();
+
+    /*
+     * The reader writes to the buffer of a pending request: wait for
+     * its completion, even in non-blocking mode.
+     *
+     * Ignore any read error: the VM doesn't need this block anymore.
+     */
+    try {
+        static_cast<void>(_reader->result(slotIndex, true));
+    } catch (const IOError&) {
+    }
+
+    _window.pop_front();
+    _freeSlotIndexes.push_back(slotIndex);
+}
+
+void ReadAheadFileDataSource::_resetWindow()
+{
+    while (!_window.empty()) {
+        this->_releaseWindowFront();
+    }
+}
+
+boost::optional<DataBlock> ReadAheadFileDataSource::_data(const Index offset, const Size minSize)
+{
+    if ((offset + minSize) > _bufFileDataSrcFactoryImpl->fileSize()) {
+        // no more data
+        return boost::none;
+    }
+
+    const auto blkEndOffset = _blkOffset + _blkSize;
+
+    if (offset >= _blkOffset && (offset + minSize) <= blkEndOffset) {
+        // requested data is within the current block
+        const auto offsetFromBlkOffset = offset - _blkOffset;
+
+        return DataBlock {
+            static_cast<const void *>(_blkBegin + offsetFromBlkOffset),
+            _blkSize - offsetFromBlkOffset
+        };
+    }
+
+    /*
+     * Until the next block is ready, this method must not modify the
+     * current block: in non-blocking mode, it throws DataNotAvailable
+     * and the VM requests the same data again later.
+     *
+     * Therefore, save the remaining bytes of the current block, if
+     * needed, and copy them to the carry-over area of the next block
+     * once it's ready.
+     */
+    std::array<std::uint8_t, BufFileDataSrcBuf::carryOverSize> carryOverBuf;
+    Size carryOverSize = 0;
+    auto reqOffset = offset;
+
+    if (offset >= _blkOffset && offset < blkEndOffset) {
+        carryOverSize = blkEndOffset - offset;
+        assert(carryOverSize < minSize);
+        assert(carryOverSize <= BufFileDataSrcBuf::carryOverSize);
+        std::memcpy(carryOverBuf.data(), _blkBegin + (offset - _blkOffset), carryOverSize);
+        reqOffset = blkEndOffset;
+    }
+
+    // forget the read-ahead blocks which precede the requested offset
+    while (!_window.empty()) {
+        const auto& slot = _slots[_window.front()];
+
+        if (slot.offset + slot.size > reqOffset) {
+            break;
+        }
+
+        this->_releaseWindowFront();
+    }
+
+    if (!_window.empty() && _slots[_window.front()].offset > reqOffset) {
+        // seeking backward
+        this->_resetWindow();
+    }
+
+    if (_window.empty()) {
+        _nextReadOffset = reqOffset;
+    }
+
+    this->_fillWindow();
+    assert(!_window.empty());
+
+    const auto slotIndex = _window.front();
+    auto readSize = _reader->result(slotIndex, false);
+    bool stalled = false;
+
+    if (!readSize) {
+        if (_isNonBlocking) {
+            throw DataNotAvailable {};
+        }
+
+        stalled = true;
+        readSize = _reader->result(slotIndex, true);
+    }
+
+    /*
+     * Adapt the read-ahead depth: double it when the VM consumes data
+     * faster than the reader provides it, and slowly decrease it when
+     * the following block is already ready too.
+     */
+    if (stalled) {
+        _depth = std::min(_depth * 2, _maxDepth);
+    } else if (_depth > this->_minDepth() && _window.size() >= 2 &&
+            _reader->result(_window[1], false)) {
+        --_depth;
+    }
+
+    // the next block becomes the current block
+    _window.pop_front();
+
+    if (_curSlotIndex) {
+        _freeSlotIndexes.push_back(*_curSlotIndex);
+    }
+
+    _curSlotIndex = slotIndex;
+
+    const auto& slot = _slots[slotIndex];
+    const auto readArea = slot.buf->readArea();
+    const auto offsetFromSlotOffset = reqOffset - slot.offset;
+
+    assert(carryOverSize == 0 || offsetFromSlotOffset == 0);
+    std::memcpy(readArea - carryOverSize, carryOverBuf.data(), carryOverSize);
+    _blkBegin = readArea + offsetFromSlotOffset - carryOverSize;
+    _blkOffset = offset;
+    _blkSize = carryOverSize;
+
+    if (*readSize > offsetFromSlotOffset) {
+        _blkSize += *readSize - offsetFromSlotOffset;
+    }
+
+    // keep reading ahead while the VM decodes this block
+    this->_fillWindow();
+
+    if (_blkSize < minSize) {
+        // file is shorter than when the factory opened it
+        return boost::none;
+    }
+
+    return DataBlock {static_cast<const void *>(_blkBegin), _blkSize};
+}
+
+} // namespace internal
+
+ReadAheadFileDataSourceFactory::ReadAheadFileDataSourceFactory(std::string path,
+                                                               const boost::optional<Size>& blockSize,
+                                                               const boost::optional<Size>& maximumReadAheadDepth,
+                                                               const bool isNonBlocking,
+                                                               const boost::optional<Backend>& backend) :
+    _pimpl {std::make_shared<internal::BufFileDataSrcFactoryImpl>(std::move(path), blockSize)},
+    _maxReadAheadDepth {maximumReadAheadDepth ?
+                        std::max(*maximumReadAheadDepth, static_cast<Size>(1)) : 8},
+    _isNonBlocking {isNonBlocking},
+    _backend {Backend::THREAD}
+{
+    if ((!backend || *backend == Backend::IO_URING) && internal::ioUringIsAvailable()) {
+        _backend = Backend::IO_URING;
+    }
+}
+
+Size ReadAheadFileDataSourceFactory::blockSize() const noexcept
+{
+    return _pimpl->blockSize();
+}
+
+DataSource::UP ReadAheadFileDataSourceFactory::_createDataSource()
+{
+    return std::make_unique<internal::ReadAheadFileDataSource>(_pimpl, _maxReadAheadDepth,
+                                                               _isNonBlocking, _backend);
+}
+
+} // namespace yactfr
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2022 Philippe Proulx <eepp.ca>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ */
+
+#include <cstring>
+#include <cassert>
+#include <array>
+#include <algorithm>
+
+#include <yactfr/zstd-file-data-src-factory.hpp>
+
+#include "internal/zstd-file-data-src-factory-impl.hpp"
+
+namespace yactfr {
+namespace internal {
+
+class ZstdSeekableFileDataSource final :
+    public DataSource
+{
+public:
+    explicit ZstdSeekableFileDataSource(std::shared_ptr<internal::ZstdFileDataSrcFactoryImpl> zstdFileDataSrcFactoryImpl);
+
+private:
+    boost::optional<DataBlock> _data(Index offset, Size minSize) override;
+    void _setFrame(Index frameIndex);
+
+private:
+    std::shared_ptr<internal::ZstdFileDataSrcFactoryImpl> _zstdFileDataSrcFactoryImpl;
+
+    // current frame: index and decompressed data
+    Index _frameIndex = 0;
+    ZstdFrameData _frameData;
+
+    std::array<std::uint8_t, 16> _tmpBuf;
+};
+
+ZstdSeekableFileDataSource::ZstdSeekableFileDataSource(std::shared_ptr<internal::ZstdFileDataSrcFactoryImpl> zstdFileDataSrcFactoryImpl) :
+    _zstdFileDataSrcFactoryImpl {zstdFileDataSrcFactoryImpl}
+{
+}
+
+void ZstdSeekableFileDataSource::_setFrame(const Index frameIndex)
+{
+    // release the current frame first so that the cache may reuse it
+    _frameData = nullptr;
+    _frameData = _zstdFileDataSrcFactoryImpl->frameData(frameIndex);
+    _frameIndex = frameIndex;
+}
+
+boost::optional<DataBlock> ZstdSeekableFileDataSource::_data(const Index offset, const Size minSize)
+{
+    if ((offset + minSize) > _zstdFileDataSrcFactoryImpl->decompressedSize()) {
+        // no more data
+        return boost::none;
+    }
+
+    const auto& frames = _zstdFileDataSrcFactoryImpl->frames();
+
+    if (!_frameData || offset < frames[_frameIndex].offset ||
+            offset >= frames[_frameIndex].offset + frames[_frameIndex].size) {
+        // requested offset is outside the current frame
+        this->_setFrame(_zstdFileDataSrcFactoryImpl->frameIndex(offset));
+    }
+
+    const auto& frame = frames[_frameIndex];
+    const auto offsetFromFrameOffset = offset - frame.offset;
+    const auto availSize = frame.size - offsetFromFrameOffset;
+
+    if (availSize >= minSize) {
+        return DataBlock {
+            static_cast<const void *>(_frameData->data() + offsetFromFrameOffset),
+            availSize
+        };
+    }
+
+    /*
+     * We don't have enough decompressed data to satisfy the requested
+     * minimum size.
+     *
+     * Copy the available data to our temporary buffer, and append the
+     * data of the following frames (which can be tiny) until we get
+     * `minSize` bytes in the temporary buffer.
+     */
+    std::memcpy(_tmpBuf.data(), _frameData->data() + offsetFromFrameOffset, availSize);
+
+    auto tmpSize = availSize;
+
+    while (tmpSize < minSize) {
+        assert(_frameIndex + 1 < frames.size());
+        this->_setFrame(_frameIndex + 1);
+
+        const auto copySize = std::min(minSize - tmpSize, frames[_frameIndex].size);
+
+        std::memcpy(_tmpBuf.data() + tmpSize, _frameData->data(), copySize);
+        tmpSize += copySize;
+    }
+
+    // return `minSize` bytes from our temporary buffer
+    return DataBlock {static_cast<const void *>(_tmpBuf.data()), minSize};
+}
+
+} // namespace internal
+
+ZstdSeekableFileDataSourceFactory::ZstdSeekableFileDataSourceFactory(std::string path,
+                                                                     const boost::optional<Size>& maximumCachedFrameCount) :
+    _pimpl {
+        std::make_shared<internal::ZstdFileDataSrcFactoryImpl>(std::move(path),
+                                                               maximumCachedFrameCount)
+    }
+{
+}
+
+bool ZstdSeekableFileDataSourceFactory::isSupported() noexcept
+{
+#ifdef YACTFR_HAVE_ZSTD
+    return true;
+#else
+    return false;
+#endif
+}
+
+Size ZstdSeekableFileDataSourceFactory::frameCount() const noexcept
+{
+    return _pimpl->frames().size();
+}
+
+Size ZstdSeekableFileDataSourceFactory::decompressedSize() const noexcept
+{
+    return _pimpl->decompressedSize();
+}
+
+Size ZstdSeekableFileDataSourceFactory::maximumCachedFrameCount() const noexcept
+{
+    return _pimpl->maxCachedFrameCount();
+}
+
+DataSource::UP ZstdSeekableFileDataSourceFactory::_createDataSource()
+{
+    return std::make_unique<internal::ZstdSeekableFileDataSource>(_pimpl);
+}
+
+} // namespace yactfr